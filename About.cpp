@@ -2,11 +2,12 @@
 
 #include "ChronoPlotter.h"
 #include "About.h"
+#include "Logging.h"
 
 About::About ( QWidget *parent )
 	: QWidget(parent)
 {
-	qDebug() << "About this app";
+	qCDebug(lcUi) << "About this app";
 
 	QLabel *logo = new QLabel();
 	QPixmap logoPix(":/images/logo.png");
@@ -1,5 +1,6 @@
 #include "PowderTest.h"
 #include "ChronoPlotter.h"
+#include "Logging.h"
 #include <QDialogButtonBox>
 #include <QFormLayout>
 #include <QVBoxLayout>
@@ -12,7 +13,7 @@ using namespace Powder;
 AutofillDialog::AutofillDialog(PowderTest *main, QDialog *parent)
 	: QDialog(parent)
 {
-	qDebug() << "Autofill dialog";
+	qCDebug(lcUi) << "Autofill dialog";
 
 	setWindowTitle("Auto-fill charge weights");
 
@@ -1,4 +1,6 @@
 #include <cmath>
+#include <stdio.h>
+#include <string.h>
 #include <Qt>
 #include <QApplication>
 #include <QDebug>
@@ -27,6 +29,10 @@
 #include <QDialog>
 #include <QByteArray>
 #include <QJsonDocument>
+#include <QShortcut>
+#include <QLoggingCategory>
+#include <QFontDatabase>
+#include <QTimer>
 #include "qcustomplot/qcustomplot.h"
 
 #include "miniz.c"
@@ -36,6 +42,12 @@
 #include "SeatingDepthTest.h"
 #include "TunerTest.h"
 #include "About.h"
+#include "ParserBenchmark.h"
+#include "RenderBenchmark.h"
+#include "Trace.h"
+#include "MemoryStats.h"
+#include "Logging.h"
+#include "Startup.h"
 
 int scaleFontSize ( int size )
 {
@@ -46,6 +58,41 @@ int scaleFontSize ( int size )
 	#endif
 }
 
+void registerFonts ( void )
+{
+	static bool registered = false;
+
+	if ( registered )
+	{
+		return;
+	}
+	registered = true;
+
+	TRACE_SPAN("startup", "register fonts");
+
+	int id = QFontDatabase::addApplicationFont(":/DejaVuSans.ttf");
+	qCDebug(lcUi) << "id:" << id << "font families:" << QFontDatabase::applicationFontFamilies(id);
+}
+
+bool saveRasterImage ( QCustomPlot *customPlot, const QString &path, const char *format )
+{
+	TraceSpan rasterSpan("render", "rasterise");
+	QImage image = customPlot->toPixmap(1440, 625, 2.0).toImage();
+	rasterSpan.end();
+
+	if ( image.isNull() )
+	{
+		return false;
+	}
+
+	// savePng() and saveJpg() store 96 dpi with the image
+	image.setDotsPerMeterX((int)(96 / 0.0254));
+	image.setDotsPerMeterY((int)(96 / 0.0254));
+
+	TRACE_SPAN("render", "encode");
+	return image.save(path, format);
+}
+
 std::vector<SplineSet> spline(QVector<double> &x, QVector<double> &y)
 {
     int n = x.size()-1;
@@ -161,14 +208,21 @@ GraphPreview::GraphPreview ( QPixmap& image, QWidget *parent )
 	label = new QLabel(this);
 	label->setPixmap(image);
 	label->setScaledContents(true);
+	imageMemory.set(MemoryStats::pixmapBytes(image));
 	setGeometry(300, 300, label->sizeHint().width() / 2, label->sizeHint().height() / 2);
 	setWindowTitle("Graph preview");
 	show();
 }
 
+void GraphPreview::setImage ( QPixmap& image )
+{
+	label->setPixmap(image);
+	imageMemory.set(MemoryStats::pixmapBytes(image));
+}
+
 void GraphPreview::resizeEvent ( QResizeEvent *event )
 {
-	qDebug() << "resizeEvent" << event;
+	qCDebug(lcUi) << "resizeEvent" << event;
 	label->setFixedSize(event->size());
 }
 
@@ -179,6 +233,41 @@ QHLine::QHLine ( QFrame *parent )
 	setFrameShadow(QFrame::Sunken);
 }
 
+LazyTab::LazyTab ( Factory factory, const char *name, QWidget *parent )
+	: QWidget(parent), factory(factory), name(name), tab(NULL)
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+	layout->setContentsMargins(0, 0, 0, 0);
+	setLayout(layout);
+}
+
+QWidget *LazyTab::content ( void )
+{
+	if ( tab == NULL )
+	{
+		TRACE_SPAN("startup", name);
+
+		tab = factory();
+		layout()->addWidget(tab);
+
+		// Children added to a page that's already showing aren't shown until the next event loop pass
+		if ( isVisible() )
+		{
+			tab->show();
+		}
+
+		qCDebug(lcUi) << "Built tab" << name << "at" << Startup::elapsed() << "ms";
+	}
+
+	return tab;
+}
+
+void LazyTab::showEvent ( QShowEvent *event )
+{
+	content();
+	QWidget::showEvent(event);
+}
+
 template<typename T>
 double sampleStdev ( T vals )
 {
@@ -201,7 +290,7 @@ template double sampleStdev<QList<double> >(QList<double>);
 
 void MainWindow::closeEvent ( QCloseEvent *event )
 {
-	qDebug() << "closeEvent called";
+	qCDebug(lcUi) << "closeEvent called";
 
 	event->ignore();
 
@@ -212,21 +301,168 @@ void MainWindow::closeEvent ( QCloseEvent *event )
 	box->show();
 }
 
+void MainWindow::paintEvent ( QPaintEvent *event )
+{
+	QMainWindow::paintEvent(event);
+
+	if ( ! painted )
+	{
+		painted = true;
+		Startup::mark("first paint");
+		QTimer::singleShot(0, this, SLOT(finishStartup()));
+	}
+}
+
+void MainWindow::finishStartup ( void )
+{
+	// Only the graphs draw with the bundled font, it can wait until the window is up
+	registerFonts();
+	Startup::mark("fonts registered");
+
+	QString report = Startup::report();
+	qCDebug(lcUi).noquote() << "Startup timings:\n" << report;
+
+	QStringList arguments = QCoreApplication::arguments();
+	int index = arguments.indexOf("--benchmark-startup");
+	if ( index < 0 )
+	{
+		return;
+	}
+
+	printf("%s", qPrintable(report));
+
+	// An optional budget in ms turns a slow first paint into a failed run
+	int exitCode = 0;
+	bool ok = false;
+	qint64 budget = (index + 1 < arguments.size()) ? arguments.at(index + 1).toLongLong(&ok) : 0;
+	if ( ok && (budget > 0) && (Startup::firstPaintMsecs() > budget) )
+	{
+		printf("First paint took %lld ms, over the %lld ms budget\n", Startup::firstPaintMsecs(), budget);
+		exitCode = 1;
+	}
+
+	fflush(stdout);
+	QCoreApplication::exit(exitCode);
+}
+
+void MainWindow::saveTrace ( void )
+{
+	// The first press starts recording, so a slow operation can be traced without restarting
+	if ( ! Trace::isEnabled() )
+	{
+		Trace::setEnabled(true);
+		QMessageBox::information(this, "Tracing", "Tracing started. Repeat the slow operation, then press Ctrl+Shift+T again to save the trace.", QMessageBox::Ok, QMessageBox::Ok);
+		return;
+	}
+
+	QString path = QFileDialog::getSaveFileName(this, "Save trace", "trace.json", "Chrome trace (*.json)");
+	qCDebug(lcUi) << "User selected trace path:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qCDebug(lcUi) << "No path selected, bailing";
+		return;
+	}
+
+	if ( Trace::writeChromeTrace(path) )
+	{
+		QMessageBox::information(this, "Tracing", QString("Saved trace to '%1'\n\nOpen it in chrome://tracing or ui.perfetto.dev").arg(path), QMessageBox::Ok, QMessageBox::Ok);
+	}
+	else
+	{
+		QMessageBox::warning(this, "Tracing", QString("Unable to save trace to '%1'").arg(path), QMessageBox::Ok, QMessageBox::Ok);
+	}
+}
+
+void MainWindow::showMemoryReport ( void )
+{
+	QString report = MemoryStats::report();
+
+	QMessageBox box(QMessageBox::Information, "Memory usage", QString("<pre>%1</pre>Sizes are estimates. Press Ctrl+Shift+M again to refresh.").arg(report.toHtmlEscaped()), QMessageBox::Ok, this);
+	box.setTextFormat(Qt::RichText);
+	box.exec();
+}
+
+void MainWindow::printMemoryReport ( void )
+{
+	printf("%s", qPrintable(MemoryStats::report()));
+	fflush(stdout);
+}
+
+static QWidget *createPowderTab ( void )
+{
+	return new Powder::PowderTest();
+}
+
+static QWidget *createSeatingTab ( void )
+{
+	return new SeatingDepth::SeatingDepthTest();
+}
+
+static QWidget *createTunerTab ( void )
+{
+	return new Tuner::TunerTest();
+}
+
+static QWidget *createAboutTab ( void )
+{
+	return new About();
+}
+
 int main ( int argc, char *argv[] )
 {
+	Startup::begin();
+
+	// The render benchmark draws off-screen, so it doesn't need a display
+	for ( int i = 1; i < argc; i++ )
+	{
+		if ( (strcmp(argv[i], "--benchmark-render") == 0) && ! qEnvironmentVariableIsSet("QT_QPA_PLATFORM") )
+		{
+			qputenv("QT_QPA_PLATFORM", "offscreen");
+		}
+	}
+
 	QApplication a(argc, argv);
+	a.setApplicationName("ChronoPlotter");
+	Startup::mark("application");
 
-	int id = QFontDatabase::addApplicationFont(":/DejaVuSans.ttf");
-	QString family = QFontDatabase::applicationFontFamilies(id).at(0);
-	qDebug() << "id:" << id << "font family:" << family;
+	// Same syntax as QT_LOGGING_RULES, with rules separated by ';'
+	int rulesIndex = a.arguments().indexOf("--log-rules");
+	if ( (rulesIndex >= 0) && (rulesIndex + 1 < a.arguments().size()) )
+	{
+		QLoggingCategory::setFilterRules(a.arguments().at(rulesIndex + 1).split(';').join('\n'));
+	}
+
+	// Record timing spans from startup, Ctrl+Shift+T saves them
+	if ( a.arguments().contains("--trace") )
+	{
+		Trace::setEnabled(true);
+	}
+
+	// Times the import parsers on generated files instead of opening the window
+	if ( a.arguments().contains("--benchmark-parsers") )
+	{
+		return ParserBenchmark::run(a.arguments());
+	}
+
+	// Times the graph renderers on generated series
+	if ( a.arguments().contains("--benchmark-render") )
+	{
+		return RenderBenchmark::run(a.arguments());
+	}
+
+	// Tabs are built the first time they're shown, the bundled font is registered after the first paint
+	LazyTab *powderTab = new LazyTab(createPowderTab, "powder tab");
 
-	QWidget *powderTab = new Powder::PowderTest();
+	LazyTab *seatingTab = new LazyTab(createSeatingTab, "seating depth tab");
 
-	QWidget *seatingTab = new SeatingDepth::SeatingDepthTest();
+	LazyTab *tunerTab = new LazyTab(createTunerTab, "tuner tab");
 
-	QWidget *tunerTab = new Tuner::TunerTest();
+	LazyTab *aboutTab = new LazyTab(createAboutTab, "about tab");
 
-	QWidget *aboutTab = new About();
+	// The window is sized for the tab it opens on
+	powderTab->content();
+	Startup::mark("first tab built");
 
 	QTabWidget *tabs = new QTabWidget();
 	tabs->setDocumentMode(true);
@@ -246,6 +482,19 @@ int main ( int argc, char *argv[] )
 	mainWindow->setGeometry(300, 300, 1200, mainLayout->sizeHint().height());
 	mainWindow->setWindowTitle("ChronoPlotter");
 	mainWindow->show();
+	Startup::mark("window shown");
+
+	QShortcut *traceShortcut = new QShortcut(QKeySequence("Ctrl+Shift+T"), mainWindow);
+	QObject::connect(traceShortcut, &QShortcut::activated, mainWindow, &MainWindow::saveTrace);
+
+	QShortcut *memoryShortcut = new QShortcut(QKeySequence("Ctrl+Shift+M"), mainWindow);
+	QObject::connect(memoryShortcut, &QShortcut::activated, mainWindow, &MainWindow::showMemoryReport);
+
+	// Prints what the session was holding when the app exits
+	if ( a.arguments().contains("--memory-report") )
+	{
+		QObject::connect(&a, &QCoreApplication::aboutToQuit, mainWindow, &MainWindow::printMemoryReport);
+	}
 
 	return a.exec();
 }
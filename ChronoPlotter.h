@@ -22,12 +22,15 @@
 #include <QDialog>
 #include <QMainWindow>
 #include "qcustomplot/qcustomplot.h"
+#include "MemoryStats.h"
 
 #define CHRONOPLOTTER_VERSION "2.2.2"
 
 #define SCATTER 0
 #define LINE_SD 1
 
+#define DENSITY_LEVELS 4
+
 #define SOLID_LINE 0
 #define DASHED_LINE 1
 
@@ -59,6 +62,13 @@
 
 int scaleFontSize ( int );
 
+// Adds the bundled fonts to the font database. Does nothing after the first call.
+void registerFonts ( void );
+
+// Saves a graph as a 1440x625 image at 2x, the same as QCustomPlot::savePng()/saveJpg() but with
+// rasterising and encoding traced separately. format is "PNG" or "JPG".
+bool saveRasterImage ( QCustomPlot *customPlot, const QString &path, const char *format );
+
 struct SplineSet
 {
 	double a;
@@ -82,11 +92,43 @@ class MainWindow : public QMainWindow
 	Q_OBJECT
 
 	public:
-		MainWindow() : QMainWindow() {};
+		MainWindow() : QMainWindow(), painted(false) {};
 		~MainWindow() {};
 
+	public slots:
+		void saveTrace ( void );
+		void showMemoryReport ( void );
+		void printMemoryReport ( void );
+		void finishStartup ( void );
+
 	protected:
 		void closeEvent(QCloseEvent *);
+		void paintEvent(QPaintEvent *);
+
+	private:
+		bool painted;
+};
+
+// Placeholder page that only builds its tab the first time it's shown
+class LazyTab : public QWidget
+{
+	public:
+		typedef QWidget *(*Factory)(void);
+
+		// name must be a string literal, it's used for the trace span
+		LazyTab(Factory, const char *name, QWidget *parent = 0);
+		~LazyTab() {};
+
+		// Builds the tab if it hasn't been yet
+		QWidget *content ( void );
+
+	protected:
+		virtual void showEvent(QShowEvent *);
+
+	private:
+		Factory factory;
+		const char *name;
+		QWidget *tab;
 };
 
 class QHLine : public QFrame
@@ -101,12 +143,14 @@ class GraphPreview : public QWidget
 	public:
 		GraphPreview(QPixmap&, QWidget *parent = 0);
 		~GraphPreview() {};
+		void setImage(QPixmap&);
 
 	protected:
 		virtual void resizeEvent(QResizeEvent *);
 
 	private:
 		QLabel *label;
+		MemoryAccount<MemoryStats::PLOT_SCENES> imageMemory;
 };
 
 #endif // CHRONOPLOTTER_H
@@ -21,8 +21,16 @@ include(./QXlsx/QXlsx.pri)
 # Input
 HEADERS += ChronoPlotter.h qcustomplot/qcustomplot.h untar.h miniz.h PowderTest.h SeatingDepthTest.h TunerTest.h About.h
 SOURCES += ChronoPlotter.cpp qcustomplot/qcustomplot.cpp untar.cpp miniz.c PowderTest.cpp SeatingDepthTest.cpp TunerTest.cpp About.cpp
+HEADERS += ChronographParsers.h FileSelectionHandlers.h FolderWatch.h GraphRenderer.h LabelLayout.h Logging.h MemoryStats.h NumberParser.h ParseCache.h ParserBenchmark.h RenderBenchmark.h Scheduler.h SeriesArena.h SeriesDataManager.h SeriesStore.h SeriesTable.h SessionFile.h ShotMarkerArchive.h ShotMarkerCsv.h Snapshot.h Startup.h TargetRenderer.h TextCache.h TimestampParser.h Trace.h
+SOURCES += AutofillDialog.cpp ChronographParsers.cpp EnterVelocitiesDialog.cpp FileSelectionHandlers.cpp FolderWatch.cpp GraphRenderer.cpp LabelLayout.cpp Logging.cpp MemoryStats.cpp NumberParser.cpp ParseCache.cpp ParserBenchmark.cpp RenderBenchmark.cpp RoundRobinDialog.cpp Scheduler.cpp SeriesDataManager.cpp SeriesStore.cpp SeriesTable.cpp SessionFile.cpp ShotMarkerArchive.cpp ShotMarkerCsv.cpp Startup.cpp TargetRenderer.cpp TextCache.cpp TimestampParser.cpp Trace.cpp
 QT += widgets printsupport
 
+# std::from_chars for floating point
+CONFIG += c++17
+
+# Compile out per-row and per-shot trace logging in release builds, see Logging.h
+CONFIG(release, debug|release): DEFINES += CHRONOPLOTTER_NO_TRACE_LOGGING
+
 CONFIG += console
 
 RESOURCES += resources.qrc
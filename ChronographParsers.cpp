@@ -1,7 +1,5 @@
 #include "ChronographParsers.h"
 #include "PowderTest.h"
-#include "miniz.h"
-#include "untar.h"
 
 #include "xlsxdocument.h"
 #include "xlsxworksheet.h"
@@ -9,99 +7,287 @@
 
 #include <QDir>
 #include <QFile>
-#include <QTemporaryDir>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonValue>
-#include <QJsonParseError>
-#include <QDateTime>
 #include <QDebug>
-#include <QLabel>
+#include "TimestampParser.h"
+#include "NumberParser.h"
+#include "Trace.h"
+#include "Logging.h"
 
 using namespace Powder;
 
-ChronoSeries* ChronographParsers::extractLabRadarSeries(QTextStream &csv)
+namespace
 {
-	ChronoSeries *series = new ChronoSeries();
-	series->isValid = false;
-	series->deleted = false;
-	series->seriesNum = -1;
+	// Enough to reach the date and time of a LabRadar velocity record
+	const int LABRADAR_CELLS = 17;
 
-	while (!csv.atEnd())
+	template <typename Char>
+	struct Cell
 	{
-		QString line = csv.readLine().replace(QString(1, QChar('\0')), "");
+		const Char *begin;
+		int length;
+	};
 
-		// LabRadar uses semicolon (;) as delimeter
-		QStringList rows(line.split(";"));
+	inline ushort code(char c)
+	{
+		return (uchar)c;
+	}
+
+	inline ushort code(QChar c)
+	{
+		return c.unicode();
+	}
 
-		// Only parse rows with enough columns to index
-		if (rows.size() < 2)
+	template <typename Char>
+	bool cellEquals(const Cell<Char> &cell, const char *text)
+	{
+		int i = 0;
+		for (; i < cell.length; i++)
 		{
-			qDebug() << "Less than 2, skipping row";
-			continue;
+			if ((text[i] == '\0') || (code(cell.begin[i]) != (uchar)text[i]))
+			{
+				return false;
+			}
 		}
+		return text[i] == '\0';
+	}
 
-		if ((rows.size() >= 17) && (rows.at(0).compare("Shot ID") != 0))
+	QString cellText(const Cell<char> &cell)
+	{
+		return QString::fromUtf8(cell.begin, cell.length);
+	}
+
+	QString cellText(const Cell<QChar> &cell)
+	{
+		return QString(cell.begin, cell.length);
+	}
+
+	// Splits one line on semicolons. Returns the number of cells, which may exceed LABRADAR_CELLS.
+	template <typename Char>
+	int splitLabRadarLine(const Char *begin, const Char *end, Cell<Char> *cells)
+	{
+		// Drop the '\r' of a "\r\n" line ending
+		if ((end > begin) && (code(end[-1]) == '\r'))
 		{
-			// Parsing a velocity record
-			if (series->firstDate.isNull())
+			end--;
+		}
+
+		int count = 0;
+		const Char *cellBegin = begin;
+		for (const Char *p = begin; p <= end; p++)
+		{
+			if ((p != end) && (code(*p) != ';'))
 			{
-				series->firstDate = rows.at(15);
-				qDebug() << "firstDate =" << series->firstDate;
+				continue;
 			}
 
-			if (series->firstTime.isNull())
+			if (count < LABRADAR_CELLS)
 			{
-				series->firstTime = rows.at(16);
-				qDebug() << "firstTime =" << series->firstTime;
+				cells[count].begin = cellBegin;
+				cells[count].length = p - cellBegin;
 			}
 
-			series->muzzleVelocities.append(rows.at(1).toInt());
-			qDebug() << "muzzleVelocities +=" << rows.at(1).toInt();
+			count++;
+			cellBegin = p + 1;
 		}
-		else if (rows.at(0).compare("Series No") == 0)
+
+		return count;
+	}
+
+	template <typename Char>
+	void parseLabRadarReport(const Char *text, qint64 length, SeriesRecord *series, SeriesStore *store)
+	{
+		// Cells are separated by semicolons, so velocities may use a decimal comma
+		NumberParser numbers(NumberParser::DETECT_SEPARATOR);
+
+		const Char *end = text + length;
+		const Char *line = text;
+		while (line < end)
 		{
-			series->seriesNum = rows.at(1).toInt();
-			qDebug() << "seriesNum =" << series->seriesNum;
+			const Char *lineEnd = line;
+			while ((lineEnd < end) && (code(*lineEnd) != '\n'))
+			{
+				lineEnd++;
+			}
+
+			Cell<Char> cells[LABRADAR_CELLS];
+			int cellCount = splitLabRadarLine(line, lineEnd, cells);
+			line = lineEnd + 1;
+
+			// Only parse rows with enough columns to index
+			if (cellCount < 2)
+			{
+				continue;
+			}
+
+			if ((cellCount >= 17) && !cellEquals(cells[0], "Shot ID"))
+			{
+				// Parsing a velocity record
+				if (series->firstDate.isNull())
+				{
+					series->firstDate = cellText(cells[15]);
+					qCDebug(lcImport) << "firstDate =" << series->firstDate;
+				}
+
+				if (series->firstTime.isNull())
+				{
+					series->firstTime = cellText(cells[16]);
+					qCDebug(lcImport) << "firstTime =" << series->firstTime;
+				}
+
+				qint64 date = TimestampParser::parseDate(cells[15].begin, cells[15].length);
+				qint64 time = TimestampParser::parseTime(cells[16].begin, cells[16].length);
+
+				double velocity;
+				if (numbers.toDouble(cells[1].begin, cells[1].length, &velocity))
+				{
+					store->appendVelocity(velocity, TimestampParser::combine(date, time));
+					LOG_TRACE(lcImportTrace) << "muzzleVelocities +=" << velocity;
+				}
+				else
+				{
+					LOG_TRACE(lcImportTrace) << "Skipping velocity entry:" << cellText(cells[1]);
+				}
+			}
+			else if (cellEquals(cells[0], "Series No"))
+			{
+				numbers.toInt(cells[1].begin, cells[1].length, &series->seriesNum);
+				qCDebug(lcImport) << "seriesNum =" << series->seriesNum;
+			}
+			else if (cellEquals(cells[0], "Units velocity"))
+			{
+				series->velocityUnits = cellText(cells[1]);
+				series->velocityUnits.replace("fps", "ft/s");
+				qCDebug(lcImport) << "velocityUnits =" << series->velocityUnits;
+			}
 		}
-		else if (rows.at(0).compare("Units velocity") == 0)
+	}
+}
+
+ChronographParsers::TextEncoding ChronographParsers::detectEncoding(const char *data, qint64 size, int *bomLength)
+{
+	const uchar *bytes = (const uchar *)data;
+
+	if ((size >= 2) && (bytes[0] == 0xff) && (bytes[1] == 0xfe))
+	{
+		*bomLength = 2;
+		return ENCODING_UTF16LE;
+	}
+
+	if ((size >= 2) && (bytes[0] == 0xfe) && (bytes[1] == 0xff))
+	{
+		*bomLength = 2;
+		return ENCODING_UTF16BE;
+	}
+
+	*bomLength = ((size >= 3) && (bytes[0] == 0xef) && (bytes[1] == 0xbb) && (bytes[2] == 0xbf)) ? 3 : 0;
+	if (*bomLength != 0)
+	{
+		return ENCODING_UTF8;
+	}
+
+	// No BOM. ASCII text in UTF-16 has a NUL in every other byte.
+	int evenNuls = 0, oddNuls = 0;
+	int sniffLength = (int)qMin(size, (qint64)512);
+	for (int i = 0; i < sniffLength; i++)
+	{
+		if (bytes[i] == 0)
+		{
+			if (i % 2)
+			{
+				oddNuls++;
+			}
+			else
+			{
+				evenNuls++;
+			}
+		}
+	}
+
+	if ((oddNuls > sniffLength / 4) && (evenNuls == 0))
+	{
+		return ENCODING_UTF16LE;
+	}
+
+	if ((evenNuls > sniffLength / 4) && (oddNuls == 0))
+	{
+		return ENCODING_UTF16BE;
+	}
+
+	return ENCODING_UTF8;
+}
+
+bool ChronographParsers::extractLabRadarSeries(const char *data, qint64 size, SeriesStore *store)
+{
+	TRACE_SPAN("import", "LabRadar CSV parse");
+
+	SeriesRecord *series = &store->at(store->beginSeries());
+
+	int bomLength;
+	TextEncoding encoding = detectEncoding(data, size, &bomLength);
+	data += bomLength;
+	size -= bomLength;
+
+	qCDebug(lcImport) << "LabRadar report encoding:" << encoding;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	const TextEncoding nativeUtf16 = ENCODING_UTF16LE;
+#else
+	const TextEncoding nativeUtf16 = ENCODING_UTF16BE;
+#endif
+
+	if (encoding == ENCODING_UTF8)
+	{
+		parseLabRadarReport(data, size, series, store);
+	}
+	else if ((encoding == nativeUtf16) && ((quintptr)data % sizeof(QChar) == 0))
+	{
+		// LabRadar writes UTF-16LE, which is tokenized in place
+		parseLabRadarReport((const QChar *)data, size / 2, series, store);
+	}
+	else
+	{
+		// Byte swapped (or unaligned) UTF-16, copy it into native order first
+		QVector<QChar> units(size / 2);
+		for (int i = 0; i < units.size(); i++)
 		{
-			series->velocityUnits = rows.at(1);
-			series->velocityUnits.replace("fps", "ft/s");
-			qDebug() << "velocityUnits =" << series->velocityUnits;
+			const uchar *unit = (const uchar *)data + (i * 2);
+			units[i] = QChar((encoding == ENCODING_UTF16LE) ? (ushort)(unit[0] | (unit[1] << 8)) : (ushort)((unit[0] << 8) | unit[1]));
 		}
+
+		parseLabRadarReport(units.constData(), units.size(), series, store);
 	}
 
 	// Ensure we have a valid LabRadar series
 	if ((series->seriesNum == -1) || series->velocityUnits.isNull() || series->firstDate.isNull() || series->firstTime.isNull())
 	{
-		qDebug() << "Series does not have all expected fields set, returning invalid.";
-		return series;
+		qCDebug(lcImport) << "Series does not have all expected fields set, returning invalid.";
+		store->discardSeries();
+		return false;
 	}
 
-	if (series->muzzleVelocities.empty())
+	if (series->velocityCount == 0)
 	{
-		qDebug() << "Series has no velocities. Likely deleted series, returning invalid.";
-		return series;
+		qCDebug(lcImport) << "Series has no velocities. Likely deleted series, returning invalid.";
+		store->discardSeries();
+		return false;
 	}
 
 	// We have a valid series CSV
 	series->isValid = true;
 
-	return series;
+	return true;
 }
 
-QList<ChronoSeries*> ChronographParsers::extractMagnetoSpeedSeries(QTextStream &csv)
+void ChronographParsers::extractMagnetoSpeedSeries(QTextStream &csv, SeriesStore *store)
 {
+	TRACE_SPAN("import", "MagnetoSpeed CSV parse");
+
 	// MagnetoSpeed XFR app exports .CSV files in a slightly different format
 	bool xfr_export = false;
 
-	QList<ChronoSeries*> allSeries;
-	ChronoSeries *curSeries = new ChronoSeries();
-	curSeries->isValid = false;
-	curSeries->deleted = false;
-	curSeries->seriesNum = -1;
+	int firstSeries = store->size();
+	SeriesRecord *curSeries = &store->at(store->beginSeries());
+	NumberParser numbers;
 
 	int i = 0;
 	while (!csv.atEnd())
@@ -119,7 +305,7 @@ QList<ChronoSeries*> ChronographParsers::extractMagnetoSpeedSeries(QTextStream &
 			it.setValue(it.value().trimmed());
 		}
 
-		qDebug() << "Line" << i << ":" << rows;
+		LOG_TRACE(lcImportTrace) << "Line" << i << ":" << rows;
 
 		if (rows.size() > 0)
 		{
@@ -130,13 +316,13 @@ QList<ChronoSeries*> ChronographParsers::extractMagnetoSpeedSeries(QTextStream &
 				// Ensure we have a valid MagnetoSpeed series
 				if (((! xfr_export) && (curSeries->seriesNum == -1)) || curSeries->velocityUnits.isNull())
 				{
-					qDebug() << "Series does not have all expected fields set, skipping series.";
+					qCDebug(lcImport) << "Series does not have all expected fields set, skipping series.";
 					useSeries = false;
 				}
 
-				if (curSeries->muzzleVelocities.empty())
+				if (curSeries->velocityCount == 0)
 				{
-					qDebug() << "Series has no velocities. Likely deleted or empty, skipping series..";
+					qCDebug(lcImport) << "Series has no velocities. Likely deleted or empty, skipping series..";
 					useSeries = false;
 				}
 
@@ -145,49 +331,49 @@ QList<ChronoSeries*> ChronographParsers::extractMagnetoSpeedSeries(QTextStream &
 					// We have a valid series CSV
 					curSeries->isValid = true;
 
-					qDebug() << "Adding curSeries to allSeries";
-
-					allSeries.append(curSeries);
+					qCDebug(lcImport) << "Keeping curSeries in the store";
+				}
+				else
+				{
+					store->discardSeries();
 				}
 
-				curSeries = new ChronoSeries();
-				curSeries->isValid = false;
-				curSeries->deleted = false;
-				curSeries->seriesNum = -1;
+				curSeries = &store->at(store->beginSeries());
 			}
 			else if (rows.at(0).compare("Synced on:") == 0)
 			{
 				// .CSV file is exported from the MagnetoSpeed XFR app
 				xfr_export = true;
 
+				curSeries->timestamp = TimestampParser::parseDateTime(rows.at(1));
+
 				QStringList dateTime = rows.at(1).split(" ");
 				if (dateTime.size() == 2)
 				{
 					curSeries->firstDate = dateTime.at(0);
 					curSeries->firstTime = dateTime.at(1);
-					qDebug() << "firstDate =" << curSeries->firstDate;
-					qDebug() << "firstTime =" << curSeries->firstTime;
+					qCDebug(lcImport) << "firstDate =" << curSeries->firstDate;
+					qCDebug(lcImport) << "firstTime =" << curSeries->firstTime;
 				}
 				else
 				{
-					qDebug() << "Failed to split datetime cell:" << rows.at(1);
+					qCDebug(lcImport) << "Failed to split datetime cell:" << rows.at(1);
 				}
 			}
 			else if ((rows.at(0).compare("Series") == 0) && (rows.at(2) == "Shots:"))
 			{
-				bool ok;
-				int seriesNum = rows.at(1).toInt(&ok);
-				if (ok)
+				int seriesNum;
+				if (numbers.toInt(rows.at(1), &seriesNum))
 				{
 					// MagnetoSpeed V3 files contain an integer in the 'Series' field. Use it as the series name.
 					curSeries->seriesNum = seriesNum;
-					curSeries->name = new QLabel(QString("Series %1").arg(seriesNum));
-					qDebug() << "seriesNum =" << curSeries->seriesNum;
+					curSeries->name = QString("Series %1").arg(seriesNum);
+					qCDebug(lcImport) << "seriesNum =" << curSeries->seriesNum;
 				}
 				else
 				{
 					// XFR export files contain a date in the 'Series' field. Ignore it since we're expecting to be replaced by the name in the 'Notes' field.
-					qDebug() << "XFR file detected, skipping Series row";
+					qCDebug(lcImport) << "XFR file detected, skipping Series row";
 				}
 			}
 			else if (rows.at(0).compare("Notes") == 0)
@@ -195,44 +381,38 @@ QList<ChronoSeries*> ChronographParsers::extractMagnetoSpeedSeries(QTextStream &
 				// Use the series name if the user entered one
 				if (rows.at(1).compare("") == 0)
 				{
-					curSeries->name = new QLabel("Unnamed");
+					curSeries->name = "Unnamed";
 				}
 				else
 				{
-					curSeries->name = new QLabel(rows.at(1));
+					curSeries->name = rows.at(1);
 				}
 
-				qDebug() << "Setting name to '" << curSeries->name << "' via Notes field";
+				qCDebug(lcImport) << "Setting name to '" << curSeries->name << "' via Notes field";
 			}
 			else
 			{
-				bool ok = false;
+				int shotIndex;
+				double velocity;
 
-				// If the first cell is a valid integer, it's a velocity entry
-				rows.at(0).toInt(&ok);
-				if (ok)
+				// If the first cell is a valid integer, it's a velocity entry. XFR exports have one column less.
+				int velocityColumn = xfr_export ? 1 : 2;
+				if (numbers.toInt(rows.at(0), &shotIndex) && (rows.size() > velocityColumn + 1))
 				{
-					if (xfr_export)
+					if (numbers.toDouble(rows.at(velocityColumn), &velocity))
 					{
-						curSeries->muzzleVelocities.append(rows.at(1).toInt());
-						qDebug() << "muzzleVelocities +=" << rows.at(1).toInt();
+						store->appendVelocity(velocity);
+						LOG_TRACE(lcImportTrace) << "muzzleVelocities +=" << velocity;
 
-						if (curSeries->muzzleVelocities.size() == 1)
+						if (curSeries->velocityCount == 1)
 						{
-							curSeries->velocityUnits = rows.at(2);
-							qDebug() << "velocityUnits =" << curSeries->velocityUnits;
+							curSeries->velocityUnits = rows.at(velocityColumn + 1);
+							qCDebug(lcImport) << "velocityUnits =" << curSeries->velocityUnits;
 						}
 					}
 					else
 					{
-						curSeries->muzzleVelocities.append(rows.at(2).toInt());
-						qDebug() << "muzzleVelocities +=" << rows.at(2).toInt();
-
-						if (curSeries->muzzleVelocities.size() == 1)
-						{
-							curSeries->velocityUnits = rows.at(3);
-							qDebug() << "velocityUnits =" << curSeries->velocityUnits;
-						}
+						LOG_TRACE(lcImportTrace) << "Skipping velocity entry:" << rows.at(velocityColumn);
 					}
 				}
 			}
@@ -241,25 +421,27 @@ QList<ChronoSeries*> ChronographParsers::extractMagnetoSpeedSeries(QTextStream &
 		i++;
 	}
 
+	// The trailing series was never terminated by a '----' row
+	store->discardSeries();
+
 	// XFR export files do not include series numbers, so iterate through and set the seriesNum's
-	for (i = 0; i < allSeries.size(); i++)
+	for (i = firstSeries; i < store->size(); i++)
 	{
-		ChronoSeries *series = allSeries.at(i);
-		series->seriesNum = i + 1;
-		qDebug() << "Setting" << series->name << "to" << series->seriesNum;
+		SeriesRecord &series = store->at(i);
+		series.seriesNum = i - firstSeries + 1;
+		qCDebug(lcImport) << "Setting" << series.name << "to" << series.seriesNum;
 	}
-
-	return allSeries;
 }
 
-QList<ChronoSeries*> ChronographParsers::extractProChronoSeries(QTextStream &csv)
+void ChronographParsers::extractProChronoSeries(QTextStream &csv, SeriesStore *store)
 {
-	QList<ChronoSeries*> allSeries;
-	ChronoSeries *curSeries = new ChronoSeries();
+	TRACE_SPAN("import", "ProChrono CSV parse");
+
+	int firstSeries = store->size();
+	SeriesRecord *curSeries = &store->at(store->beginSeries());
 	curSeries->isValid = true;
-	curSeries->deleted = false;
-	curSeries->seriesNum = -1;
 	curSeries->velocityUnits = "ft/s";
+	NumberParser numbers;
 
 	int i = 0;
 	while (!csv.atEnd())
@@ -277,41 +459,40 @@ QList<ChronoSeries*> ChronographParsers::extractProChronoSeries(QTextStream &csv
 			it.setValue(it.value().trimmed());
 		}
 
-		qDebug() << "Line" << i << ":" << rows;
+		LOG_TRACE(lcImportTrace) << "Line" << i << ":" << rows;
 
 		if (rows.size() >= 9)
 		{
 			if (rows.at(0) == "Shot List")
 			{
 				// skip column headers
-				qDebug() << "Skipping column headers";
+				qCDebug(lcImport) << "Skipping column headers";
 			}
 			else
 			{
-				bool ok = false;
-				int index = rows.at(1).toInt(&ok);
+				int index;
 
 				// If cell is a valid integer, the row is a shot entry
-				if (ok)
+				if (numbers.toInt(rows.at(1), &index))
 				{
 					if (index == 1)
 					{
 						// First shot in the series. End the previous series (if necessary) and start a new one.
 
-						if (curSeries->muzzleVelocities.size() > 0)
+						if (curSeries->velocityCount > 0)
 						{
-							qDebug() << "Adding curSeries to allSeries";
-
-							allSeries.append(curSeries);
+							qCDebug(lcImport) << "Keeping curSeries in the store";
+						}
+						else
+						{
+							store->discardSeries();
 						}
 
-						qDebug() << "Beginning new series";
+						qCDebug(lcImport) << "Beginning new series";
 
-						curSeries = new ChronoSeries();
+						curSeries = &store->at(store->beginSeries());
 						curSeries->isValid = true;
-						curSeries->deleted = false;
-						curSeries->seriesNum = -1;
-						curSeries->name = new QLabel(rows.at(0));
+						curSeries->name = rows.at(0);
 						curSeries->velocityUnits = "ft/s";
 					}
 
@@ -322,17 +503,26 @@ QList<ChronoSeries*> ChronographParsers::extractProChronoSeries(QTextStream &csv
 						{
 							curSeries->firstDate = dateTime.at(0);
 							curSeries->firstTime = dateTime.at(1);
-							qDebug() << "firstDate =" << curSeries->firstDate;
-							qDebug() << "firstTime =" << curSeries->firstTime;
+							qCDebug(lcImport) << "firstDate =" << curSeries->firstDate;
+							qCDebug(lcImport) << "firstTime =" << curSeries->firstTime;
 						}
 						else
 						{
-							qDebug() << "Failed to split datetime cell:" << rows.at(8);
+							qCDebug(lcImport) << "Failed to split datetime cell:" << rows.at(8);
 						}
 					}
 
-					curSeries->muzzleVelocities.append(rows.at(2).toInt());
-					qDebug() << "muzzleVelocities +=" << rows.at(2).toInt();
+					// Every shot row carries its own date and time
+					double velocity;
+					if (numbers.toDouble(rows.at(2), &velocity))
+					{
+						store->appendVelocity(velocity, TimestampParser::parseDateTime(rows.at(8)));
+						LOG_TRACE(lcImportTrace) << "muzzleVelocities +=" << velocity;
+					}
+					else
+					{
+						LOG_TRACE(lcImportTrace) << "Skipping velocity entry:" << rows.at(2);
+					}
 				}
 			}
 		}
@@ -341,36 +531,36 @@ QList<ChronoSeries*> ChronographParsers::extractProChronoSeries(QTextStream &csv
 	}
 
 	// End of the file. Finish parsing the current series.
-	qDebug() << "End of file";
+	qCDebug(lcImport) << "End of file";
 
-	if (curSeries->muzzleVelocities.size() > 0)
+	if (curSeries->velocityCount > 0)
 	{
-		qDebug() << "Adding curSeries to allSeries";
-
-		allSeries.append(curSeries);
+		qCDebug(lcImport) << "Keeping curSeries in the store";
+	}
+	else
+	{
+		store->discardSeries();
 	}
 
 	// ProChrono files list series in reverse order from newest to oldest. Iterate through and
 	// set the seriesNum's accordingly.
 	int seriesNum = 1;
-	for (i = allSeries.size() - 1; i >= 0; i--)
+	for (i = store->size() - 1; i >= firstSeries; i--)
 	{
-		ChronoSeries *series = allSeries.at(i);
-		series->seriesNum = seriesNum;
+		store->at(i).seriesNum = seriesNum;
 		seriesNum++;
 	}
-
-	return allSeries;
 }
 
-QList<ChronoSeries*> ChronographParsers::extractProChronoSeries_format2(QTextStream &csv)
+void ChronographParsers::extractProChronoSeries_format2(QTextStream &csv, SeriesStore *store)
 {
-	QList<ChronoSeries*> allSeries;
-	ChronoSeries *curSeries = new ChronoSeries();
+	TRACE_SPAN("import", "ProChrono CSV parse");
+
+	int firstSeries = store->size();
+	SeriesRecord *curSeries = &store->at(store->beginSeries());
 	curSeries->isValid = true;
-	curSeries->deleted = false;
-	curSeries->seriesNum = -1;
 	curSeries->velocityUnits = "ft/s";
+	NumberParser numbers;
 
 	int i = 0;
 	while (!csv.atEnd())
@@ -388,69 +578,67 @@ QList<ChronoSeries*> ChronographParsers::extractProChronoSeries_format2(QTextStr
 			it.setValue(it.value().trimmed());
 		}
 
-		qDebug() << "Line" << i << ":" << rows;
+		LOG_TRACE(lcImportTrace) << "Line" << i << ":" << rows;
 
 		if (rows.at(0).contains("Shot"))
 		{
 			// skip column headers
-			qDebug() << "Skipping column headers";
+			qCDebug(lcImport) << "Skipping column headers";
 		}
 		else
 		{
 			// If cell is a valid integer, parse the row as velocity data
 
-			bool ok = false;
-			rows.at(0).toInt(&ok);
-			if (ok)
+			int shotIndex;
+			if (numbers.toInt(rows.at(0), &shotIndex))
 			{
 				// End the previous series (if necessary) and start a new one
 
-				if (curSeries->muzzleVelocities.size() > 0)
+				if (curSeries->velocityCount > 0)
 				{
-					qDebug() << "Adding curSeries to allSeries";
-
-					allSeries.append(curSeries);
+					qCDebug(lcImport) << "Keeping curSeries in the store";
+				}
+				else
+				{
+					store->discardSeries();
 				}
 
-				qDebug() << "Beginning new series";
+				qCDebug(lcImport) << "Beginning new series";
 
-				curSeries = new ChronoSeries();
+				curSeries = &store->at(store->beginSeries());
 				curSeries->isValid = true;
-				curSeries->deleted = false;
-				curSeries->seriesNum = -1;
 				curSeries->velocityUnits = "ft/s";
 
 				// Series in the file are recorded newest first. We'll iterate through and name them at the end.
 
 				for (int j = 0; j < rows.size(); j++)
 				{
-					bool ok = false;
-					int veloc = rows.at(j).toInt(&ok);
-
-					if (ok)
+					double veloc;
+					if (numbers.toDouble(rows.at(j), &veloc))
 					{
-						curSeries->muzzleVelocities.append(rows.at(j).toInt());
-						qDebug() << "muzzleVelocities +=" << rows.at(j).toInt();
+						store->appendVelocity(veloc);
+						LOG_TRACE(lcImportTrace) << "muzzleVelocities +=" << veloc;
 					}
 					else
 					{
-						qDebug() << "Skipping velocity entry:" << rows.at(j);
+						LOG_TRACE(lcImportTrace) << "Skipping velocity entry:" << rows.at(j);
 					}
 				}
 			}
 			else
 			{
-				QDateTime seriesDateTime;
-				seriesDateTime = QDateTime::fromString(rows.at(0), "M/d/yyyy hh:mm:ss");
-				if (seriesDateTime.isValid())
+				qint64 timestamp = TimestampParser::parseDateTime(rows.at(0));
+				if (timestamp != INVALID_TIMESTAMP)
 				{
+					curSeries->timestamp = timestamp;
+
 					QStringList dateTime = rows.at(0).split(" ");
 					if (dateTime.size() == 2)
 					{
 						curSeries->firstDate = dateTime.at(0);
 						curSeries->firstTime = dateTime.at(1);
-						qDebug() << "firstDate =" << curSeries->firstDate;
-						qDebug() << "firstTime =" << curSeries->firstTime;
+						qCDebug(lcImport) << "firstDate =" << curSeries->firstDate;
+						qCDebug(lcImport) << "firstTime =" << curSeries->firstTime;
 					}
 				}
 			}
@@ -460,41 +648,44 @@ QList<ChronoSeries*> ChronographParsers::extractProChronoSeries_format2(QTextStr
 	}
 
 	// End of the file. Finish parsing the current series.
-	qDebug() << "End of file";
+	qCDebug(lcImport) << "End of file";
 
-	if (curSeries->muzzleVelocities.size() > 0)
+	if (curSeries->velocityCount > 0)
 	{
-		qDebug() << "Adding curSeries to allSeries";
-
-		allSeries.append(curSeries);
+		qCDebug(lcImport) << "Keeping curSeries in the store";
+	}
+	else
+	{
+		store->discardSeries();
 	}
 
 	// ProChrono files list series in reverse order from newest to oldest. Iterate through and
 	// set the seriesNum's and names accordingly.
 	int seriesNum = 1;
-	for (i = allSeries.size() - 1; i >= 0; i--)
+	for (i = store->size() - 1; i >= firstSeries; i--)
 	{
-		ChronoSeries *series = allSeries.at(i);
-		series->seriesNum = seriesNum;
-		series->name = new QLabel(QString("Series %1").arg(seriesNum));
+		SeriesRecord &series = store->at(i);
+		series.seriesNum = seriesNum;
+		series.name = QString("Series %1").arg(seriesNum);
 		seriesNum++;
 	}
-
-	return allSeries;
 }
 
-QList<ChronoSeries*> ChronographParsers::extractGarminSeries_xlsx(QXlsx::Document &xlsx)
+void ChronographParsers::extractGarminSeries_xlsx(QXlsx::Document &xlsx, SeriesStore *store)
 {
-	QList<ChronoSeries*> allSeries;
-	
+	TRACE_SPAN("import", "Garmin XLSX parse");
+
+	// International exports write velocities with a decimal comma
+	NumberParser numbers(NumberParser::DETECT_SEPARATOR);
+
 	int i = 0;
 	foreach (QString sheetName, xlsx.sheetNames())
 	{
-		qDebug() << "Sheet: " << sheetName;
+		qCDebug(lcImport) << "Sheet: " << sheetName;
 		QXlsx::AbstractSheet *curSheet = xlsx.sheet(sheetName);
 		if (curSheet == NULL)
 		{
-			qDebug() << "Failed to get sheet, skipping...";
+			qCDebug(lcImport) << "Failed to get sheet, skipping...";
 			continue;
 		}
 		
@@ -503,19 +694,17 @@ QList<ChronoSeries*> ChronographParsers::extractGarminSeries_xlsx(QXlsx::Documen
 		QXlsx::Worksheet *worksheet = (QXlsx::Worksheet *)curSheet->workbook()->activeSheet();
 		if (worksheet == NULL)
 		{
-			qDebug() << "Failed to set active sheet, skipping...";
+			qCDebug(lcImport) << "Failed to set active sheet, skipping...";
 			continue;
 		}
 		
-		ChronoSeries *curSeries = new ChronoSeries();
-		curSeries->isValid = false;
-		curSeries->deleted = false;
+		SeriesRecord *curSeries = &store->at(store->beginSeries());
 		curSeries->seriesNum = i + 1;
 		curSeries->firstDate = QString("-");
 		curSeries->firstTime = QString("");
 		
-		qDebug() << "Series name:" << worksheet->read(1,1).toString();
-		curSeries->name = new QLabel(worksheet->read(1, 1).toString());
+		qCDebug(lcImport) << "Series name:" << worksheet->read(1,1).toString();
+		curSeries->name = worksheet->read(1, 1).toString();
 		
 		// Unit of measure
 		if (worksheet->read(2, 2).toString().contains("FPS"))
@@ -540,53 +729,65 @@ QList<ChronoSeries*> ChronographParsers::extractGarminSeries_xlsx(QXlsx::Documen
 			{
 				// We found a row with an integer (shot ID) in the first column
 				
-				bool ok_veloc = false;
-				QString veloc_str = worksheet->read(j, 2).toString();
-				veloc_str.replace(",", "."); // handle international-formatted numbers
-				double veloc = veloc_str.toFloat(&ok_veloc);
+				// Numeric cells come back as doubles, only text cells need parsing
+				QVariant veloc_cell = worksheet->read(j, 2);
+				double veloc = 0;
+				bool ok_veloc;
+				if (veloc_cell.userType() == QMetaType::Double)
+				{
+					veloc = veloc_cell.toDouble();
+					ok_veloc = true;
+				}
+				else
+				{
+					ok_veloc = numbers.toDouble(veloc_cell.toString(), &veloc);
+				}
+
 				if (ok_veloc)
 				{
-					curSeries->muzzleVelocities.append(veloc);
-					qDebug() << "muzzleVelocities +=" << veloc;
+					store->appendVelocity(veloc);
+					LOG_TRACE(lcImportTrace) << "muzzleVelocities +=" << veloc;
 				}
 				else
 				{
-					qDebug() << "Skipping velocity entry:" << worksheet->read(j, 2);
+					LOG_TRACE(lcImportTrace) << "Skipping velocity entry:" << worksheet->read(j, 2);
 				}
 			}
 			else
 			{
 				if (worksheet->read(j, 1).toString().compare("DATE") == 0)
 				{
-					// Date time
+					// Date time, e.g. "June 5, 2022 at 10:31 AM"
+					curSeries->timestamp = TimestampParser::parseDateTime(worksheet->read(j, 2).toString());
+
 					QStringList dateTime = worksheet->read(j, 2).toString().split(" at ");
 					if (dateTime.size() == 2)
 					{
 						curSeries->firstDate = dateTime.at(0);
 						curSeries->firstTime = dateTime.at(1);
-						qDebug() << "firstDate =" << curSeries->firstDate;
-						qDebug() << "firstTime =" << curSeries->firstTime;
+						qCDebug(lcImport) << "firstDate =" << curSeries->firstDate;
+						qCDebug(lcImport) << "firstTime =" << curSeries->firstTime;
 					}
 					else
 					{
-						qDebug() << "Failed to split datetime cell:" << worksheet->read(j, 2);
+						qCDebug(lcImport) << "Failed to split datetime cell:" << worksheet->read(j, 2);
 					}
 				}
 			}
 		}
 		
-		if (curSeries->muzzleVelocities.size() > 0)
+		if (curSeries->velocityCount > 0)
 		{
-			qDebug() << "Adding curSeries to allSeries";
+			qCDebug(lcImport) << "Keeping curSeries in the store";
 			curSeries->isValid = true;
-
-			allSeries.append(curSeries);
+		}
+		else
+		{
+			store->discardSeries();
 		}
 		
 		i += 1;
 	}
-
-	return allSeries;
 }
 
 // https://stackoverflow.com/a/40229435
@@ -637,24 +838,26 @@ bool ChronographParsers::readCSVRow(QTextStream &in, QStringList *row)
 
 	if (state == -2)
 	{
-		qDebug() << "End-of-file found while inside quotes.";
+		qCDebug(lcImport) << "End-of-file found while inside quotes.";
 		return false;
 	}
 
 	return true;
 }
 
-QList<ChronoSeries*> ChronographParsers::extractGarminSeries_csv(QTextStream &csv)
+void ChronographParsers::extractGarminSeries_csv(QTextStream &csv, SeriesStore *store)
 {
-	QList<ChronoSeries*> allSeries;
-	ChronoSeries *curSeries = new ChronoSeries();
-	curSeries->isValid = false;
-	curSeries->deleted = false;
+	TRACE_SPAN("import", "Garmin CSV parse");
+
+	SeriesRecord *curSeries = &store->at(store->beginSeries());
 	curSeries->seriesNum = 1;
 	curSeries->velocityUnits = "ft/s";
 	curSeries->firstDate = QString("-");
 	curSeries->firstTime = QString("");
 
+	// International exports write velocities with a decimal comma, quoted so it isn't taken as a delimiter
+	NumberParser numbers(NumberParser::DETECT_SEPARATOR);
+
 	int i = 0;
 	QStringList cols;
 	while (readCSVRow(csv, &cols))
@@ -667,27 +870,27 @@ QList<ChronoSeries*> ChronographParsers::extractGarminSeries_csv(QTextStream &cs
 			it.setValue(it.value().trimmed());
 		}
 
-		qDebug() << "Line" << i << ":" << cols;
+		LOG_TRACE(lcImportTrace) << "Line" << i << ":" << cols;
 
 		if (cols.size() >= 1)
 		{
 			// Series name in first row, first column
 			if (i == 0)
 			{
-				qDebug() << "Series name:" << cols.at(0);
-				curSeries->name = new QLabel(cols.at(0));
+				qCDebug(lcImport) << "Series name:" << cols.at(0);
+				curSeries->name = cols.at(0);
 			}
 			// Unit of measure in second row, second column
 			else if (i == 1)
 			{
 				if (cols.at(1).contains("FPS"))
 				{
-					qDebug() << "Velocity units: ft/s";
+					qCDebug(lcImport) << "Velocity units: ft/s";
 					curSeries->velocityUnits = "ft/s";
 				}
 				else
 				{
-					qDebug() << "Velocity units: m/s";
+					qCDebug(lcImport) << "Velocity units: m/s";
 					curSeries->velocityUnits = "m/s";
 				}
 			}
@@ -696,30 +899,27 @@ QList<ChronoSeries*> ChronographParsers::extractGarminSeries_csv(QTextStream &cs
 			{
 				curSeries->firstDate = cols.at(1);
 				curSeries->firstTime = QString("");
-				qDebug() << "firstDate =" << curSeries->firstDate;
-				qDebug() << "firstTime =" << curSeries->firstTime;
+				curSeries->timestamp = TimestampParser::parseDateTime(cols.at(1));
+				qCDebug(lcImport) << "firstDate =" << curSeries->firstDate;
+				qCDebug(lcImport) << "firstTime =" << curSeries->firstTime;
 			}
 			// Look for shot velocity row
 			else
 			{
-				bool ok_shot_id = false;
-				int shot_id = cols.at(0).toInt(&ok_shot_id);
-				if (ok_shot_id)
+				int shot_id;
+				if (numbers.toInt(cols.at(0), &shot_id) && (cols.size() >= 2))
 				{
 					// We found a row with an integer (shot ID) in the first column
 					
-					bool ok_veloc = false;
-					QString veloc_str = cols.at(1);
-					veloc_str.replace(",", "."); // handle international-formatted numbers
-					double veloc = veloc_str.toFloat(&ok_veloc);
-					if (ok_veloc)
+					double veloc;
+					if (numbers.toDouble(cols.at(1), &veloc))
 					{
-						curSeries->muzzleVelocities.append(veloc);
-						qDebug() << "muzzleVelocities +=" << veloc;
+						store->appendVelocity(veloc);
+						LOG_TRACE(lcImportTrace) << "muzzleVelocities +=" << veloc;
 					}
 					else
 					{
-						qDebug() << "Skipping velocity entry:" << cols.at(1);
+						LOG_TRACE(lcImportTrace) << "Skipping velocity entry:" << cols.at(1);
 					}
 				}
 			}
@@ -729,151 +929,15 @@ QList<ChronoSeries*> ChronographParsers::extractGarminSeries_csv(QTextStream &cs
 	}
 
 	// End of the file. Finish parsing the current series.
-	qDebug() << "End of file";
+	qCDebug(lcImport) << "End of file";
 	
 	// Ensure we have a valid Garmin series
-	if (curSeries->muzzleVelocities.empty())
-	{
-		qDebug() << "Series has no velocities, returning invalid.";
-		return allSeries;
-	}
-
-	allSeries.append(curSeries);
-
-	return allSeries;
-}
-
-QList<ChronoSeries*> ChronographParsers::extractShotMarkerSeriesTar(QString path)
-{
-	QList<ChronoSeries*> allSeries;
-	ChronoSeries *curSeries = new ChronoSeries();
-	QTemporaryDir tempDir;
-	int ret;
-
-	if (!tempDir.isValid())
-	{
-		qDebug() << "Temp directory is NOT valid";
-	}
-
-	qDebug() << "Temporary directory:" << tempDir.path();
-
-	QFile rf(path);
-	if (!rf.open(QIODevice::ReadOnly))
+	if (curSeries->velocityCount == 0)
 	{
-		qDebug() << "Failed to open ShotMarker .tar file:" << path;
-		return allSeries;
-	}
-
-	ret = untar(rf, tempDir.path());
-	if (ret)
-	{
-		qDebug() << "Error while extracting ShotMarker .tar file:" << path;
-		return allSeries;
-	}
-
-	QDir dir(tempDir.path());
-	QStringList stringFiles = dir.entryList(QStringList() << "*.z", QDir::Files);
-
-	qDebug() << "iterating over files:";
-	int seriesNum = 1;
-	foreach (QString filename, stringFiles)
-	{
-		QString path(tempDir.path());
-		path.append("/");
-		path.append(filename);
-		qDebug() << path;
-
-		QFile file(path);
-		file.open(QIODevice::ReadOnly);
-		QByteArray buf = file.readAll();
-		qDebug() << "file:" << path << ", size:" << buf.size();
-
-		// 1mb ought to be enough for anybody!
-		unsigned char *destBuf = (unsigned char *)malloc(1024 * 1024);
-		qDebug() << "malloc returned" << (void *)destBuf;
-		if (destBuf == NULL)
-		{
-			qDebug() << "malloc returned NULL! skipping... but we should really throw an exception here.";
-			continue;
-		}
-
-		mz_ulong uncomp_len = 1024 * 1024;
-		qDebug() << "calling uncompress 1 with destBuf=" << (void *)destBuf << ", uncomp_len=" << uncomp_len << ", buf.data()=" << buf.data() << ", buf.size()=" << buf.size();
-		ret = uncompress(destBuf, &uncomp_len, (const unsigned char *)buf.data(), buf.size());
-
-		qDebug() << "output size:" << uncomp_len;
-		if (ret != MZ_OK)
-		{
-			qDebug() << "Failed to uncompress, skipping..." << path;
-			free(destBuf);
-			continue;
-		}
-
-		QByteArray ba = QByteArray::fromRawData((const char *)destBuf, uncomp_len);
-
-		QJsonParseError parseError;
-		QJsonDocument jsonDoc;
-		jsonDoc = QJsonDocument::fromJson(ba, &parseError);
-
-		if (parseError.error != QJsonParseError::NoError)
-		{
-			qDebug() << "JSON parse error, skipping... at" << parseError.offset << ":" << parseError.errorString();
-			free(destBuf);
-			continue;
-		}
-
-		QJsonObject jsonObj = jsonDoc.object();
-
-		qDebug() << "Beginning new series";
-
-		curSeries = new ChronoSeries();
-		curSeries->isValid = false;
-		curSeries->seriesNum = seriesNum;
-		qDebug() << "name =" << jsonObj["name"].toString();
-		curSeries->name = new QLabel(jsonObj["name"].toString());
-		curSeries->velocityUnits = "ft/s";
-		curSeries->deleted = false;
-		QDateTime dateTime;
-		dateTime.setMSecsSinceEpoch(jsonObj["ts"].toVariant().toULongLong());
-		curSeries->firstDate = dateTime.date().toString(Qt::TextDate);
-		curSeries->firstTime = dateTime.time().toString(Qt::TextDate);
-
-		qDebug() << "setting date =" << curSeries->firstDate << " time =" << curSeries->firstTime << "from ts" << jsonObj["ts"].toVariant().toULongLong();
-
-		foreach (const QJsonValue& shot, jsonObj["shots"].toArray())
-		{
-			// convert from m/s to ft/s
-			int velocity = shot["v"].toDouble() * 1.0936133 * 3; // the result is cast to an int
-
-			if (shot["hidden"].toBool())
-			{
-				qDebug() << "ignoring hidden shot" << shot["display_text"];
-			}
-			else if (shot["sighter"].toBool())
-			{
-				qDebug() << "ignoring sighter shot" << shot["display_text"];
-			}
-			else
-			{
-				qDebug() << "adding velocity" << velocity << "from m/s:" << shot["v"].toDouble();
-				curSeries->muzzleVelocities.append(velocity);
-			}
-		}
-
-		// Finish parsing the current series.
-		qDebug() << "End of JSON";
-
-		if (curSeries->muzzleVelocities.size() > 0)
-		{
-			qDebug() << "Adding curSeries to allSeries";
-
-			allSeries.append(curSeries);
-		}
-
-		free(destBuf);
-
-		seriesNum++;
+		qCDebug(lcImport) << "Series has no velocities, returning invalid.";
+		store->discardSeries();
+		return;
 	}
 
-	return allSeries;
+	curSeries->isValid = true;
 }
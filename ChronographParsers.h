@@ -5,32 +5,42 @@
 #include <QList>
 #include <QString>
 #include "xlsxdocument.h"
+#include "SeriesStore.h"
 
 namespace Powder
 {
-	struct ChronoSeries;
-
+	/*
+	 * Chronograph parsers append each series they find to a SeriesStore. Series without usable
+	 * data are left out of the store.
+	 */
 	class ChronographParsers
 	{
 	public:
-		// LabRadar parser
-		static ChronoSeries* extractLabRadarSeries(QTextStream &csv);
+		// LabRadar parser. Takes the raw bytes of a report, which may be UTF-8 or UTF-16 of either byte order.
+		static bool extractLabRadarSeries(const char *data, qint64 size, SeriesStore *store);
 		
 		// MagnetoSpeed parser
-		static QList<ChronoSeries*> extractMagnetoSpeedSeries(QTextStream &csv);
+		static void extractMagnetoSpeedSeries(QTextStream &csv, SeriesStore *store);
 		
 		// ProChrono parsers
-		static QList<ChronoSeries*> extractProChronoSeries(QTextStream &csv);
-		static QList<ChronoSeries*> extractProChronoSeries_format2(QTextStream &csv);
+		static void extractProChronoSeries(QTextStream &csv, SeriesStore *store);
+		static void extractProChronoSeries_format2(QTextStream &csv, SeriesStore *store);
 		
 		// Garmin parsers
-		static QList<ChronoSeries*> extractGarminSeries_xlsx(QXlsx::Document &xlsx);
-		static QList<ChronoSeries*> extractGarminSeries_csv(QTextStream &csv);
-		
-		// ShotMarker parser
-		static QList<ChronoSeries*> extractShotMarkerSeriesTar(QString path);
+		static void extractGarminSeries_xlsx(QXlsx::Document &xlsx, SeriesStore *store);
+		static void extractGarminSeries_csv(QTextStream &csv, SeriesStore *store);
 	
 	private:
+		enum TextEncoding
+		{
+			ENCODING_UTF8,
+			ENCODING_UTF16LE,
+			ENCODING_UTF16BE
+		};
+
+		// Looks for a byte order mark, then for the NUL bytes ASCII text has in UTF-16
+		static TextEncoding detectEncoding(const char *data, qint64 size, int *bomLength);
+
 		// CSV parsing helper
 		static bool readCSVRow(QTextStream &in, QStringList *row);
 	};
@@ -1,4 +1,5 @@
 #include "PowderTest.h"
+#include "Logging.h"
 #include <QDialogButtonBox>
 #include <QVBoxLayout>
 #include <QDebug>
@@ -8,7 +9,7 @@ using namespace Powder;
 EnterVelocitiesDialog::EnterVelocitiesDialog(ChronoSeries *series, QDialog *parent)
 	: QDialog(parent)
 {
-	qDebug() << "Enter velocities dialog";
+	qCDebug(lcUi) << "Enter velocities dialog";
 
 	setWindowTitle("Enter velocities");
 
@@ -64,7 +65,7 @@ void EnterVelocitiesDialog::textChanged()
 		}
 		else
 		{
-			qDebug() << "Skipping invalid number:" << list.at(i);
+			LOG_TRACE(lcImportTrace) << "Skipping invalid number:" << list.at(i);
 		}
 	}
 
@@ -76,7 +77,7 @@ QList<double> EnterVelocitiesDialog::getValues(void)
 	QList<double> values;
 
 	QStringList list = textEdit->toPlainText().split("\n");
-	qDebug() << list;
+	LOG_TRACE(lcImportTrace) << "Entered velocities:" << list;
 
 	for (int i = 0; i < list.length(); i++)
 	{
@@ -88,7 +89,7 @@ QList<double> EnterVelocitiesDialog::getValues(void)
 		}
 		else
 		{
-			qDebug() << "Skipping invalid number:" << list.at(i);
+			LOG_TRACE(lcImportTrace) << "Skipping invalid number:" << list.at(i);
 		}
 	}
 
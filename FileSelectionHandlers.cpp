@@ -1,6 +1,12 @@
 #include "FileSelectionHandlers.h"
 #include "PowderTest.h"
 #include "ChronographParsers.h"
+#include "ShotMarkerArchive.h"
+#include "ParseCache.h"
+#include "MemoryStats.h"
+#include "Scheduler.h"
+#include "Logging.h"
+#include "miniz.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -9,55 +15,259 @@
 #include <QRegularExpression>
 #include <QTextStream>
 #include <QDebug>
-#include <QCheckBox>
-#include <QDoubleSpinBox>
-#include <QLabel>
+#include <string.h>
 
 #include "xlsxdocument.h"
 
 using namespace Powder;
 
-QList<ChronoSeries*> FileSelectionHandlers::selectLabRadarDirectory(
-	QWidget *parent,
-	const QString &prevDir,
-	QString *outDir)
+// QXlsx inflates every part of the workbook while loading, the zip directory says how much that is
+static qint64 xlsxUncompressedSize(const QString &path)
 {
-	qDebug() << "selectLabRadarDirectory";
-	qDebug() << "Previous directory:" << prevDir;
+	mz_zip_archive zip;
+	memset(&zip, 0, sizeof(zip));
+	if (!mz_zip_reader_init_file(&zip, QFile::encodeName(path).constData(), 0))
+	{
+		return 0;
+	}
 
-	QString path = QFileDialog::getExistingDirectory(parent, "Select directory", prevDir);
-	*outDir = path;
+	qint64 bytes = 0;
+	for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&zip); i++)
+	{
+		mz_zip_archive_file_stat stat;
+		if (mz_zip_reader_file_stat(&zip, i, &stat))
+		{
+			bytes += stat.m_uncomp_size;
+		}
+	}
 
-	qDebug() << "Selected directory:" << path;
+	mz_zip_reader_end(&zip);
+	return bytes;
+}
 
-	QList<ChronoSeries*> seriesData;
+namespace
+{
+	// What a parse job reads and where it puts the result, owned by the handler waiting for it
+	struct ParseContext
+	{
+		ParseContext() : useCache(true) {}
 
-	if (path.isEmpty())
+		QStringList paths;
+		QStringList names;
+		SeriesStore store;
+		bool useCache;
+	};
+}
+
+// Runs the parse on a worker while the handler waits with a progress dialog. False if it was cancelled.
+static bool runParse(FunctionJob::Function parse, ParseContext *context, QWidget *parent, const QString &label)
+{
+	return Scheduler::run(new FunctionJob(parse, context, Job::INTERACTIVE), parent, label);
+}
+
+static void parseLabRadar(Job *job, void *context)
+{
+	ParseContext *parse = (ParseContext *)context;
+
+	// Series are named after their directory, so a renamed card folder is a different entry
+	ParseCache cache("labradar", parse->useCache);
+	for (int i = 0; i < parse->paths.size(); i++)
 	{
-		qDebug() << "User didn't select a directory, bail";
-		return seriesData;
+		cache.addFile(parse->paths.at(i));
+		cache.addText(parse->names.at(i));
+	}
+
+	if (cache.load(&parse->store))
+	{
+		return;
+	}
+
+	for (int i = 0; i < parse->paths.size(); i++)
+	{
+		// A cancelled parse is thrown away, so don't let it into the cache either
+		if (job->isCancelled())
+		{
+			return;
+		}
+		job->setProgress(i, parse->paths.size());
+
+		// Reports are UTF-16, so they're parsed from the raw bytes rather than through a QTextStream
+		QFile csvFile(parse->paths.at(i));
+		if (!csvFile.open(QIODevice::ReadOnly) || (csvFile.size() == 0))
+		{
+			qCDebug(lcImport) << "Failed to open" << parse->paths.at(i) << ", skipping...";
+			continue;
+		}
+
+		uchar *data = csvFile.map(0, csvFile.size());
+		if (data == NULL)
+		{
+			qCDebug(lcImport) << "Failed to map" << parse->paths.at(i) << ", skipping...";
+			continue;
+		}
+
+		bool valid = ChronographParsers::extractLabRadarSeries((const char *)data, csvFile.size(), &parse->store);
+
+		csvFile.unmap(data);
+		csvFile.close();
+
+		if (!valid)
+		{
+			qCDebug(lcImport) << "Invalid series, skipping...";
+			continue;
+		}
+
+		parse->store.last().name = parse->names.at(i);
+	}
+
+	cache.save(parse->store);
+}
+
+static void parseMagnetoSpeed(Job *, void *context)
+{
+	ParseContext *parse = (ParseContext *)context;
+	QString path = parse->paths.first();
+
+	ParseCache cache("magnetospeed", parse->useCache);
+	cache.addFile(path);
+
+	if (!cache.load(&parse->store))
+	{
+		QFile csvFile(path);
+		csvFile.open(QIODevice::ReadOnly);
+		QTextStream csv(&csvFile);
+
+		ChronographParsers::extractMagnetoSpeedSeries(csv, &parse->store);
+
+		csvFile.close();
+
+		cache.save(parse->store);
+	}
+}
+
+static void parseProChrono(Job *, void *context)
+{
+	ParseContext *parse = (ParseContext *)context;
+	QString path = parse->paths.first();
+
+	ParseCache cache("prochrono", parse->useCache);
+	cache.addFile(path);
+
+	if (!cache.load(&parse->store))
+	{
+		QFile csvFile(path);
+		csvFile.open(QIODevice::ReadOnly);
+		QTextStream csv(&csvFile);
+
+		// Test which format this ProChrono file is
+		QString line = csv.readLine();
+		csv.seek(0);
+
+		if (line.startsWith("Shot 1"))
+		{
+			qCDebug(lcImport) << "Detected ProChrono format 2";
+			ChronographParsers::extractProChronoSeries_format2(csv, &parse->store);
+		}
+		else
+		{
+			qCDebug(lcImport) << "Detected ProChrono format 1";
+			ChronographParsers::extractProChronoSeries(csv, &parse->store);
+		}
+
+		csvFile.close();
+
+		cache.save(parse->store);
+	}
+}
+
+static void parseGarmin(Job *, void *context)
+{
+	ParseContext *parse = (ParseContext *)context;
+	QString path = parse->paths.first();
+
+	ParseCache cache("garmin", parse->useCache);
+	cache.addFile(path);
+
+	if (cache.load(&parse->store))
+	{
+		return;
+	}
+
+	if (path.endsWith(".xlsx", Qt::CaseInsensitive))
+	{
+		qCDebug(lcImport) << "Garmin XLSX file";
+
+		MemoryAccount<MemoryStats::DECOMPRESSION_BUFFERS> xlsxMemory;
+		xlsxMemory.set(xlsxUncompressedSize(path));
+
+		QXlsx::Document xlsx(path);
+		xlsx.load();
+
+		qCDebug(lcImport) << "Loaded xlsx doc. sheets: " << xlsx.sheetNames();
+
+		ChronographParsers::extractGarminSeries_xlsx(xlsx, &parse->store);
+	}
+	else
+	{
+		qCDebug(lcImport) << "Garmin CSV file";
+
+		QFile csvFile(path);
+		csvFile.open(QIODevice::ReadOnly | QIODevice::Text);
+		QTextStream csv(&csvFile);
+
+		ChronographParsers::extractGarminSeries_csv(csv, &parse->store);
+	}
+
+	cache.save(parse->store);
+}
+
+static void parseShotMarker(Job *, void *context)
+{
+	ParseContext *parse = (ParseContext *)context;
+	QString path = parse->paths.first();
+
+	ParseCache cache("shotmarker-velocity", parse->useCache);
+	cache.addFile(path);
+
+	if (!cache.load(&parse->store))
+	{
+		QSharedPointer<const ShotMarkerArchive> archive = ShotMarkerArchive::open(path);
+		if (archive)
+		{
+			archive->appendVelocitySeries(&parse->store);
+		}
+
+		cache.save(parse->store);
 	}
+}
+
+QString FileSelectionHandlers::findLabRadarDirectory(const QString &path)
+{
+	QString result = path;
 
 	// Look for LabRadar data
-	QDir lbrPath(path);
+	QDir lbrPath(result);
 	lbrPath.setPath(lbrPath.filePath("LBR"));
 	if (lbrPath.exists())
 	{
-		path = lbrPath.path();
-		qDebug() << "Detected LabRadar directory" << path << ". Using that directory instead.";
+		result = lbrPath.path();
+		qCDebug(lcImport) << "Detected LabRadar directory" << result << ". Using that directory instead.";
 	}
 
-	QDir trkPath(path);
+	QDir trkPath(result);
 	trkPath.setPath(trkPath.filePath("TRK"));
 	if (trkPath.exists())
 	{
 		trkPath.setPath(trkPath.filePath("../.."));
-		path = trkPath.canonicalPath();
-		qDebug() << "Detected LabRadar directory" << path << ". Using one directory level up instead.";
+		result = trkPath.canonicalPath();
+		qCDebug(lcImport) << "Detected LabRadar directory" << result << ". Using one directory level up instead.";
 	}
 
-	qDebug() << "path:" << path;
+	return result;
+}
 
+void FileSelectionHandlers::findLabRadarReports(const QString &path, QStringList *outPaths, QStringList *outNames)
+{
 	/* Enumerate the LabRadar directory */
 	QRegularExpression re;
 	re.setPattern("^SR\\d\\d\\d\\d.*");
@@ -67,52 +277,152 @@ QList<ChronoSeries*> FileSelectionHandlers::selectLabRadarDirectory(
 
 	foreach (QString fileName, items)
 	{
-		qDebug() << "Entry:" << fileName;
+		LOG_TRACE(lcImportTrace) << "Entry:" << fileName;
 		if (re.match(fileName).hasMatch())
 		{
-			qDebug() << "Detected LabRadar series directory" << fileName;
+			qCDebug(lcImport) << "Detected LabRadar series directory" << fileName;
 
 			QString seriesPath(dir.filePath(fileName));
 			QDir seriesDir(seriesPath);
 			QStringList csvItems = seriesDir.entryList(QStringList() << "* Report.csv", QDir::Files | QDir::NoDotAndDotDot);
+
+			// The radar creates the directory when a series starts and writes the report after the first shot
+			if (csvItems.isEmpty())
+			{
+				qCDebug(lcImport) << "No report in" << fileName << "yet, skipping...";
+				continue;
+			}
+
 			QString csvFileName = csvItems.at(0);
 
-			qDebug() << "CSV file:" << csvFileName;
+			LOG_TRACE(lcImportTrace) << "CSV file:" << csvFileName;
 
-			QFile csvFile(seriesDir.filePath(csvFileName));
-			csvFile.open(QIODevice::ReadOnly);
-			QTextStream csv(&csvFile);
+			outNames->append(fileName);
+			outPaths->append(seriesDir.filePath(csvFileName));
+		}
+	}
+}
+
+QStringList FileSelectionHandlers::fileFilters(Source source)
+{
+	switch (source)
+	{
+		case MAGNETOSPEED:
+		case PROCHRONO:
+			return QStringList() << "*.csv";
+		case GARMIN:
+			return QStringList() << "*.xlsx" << "*.csv";
+		case SHOTMARKER:
+			return QStringList() << "*.tar";
+		default:
+			return QStringList();
+	}
+}
 
-			ChronoSeries *series = ChronographParsers::extractLabRadarSeries(csv);
+void FileSelectionHandlers::parseFile(Job *job, Source source, const QString &path, const QString &name, SeriesStore *store, bool useCache)
+{
+	ParseContext parse;
+	parse.paths.append(path);
+	parse.names.append(name);
+	parse.useCache = useCache;
 
-			if (!series->isValid)
-			{
-				qDebug() << "Invalid series, skipping...";
-				continue;
-			}
+	switch (source)
+	{
+		case LABRADAR:
+			parseLabRadar(job, &parse);
+			break;
+		case MAGNETOSPEED:
+			parseMagnetoSpeed(job, &parse);
+			break;
+		case PROCHRONO:
+			parseProChrono(job, &parse);
+			break;
+		case GARMIN:
+			parseGarmin(job, &parse);
+			break;
+		case SHOTMARKER:
+			parseShotMarker(job, &parse);
+			break;
+		default:
+			break;
+	}
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+	*store = parse.store;
+}
 
-			series->name = new QLabel(fileName);
+QList<ChronoSeries*> FileSelectionHandlers::createSeriesFromStore(const SeriesStore &store, SeriesArena<ChronoSeries> *arena)
+{
+	QList<ChronoSeries*> seriesData;
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+	for (int i = 0; i < store.size(); i++)
+	{
+		ChronoSeries *series = arena->create();
+		copySeriesFromStore(store, i, series);
+		series->enabled = true;
+		series->chargeWeight = 0;
 
-			seriesData.append(series);
+		seriesData.append(series);
+	}
 
-			csvFile.close();
-		}
+	return seriesData;
+}
+
+void FileSelectionHandlers::copySeriesFromStore(const SeriesStore &store, int index, ChronoSeries *series)
+{
+	const SeriesRecord &record = store.at(index);
+
+	series->isValid = record.isValid;
+	series->seriesNum = record.seriesNum;
+	series->muzzleVelocities = store.velocities(index);
+	series->velocityUnits = record.velocityUnits;
+	series->firstDate = record.firstDate;
+	series->firstTime = record.firstTime;
+	series->timestamp = record.timestamp;
+	series->name = record.name;
+}
+
+QList<ChronoSeries*> FileSelectionHandlers::selectLabRadarDirectory(
+	QWidget *parent,
+	const QString &prevDir,
+	QString *outDir,
+	SeriesArena<ChronoSeries> *arena)
+{
+	qCDebug(lcImport) << "selectLabRadarDirectory";
+	qCDebug(lcImport) << "Previous directory:" << prevDir;
+
+	QString path = QFileDialog::getExistingDirectory(parent, "Select directory", prevDir);
+	*outDir = path;
+
+	qCDebug(lcImport) << "Selected directory:" << path;
+
+	QList<ChronoSeries*> seriesData;
+
+	if (path.isEmpty())
+	{
+		qCDebug(lcImport) << "User didn't select a directory, bail";
+		return seriesData;
+	}
+
+	path = findLabRadarDirectory(path);
+
+	qCDebug(lcImport) << "path:" << path;
+
+	// Find every series' report first, so the whole directory can be looked up in the parse cache
+	ParseContext parse;
+	findLabRadarReports(path, &parse.paths, &parse.names);
+
+	if (!runParse(parseLabRadar, &parse, parent, "Reading LabRadar data..."))
+	{
+		qCDebug(lcImport) << "User cancelled reading the directory, bail";
+		return seriesData;
 	}
 
+	seriesData = createSeriesFromStore(parse.store, arena);
+
 	/* We're finished enumerating the directory */
 	if (seriesData.empty())
 	{
-		qDebug() << "Didn't find any chrono data in this directory, bail";
+		qCDebug(lcImport) << "Didn't find any chrono data in this directory, bail";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -122,7 +432,7 @@ QList<ChronoSeries*> FileSelectionHandlers::selectLabRadarDirectory(
 	}
 	else
 	{
-		qDebug() << "Detected LabRadar directory" << path;
+		qCDebug(lcImport) << "Detected LabRadar directory" << path;
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
@@ -137,60 +447,47 @@ QList<ChronoSeries*> FileSelectionHandlers::selectLabRadarDirectory(
 QList<ChronoSeries*> FileSelectionHandlers::selectMagnetoSpeedFile(
 	QWidget *parent,
 	const QString &prevDir,
-	QString *outDir)
+	QString *outDir,
+	SeriesArena<ChronoSeries> *arena)
 {
-	qDebug() << "selectMagnetoSpeedFile";
-	qDebug() << "Previous directory:" << prevDir;
+	qCDebug(lcImport) << "selectMagnetoSpeedFile";
+	qCDebug(lcImport) << "Previous directory:" << prevDir;
 
 	QString path = QFileDialog::getOpenFileName(parent, "Select file", prevDir, "CSV files (*.csv)");
 	*outDir = path;
 
-	qDebug() << "Selected file:" << path;
+	qCDebug(lcImport) << "Selected file:" << path;
 
 	QList<ChronoSeries*> seriesData;
 
 	if (path.isEmpty())
 	{
-		qDebug() << "User didn't select a file, bail";
+		qCDebug(lcImport) << "User didn't select a file, bail";
 		return seriesData;
 	}
 
-	QFile csvFile(path);
-	csvFile.open(QIODevice::ReadOnly);
-	QTextStream csv(&csvFile);
+	ParseContext parse;
+	parse.paths.append(path);
 
-	QList<ChronoSeries*> allSeries = ChronographParsers::extractMagnetoSpeedSeries(csv);
-
-	qDebug() << "Got allSeries from ExtractMagnetoSpeedSeries with size" << allSeries.size();
-
-	if (!allSeries.empty())
+	if (!runParse(parseMagnetoSpeed, &parse, parent, "Reading MagnetoSpeed data..."))
 	{
-		qDebug() << "Detected MagnetoSpeed file";
-
-		for (int i = 0; i < allSeries.size(); i++)
-		{
-			ChronoSeries *series = allSeries.at(i);
+		qCDebug(lcImport) << "User cancelled reading the file, bail";
+		return seriesData;
+	}
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+	qCDebug(lcImport) << "Got store from ExtractMagnetoSpeedSeries with size" << parse.store.size();
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+	if (!parse.store.isEmpty())
+	{
+		qCDebug(lcImport) << "Detected MagnetoSpeed file";
 
-			seriesData.append(series);
-		}
+		seriesData = createSeriesFromStore(parse.store, arena);
 	}
 
-	csvFile.close();
-
 	/* We're finished parsing the file */
 	if (seriesData.empty())
 	{
-		qDebug() << "Didn't find any chrono data in this file, bail";
+		qCDebug(lcImport) << "Didn't find any chrono data in this file, bail";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -200,7 +497,7 @@ QList<ChronoSeries*> FileSelectionHandlers::selectMagnetoSpeedFile(
 	}
 	else
 	{
-		qDebug() << "Detected MagnetoSpeed file" << path;
+		qCDebug(lcImport) << "Detected MagnetoSpeed file" << path;
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
@@ -215,75 +512,47 @@ QList<ChronoSeries*> FileSelectionHandlers::selectMagnetoSpeedFile(
 QList<ChronoSeries*> FileSelectionHandlers::selectProChronoFile(
 	QWidget *parent,
 	const QString &prevDir,
-	QString *outDir)
+	QString *outDir,
+	SeriesArena<ChronoSeries> *arena)
 {
-	qDebug() << "selectProChronoFile";
-	qDebug() << "Previous directory:" << prevDir;
+	qCDebug(lcImport) << "selectProChronoFile";
+	qCDebug(lcImport) << "Previous directory:" << prevDir;
 
 	QString path = QFileDialog::getOpenFileName(parent, "Select file", prevDir, "CSV files (*.csv)");
 	*outDir = path;
 
-	qDebug() << "Selected file:" << path;
+	qCDebug(lcImport) << "Selected file:" << path;
 
 	QList<ChronoSeries*> seriesData;
 
 	if (path.isEmpty())
 	{
-		qDebug() << "User didn't select a file, bail";
+		qCDebug(lcImport) << "User didn't select a file, bail";
 		return seriesData;
 	}
 
-	QFile csvFile(path);
-	csvFile.open(QIODevice::ReadOnly);
-	QTextStream csv(&csvFile);
-
-	// Test which format this ProChrono file is
-	QString line = csv.readLine();
-	csv.seek(0);
-
-	QList<ChronoSeries*> allSeries;
+	ParseContext parse;
+	parse.paths.append(path);
 
-	if (line.startsWith("Shot 1"))
-	{
-		qDebug() << "Detected ProChrono format 2";
-		allSeries = ChronographParsers::extractProChronoSeries_format2(csv);
-	}
-	else
+	if (!runParse(parseProChrono, &parse, parent, "Reading ProChrono data..."))
 	{
-		qDebug() << "Detected ProChrono format 1";
-		allSeries = ChronographParsers::extractProChronoSeries(csv);
+		qCDebug(lcImport) << "User cancelled reading the file, bail";
+		return seriesData;
 	}
 
-	qDebug() << "Got allSeries from ExtractProChronoSeries with size" << allSeries.size();
+	qCDebug(lcImport) << "Got store from ExtractProChronoSeries with size" << parse.store.size();
 
-	if (!allSeries.empty())
+	if (!parse.store.isEmpty())
 	{
-		qDebug() << "Detected ProChrono file";
-
-		for (int i = 0; i < allSeries.size(); i++)
-		{
-			ChronoSeries *series = allSeries.at(i);
-
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+		qCDebug(lcImport) << "Detected ProChrono file";
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
-
-			seriesData.append(series);
-		}
+		seriesData = createSeriesFromStore(parse.store, arena);
 	}
 
-	csvFile.close();
-
 	/* We're finished parsing the file */
 	if (seriesData.empty())
 	{
-		qDebug() << "Didn't find any chrono data in this file, bail";
+		qCDebug(lcImport) << "Didn't find any chrono data in this file, bail";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -293,7 +562,7 @@ QList<ChronoSeries*> FileSelectionHandlers::selectProChronoFile(
 	}
 	else
 	{
-		qDebug() << "Detected ProChrono file" << path;
+		qCDebug(lcImport) << "Detected ProChrono file" << path;
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
@@ -308,50 +577,28 @@ QList<ChronoSeries*> FileSelectionHandlers::selectProChronoFile(
 QList<ChronoSeries*> FileSelectionHandlers::selectGarminFile(
 	QWidget *parent,
 	const QString &prevDir,
-	QString *outDir)
+	QString *outDir,
+	SeriesArena<ChronoSeries> *arena)
 {
-	qDebug() << "selectGarminFile";
-	qDebug() << "Previous directory:" << prevDir;
+	qCDebug(lcImport) << "selectGarminFile";
+	qCDebug(lcImport) << "Previous directory:" << prevDir;
 
 	QString path = QFileDialog::getOpenFileName(parent, "Select file", prevDir, "Garmin files (*.xlsx *.csv)");
 	*outDir = path;
 
-	qDebug() << "Selected file:" << path;
+	qCDebug(lcImport) << "Selected file:" << path;
 
 	QList<ChronoSeries*> seriesData;
 
 	if (path.isEmpty())
 	{
-		qDebug() << "User didn't select a file, bail";
+		qCDebug(lcImport) << "User didn't select a file, bail";
 		return seriesData;
 	}
 
-	QList<ChronoSeries*> allSeries;
-
-	if (path.endsWith(".xlsx", Qt::CaseInsensitive))
-	{
-		qDebug() << "Garmin XLSX file";
-
-		QXlsx::Document xlsx(path);
-		xlsx.load();
-
-		qDebug() << "Loaded xlsx doc. sheets: " << xlsx.sheetNames();
-
-		allSeries = ChronographParsers::extractGarminSeries_xlsx(xlsx);
-	}
-	else if (path.endsWith(".csv", Qt::CaseInsensitive))
-	{
-		qDebug() << "Garmin CSV file";
-
-		QFile csvFile(path);
-		csvFile.open(QIODevice::ReadOnly | QIODevice::Text);
-		QTextStream csv(&csvFile);
-
-		allSeries = ChronographParsers::extractGarminSeries_csv(csv);
-	}
-	else
+	if (!path.endsWith(".xlsx", Qt::CaseInsensitive) && !path.endsWith(".csv", Qt::CaseInsensitive))
 	{
-		qDebug() << "Garmin unsupported file, bailing...";
+		qCDebug(lcImport) << "Garmin unsupported file, bailing...";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -362,34 +609,28 @@ QList<ChronoSeries*> FileSelectionHandlers::selectGarminFile(
 		return seriesData;
 	}
 
-	qDebug() << "Got allSeries with size" << allSeries.size();
+	ParseContext parse;
+	parse.paths.append(path);
 
-	if (!allSeries.empty())
+	if (!runParse(parseGarmin, &parse, parent, "Reading Garmin data..."))
 	{
-		qDebug() << "Detected Garmin file";
-
-		for (int i = 0; i < allSeries.size(); i++)
-		{
-			ChronoSeries *series = allSeries.at(i);
+		qCDebug(lcImport) << "User cancelled reading the file, bail";
+		return seriesData;
+	}
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+	qCDebug(lcImport) << "Got store with size" << parse.store.size();
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+	if (!parse.store.isEmpty())
+	{
+		qCDebug(lcImport) << "Detected Garmin file";
 
-			seriesData.append(series);
-		}
+		seriesData = createSeriesFromStore(parse.store, arena);
 	}
 
 	/* We're finished parsing the file */
 	if (seriesData.empty())
 	{
-		qDebug() << "Didn't find any chrono data in this file, bail";
+		qCDebug(lcImport) << "Didn't find any chrono data in this file, bail";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -399,7 +640,7 @@ QList<ChronoSeries*> FileSelectionHandlers::selectGarminFile(
 	}
 	else
 	{
-		qDebug() << "Detected Garmin file" << path;
+		qCDebug(lcImport) << "Detected Garmin file" << path;
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
@@ -414,35 +655,28 @@ QList<ChronoSeries*> FileSelectionHandlers::selectGarminFile(
 QList<ChronoSeries*> FileSelectionHandlers::selectShotMarkerFile(
 	QWidget *parent,
 	const QString &prevDir,
-	QString *outDir)
+	QString *outDir,
+	SeriesArena<ChronoSeries> *arena)
 {
-	qDebug() << "selectShotMarkerFile";
-	qDebug() << "Previous directory:" << prevDir;
+	qCDebug(lcImport) << "selectShotMarkerFile";
+	qCDebug(lcImport) << "Previous directory:" << prevDir;
 
 	QString path = QFileDialog::getOpenFileName(parent, "Select file", prevDir, "ShotMarker files (*.tar)");
 	*outDir = path;
 
-	qDebug() << "Selected file:" << path;
+	qCDebug(lcImport) << "Selected file:" << path;
 
 	QList<ChronoSeries*> seriesData;
 
 	if (path.isEmpty())
 	{
-		qDebug() << "User didn't select a file, bail";
+		qCDebug(lcImport) << "User didn't select a file, bail";
 		return seriesData;
 	}
 
-	QList<ChronoSeries*> allSeries;
-
-	if (path.endsWith(".tar"))
-	{
-		qDebug() << "ShotMarker .tar bundle";
-
-		allSeries = ChronographParsers::extractShotMarkerSeriesTar(path);
-	}
-	else
+	if (!path.endsWith(".tar"))
 	{
-		qDebug() << "ShotMarker .csv export, bailing";
+		qCDebug(lcImport) << "ShotMarker .csv export, bailing";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -453,34 +687,30 @@ QList<ChronoSeries*> FileSelectionHandlers::selectShotMarkerFile(
 		return seriesData;
 	}
 
-	qDebug() << "Got allSeries with size" << allSeries.size();
+	qCDebug(lcImport) << "ShotMarker .tar bundle";
 
-	if (!allSeries.empty())
-	{
-		qDebug() << "Detected ShotMarker file";
+	ParseContext parse;
+	parse.paths.append(path);
 
-		for (int i = 0; i < allSeries.size(); i++)
-		{
-			ChronoSeries *series = allSeries.at(i);
+	if (!runParse(parseShotMarker, &parse, parent, "Reading ShotMarker data..."))
+	{
+		qCDebug(lcImport) << "User cancelled reading the file, bail";
+		return seriesData;
+	}
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+	qCDebug(lcImport) << "Got store with size" << parse.store.size();
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+	if (!parse.store.isEmpty())
+	{
+		qCDebug(lcImport) << "Detected ShotMarker file";
 
-			seriesData.append(series);
-		}
+		seriesData = createSeriesFromStore(parse.store, arena);
 	}
 
 	/* We're finished parsing the file */
 	if (seriesData.empty())
 	{
-		qDebug() << "Didn't find any shot data in this file, bail";
+		qCDebug(lcImport) << "Didn't find any shot data in this file, bail";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -490,7 +720,7 @@ QList<ChronoSeries*> FileSelectionHandlers::selectShotMarkerFile(
 	}
 	else
 	{
-		qDebug() << "Detected ShotMarker file" << path;
+		qCDebug(lcImport) << "Detected ShotMarker file" << path;
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
@@ -3,8 +3,14 @@
 
 #include <QString>
 #include <QList>
+#include <QStringList>
 #include <QWidget>
 
+#include "SeriesStore.h"
+#include "SeriesArena.h"
+
+class Job;
+
 namespace Powder
 {
 	struct ChronoSeries;
@@ -12,35 +18,71 @@ namespace Powder
 	class FileSelectionHandlers
 	{
 	public:
+		// Where a session's series were imported from
+		enum Source
+		{
+			NO_SOURCE,
+			LABRADAR,
+			MAGNETOSPEED,
+			PROCHRONO,
+			GARMIN,
+			SHOTMARKER
+		};
+
 		static QList<ChronoSeries*> selectLabRadarDirectory(
 			QWidget *parent,
 			const QString &prevDir,
-			QString *outDir
+			QString *outDir,
+			SeriesArena<ChronoSeries> *arena
 		);
 
 		static QList<ChronoSeries*> selectMagnetoSpeedFile(
 			QWidget *parent,
 			const QString &prevDir,
-			QString *outDir
+			QString *outDir,
+			SeriesArena<ChronoSeries> *arena
 		);
 
 		static QList<ChronoSeries*> selectProChronoFile(
 			QWidget *parent,
 			const QString &prevDir,
-			QString *outDir
+			QString *outDir,
+			SeriesArena<ChronoSeries> *arena
 		);
 
 		static QList<ChronoSeries*> selectGarminFile(
 			QWidget *parent,
 			const QString &prevDir,
-			QString *outDir
+			QString *outDir,
+			SeriesArena<ChronoSeries> *arena
 		);
 
 		static QList<ChronoSeries*> selectShotMarkerFile(
 			QWidget *parent,
 			const QString &prevDir,
-			QString *outDir
+			QString *outDir,
+			SeriesArena<ChronoSeries> *arena
 		);
+
+		// The directory holding a card's series directories, the user may have picked the card or a series' TRK directory
+		static QString findLabRadarDirectory(const QString &path);
+
+		// Every series directory that has a report yet, with the directory name the series is named after
+		static void findLabRadarReports(const QString &path, QStringList *outPaths, QStringList *outNames);
+
+		// Name filters for the files a single-file source exports, e.g. "*.tar" for ShotMarker
+		static QStringList fileFilters(Source source);
+
+		/* Parses one file, or one LabRadar report named after its directory, into the store. Doesn't
+		   touch any widgets, it runs on a worker. Pass useCache false for files that are still growing,
+		   every version of them would otherwise get its own parse cache entry. */
+		static void parseFile(Job *job, Source source, const QString &path, const QString &name, SeriesStore *store, bool useCache = true);
+
+		// Creates a series in the arena for each series in the store
+		static QList<ChronoSeries*> createSeriesFromStore(const SeriesStore &store, SeriesArena<ChronoSeries> *arena);
+
+		// Copies one parsed series over the imported fields of a series, leaving the charge weight and enabled state alone
+		static void copySeriesFromStore(const SeriesStore &store, int index, ChronoSeries *series);
 	};
 }
 
@@ -0,0 +1,345 @@
+#include "FolderWatch.h"
+#include "PowderTest.h"
+#include "Scheduler.h"
+#include "Trace.h"
+#include "Logging.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+#include <QDebug>
+
+// Chronographs write a file in several goes, wait until it's been quiet this long before reading it
+#define WATCH_SETTLE_MSECS 1000
+
+namespace Powder
+{
+	// Parses the files a scan found, the results are read by FolderWatch::scanFinished()
+	class FolderScanJob : public Job
+	{
+	public:
+		struct Request
+		{
+			QString path;
+			QString name;
+			qint64 size;
+			QDateTime modified;
+		};
+
+		FolderScanJob(FileSelectionHandlers::Source source)
+			: Job(Job::NORMAL), source(source)
+		{
+		}
+
+		FileSelectionHandlers::Source source;
+		QList<Request> requests;
+		QList<SeriesStore> results;
+
+	protected:
+		virtual void run() Q_DECL_OVERRIDE
+		{
+			TRACE_SPAN("import", "folder watch");
+
+			for (int i = 0; i < requests.size(); i++)
+			{
+				if (isCancelled())
+				{
+					return;
+				}
+
+				// A watched file changes with every shot, caching each version would only fill the cache
+				SeriesStore store;
+				FileSelectionHandlers::parseFile(this, source, requests.at(i).path, requests.at(i).name, &store, false);
+				results.append(store);
+			}
+		}
+	};
+}
+
+using namespace Powder;
+
+FolderWatch::FolderWatch(SeriesArena<ChronoSeries> *arena, QObject *parent)
+	: QObject(parent), arena(arena), source(FileSelectionHandlers::NO_SOURCE), scanning(NULL), rescanPending(false)
+{
+	watcher = new QFileSystemWatcher(this);
+	connect(watcher, SIGNAL(directoryChanged(const QString &)), this, SLOT(folderChanged()));
+	connect(watcher, SIGNAL(fileChanged(const QString &)), this, SLOT(folderChanged()));
+
+	settleTimer = new QTimer(this);
+	settleTimer->setSingleShot(true);
+	settleTimer->setInterval(WATCH_SETTLE_MSECS);
+	connect(settleTimer, SIGNAL(timeout()), this, SLOT(scan()));
+}
+
+FolderWatch::~FolderWatch()
+{
+	stop();
+}
+
+void FolderWatch::start(FileSelectionHandlers::Source source, const QString &path, const QList<ChronoSeries*> &seriesData)
+{
+	stop();
+
+	this->source = source;
+
+	QString importedFile;
+	if (source == FileSelectionHandlers::LABRADAR)
+	{
+		folder = QDir(FileSelectionHandlers::findLabRadarDirectory(path)).absolutePath();
+	}
+	else
+	{
+		importedFile = QFileInfo(path).absoluteFilePath();
+		folder = QFileInfo(path).absolutePath();
+	}
+
+	qCDebug(lcImport) << "Watching" << folder << "for new data";
+
+	// What's there now was read by the import, remember it so only later changes are parsed
+	QStringList paths;
+	QStringList names;
+	findFiles(&paths, &names);
+
+	for (int i = 0; i < paths.size(); i++)
+	{
+		QFileInfo info(paths.at(i));
+
+		WatchedFile file;
+		file.size = info.size();
+		file.modified = info.lastModified();
+
+		// LabRadar series are named after their directory, the other sources came from a single file
+		foreach (ChronoSeries *series, seriesData)
+		{
+			if ((source == FileSelectionHandlers::LABRADAR) ? (series->name == names.at(i)) : (paths.at(i) == importedFile))
+			{
+				file.series.append(series);
+			}
+		}
+
+		files.insert(paths.at(i), file);
+	}
+
+	watchPaths(paths);
+}
+
+void FolderWatch::stop()
+{
+	settleTimer->stop();
+	rescanPending = false;
+
+	// A running scan finishes on its own, its results are no longer wanted
+	if (scanning != NULL)
+	{
+		scanning->cancel();
+		disconnect(scanning, 0, this, 0);
+		scanning = NULL;
+	}
+
+	QStringList watched = watcher->files() + watcher->directories();
+	if (!watched.isEmpty())
+	{
+		watcher->removePaths(watched);
+	}
+
+	if (source != FileSelectionHandlers::NO_SOURCE)
+	{
+		qCDebug(lcImport) << "Stopped watching" << folder;
+	}
+
+	files.clear();
+	folder.clear();
+	source = FileSelectionHandlers::NO_SOURCE;
+}
+
+bool FolderWatch::isWatching() const
+{
+	return source != FileSelectionHandlers::NO_SOURCE;
+}
+
+void FolderWatch::folderChanged()
+{
+	// Every write restarts the wait, so a file is read once the chronograph is done with it
+	settleTimer->start();
+}
+
+void FolderWatch::scan()
+{
+	if (!isWatching())
+	{
+		return;
+	}
+
+	// One scan at a time, changes seen meanwhile are picked up when it finishes
+	if (scanning != NULL)
+	{
+		rescanPending = true;
+		return;
+	}
+
+	QStringList paths;
+	QStringList names;
+	findFiles(&paths, &names);
+
+	// Removed files keep their series, the session is only ever added to
+	watchPaths(paths);
+
+	FolderScanJob *job = new FolderScanJob(source);
+
+	for (int i = 0; i < paths.size(); i++)
+	{
+		QFileInfo info(paths.at(i));
+
+		QHash<QString, WatchedFile>::const_iterator it = files.constFind(paths.at(i));
+		if ((it != files.constEnd()) && (it.value().size == info.size()) && (it.value().modified == info.lastModified()))
+		{
+			continue;
+		}
+
+		LOG_TRACE(lcImportTrace) << "New or changed file" << paths.at(i);
+
+		// Stat before parsing, so a write during the parse shows up as another change
+		FolderScanJob::Request request;
+		request.path = paths.at(i);
+		request.name = names.at(i);
+		request.size = info.size();
+		request.modified = info.lastModified();
+		job->requests.append(request);
+	}
+
+	if (job->requests.isEmpty())
+	{
+		delete job;
+		return;
+	}
+
+	qCDebug(lcImport) << "Parsing" << job->requests.size() << "new or changed files in" << folder;
+
+	scanning = job;
+	connect(job, SIGNAL(finished()), this, SLOT(scanFinished()));
+	Scheduler::submit(job);
+}
+
+void FolderWatch::scanFinished()
+{
+	FolderScanJob *job = scanning;
+	scanning = NULL;
+
+	if (job->isCancelled())
+	{
+		return;
+	}
+
+	QList<ChronoSeries*> added;
+	QList<ChronoSeries*> updated;
+
+	for (int i = 0; i < job->results.size(); i++)
+	{
+		const FolderScanJob::Request &request = job->requests.at(i);
+
+		WatchedFile &file = files[request.path];
+		file.size = request.size;
+		file.modified = request.modified;
+
+		updateSeries(&file, job->results.at(i), &added, &updated);
+	}
+
+	qCDebug(lcImport) << "Folder watch added" << added.size() << "series and updated" << updated.size();
+
+	if (!added.isEmpty() || !updated.isEmpty())
+	{
+		emit seriesArrived(added, updated);
+	}
+
+	if (rescanPending)
+	{
+		rescanPending = false;
+		scan();
+	}
+}
+
+void FolderWatch::findFiles(QStringList *outPaths, QStringList *outNames) const
+{
+	if (source == FileSelectionHandlers::LABRADAR)
+	{
+		FileSelectionHandlers::findLabRadarReports(folder, outPaths, outNames);
+		return;
+	}
+
+	QDir dir(folder);
+	QStringList items = dir.entryList(FileSelectionHandlers::fileFilters(source), QDir::Files | QDir::NoDotAndDotDot);
+
+	foreach (QString fileName, items)
+	{
+		outPaths->append(dir.absoluteFilePath(fileName));
+		outNames->append(fileName);
+	}
+}
+
+void FolderWatch::watchPaths(const QStringList &paths)
+{
+	QStringList wanted;
+	wanted << folder << paths;
+
+	// A LabRadar report is written inside its series directory, which may not have one yet
+	if (source == FileSelectionHandlers::LABRADAR)
+	{
+		QDir dir(folder);
+		foreach (const QString &fileName, dir.entryList(QStringList() << "SR*", QDir::AllDirs | QDir::NoDotAndDotDot))
+		{
+			wanted << dir.absoluteFilePath(fileName);
+		}
+	}
+
+	// Files replaced rather than rewritten drop out of the watcher, so this is checked on every scan
+	QSet<QString> watched;
+	foreach (const QString &path, watcher->files() + watcher->directories())
+	{
+		watched.insert(path);
+	}
+
+	QStringList missing;
+	foreach (const QString &path, wanted)
+	{
+		if (!watched.contains(path))
+		{
+			watched.insert(path);
+			missing << path;
+		}
+	}
+
+	if (!missing.isEmpty())
+	{
+		watcher->addPaths(missing);
+	}
+}
+
+void FolderWatch::updateSeries(WatchedFile *file, const SeriesStore &store, QList<ChronoSeries*> *added, QList<ChronoSeries*> *updated)
+{
+	for (int i = 0; i < store.size(); i++)
+	{
+		// Series already imported from this file keep their charge weight and checkbox
+		if (i < file->series.size())
+		{
+			ChronoSeries *series = file->series.at(i);
+			if (series->muzzleVelocities == store.velocities(i))
+			{
+				continue;
+			}
+
+			FileSelectionHandlers::copySeriesFromStore(store, i, series);
+			updated->append(series);
+			continue;
+		}
+
+		ChronoSeries *series = arena->create();
+		FileSelectionHandlers::copySeriesFromStore(store, i, series);
+		series->enabled = true;
+		series->chargeWeight = 0;
+
+		file->series.append(series);
+		added->append(series);
+	}
+}
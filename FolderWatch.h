@@ -0,0 +1,77 @@
+#ifndef FOLDER_WATCH_H
+#define FOLDER_WATCH_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "FileSelectionHandlers.h"
+#include "SeriesArena.h"
+
+class QFileSystemWatcher;
+class QTimer;
+
+namespace Powder
+{
+	struct ChronoSeries;
+	class FolderScanJob;
+
+	/*
+	 * Follows the folder a session was imported from while shooting carries on, e.g. a LabRadar card, a
+	 * Garmin export folder or a ShotMarker download directory. A file is read again once it's been
+	 * quiet for a moment, and only new or changed files are parsed, on a worker. Each parsed series
+	 * either updates the one already imported from that file (a LabRadar report grows with every shot)
+	 * or is added to the session.
+	 *
+	 * Series are created in the tab's arena, so stop() before the arena is cleared.
+	 */
+	class FolderWatch : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		FolderWatch(SeriesArena<ChronoSeries> *arena, QObject *parent = 0);
+		~FolderWatch();
+
+		/* path is the LabRadar directory or the chronograph file that was imported. Everything already
+		   in the folder counts as read, seriesData is what the import made of it. */
+		void start(FileSelectionHandlers::Source source, const QString &path, const QList<ChronoSeries*> &seriesData);
+		void stop();
+		bool isWatching() const;
+
+	signals:
+		// added are new to the session, updated were already in it and have new shots
+		void seriesArrived(const QList<ChronoSeries*> &added, const QList<ChronoSeries*> &updated);
+
+	private slots:
+		void folderChanged();
+		void scan();
+		void scanFinished();
+
+	private:
+		struct WatchedFile
+		{
+			qint64 size;
+			QDateTime modified;
+			QList<ChronoSeries*> series;
+		};
+
+		void findFiles(QStringList *outPaths, QStringList *outNames) const;
+		void watchPaths(const QStringList &paths);
+		void updateSeries(WatchedFile *file, const SeriesStore &store, QList<ChronoSeries*> *added, QList<ChronoSeries*> *updated);
+
+		SeriesArena<ChronoSeries> *arena;
+		QFileSystemWatcher *watcher;
+		QTimer *settleTimer;
+		FileSelectionHandlers::Source source;
+		QString folder;
+		QHash<QString, WatchedFile> files;
+		FolderScanJob *scanning;
+		bool rescanPending;
+	};
+}
+
+#endif // FOLDER_WATCH_H
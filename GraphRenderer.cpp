@@ -1,6 +1,11 @@
 #include "GraphRenderer.h"
 #include "PowderTest.h"
 #include "ChronoPlotter.h"
+#include "LabelLayout.h"
+#include "TextCache.h"
+#include "Trace.h"
+#include "Scheduler.h"
+#include "Logging.h"
 
 #include "qcustomplot/qcustomplot.h"
 #include <QMessageBox>
@@ -8,156 +13,399 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QtMath>
 #include <algorithm>
 #include <numeric>
 
 using namespace Powder;
 
-static bool ChargeWeightComparator(ChronoSeries *one, ChronoSeries *two)
+static void accountScene(LiveGraph *liveGraph)
 {
-	return (one->chargeWeight->value() < two->chargeWeight->value());
+	liveGraph->sceneMemory.set(MemoryStats::plotBytes(liveGraph->customPlot) + liveGraph->dataKey.capacity() * (qint64)sizeof(double));
+}
+
+static bool ChargeWeightComparator(const SeriesSnapshot &one, const SeriesSnapshot &two)
+{
+	return (one.chargeWeight < two.chargeWeight);
+}
+
+namespace
+{
+	// What the statistics job works from and fills in, owned by renderGraph()
+	struct GraphJobContext
+	{
+		QVector<SeriesSnapshot> seriesToGraph;
+		GraphOptions options;
+		int xAxisSpacing;
+		GraphData data;
+	};
+}
+
+PowderSnapshot *PowderSnapshot::create(const QList<ChronoSeries*> &seriesData)
+{
+	PowderSnapshot *snapshot = new PowderSnapshot();
+	snapshot->series.reserve(seriesData.size());
+
+	for (int i = 0; i < seriesData.size(); i++)
+	{
+		const ChronoSeries *series = seriesData.at(i);
+
+		SeriesSnapshot entry;
+		entry.seriesNum = series->seriesNum;
+		entry.name = series->name;
+		entry.muzzleVelocities = series->muzzleVelocities;
+		entry.chargeWeight = series->chargeWeight;
+		entry.enabled = series->enabled;
+		snapshot->series.append(entry);
+	}
+
+	return snapshot;
 }
 
 void GraphRenderer::renderGraph(
 	QWidget *parent,
-	const QList<ChronoSeries*> &seriesData,
+	const SnapshotPublisher<PowderSnapshot> &publishedSeries,
 	bool displayGraphPreview,
 	const GraphOptions &options,
 	const QString &prevSaveDir,
 	QString *outSaveDir,
+	LiveGraph **outLiveGraph,
 	GraphPreview **outGraphPreview)
 {
-	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
+	qCDebug(lcRender) << "renderGraph displayGraphPreview =" << displayGraphPreview;
+
+	LiveGraph *liveGraph = NULL;
+	while (liveGraph == NULL)
+	{
+		QSharedPointer<const PowderSnapshot> snapshot = publishedSeries.snapshot();
+		QVector<double> dataKey = getDataKey(*snapshot, options);
+
+		/* If only the graph options changed since the last preview, reuse the existing graph */
+		if (displayGraphPreview && (*outLiveGraph) && (*outGraphPreview) && ((*outLiveGraph)->dataKey == dataKey))
+		{
+			qCDebug(lcRender) << "Series data unchanged, updating existing graph preview";
+
+			updateGraphPreview(options, *outLiveGraph, *outGraphPreview);
+			(*outGraphPreview)->show();
+			(*outGraphPreview)->raise();
+			(*outGraphPreview)->activateWindow();
+			return;
+		}
+
+		GraphJobContext context;
+		context.options = options;
+		if (!prepareGraph(parent, *snapshot, options, &context.seriesToGraph, &context.xAxisSpacing))
+		{
+			return;
+		}
+
+		if (!Scheduler::run(new FunctionJob(computeGraphJob, &context, Job::INTERACTIVE), parent, "Calculating graph..."))
+		{
+			qCDebug(lcRender) << "User cancelled the graph, bailing";
+			return;
+		}
+
+		/* The window is disabled while the job runs, but the folder watch can still add shots and publish a
+		   new snapshot. Anything calculated from an older snapshot is dropped. */
+		if (snapshot->generation != publishedSeries.generation())
+		{
+			qCDebug(lcRender) << "Series changed since snapshot" << snapshot->generation << ", calculating again";
+			continue;
+		}
+
+		liveGraph = buildGraph(context.data, options, context.xAxisSpacing);
+		liveGraph->dataKey = dataKey;
+		accountScene(liveGraph);
+	}
+
+	if (displayGraphPreview)
+	{
+		qCDebug(lcRender) << "Showing graph preview";
+
+		TraceSpan rasterSpan("render", "rasterise");
+		QPixmap preview = liveGraph->customPlot->toPixmap(1440, 625, 2.0);
+		rasterSpan.end();
+
+		if (*outGraphPreview)
+		{
+			(*outGraphPreview)->deleteLater();
+		}
 
+		deleteGraph(*outLiveGraph);
+		*outLiveGraph = liveGraph;
+
+		*outGraphPreview = new GraphPreview(preview);
+	}
+	else
+	{
+		saveGraphToFile(parent, liveGraph->customPlot, options.graphTitle, prevSaveDir, outSaveDir);
+		deleteGraph(liveGraph);
+	}
+}
+
+void GraphRenderer::updateGraphPreview(
+	const GraphOptions &options,
+	LiveGraph *liveGraph,
+	GraphPreview *graphPreview)
+{
+	applyOptions(liveGraph, options);
+
+	// Annotations come and go with the options
+	accountScene(liveGraph);
+
+	TraceSpan rasterSpan("render", "rasterise");
+	QPixmap preview = liveGraph->customPlot->toPixmap(1440, 625, 2.0);
+	rasterSpan.end();
+	graphPreview->setImage(preview);
+}
+
+void GraphRenderer::deleteGraph(LiveGraph *liveGraph)
+{
+	if (liveGraph == NULL)
+	{
+		return;
+	}
+
+	/* Graphs, items and layout elements are all owned by the plot */
+	delete liveGraph->customPlot;
+	delete liveGraph;
+}
+
+QVector<double> GraphRenderer::getDataKey(
+	const PowderSnapshot &snapshot,
+	const GraphOptions &options)
+{
+	/* Everything the graph structure depends on. Options not in here are applied in place. */
+	QVector<double> dataKey;
+	dataKey << options.graphType << options.xAxisSpacingIndex;
+
+	for (int i = 0; i < snapshot.series.size(); i++)
+	{
+		const SeriesSnapshot &series = snapshot.series.at(i);
+
+		if (series.enabled)
+		{
+			dataKey << series.seriesNum << series.chargeWeight << series.muzzleVelocities.size();
+			for (int j = 0; j < series.muzzleVelocities.size(); j++)
+			{
+				dataKey << series.muzzleVelocities.at(j);
+			}
+		}
+	}
+
+	return dataKey;
+}
+
+bool GraphRenderer::prepareGraph(
+	QWidget *parent,
+	const PowderSnapshot &snapshot,
+	const GraphOptions &options,
+	QVector<SeriesSnapshot> *outSeriesToGraph,
+	int *outXAxisSpacing)
+{
 	/* Validate series before continuing */
 	int numEnabled = 0;
-	if (!validateSeries(parent, seriesData, &numEnabled))
+	if (!validateSeries(parent, snapshot, &numEnabled))
 	{
-		return;
+		return false;
 	}
 
 	if (numEnabled < 2)
 	{
-		qDebug() << "Only" << numEnabled << "series enabled, bailing";
+		qCDebug(lcRender) << "Only" << numEnabled << "series enabled, bailing";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
 		msg->setText("At least two series are required to graph!");
 		msg->setWindowTitle("Error");
 		msg->exec();
-		return;
+		return false;
 	}
 
-	QCustomPlot *customPlot = new QCustomPlot();
-	customPlot->setGeometry(40, 40, 1440, 625);
-	customPlot->setAntialiasedElements(QCP::aeAll);
-
 	/* Make a copy of the subset of data actually being graphed */
-	QList<ChronoSeries*> seriesToGraph = getEnabledSeries(seriesData);
+	*outSeriesToGraph = getEnabledSeries(snapshot);
 
 	/* Sort the data by charge weight */
-	std::sort(seriesToGraph.begin(), seriesToGraph.end(), ChargeWeightComparator);
+	std::sort(outSeriesToGraph->begin(), outSeriesToGraph->end(), ChargeWeightComparator);
 
 	/* Check if any charge weights are duplicated */
-	int xAxisSpacing = options.xAxisSpacingIndex;
-	if (!checkDuplicateChargeWeights(parent, seriesToGraph, options.xAxisSpacingIndex, &xAxisSpacing))
-	{
-		return;
-	}
-
-	/* Collect the data to graph */
-	QSharedPointer<QCPAxisTickerText> textTicker(new QCPAxisTickerText);
+	return checkDuplicateChargeWeights(parent, *outSeriesToGraph, options.xAxisSpacingIndex, outXAxisSpacing);
+}
 
-	QVector<double> xPoints;
-	QVector<double> yPoints;
-	QVector<double> xAvgPoints;
-	QVector<double> yAvgPoints;
-	QVector<double> yError;
+void GraphRenderer::computeGraphData(
+	const QVector<SeriesSnapshot> &seriesToGraph,
+	const GraphOptions &options,
+	int xAxisSpacing,
+	GraphData *outData)
+{
+	QVector<int> pointCounts;
 	QVector<double> allXPoints;
 	QVector<double> allYPoints;
 
+	/* Scatter points are binned to the velocity covered by one device pixel of the graph, so the
+	   number of points drawn depends on the graph size rather than the number of shots */
+	double graphVelocityMin = 0;
+	double graphVelocityMax = 0;
+	for (int i = 0; i < seriesToGraph.size(); i++)
+	{
+		const SeriesSnapshot &series = seriesToGraph.at(i);
+		double velocityMin = *std::min_element(series.muzzleVelocities.begin(), series.muzzleVelocities.end());
+		double velocityMax = *std::max_element(series.muzzleVelocities.begin(), series.muzzleVelocities.end());
+
+		if ((i == 0) || (velocityMin < graphVelocityMin))
+		{
+			graphVelocityMin = velocityMin;
+		}
+		if ((i == 0) || (velocityMax > graphVelocityMax))
+		{
+			graphVelocityMax = velocityMax;
+		}
+	}
+
+	// The y-axis is scaled to 1.3x the data range, and the axis rect is always shorter than the graph
+	double binSize = ((graphVelocityMax - graphVelocityMin) * 1.3) / (625 * 2.0);
+	qCDebug(lcRender) << "Scatter velocity bin size:" << binSize;
+
+	TraceSpan statsSpan("stats", "series statistics");
 	for (int i = 0; i < seriesToGraph.size(); i++)
 	{
-		ChronoSeries *series = seriesToGraph.at(i);
+		const SeriesSnapshot &series = seriesToGraph.at(i);
 
-		double chargeWeight = series->chargeWeight->value();
+		double chargeWeight = series.chargeWeight;
 
-		qDebug() << QString("Series %1 (%2 gr)").arg(series->seriesNum).arg(chargeWeight);
-		qDebug() << series->muzzleVelocities;
+		LOG_TRACE(lcStatsTrace) << QString("Series %1 (%2 gr)").arg(series.seriesNum).arg(chargeWeight);
+		LOG_TRACE(lcStatsTrace) << series.muzzleVelocities;
 
-		int totalShots = series->muzzleVelocities.size();
-		double mean = std::accumulate(series->muzzleVelocities.begin(), series->muzzleVelocities.end(), 0.0) / static_cast<double>(totalShots);
-		double stdev = sampleStdev(series->muzzleVelocities);
+		int totalShots = series.muzzleVelocities.size();
+		double mean = std::accumulate(series.muzzleVelocities.begin(), series.muzzleVelocities.end(), 0.0) / static_cast<double>(totalShots);
+		double stdev = sampleStdev(series.muzzleVelocities);
 
-		qDebug() << "Total shots:" << totalShots;
-		qDebug() << "Mean:" << mean;
-		qDebug() << "Stdev:" << stdev;
+		LOG_TRACE(lcStatsTrace) << "Total shots:" << totalShots;
+		LOG_TRACE(lcStatsTrace) << "Mean:" << mean;
+		LOG_TRACE(lcStatsTrace) << "Stdev:" << stdev;
 
+		double x;
 		if (xAxisSpacing == CONSTANT)
 		{
-			xAvgPoints.push_back(i);
+			x = i;
 		}
 		else
 		{
-			xAvgPoints.push_back(chargeWeight);
+			x = chargeWeight;
 		}
-		yAvgPoints.push_back(mean);
+
+		SeriesStats stats;
+		stats.x = x;
+		stats.velocityMin = *std::min_element(series.muzzleVelocities.begin(), series.muzzleVelocities.end());
+		stats.velocityMax = *std::max_element(series.muzzleVelocities.begin(), series.muzzleVelocities.end());
+		stats.mean = mean;
+		stats.stdev = stdev;
+		stats.totalShots = totalShots;
+		outData->stats.append(stats);
+
+		outData->xAvgPoints.push_back(x);
+		outData->yAvgPoints.push_back(mean);
 
 		if (options.graphType == SCATTER)
 		{
 			for (int j = 0; j < totalShots; j++)
 			{
-				if (xAxisSpacing == CONSTANT)
-				{
-					xPoints.push_back(i);
-					allXPoints.push_back(i);
-				}
-				else
-				{
-					xPoints.push_back(chargeWeight);
-					allXPoints.push_back(chargeWeight);
-				}
-				yPoints.push_back(series->muzzleVelocities.at(j));
-				allYPoints.push_back(series->muzzleVelocities.at(j));
+				allXPoints.push_back(x);
+				allYPoints.push_back(series.muzzleVelocities.at(j));
 			}
+
+			QVector<double> binnedVelocities;
+			binVelocities(series.muzzleVelocities, graphVelocityMin, binSize, &binnedVelocities, &pointCounts);
+			for (int j = 0; j < binnedVelocities.size(); j++)
+			{
+				outData->xPoints.push_back(x);
+				outData->yPoints.push_back(binnedVelocities.at(j));
+			}
+
+			LOG_TRACE(lcRenderTrace) << totalShots << "shots binned to" << binnedVelocities.size() << "points";
 		}
 		else
 		{
 			for (int j = 0; j < totalShots; j++)
 			{
-				if (xAxisSpacing == CONSTANT)
-				{
-					allXPoints.push_back(i);
-				}
-				else
-				{
-					allXPoints.push_back(chargeWeight);
-				}
-				allYPoints.push_back(series->muzzleVelocities.at(j));
+				allXPoints.push_back(x);
+				allYPoints.push_back(series.muzzleVelocities.at(j));
 			}
 
-			if (xAxisSpacing == CONSTANT)
-			{
-				xPoints.push_back(i);
-			}
-			else
-			{
-				xPoints.push_back(chargeWeight);
-			}
-			yPoints.push_back(mean);
-			yError.push_back(stdev);
+			outData->xPoints.push_back(x);
+			outData->yPoints.push_back(mean);
+			outData->yError.push_back(stdev);
 		}
 
-		if (xAxisSpacing == CONSTANT)
-		{
-			textTicker->addTick(i, QString::number(series->chargeWeight->value()));
-		}
-		else
+		outData->tickPositions.push_back(x);
+		outData->tickLabels.push_back(QString::number(series.chargeWeight));
+	}
+
+	statsSpan.end();
+
+	/* Density shading draws the same points split by how many shots landed in each bin */
+	if (options.graphType == SCATTER)
+	{
+		int maxCount = *std::max_element(pointCounts.begin(), pointCounts.end());
+
+		outData->xDensityPoints.resize(DENSITY_LEVELS);
+		outData->yDensityPoints.resize(DENSITY_LEVELS);
+		for (int j = 0; j < pointCounts.size(); j++)
 		{
-			textTicker->addTick(chargeWeight, QString::number(series->chargeWeight->value()));
+			int pointLevel = qCeil((pointCounts.at(j) * DENSITY_LEVELS) / static_cast<double>(maxCount));
+			outData->xDensityPoints[pointLevel - 1].push_back(outData->xPoints.at(j));
+			outData->yDensityPoints[pointLevel - 1].push_back(outData->yPoints.at(j));
 		}
 	}
 
+	/* Trend line is always fitted, its layer is hidden when the option is off */
+	std::vector<double> res = GetLinearFit(allXPoints, allYPoints);
+	qCDebug(lcRender) << "linear fit:" << res[0] << res[1];
+
+	outData->xTrendPoints.push_back(allXPoints.first());
+	outData->yTrendPoints.push_back(res[1] + (allXPoints.first() * res[0]));
+	outData->xTrendPoints.push_back(allXPoints.last());
+	outData->yTrendPoints.push_back(res[1] + (allXPoints.last() * res[0]));
+
+	LOG_TRACE(lcRenderTrace) << "xPoints:" << outData->xPoints;
+	LOG_TRACE(lcRenderTrace) << "yPoints:" << outData->yPoints;
+	LOG_TRACE(lcRenderTrace) << "allXPoints:" << allXPoints;
+	LOG_TRACE(lcRenderTrace) << "allYPoints:" << allYPoints;
+}
+
+void GraphRenderer::computeGraphJob(Job *, void *context)
+{
+	GraphJobContext *graphJob = (GraphJobContext *)context;
+	computeGraphData(graphJob->seriesToGraph, graphJob->options, graphJob->xAxisSpacing, &graphJob->data);
+}
+
+LiveGraph *GraphRenderer::buildGraph(
+	const GraphData &data,
+	const GraphOptions &options,
+	int xAxisSpacing)
+{
+	TRACE_SPAN("render", "build graph");
+
+	LiveGraph *liveGraph = new LiveGraph();
+	liveGraph->stats = data.stats;
+
+	QCustomPlot *customPlot = new QCustomPlot();
+	customPlot->setGeometry(40, 40, 1440, 625);
+	customPlot->setAntialiasedElements(QCP::aeAll);
+	liveGraph->customPlot = customPlot;
+
+	/* Each optional part of the graph gets its own layer so it can be toggled without a rebuild */
+	customPlot->addLayer("density", customPlot->layer("main"), QCustomPlot::limAbove);
+	customPlot->addLayer("trend", customPlot->layer("density"), QCustomPlot::limAbove);
+	customPlot->addLayer("boxes", customPlot->layer("trend"), QCustomPlot::limAbove);
+	customPlot->addLayer("annotations", customPlot->layer("overlay"), QCustomPlot::limAbove);
+
+	QSharedPointer<QCPAxisTickerText> textTicker(new QCPAxisTickerText);
+	for (int i = 0; i < data.tickPositions.size(); i++)
+	{
+		textTicker->addTick(data.tickPositions.at(i), data.tickLabels.at(i));
+	}
+
 	/* Create average line */
 	QPen avgLinePen(Qt::SolidLine);
 	QColor avgLineColor("#1c57eb");
@@ -166,82 +414,63 @@ void GraphRenderer::renderGraph(
 	avgLinePen.setWidthF(1.5);
 
 	QCPGraph *averageLine = customPlot->addGraph();
-	averageLine->setData(xAvgPoints, yAvgPoints);
+	averageLine->setData(data.xAvgPoints, data.yAvgPoints);
 	averageLine->setScatterStyle(QCPScatterStyle::ssNone);
 	averageLine->setPen(avgLinePen);
 
 	/* Create scatter plot */
 	QCPGraph *scatterPlot = customPlot->addGraph();
-	scatterPlot->setData(xPoints, yPoints);
+	scatterPlot->setData(data.xPoints, data.yPoints);
 	scatterPlot->rescaleAxes();
 	scatterPlot->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor("#0536b0"), 6.0));
 	scatterPlot->setLineStyle(QCPGraph::lsNone);
+	liveGraph->scatterPlot = scatterPlot;
+
+	/* Density shading draws the same points split by how many shots landed in each bin */
+	for (int level = 1; level <= data.xDensityPoints.size(); level++)
+	{
+		QColor densityColor("#0536b0");
+		densityColor.setAlphaF(level / static_cast<double>(DENSITY_LEVELS));
+
+		QCPGraph *densityPlot = customPlot->addGraph();
+		densityPlot->setData(data.xDensityPoints.at(level - 1), data.yDensityPoints.at(level - 1));
+		densityPlot->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, densityColor, 6.0));
+		densityPlot->setLineStyle(QCPGraph::lsNone);
+		densityPlot->setLayer("density");
+	}
 
 	/* Draw SD error bars if necessary */
 	if (options.graphType == LINE_SD)
 	{
 		QCPErrorBars *errorBars = new QCPErrorBars(customPlot->xAxis, customPlot->yAxis);
-		errorBars->setData(yError);
+		errorBars->setData(data.yError);
 		errorBars->setDataPlottable(averageLine);
 		errorBars->rescaleAxes();
 
 		customPlot->xAxis->grid()->setVisible(false);
 	}
 
-	/* Draw trend line if necessary */
-	if (options.showTrend)
-	{
-		std::vector<double> res = GetLinearFit(allXPoints, allYPoints);
-		qDebug() << "linear fit:" << res[0] << res[1];
-
-		QVector<double> xTrendPoints;
-		QVector<double> yTrendPoints;
-		xTrendPoints.push_back(allXPoints.first());
-		yTrendPoints.push_back(res[1] + (allXPoints.first() * res[0]));
-		xTrendPoints.push_back(allXPoints.last());
-		yTrendPoints.push_back(res[1] + (allXPoints.last() * res[0]));
-
-		Qt::PenStyle lineType;
-		if (options.trendLineType == SOLID_LINE)
-		{
-			lineType = Qt::SolidLine;
-		}
-		else
-		{
-			lineType = Qt::DashLine;
-		}
-
-		QPen trendLinePen(lineType);
-		QColor trendLineColor(Qt::red);
-		trendLineColor.setAlphaF(0.65);
-		trendLinePen.setColor(trendLineColor);
-		trendLinePen.setWidthF(1.5);
-
-		QCPGraph *trendLine = customPlot->addGraph();
-		trendLine->setData(xTrendPoints, yTrendPoints);
-		trendLine->setScatterStyle(QCPScatterStyle::ssNone);
-		trendLine->setPen(trendLinePen);
-	}
+	/* Trend line is always drawn, its layer is hidden when the option is off */
+	QCPGraph *trendLine = customPlot->addGraph();
+	trendLine->setData(data.xTrendPoints, data.yTrendPoints);
+	trendLine->setScatterStyle(QCPScatterStyle::ssNone);
+	trendLine->setLayer("trend");
+	liveGraph->trendLine = trendLine;
 
 	/* Configure rest of the graph */
-	QString weightUnits2 = getWeightUnit(options.weightUnitsIndex);
-	QString velocityUnits2 = getVelocityUnit(options.velocityUnitsIndex);
-
 	QCPTextElement *title = new QCPTextElement(customPlot);
-	title->setText(QString("\n%1").arg(options.graphTitle));
-	title->setFont(QFont("DejaVu Sans", scaleFontSize(24)));
+	title->setFont(TextCache::font(24));
 	title->setTextColor(QColor("#4d4d4d"));
 	customPlot->plotLayout()->insertRow(0);
 	customPlot->plotLayout()->addElement(0, 0, title);
+	liveGraph->title = title;
 
 	QCPTextElement *subtitle = new QCPTextElement(customPlot);
-	QStringList subtitleText;
-	subtitleText << options.rifle << options.propellant << options.projectile << options.brass << options.primer << options.weather;
-	subtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
-	subtitle->setFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	subtitle->setFont(TextCache::font(12));
 	subtitle->setTextColor(QColor("#4d4d4d"));
 	customPlot->plotLayout()->insertRow(1);
 	customPlot->plotLayout()->addElement(1, 0, subtitle);
+	liveGraph->subtitle = subtitle;
 
 	QPen gridPen(Qt::SolidLine);
 	gridPen.setColor("#d9d9d9");
@@ -250,12 +479,11 @@ void GraphRenderer::renderGraph(
 	axisBasePen.setColor("#d9d9d9");
 	axisBasePen.setWidth(2);
 
-	customPlot->xAxis->setLabel(QString("Powder charge (%1)").arg(weightUnits2));
 	customPlot->xAxis->scaleRange(1.1);
 	customPlot->xAxis->setTicker(textTicker);
-	customPlot->xAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->xAxis->setTickLabelFont(TextCache::font(9));
 	customPlot->xAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->xAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->xAxis->setLabelFont(TextCache::font(12));
 	customPlot->xAxis->setLabelColor(QColor("#4d4d4d"));
 	customPlot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
 	customPlot->xAxis->grid()->setPen(gridPen);
@@ -270,11 +498,10 @@ void GraphRenderer::renderGraph(
 	customPlot->xAxis2->setSubTickPen(Qt::NoPen);
 	customPlot->xAxis2->setPadding(20);
 
-	customPlot->yAxis->setLabel(QString("Velocity (%1)").arg(velocityUnits2));
 	customPlot->yAxis->scaleRange(1.3);
-	customPlot->yAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->yAxis->setTickLabelFont(TextCache::font(9));
 	customPlot->yAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->yAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->yAxis->setLabelFont(TextCache::font(12));
 	customPlot->yAxis->setLabelColor(QColor("#4d4d4d"));
 	customPlot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
 	customPlot->yAxis->grid()->setPen(gridPen);
@@ -292,68 +519,108 @@ void GraphRenderer::renderGraph(
 	customPlot->yAxis->ticker()->setTickCount(6);
 	customPlot->axisRect()->setupFullAxesBox();
 
-	// Render the graph off-screen
-	QPixmap picture(QSize(1440, 625));
-	QCPPainter painter(&picture);
-	customPlot->toPainter(&painter, 1440, 625);
-
 	/* Generate bounding boxes and text annotations */
-	addAnnotations(customPlot, seriesToGraph, options);
+	addAnnotations(liveGraph, options, xAxisSpacing);
 
-	if (displayGraphPreview)
+	/* Apply everything that can change without rebuilding the graph */
+	applyOptions(liveGraph, options);
+
+	return liveGraph;
+}
+
+LiveGraph *GraphRenderer::buildGraph(
+	QWidget *parent,
+	const PowderSnapshot &snapshot,
+	const GraphOptions &options)
+{
+	QVector<SeriesSnapshot> seriesToGraph;
+	int xAxisSpacing = options.xAxisSpacingIndex;
+	if (!prepareGraph(parent, snapshot, options, &seriesToGraph, &xAxisSpacing))
 	{
-		qDebug() << "Showing graph preview";
+		return NULL;
+	}
 
-		QPixmap preview = customPlot->toPixmap(1440, 625, 2.0);
+	GraphData data;
+	computeGraphData(seriesToGraph, options, xAxisSpacing, &data);
 
-		if (*outGraphPreview)
-		{
-			(*outGraphPreview)->deleteLater();
-		}
+	LiveGraph *liveGraph = buildGraph(data, options, xAxisSpacing);
+	liveGraph->dataKey = getDataKey(snapshot, options);
+	accountScene(liveGraph);
+
+	return liveGraph;
+}
 
-		qDebug() << "xPoints:" << xPoints;
-		qDebug() << "yPoints:" << yPoints;
-		qDebug() << "allXPoints:" << allXPoints;
-		qDebug() << "allYPoints:" << allYPoints;
+void GraphRenderer::applyOptions(
+	LiveGraph *liveGraph,
+	const GraphOptions &options)
+{
+	QCustomPlot *customPlot = liveGraph->customPlot;
 
-		*outGraphPreview = new GraphPreview(preview);
+	liveGraph->title->setText(QString("\n%1").arg(options.graphTitle));
+
+	QStringList subtitleText;
+	subtitleText << options.rifle << options.propellant << options.projectile << options.brass << options.primer << options.weather;
+	liveGraph->subtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
+
+	customPlot->xAxis->setLabel(QString("Powder charge (%1)").arg(getWeightUnit(options.weightUnitsIndex)));
+	customPlot->yAxis->setLabel(QString("Velocity (%1)").arg(getVelocityUnit(options.velocityUnitsIndex)));
+
+	Qt::PenStyle lineType;
+	if (options.trendLineType == SOLID_LINE)
+	{
+		lineType = Qt::SolidLine;
 	}
 	else
 	{
-		saveGraphToFile(parent, customPlot, options.graphTitle, prevSaveDir, outSaveDir);
+		lineType = Qt::DashLine;
 	}
+
+	QPen trendLinePen(lineType);
+	QColor trendLineColor(Qt::red);
+	trendLineColor.setAlphaF(0.65);
+	trendLinePen.setColor(trendLineColor);
+	trendLinePen.setWidthF(1.5);
+
+	liveGraph->trendLine->setPen(trendLinePen);
+	customPlot->layer("trend")->setVisible(options.showTrend);
+
+	// Density shading only exists for scatter plots, the plain points stay for line charts
+	liveGraph->scatterPlot->setVisible(!(options.showDensity && (options.graphType == SCATTER)));
+	customPlot->layer("density")->setVisible(options.showDensity);
+
+	layoutAnnotations(liveGraph, options);
 }
 
 bool GraphRenderer::validateSeries(
 	QWidget *parent,
-	const QList<ChronoSeries*> &seriesData,
+	const PowderSnapshot &snapshot,
 	int *outNumEnabled)
 {
 	int numEnabled = 0;
-	for (int i = 0; i < seriesData.size(); i++)
+	for (int i = 0; i < snapshot.series.size(); i++)
 	{
-		ChronoSeries *series = seriesData.at(i);
-		if ((!series->deleted) && series->enabled->isChecked())
+		const SeriesSnapshot &series = snapshot.series.at(i);
+		if (series.enabled)
 		{
 			numEnabled += 1;
-			if (series->chargeWeight->value() == 0)
+			if (series.chargeWeight == 0)
 			{
-				qDebug() << series->name->text() << "is missing charge weight, bailing";
+				qCDebug(lcRender) << series.name << "is missing charge weight, bailing";
 
 				QMessageBox *msg = new QMessageBox();
 				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("'%1' is missing charge weight!").arg(series->name->text()));
+				msg->setText(QString("'%1' is missing charge weight!").arg(series.name));
 				msg->setWindowTitle("Error");
 				msg->exec();
 				return false;
 			}
-			else if (series->muzzleVelocities.size() == 0)
+			else if (series.muzzleVelocities.size() == 0)
 			{
-				qDebug() << series->name->text() << "is missing velocities, bailing";
+				qCDebug(lcRender) << series.name << "is missing velocities, bailing";
 
 				QMessageBox *msg = new QMessageBox();
 				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("'%1' is missing velocities!").arg(series->name->text()));
+				msg->setText(QString("'%1' is missing velocities!").arg(series.name));
 				msg->setWindowTitle("Error");
 				msg->exec();
 				return false;
@@ -365,20 +632,52 @@ bool GraphRenderer::validateSeries(
 	return true;
 }
 
-QList<ChronoSeries*> GraphRenderer::getEnabledSeries(const QList<ChronoSeries*> &seriesData)
+bool GraphRenderer::isGraphable(const PowderSnapshot &snapshot, int xAxisSpacingIndex)
 {
-	QList<ChronoSeries*> seriesToGraph;
-	for (int i = 0; i < seriesData.size(); i++)
+	QVector<SeriesSnapshot> seriesToGraph = getEnabledSeries(snapshot);
+	if (seriesToGraph.size() < 2)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < seriesToGraph.size(); i++)
+	{
+		if ((seriesToGraph.at(i).chargeWeight == 0) || seriesToGraph.at(i).muzzleVelocities.isEmpty())
+		{
+			return false;
+		}
+	}
+
+	// Duplicates would ask to switch to constant spacing
+	if (xAxisSpacingIndex == PROPORTIONAL)
+	{
+		std::sort(seriesToGraph.begin(), seriesToGraph.end(), ChargeWeightComparator);
+		for (int i = 1; i < seriesToGraph.size(); i++)
+		{
+			if (seriesToGraph.at(i).chargeWeight == seriesToGraph.at(i - 1).chargeWeight)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+QVector<SeriesSnapshot> GraphRenderer::getEnabledSeries(const PowderSnapshot &snapshot)
+{
+	QVector<SeriesSnapshot> seriesToGraph;
+	for (int i = 0; i < snapshot.series.size(); i++)
 	{
-		ChronoSeries *series = seriesData.at(i);
+		const SeriesSnapshot &series = snapshot.series.at(i);
 
-		if ((!series->deleted) && series->enabled->isChecked())
+		if (series.enabled)
 		{
 			seriesToGraph.append(series);
 		}
 		else
 		{
-			qDebug() << "Series" << series->seriesNum << "is unchecked, skipping...";
+			qCDebug(lcRender) << "Series" << series.seriesNum << "is unchecked, skipping...";
 		}
 	}
 
@@ -387,7 +686,7 @@ QList<ChronoSeries*> GraphRenderer::getEnabledSeries(const QList<ChronoSeries*>
 
 bool GraphRenderer::checkDuplicateChargeWeights(
 	QWidget *parent,
-	const QList<ChronoSeries*> &seriesToGraph,
+	const QVector<SeriesSnapshot> &seriesToGraph,
 	int xAxisSpacingIndex,
 	int *outXAxisSpacing)
 {
@@ -396,12 +695,12 @@ bool GraphRenderer::checkDuplicateChargeWeights(
 		double lastChargeWeight = 0;
 		for (int i = 0; i < seriesToGraph.size(); i++)
 		{
-			ChronoSeries *series = seriesToGraph.at(i);
-			double chargeWeight = series->chargeWeight->value();
+			const SeriesSnapshot &series = seriesToGraph.at(i);
+			double chargeWeight = series.chargeWeight;
 
 			if (chargeWeight == lastChargeWeight)
 			{
-				qDebug() << "Duplicate charge weight detected" << chargeWeight;
+				qCDebug(lcRender) << "Duplicate charge weight detected" << chargeWeight;
 
 				QMessageBox::StandardButton reply;
 				reply = QMessageBox::question(parent, "Duplicate charge weights", 
@@ -410,13 +709,13 @@ bool GraphRenderer::checkDuplicateChargeWeights(
 
 				if (reply == QMessageBox::Ok)
 				{
-					qDebug() << "Set x-axis spacing to constant";
+					qCDebug(lcRender) << "Set x-axis spacing to constant";
 					*outXAxisSpacing = CONSTANT;
 					return true;
 				}
 				else
 				{
-					qDebug() << "User cancel, bailing out";
+					qCDebug(lcRender) << "User cancel, bailing out";
 					return false;
 				}
 			}
@@ -426,7 +725,7 @@ bool GraphRenderer::checkDuplicateChargeWeights(
 	}
 	else
 	{
-		qDebug() << "Constant x-axis spacing selected, skipping duplicate check";
+		qCDebug(lcRender) << "Constant x-axis spacing selected, skipping duplicate check";
 	}
 
 	*outXAxisSpacing = xAxisSpacingIndex;
@@ -434,27 +733,54 @@ bool GraphRenderer::checkDuplicateChargeWeights(
 }
 
 void GraphRenderer::addAnnotations(
-	QCustomPlot *customPlot,
-	const QList<ChronoSeries*> &seriesToGraph,
-	const GraphOptions &options)
+	LiveGraph *liveGraph,
+	const GraphOptions &options,
+	int xAxisSpacing)
 {
-	bool prevMeanSet = false;
-	double prevMean = 0;
+	TRACE_SPAN("render", "annotations");
 
-	for (int i = 0; i < seriesToGraph.size(); i++)
+	QCustomPlot *customPlot = liveGraph->customPlot;
+
+	qCDebug(lcRender) << "Adding annotations, xAxisSpacing =" << xAxisSpacing;
+
+	for (int i = 0; i < liveGraph->stats.size(); i++)
 	{
-		ChronoSeries *series = seriesToGraph.at(i);
+		const SeriesStats &stats = liveGraph->stats.at(i);
 
-		double chargeWeight = series->chargeWeight->value();
+		// Obtain plot coordinates for the top and bottom of the string
+		double yCoordBelow;
+		double yCoordAbove;
 
-		int totalShots = series->muzzleVelocities.size();
-		double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		double mean = std::accumulate(series->muzzleVelocities.begin(), series->muzzleVelocities.end(), 0.0) / static_cast<double>(totalShots);
-		int es = velocityMax - velocityMin;
-		double stdev = sampleStdev(series->muzzleVelocities);
-		QStringList aboveAnnotationText;
-		QStringList belowAnnotationText;
+		if (options.graphType == SCATTER)
+		{
+			yCoordBelow = stats.velocityMin;
+			yCoordAbove = stats.velocityMax;
+		}
+		else
+		{
+			if (qIsNaN(stats.stdev))
+			{
+				yCoordBelow = stats.mean;
+				yCoordAbove = stats.mean;
+			}
+			else
+			{
+				yCoordBelow = stats.mean - stats.stdev;
+				yCoordAbove = stats.mean + stats.stdev;
+			}
+		}
+
+		/* Invisible anchors in plot coordinates. Items are offset from these in pixels,
+		   so they stay in place no matter what size the graph is rendered at. */
+		QCPItemTracer *belowAnchor = new QCPItemTracer(customPlot);
+		belowAnchor->setStyle(QCPItemTracer::tsNone);
+		belowAnchor->position->setCoords(stats.x, yCoordBelow);
+		belowAnchor->setLayer("annotations");
+
+		QCPItemTracer *aboveAnchor = new QCPItemTracer(customPlot);
+		aboveAnchor->setStyle(QCPItemTracer::tsNone);
+		aboveAnchor->position->setCoords(stats.x, yCoordAbove);
+		aboveAnchor->setLayer("annotations");
 
 		if (options.graphType == SCATTER)
 		{
@@ -463,22 +789,63 @@ void GraphRenderer::addAnnotations(
 			rectPen.setWidthF(1.3);
 			rect->setPen(rectPen);
 			rect->topLeft->setType(QCPItemPosition::ptAbsolute);
+			rect->topLeft->setParentAnchor(aboveAnchor->position);
+			rect->topLeft->setCoords(-7, -7);
 			rect->bottomRight->setType(QCPItemPosition::ptAbsolute);
-			if (options.xAxisSpacingIndex == CONSTANT)
-			{
-				rect->topLeft->setCoords(customPlot->xAxis->coordToPixel(i) - 7, customPlot->yAxis->coordToPixel(velocityMax) - 7);
-				rect->bottomRight->setCoords(customPlot->xAxis->coordToPixel(i) + 7, customPlot->yAxis->coordToPixel(velocityMin) + 7);
-			}
-			else
-			{
-				rect->topLeft->setCoords(customPlot->xAxis->coordToPixel(chargeWeight) - 7, customPlot->yAxis->coordToPixel(velocityMax) - 7);
-				rect->bottomRight->setCoords(customPlot->xAxis->coordToPixel(chargeWeight) + 7, customPlot->yAxis->coordToPixel(velocityMin) + 7);
-			}
+			rect->bottomRight->setParentAnchor(belowAnchor->position);
+			rect->bottomRight->setCoords(7, 7);
+			rect->setLayer("boxes");
 		}
 
-		if (options.showES && (series->muzzleVelocities.size() > 1))
+		QCPItemText *belowAnnotation = new CachedTextItem(customPlot);
+		belowAnnotation->setFont(TextCache::font(9));
+		belowAnnotation->setColor(QColor("#4d4d4d"));
+		belowAnnotation->position->setType(QCPItemPosition::ptAbsolute);
+		belowAnnotation->position->setParentAnchor(belowAnchor->position);
+		belowAnnotation->position->setCoords(0, 10);
+		belowAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignTop);
+		belowAnnotation->setTextAlignment(Qt::AlignCenter);
+		belowAnnotation->setBrush(QBrush(Qt::white));
+		belowAnnotation->setClipToAxisRect(false);
+		belowAnnotation->setLayer("annotations");
+		liveGraph->belowAnnotations.append(belowAnnotation);
+
+		QCPItemText *aboveAnnotation = new CachedTextItem(customPlot);
+		aboveAnnotation->setFont(TextCache::font(9));
+		aboveAnnotation->setColor(QColor("#4d4d4d"));
+		aboveAnnotation->position->setType(QCPItemPosition::ptAbsolute);
+		aboveAnnotation->position->setParentAnchor(aboveAnchor->position);
+		aboveAnnotation->position->setCoords(0, -10);
+		aboveAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignBottom);
+		aboveAnnotation->setTextAlignment(Qt::AlignCenter);
+		aboveAnnotation->setBrush(QBrush(Qt::white));
+		aboveAnnotation->setClipToAxisRect(false);
+		aboveAnnotation->setLayer("annotations");
+		liveGraph->aboveAnnotations.append(aboveAnnotation);
+	}
+}
+
+void GraphRenderer::layoutAnnotations(
+	LiveGraph *liveGraph,
+	const GraphOptions &options)
+{
+	TRACE_SPAN("render", "annotation layout");
+
+	QList<PlotLabel> labels;
+	bool prevMeanSet = false;
+	double prevMean = 0;
+
+	for (int i = 0; i < liveGraph->stats.size(); i++)
+	{
+		const SeriesStats &stats = liveGraph->stats.at(i);
+
+		double es = stats.velocityMax - stats.velocityMin;
+		QStringList aboveAnnotationText;
+		QStringList belowAnnotationText;
+
+		if (options.showES && (stats.totalShots > 1))
 		{
-			QString annotation = QString("ES: %1").arg(es);
+			QString annotation = QString("ES: %1").arg(es, 0, 'f', 1);
 			if (options.esLocation == ABOVE_STRING)
 			{
 				aboveAnnotationText.append(annotation);
@@ -489,9 +856,9 @@ void GraphRenderer::addAnnotations(
 			}
 		}
 
-		if (options.showSD && (series->muzzleVelocities.size() > 1))
+		if (options.showSD && (stats.totalShots > 1))
 		{
-			QString annotation = QString("SD: %1").arg(stdev, 0, 'f', 1);
+			QString annotation = QString("SD: %1").arg(stats.stdev, 0, 'f', 1);
 			if (options.sdLocation == ABOVE_STRING)
 			{
 				aboveAnnotationText.append(annotation);
@@ -505,13 +872,13 @@ void GraphRenderer::addAnnotations(
 		if (options.showAvg)
 		{
 			QString annotation;
-			if (series->muzzleVelocities.size() > 1)
+			if (stats.totalShots > 1)
 			{
-				annotation = QString("x\u0305: %1").arg(mean, 0, 'f', 1);
+				annotation = QString("x\u0305: %1").arg(stats.mean, 0, 'f', 1);
 			}
 			else
 			{
-				annotation = QString::number(mean);
+				annotation = QString::number(stats.mean);
 			}
 
 			if (options.avgLocation == ABOVE_STRING)
@@ -529,7 +896,7 @@ void GraphRenderer::addAnnotations(
 			if (prevMeanSet)
 			{
 				QString sign;
-				int delta = round(mean - prevMean);
+				int delta = round(stats.mean - prevMean);
 				if (delta < 0)
 				{
 					sign = QString("-");
@@ -551,69 +918,80 @@ void GraphRenderer::addAnnotations(
 			}
 		}
 
-		// Obtain pixel coordinates for points
-		double yCoordBelow;
-		double yCoordAbove;
+		PlotLabel belowLabel;
+		belowLabel.item = liveGraph->belowAnnotations.at(i);
+		belowLabel.baseCoords = QPointF(0, 10);
+		belowLabel.lines = belowAnnotationText;
+		belowLabel.above = false;
+		labels.append(belowLabel);
+
+		PlotLabel aboveLabel;
+		aboveLabel.item = liveGraph->aboveAnnotations.at(i);
+		aboveLabel.baseCoords = QPointF(0, -10);
+		aboveLabel.lines = aboveAnnotationText;
+		aboveLabel.above = true;
+		labels.append(aboveLabel);
+
+		prevMean = stats.mean;
+		prevMeanSet = true;
+	}
 
-		if (options.graphType == SCATTER)
-		{
-			yCoordBelow = velocityMin;
-			yCoordAbove = velocityMax;
-		}
-		else
+	/* Lay out the graph at its render size so the annotation anchors have pixel positions */
+	QCustomPlot *customPlot = liveGraph->customPlot;
+	customPlot->setViewport(QRect(0, 0, 1440, 625));
+	customPlot->plotLayout()->update(QCPLayoutElement::upPreparation);
+	customPlot->plotLayout()->update(QCPLayoutElement::upMargins);
+	customPlot->plotLayout()->update(QCPLayoutElement::upLayout);
+
+	/* Stagger, abbreviate or drop labels that would overlap on wide ladders */
+	LabelLayout::layoutLabels(labels, QRectF(customPlot->viewport()));
+}
+
+void GraphRenderer::binVelocities(
+	const QList<double> &velocities,
+	double binMin,
+	double binSize,
+	QVector<double> *outVelocities,
+	QVector<int> *outCounts)
+{
+	QList<double> sortedVelocities = velocities;
+	std::sort(sortedVelocities.begin(), sortedVelocities.end());
+
+	int i = 0;
+	while (i < sortedVelocities.size())
+	{
+		double lowest = sortedVelocities.at(i);
+		double highest = lowest;
+		int count = 0;
+
+		if (binSize > 0)
 		{
-			if (qIsNaN(stdev))
+			qint64 bin = qFloor((lowest - binMin) / binSize);
+			while ((i < sortedVelocities.size()) && (qFloor((sortedVelocities.at(i) - binMin) / binSize) == bin))
 			{
-				yCoordBelow = mean;
-				yCoordAbove = mean;
+				highest = sortedVelocities.at(i);
+				count++;
+				i++;
 			}
-			else
-			{
-				yCoordBelow = mean - stdev;
-				yCoordAbove = mean + stdev;
-			}
-		}
-
-		QCPItemText *belowAnnotation = new QCPItemText(customPlot);
-		belowAnnotation->setText(belowAnnotationText.join('\n'));
-		belowAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
-		belowAnnotation->setColor(QColor("#4d4d4d"));
-		belowAnnotation->position->setType(QCPItemPosition::ptAbsolute);
-		if (options.xAxisSpacingIndex == CONSTANT)
-		{
-			belowAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(i), customPlot->yAxis->coordToPixel(yCoordBelow) + 10);
 		}
 		else
 		{
-			belowAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(chargeWeight), customPlot->yAxis->coordToPixel(yCoordBelow) + 10);
+			// Every shot has the same velocity
+			while ((i < sortedVelocities.size()) && (sortedVelocities.at(i) == lowest))
+			{
+				count++;
+				i++;
+			}
 		}
-		belowAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignTop);
-		belowAnnotation->setTextAlignment(Qt::AlignCenter);
-		belowAnnotation->setBrush(QBrush(Qt::white));
-		belowAnnotation->setClipToAxisRect(false);
-		belowAnnotation->setLayer(customPlot->layer(5));
 
-		QCPItemText *aboveAnnotation = new QCPItemText(customPlot);
-		aboveAnnotation->setText(aboveAnnotationText.join('\n'));
-		aboveAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
-		aboveAnnotation->setColor(QColor("#4d4d4d"));
-		aboveAnnotation->position->setType(QCPItemPosition::ptAbsolute);
-		if (options.xAxisSpacingIndex == CONSTANT)
+		/* Keep the actual extremes of each bin so the string's ES is drawn exactly */
+		outVelocities->push_back(lowest);
+		outCounts->push_back(count);
+		if (highest != lowest)
 		{
-			aboveAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(i), customPlot->yAxis->coordToPixel(yCoordAbove) - 10);
+			outVelocities->push_back(highest);
+			outCounts->push_back(count);
 		}
-		else
-		{
-			aboveAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(chargeWeight), customPlot->yAxis->coordToPixel(yCoordAbove) - 10);
-		}
-		aboveAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignBottom);
-		aboveAnnotation->setTextAlignment(Qt::AlignCenter);
-		aboveAnnotation->setBrush(QBrush(Qt::white));
-		aboveAnnotation->setClipToAxisRect(false);
-		aboveAnnotation->setLayer(customPlot->layer(5));
-
-		prevMean = mean;
-		prevMeanSet = true;
 	}
 }
 
@@ -635,17 +1013,17 @@ void GraphRenderer::saveGraphToFile(
 	}
 
 	QString savePath = QDir(prevSaveDir).filePath(fileName);
-	qDebug() << "graphTitle:" << graphTitle;
-	qDebug() << "fileName:" << fileName;
-	qDebug() << "savePath:" << savePath;
+	qCDebug(lcRender) << "graphTitle:" << graphTitle;
+	qCDebug(lcRender) << "fileName:" << fileName;
+	qCDebug(lcRender) << "savePath:" << savePath;
 
 	QString path = QFileDialog::getSaveFileName(parent, "Save graph as image", savePath, 
 		"PNG image (*.png);;JPG image (*.jpg);;PDF file (*.pdf)");
-	qDebug() << "User selected save path:" << path;
+	qCDebug(lcRender) << "User selected save path:" << path;
 
 	if (path.isEmpty())
 	{
-		qDebug() << "No path selected, bailing";
+		qCDebug(lcRender) << "No path selected, bailing";
 		return;
 	}
 
@@ -663,16 +1041,16 @@ void GraphRenderer::saveGraphToFile(
 		pathExt = "png";
 	}
 
-	qDebug() << "Using save path:" << path;
+	qCDebug(lcRender) << "Using save path:" << path;
 
 	bool res;
 	if (pathExt == "png")
 	{
-		res = customPlot->savePng(path, 1440, 625, 2.0);
+		res = saveRasterImage(customPlot, path, "PNG");
 	}
 	else if (pathExt == "jpg")
 	{
-		res = customPlot->saveJpg(path, 1440, 625, 2.0);
+		res = saveRasterImage(customPlot, path, "JPG");
 	}
 	else if (pathExt == "pdf")
 	{
@@ -680,11 +1058,11 @@ void GraphRenderer::saveGraphToFile(
 	}
 	else
 	{
-		qDebug() << "error, shouldn't be reached";
+		qCDebug(lcRender) << "error, shouldn't be reached";
 		res = false;
 	}
 
-	qDebug() << "save file res =" << res;
+	qCDebug(lcRender) << "save file res =" << res;
 
 	if (res)
 	{
@@ -4,9 +4,17 @@
 #include <QWidget>
 #include <QList>
 #include <QString>
+#include <QVector>
+#include "MemoryStats.h"
+#include "Snapshot.h"
 
 class QCustomPlot;
+class QCPGraph;
+class QCPTextElement;
+class QCPItemText;
 class GraphPreview;
+class RenderBenchmark;
+class Job;
 
 namespace Powder
 {
@@ -35,50 +43,184 @@ namespace Powder
 		int vdLocation;
 		bool showTrend;
 		int trendLineType;
+		bool showDensity;
+	};
+
+	/* Per-string values the annotations are generated from */
+	struct SeriesStats
+	{
+		double x;
+		double velocityMin;
+		double velocityMax;
+		double mean;
+		double stdev;
+		int totalShots;
+	};
+
+	/* One series as it was when the test published a snapshot. The velocities are shared with the
+	   live series until one side changes them. */
+	struct SeriesSnapshot
+	{
+		int seriesNum;
+		QString name;
+		QList<double> muzzleVelocities;
+		double chargeWeight;
+		bool enabled;
+	};
+
+	/* The powder test's series at one point in time, published through a SnapshotPublisher */
+	struct PowderSnapshot
+	{
+		PowderSnapshot() : generation(0) {}
+
+		static PowderSnapshot *create(const QList<ChronoSeries*> &seriesData);
+
+		quint64 generation;
+		QVector<SeriesSnapshot> series;
+	};
+
+	/* Everything a graph is built from that can be worked out away from the GUI thread */
+	struct GraphData
+	{
+		QList<SeriesStats> stats;
+		QVector<double> tickPositions;
+		QVector<QString> tickLabels;
+		QVector<double> xPoints;
+		QVector<double> yPoints;
+		QVector<double> xAvgPoints;
+		QVector<double> yAvgPoints;
+		QVector<double> yError;
+		QVector<QVector<double> > xDensityPoints;
+		QVector<QVector<double> > yDensityPoints;
+		QVector<double> xTrendPoints;
+		QVector<double> yTrendPoints;
+	};
+
+	/* A graph that is kept around between previews. Everything that depends only on
+	   the series data is built once, options are applied to the existing items. */
+	struct LiveGraph
+	{
+		QCustomPlot *customPlot;
+		QCPGraph *scatterPlot;
+		QCPGraph *trendLine;
+		QCPTextElement *title;
+		QCPTextElement *subtitle;
+		QList<QCPItemText *> aboveAnnotations;
+		QList<QCPItemText *> belowAnnotations;
+		QList<SeriesStats> stats;
+		QVector<double> dataKey;
+		MemoryAccount<MemoryStats::PLOT_SCENES> sceneMemory;
 	};
 
 	class GraphRenderer
 	{
+		// Drives buildGraph() with generated series
+		friend class ::RenderBenchmark;
+
 	public:
+		/* Builds the graph from the latest snapshot. The statistics are worked out on a worker, if the
+		   series are edited in the meantime that result is dropped and the graph is built again. */
 		static void renderGraph(
 			QWidget *parent,
-			const QList<ChronoSeries*> &seriesData,
+			const SnapshotPublisher<PowderSnapshot> &publishedSeries,
 			bool displayGraphPreview,
 			const GraphOptions &options,
 			const QString &prevSaveDir,
 			QString *outSaveDir,
+			LiveGraph **outLiveGraph,
 			GraphPreview **outGraphPreview
 		);
 
+		static void updateGraphPreview(
+			const GraphOptions &options,
+			LiveGraph *liveGraph,
+			GraphPreview *graphPreview
+		);
+
+		static void deleteGraph(LiveGraph *liveGraph);
+
+		// The checks prepareGraph() makes, without asking the user anything, for redrawing a preview when new data arrives
+		static bool isGraphable(const PowderSnapshot &snapshot, int xAxisSpacingIndex);
+
 	private:
 		static bool validateSeries(
 			QWidget *parent,
-			const QList<ChronoSeries*> &seriesData,
+			const PowderSnapshot &snapshot,
 			int *outNumEnabled
 		);
 
-		static QList<ChronoSeries*> getEnabledSeries(
-			const QList<ChronoSeries*> &seriesData
+		static QVector<SeriesSnapshot> getEnabledSeries(
+			const PowderSnapshot &snapshot
 		);
 
 		static bool checkDuplicateChargeWeights(
 			QWidget *parent,
-			const QList<ChronoSeries*> &seriesToGraph,
+			const QVector<SeriesSnapshot> &seriesToGraph,
 			int xAxisSpacingIndex,
 			int *outXAxisSpacing
 		);
 
-		static void configureGraph(
-			QCustomPlot *customPlot,
+		static QVector<double> getDataKey(
+			const PowderSnapshot &snapshot,
+			const GraphOptions &options
+		);
+
+		// Validates and sorts the series, asking the user about anything that needs it
+		static bool prepareGraph(
+			QWidget *parent,
+			const PowderSnapshot &snapshot,
+			const GraphOptions &options,
+			QVector<SeriesSnapshot> *outSeriesToGraph,
+			int *outXAxisSpacing
+		);
+
+		// Doesn't touch any widgets, safe to call on a worker
+		static void computeGraphData(
+			const QVector<SeriesSnapshot> &seriesToGraph,
+			const GraphOptions &options,
+			int xAxisSpacing,
+			GraphData *outData
+		);
+
+		static void computeGraphJob(Job *job, void *context);
+
+		static LiveGraph *buildGraph(
+			const GraphData &data,
+			const GraphOptions &options,
+			int xAxisSpacing
+		);
+
+		// Everything at once on the calling thread
+		static LiveGraph *buildGraph(
+			QWidget *parent,
+			const PowderSnapshot &snapshot,
+			const GraphOptions &options
+		);
+
+		static void applyOptions(
+			LiveGraph *liveGraph,
 			const GraphOptions &options
 		);
 
 		static void addAnnotations(
-			QCustomPlot *customPlot,
-			const QList<ChronoSeries*> &seriesToGraph,
+			LiveGraph *liveGraph,
+			const GraphOptions &options,
+			int xAxisSpacing
+		);
+
+		static void layoutAnnotations(
+			LiveGraph *liveGraph,
 			const GraphOptions &options
 		);
 
+		static void binVelocities(
+			const QList<double> &velocities,
+			double binMin,
+			double binSize,
+			QVector<double> *outVelocities,
+			QVector<int> *outCounts
+		);
+
 		static void saveGraphToFile(
 			QWidget *parent,
 			QCustomPlot *customPlot,
@@ -0,0 +1,186 @@
+#include "LabelLayout.h"
+#include "TextCache.h"
+#include "Trace.h"
+#include "Logging.h"
+
+#include "qcustomplot/qcustomplot.h"
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+
+// Cells are a bit larger than a typical annotation, so most labels only touch one to four cells
+#define LABEL_GRID_CELL_SIZE 64
+
+// How many label heights a label may be pushed away from its string before it's abbreviated or dropped
+#define LABEL_MAX_STAGGER 3
+
+/* Uniform grid of placed label rectangles. Collision checks only look at labels in nearby cells. */
+class LabelGrid
+{
+public:
+	bool intersects(const QRectF &rect) const
+	{
+		for (int cx = cellIndex(rect.left()); cx <= cellIndex(rect.right()); cx++)
+		{
+			for (int cy = cellIndex(rect.top()); cy <= cellIndex(rect.bottom()); cy++)
+			{
+				QHash<qint64, QVector<QRectF> >::const_iterator cell = cells.constFind(cellKey(cx, cy));
+				if (cell == cells.constEnd())
+				{
+					continue;
+				}
+
+				for (int i = 0; i < cell.value().size(); i++)
+				{
+					if (cell.value().at(i).intersects(rect))
+					{
+						return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void insert(const QRectF &rect)
+	{
+		for (int cx = cellIndex(rect.left()); cx <= cellIndex(rect.right()); cx++)
+		{
+			for (int cy = cellIndex(rect.top()); cy <= cellIndex(rect.bottom()); cy++)
+			{
+				cells[cellKey(cx, cy)].append(rect);
+			}
+		}
+	}
+
+private:
+	static int cellIndex(double coord)
+	{
+		return qFloor(coord / LABEL_GRID_CELL_SIZE);
+	}
+
+	static qint64 cellKey(int cx, int cy)
+	{
+		return (static_cast<qint64>(cx) << 32) | static_cast<quint32>(cy);
+	}
+
+	QHash<qint64, QVector<QRectF> > cells;
+};
+
+void LabelLayout::layoutLabels(
+	QList<PlotLabel> &labels,
+	const QRectF &bounds)
+{
+	TRACE_SPAN("render", "label layout");
+
+	/* Reset every label to its preferred spot so pixel positions can be read back */
+	QVector<QPair<double, int> > order;
+	for (int i = 0; i < labels.size(); i++)
+	{
+		const PlotLabel &label = labels.at(i);
+		label.item->position->setCoords(label.baseCoords);
+		order.append(qMakePair(label.item->position->pixelPosition().x(), i));
+	}
+
+	/* Place labels left to right, each one only has to avoid labels already placed */
+	std::sort(order.begin(), order.end());
+
+	LabelGrid grid;
+	int numStaggered = 0;
+	int numAbbreviated = 0;
+	int numDropped = 0;
+
+	for (int i = 0; i < order.size(); i++)
+	{
+		const PlotLabel &label = labels.at(order.at(i).second);
+
+		if (label.lines.isEmpty())
+		{
+			label.item->setText(QString());
+			label.item->setVisible(false);
+			continue;
+		}
+
+		if (placeLabel(label, label.lines, bounds, &grid))
+		{
+			if (label.item->position->coords() != label.baseCoords)
+			{
+				numStaggered++;
+			}
+			continue;
+		}
+
+		// Out of room, keep only the first line
+		if ((label.lines.size() > 1) && placeLabel(label, label.lines.mid(0, 1), bounds, &grid))
+		{
+			numAbbreviated++;
+			continue;
+		}
+
+		label.item->position->setCoords(label.baseCoords);
+		label.item->setVisible(false);
+		numDropped++;
+	}
+
+	qCDebug(lcRender) << "Placed" << labels.size() << "labels:" << numStaggered << "staggered," << numAbbreviated << "abbreviated," << numDropped << "dropped";
+}
+
+bool LabelLayout::placeLabel(
+	const PlotLabel &label,
+	const QStringList &lines,
+	const QRectF &bounds,
+	LabelGrid *grid)
+{
+	QString text = lines.join('\n');
+
+	// Same measurement CachedTextItem uses when drawing
+	QRect textRect = TextCache::textRect(label.item->font(), Qt::TextDontClip | label.item->textAlignment(), text);
+	QMargins padding = label.item->padding();
+	double width = textRect.width() + padding.left() + padding.right();
+	double height = textRect.height() + padding.top() + padding.bottom();
+
+	QPointF anchor = label.item->position->pixelPosition();
+
+	for (int stagger = 0; stagger <= LABEL_MAX_STAGGER; stagger++)
+	{
+		// Push the label further away from its string, up for labels above and down for labels below
+		double offset = stagger * (height + 2);
+		if (label.above)
+		{
+			offset = -offset;
+		}
+
+		QRectF rect;
+		if (label.above)
+		{
+			rect = QRectF(anchor.x() - (width / 2), anchor.y() + offset - height, width, height);
+		}
+		else
+		{
+			rect = QRectF(anchor.x() - (width / 2), anchor.y() + offset, width, height);
+		}
+
+		// Labels at their preferred spot are allowed to hang off the graph like they always have
+		if ((stagger > 0) && (!bounds.contains(rect)))
+		{
+			break;
+		}
+
+		if (grid->intersects(rect))
+		{
+			continue;
+		}
+
+		grid->insert(rect);
+		label.item->setText(text);
+		label.item->position->setCoords(label.baseCoords.x(), label.baseCoords.y() + offset);
+		label.item->setVisible(true);
+		return true;
+	}
+
+	return false;
+}
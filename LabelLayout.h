@@ -0,0 +1,38 @@
+#ifndef LABEL_LAYOUT_H
+#define LABEL_LAYOUT_H
+
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QStringList>
+
+class QCPItemText;
+class LabelGrid;
+
+/* A graph annotation waiting to be placed. baseCoords are the item's position coordinates when nothing is in the way. */
+struct PlotLabel
+{
+	QCPItemText *item;
+	QPointF baseCoords;
+	QStringList lines;
+	bool above;
+};
+
+class LabelLayout
+{
+public:
+	static void layoutLabels(
+		QList<PlotLabel> &labels,
+		const QRectF &bounds
+	);
+
+private:
+	static bool placeLabel(
+		const PlotLabel &label,
+		const QStringList &lines,
+		const QRectF &bounds,
+		LabelGrid *grid
+	);
+};
+
+#endif // LABEL_LAYOUT_H
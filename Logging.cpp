@@ -0,0 +1,9 @@
+#include "Logging.h"
+
+Q_LOGGING_CATEGORY(lcImport, "chronoplotter.import")
+Q_LOGGING_CATEGORY(lcImportTrace, "chronoplotter.import.trace", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcStats, "chronoplotter.stats")
+Q_LOGGING_CATEGORY(lcStatsTrace, "chronoplotter.stats.trace", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcRender, "chronoplotter.render")
+Q_LOGGING_CATEGORY(lcRenderTrace, "chronoplotter.render.trace", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUi, "chronoplotter.ui")
@@ -0,0 +1,30 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+
+/*
+ * Log categories. Verbosity is switched at runtime with Qt's logging rules, given either in the
+ * QT_LOGGING_RULES environment variable or on the command line:
+ *
+ *     ChronoPlotter --log-rules "chronoplotter.render.debug=false;chronoplotter.import.trace.debug=true"
+ *
+ * The .trace categories carry the per-row and per-shot messages from the parser, statistics and render
+ * loops. They're off by default, and builds with CHRONOPLOTTER_NO_TRACE_LOGGING defined (release
+ * builds) compile them out, so their arguments aren't even formatted.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcImport)
+Q_DECLARE_LOGGING_CATEGORY(lcImportTrace)
+Q_DECLARE_LOGGING_CATEGORY(lcStats)
+Q_DECLARE_LOGGING_CATEGORY(lcStatsTrace)
+Q_DECLARE_LOGGING_CATEGORY(lcRender)
+Q_DECLARE_LOGGING_CATEGORY(lcRenderTrace)
+Q_DECLARE_LOGGING_CATEGORY(lcUi)
+
+#ifdef CHRONOPLOTTER_NO_TRACE_LOGGING
+#define LOG_TRACE(category) while (false) QMessageLogger().noDebug()
+#else
+#define LOG_TRACE(category) qCDebug(category)
+#endif
+
+#endif // LOGGING_H
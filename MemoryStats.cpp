@@ -0,0 +1,193 @@
+#include "MemoryStats.h"
+#include "Logging.h"
+
+#include "qcustomplot/qcustomplot.h"
+#include <QApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPixmap>
+#include <QWidget>
+#include <QDebug>
+
+// Typical cost of a QWidget with its private data, layout item and style state
+#define WIDGET_BYTES 1024
+
+// Typical cost of a plot item with its positions, pens, brushes and font
+#define PLOT_ITEM_BYTES 1024
+
+namespace
+{
+	struct ProbeEntry
+	{
+		MemoryStats::Category category;
+		MemoryStats::Probe probe;
+		const void *context;
+	};
+
+	QMutex probesMutex;
+	QList<ProbeEntry> probes;
+
+	QString kilobytes(qint64 bytes)
+	{
+		return QString::number((bytes + 1023) / 1024);
+	}
+}
+
+QAtomicInteger<qint64> MemoryStats::counterBytes[CATEGORY_COUNT];
+QAtomicInteger<qint64> MemoryStats::probedBytes[CATEGORY_COUNT];
+QAtomicInteger<qint64> MemoryStats::peakBytes[CATEGORY_COUNT];
+
+void MemoryStats::add(Category category, qint64 bytes)
+{
+	qint64 total = counterBytes[category].fetchAndAddRelaxed(bytes) + bytes;
+	if (bytes > 0)
+	{
+		updatePeak(category, total + probedBytes[category].loadRelaxed());
+	}
+}
+
+void MemoryStats::addProbe(Category category, Probe probe, const void *context)
+{
+	ProbeEntry entry;
+	entry.category = category;
+	entry.probe = probe;
+	entry.context = context;
+
+	QMutexLocker locker(&probesMutex);
+	probes.append(entry);
+}
+
+void MemoryStats::removeProbes(const void *context)
+{
+	QMutexLocker locker(&probesMutex);
+	for (int i = probes.size() - 1; i >= 0; i--)
+	{
+		if (probes.at(i).context == context)
+		{
+			probes.removeAt(i);
+		}
+	}
+}
+
+qint64 MemoryStats::current(Category category)
+{
+	qint64 bytes = probeBytes(category);
+	probedBytes[category].storeRelaxed(bytes);
+
+	qint64 total = counterBytes[category].loadRelaxed() + bytes;
+	updatePeak(category, total);
+	return total;
+}
+
+qint64 MemoryStats::peak(Category category)
+{
+	return peakBytes[category].loadRelaxed();
+}
+
+const char *MemoryStats::categoryName(Category category)
+{
+	switch (category)
+	{
+		case SHOT_DATA: return "Shot data";
+		case METRIC_CACHES: return "Metric caches";
+		case WIDGETS: return "Widgets";
+		case PLOT_SCENES: return "Plot scenes";
+		case DECOMPRESSION_BUFFERS: return "Decompression buffers";
+		default: return "Unknown";
+	}
+}
+
+QString MemoryStats::report()
+{
+	QString text = QString("%1 %2 %3\n").arg("Category", -22).arg("Current KB", 11).arg("Peak KB", 11);
+
+	qint64 currentTotal = 0;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		Category category = (Category)i;
+		qint64 bytes = current(category);
+		currentTotal += bytes;
+
+		text += QString("%1 %2 %3\n").arg(categoryName(category), -22).arg(kilobytes(bytes), 11).arg(kilobytes(peak(category)), 11);
+	}
+
+	text += QString("%1 %2\n").arg("Total", -22).arg(kilobytes(currentTotal), 11);
+
+	qCDebug(lcUi) << "Memory report, total" << currentTotal << "bytes";
+
+	return text;
+}
+
+qint64 MemoryStats::probeBytes(Category category)
+{
+	qint64 bytes = 0;
+
+	// Widgets aren't owned by anything that could keep a counter, count them instead
+	if ((category == WIDGETS) && (qobject_cast<QApplication *>(QCoreApplication::instance()) != NULL))
+	{
+		bytes += QApplication::allWidgets().size() * (qint64)WIDGET_BYTES;
+	}
+
+	QList<ProbeEntry> entries;
+	{
+		QMutexLocker locker(&probesMutex);
+		entries = probes;
+	}
+
+	foreach (const ProbeEntry &entry, entries)
+	{
+		if (entry.category == category)
+		{
+			bytes += entry.probe(entry.context);
+		}
+	}
+
+	return bytes;
+}
+
+void MemoryStats::updatePeak(Category category, qint64 bytes)
+{
+	qint64 previous = peakBytes[category].loadRelaxed();
+	while ((bytes > previous) && !peakBytes[category].testAndSetRelaxed(previous, bytes, previous))
+	{
+	}
+}
+
+qint64 MemoryStats::stringBytes(const QString &string)
+{
+	return string.capacity() * (qint64)sizeof(QChar);
+}
+
+qint64 MemoryStats::plotBytes(QCustomPlot *customPlot)
+{
+	qint64 bytes = customPlot->itemCount() * (qint64)PLOT_ITEM_BYTES;
+
+	for (int i = 0; i < customPlot->plottableCount(); i++)
+	{
+		QCPAbstractPlottable *plottable = customPlot->plottable(i);
+
+		if (QCPGraph *graph = qobject_cast<QCPGraph *>(plottable))
+		{
+			bytes += graph->data()->size() * (qint64)sizeof(QCPGraphData);
+		}
+		else if (QCPCurve *curve = qobject_cast<QCPCurve *>(plottable))
+		{
+			bytes += curve->data()->size() * (qint64)sizeof(QCPCurveData);
+		}
+		else if (QCPErrorBars *errorBars = qobject_cast<QCPErrorBars *>(plottable))
+		{
+			bytes += errorBars->dataCount() * (qint64)sizeof(QCPErrorBarsData);
+		}
+		else if (plottable->interface1D() != NULL)
+		{
+			bytes += plottable->interface1D()->dataCount() * (qint64)sizeof(QCPGraphData);
+		}
+	}
+
+	return bytes;
+}
+
+qint64 MemoryStats::pixmapBytes(const QPixmap &pixmap)
+{
+	return (qint64)pixmap.width() * pixmap.height() * (pixmap.depth() / 8);
+}
@@ -0,0 +1,128 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <QAtomicInteger>
+#include <QList>
+#include <QString>
+
+class QCustomPlot;
+class QPixmap;
+
+/*
+ * Rough accounting of what the session holds in memory, so a long range day that keeps growing can
+ * be spotted. Bytes are tracked by category in two ways:
+ *
+ *   - Owners of large buffers (series arenas, parse stores, decoded archives, inflate buffers, graphs)
+ *     hold a MemoryAccount and set it to their size whenever it changes. These counters are atomic and
+ *     can be updated from any thread.
+ *   - Probes are asked for their size only when a report is made, for data that changes in too many
+ *     places to keep a counter in step (e.g. the tabs' series lists).
+ *
+ * Sizes are estimates of the heap blocks behind Qt containers, not allocator totals. Widgets are
+ * counted and multiplied by a typical per-widget cost.
+ *
+ * report() calls the probes, so it must be called on the GUI thread.
+ */
+class MemoryStats
+{
+public:
+	enum Category
+	{
+		SHOT_DATA,
+		METRIC_CACHES,
+		WIDGETS,
+		PLOT_SCENES,
+		DECOMPRESSION_BUFFERS,
+		CATEGORY_COUNT
+	};
+
+	// Returns the current size in bytes of whatever the context points at
+	typedef qint64 (*Probe)(const void *context);
+
+	static void add(Category category, qint64 bytes);
+	static void addProbe(Category category, Probe probe, const void *context);
+	static void removeProbes(const void *context);
+
+	// Counters plus probes
+	static qint64 current(Category category);
+	static qint64 peak(Category category);
+	static const char *categoryName(Category category);
+
+	// Plain text table of every category, for the diagnostics dialog and the command line
+	static QString report();
+
+	// Estimates for common containers
+	static qint64 stringBytes(const QString &string);
+	static qint64 plotBytes(QCustomPlot *customPlot);
+	static qint64 pixmapBytes(const QPixmap &pixmap);
+
+	template <typename T>
+	static qint64 listBytes(const QList<T> &list)
+	{
+		// QList keeps small movable types in its pointer array and allocates a node for anything else
+		if (QTypeInfo<T>::isLarge || QTypeInfo<T>::isStatic)
+		{
+			return list.size() * (qint64)(sizeof(void *) + sizeof(T));
+		}
+		return list.size() * (qint64)sizeof(void *);
+	}
+
+private:
+	static qint64 probeBytes(Category category);
+	static void updatePeak(Category category, qint64 bytes);
+
+	static QAtomicInteger<qint64> counterBytes[CATEGORY_COUNT];
+	static QAtomicInteger<qint64> probedBytes[CATEGORY_COUNT];
+	static QAtomicInteger<qint64> peakBytes[CATEGORY_COUNT];
+};
+
+/*
+ * The bytes one owner currently accounts for. Copies account for their own bytes and the
+ * destructor gives everything back.
+ */
+template <MemoryStats::Category category>
+class MemoryAccount
+{
+public:
+	MemoryAccount() : bytes(0) {}
+
+	MemoryAccount(const MemoryAccount &other) : bytes(0)
+	{
+		set(other.bytes);
+	}
+
+	MemoryAccount &operator=(const MemoryAccount &other)
+	{
+		set(other.bytes);
+		return *this;
+	}
+
+	~MemoryAccount()
+	{
+		set(0);
+	}
+
+	void set(qint64 newBytes)
+	{
+		if (newBytes != bytes)
+		{
+			MemoryStats::add(category, newBytes - bytes);
+			bytes = newBytes;
+		}
+	}
+
+	void add(qint64 moreBytes)
+	{
+		set(bytes + moreBytes);
+	}
+
+	qint64 size() const
+	{
+		return bytes;
+	}
+
+private:
+	qint64 bytes;
+};
+
+#endif // MEMORY_STATS_H
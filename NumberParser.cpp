@@ -0,0 +1,149 @@
+#include "NumberParser.h"
+
+#include <charconv>
+#include <cmath>
+#include <string.h>
+
+// Longer fields aren't velocities or coordinates
+#define MAX_FIELD_LENGTH 64
+
+namespace
+{
+	void trim(const char **begin, const char **end)
+	{
+		while ((*begin < *end) && ((**begin == ' ') || (**begin == '\t') || (**begin == '\r') || (**begin == '"')))
+		{
+			(*begin)++;
+		}
+
+		while ((*end > *begin) && (((*end)[-1] == ' ') || ((*end)[-1] == '\t') || ((*end)[-1] == '\r') || ((*end)[-1] == '"')))
+		{
+			(*end)--;
+		}
+
+		// from_chars doesn't take a leading '+'
+		if ((*begin < *end) && (**begin == '+'))
+		{
+			(*begin)++;
+		}
+	}
+
+	// Copies a UTF-16 field into buf. Returns the length, or -1 if it's too long or not ASCII.
+	int toLatin1(const QChar *text, int length, char *buf)
+	{
+		if (length > MAX_FIELD_LENGTH)
+		{
+			return -1;
+		}
+
+		for (int i = 0; i < length; i++)
+		{
+			ushort c = text[i].unicode();
+			if (c > 0x7f)
+			{
+				return -1;
+			}
+			buf[i] = (char)c;
+		}
+
+		return length;
+	}
+}
+
+NumberParser::NumberParser(DecimalSeparator separator)
+	: separator(separator)
+{
+}
+
+NumberParser::DecimalSeparator NumberParser::decimalSeparator() const
+{
+	return separator;
+}
+
+bool NumberParser::toDouble(const char *text, int length, double *value)
+{
+	const char *begin = text;
+	const char *end = text + length;
+	trim(&begin, &end);
+
+	if ((begin == end) || ((end - begin) > MAX_FIELD_LENGTH))
+	{
+		return false;
+	}
+
+	if (separator == DETECT_SEPARATOR)
+	{
+		if (memchr(begin, ',', end - begin) != NULL)
+		{
+			separator = DECIMAL_COMMA;
+		}
+		else if (memchr(begin, '.', end - begin) != NULL)
+		{
+			separator = DECIMAL_POINT;
+		}
+	}
+
+	char buf[MAX_FIELD_LENGTH];
+	if (separator == DECIMAL_COMMA)
+	{
+		// from_chars only knows '.', so parse a copy with the two swapped. A '.' then fails the parse.
+		int size = end - begin;
+		for (int i = 0; i < size; i++)
+		{
+			buf[i] = (begin[i] == ',') ? '.' : ((begin[i] == '.') ? ',' : begin[i]);
+		}
+		begin = buf;
+		end = buf + size;
+	}
+
+	double result;
+	std::from_chars_result parsed = std::from_chars(begin, end, result);
+	if ((parsed.ec != std::errc()) || (parsed.ptr != end) || !std::isfinite(result))
+	{
+		return false;
+	}
+
+	*value = result;
+	return true;
+}
+
+bool NumberParser::toDouble(const QChar *text, int length, double *value)
+{
+	char buf[MAX_FIELD_LENGTH];
+	int bufLength = toLatin1(text, length, buf);
+	return (bufLength >= 0) && toDouble(buf, bufLength, value);
+}
+
+bool NumberParser::toDouble(const QString &text, double *value)
+{
+	return toDouble(text.constData(), text.size(), value);
+}
+
+bool NumberParser::toInt(const char *text, int length, int *value) const
+{
+	const char *begin = text;
+	const char *end = text + length;
+	trim(&begin, &end);
+
+	int result;
+	std::from_chars_result parsed = std::from_chars(begin, end, result);
+	if ((begin == end) || (parsed.ec != std::errc()) || (parsed.ptr != end))
+	{
+		return false;
+	}
+
+	*value = result;
+	return true;
+}
+
+bool NumberParser::toInt(const QChar *text, int length, int *value) const
+{
+	char buf[MAX_FIELD_LENGTH];
+	int bufLength = toLatin1(text, length, buf);
+	return (bufLength >= 0) && toInt(buf, bufLength, value);
+}
+
+bool NumberParser::toInt(const QString &text, int *value) const
+{
+	return toInt(text.constData(), text.size(), value);
+}
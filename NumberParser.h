@@ -0,0 +1,41 @@
+#ifndef NUMBER_PARSER_H
+#define NUMBER_PARSER_H
+
+#include <QString>
+
+/*
+ * Parses numeric fields with std::from_chars, straight from the bytes of a cell. Values keep full
+ * double precision and no QString temporaries are made.
+ *
+ * One parser is used per file, since an export is written with a single decimal separator. With
+ * DETECT_SEPARATOR the first field containing a ',' or '.' decides which one the file uses. Only use
+ * it for files whose delimiter isn't a comma, or whose numbers are quoted.
+ */
+class NumberParser
+{
+public:
+	enum DecimalSeparator
+	{
+		DETECT_SEPARATOR,
+		DECIMAL_POINT,
+		DECIMAL_COMMA
+	};
+
+	explicit NumberParser(DecimalSeparator separator = DECIMAL_POINT);
+
+	DecimalSeparator decimalSeparator() const;
+
+	// Each returns false unless the whole field (surrounding spaces aside) is a finite number
+	bool toDouble(const char *text, int length, double *value);
+	bool toDouble(const QChar *text, int length, double *value);
+	bool toDouble(const QString &text, double *value);
+
+	bool toInt(const char *text, int length, int *value) const;
+	bool toInt(const QChar *text, int length, int *value) const;
+	bool toInt(const QString &text, int *value) const;
+
+private:
+	DecimalSeparator separator;
+};
+
+#endif // NUMBER_PARSER_H
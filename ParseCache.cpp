@@ -0,0 +1,188 @@
+#include "ParseCache.h"
+#include "Logging.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+#define PARSE_CACHE_MAGIC 0x43505043 // 'CPPC'
+
+// A season of range days fits easily, entries are a few KB per series
+#define PARSE_CACHE_MAX_BYTES (64 * 1024 * 1024)
+#define PARSE_CACHE_MAX_AGE_DAYS 30
+
+ParseCache::ParseCache(const char *parser, bool enabled)
+	: hash(QCryptographicHash::Sha1)
+{
+	usable = enabled;
+
+	hash.addData(QByteArray(parser));
+	hash.addData(QByteArray::number((int)PARSER_VERSION));
+}
+
+bool ParseCache::addFile(const QString &path)
+{
+	if (!usable)
+	{
+		return false;
+	}
+
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qCDebug(lcImport) << "ParseCache: can't read" << path << ", not caching";
+		usable = false;
+		return false;
+	}
+
+	// Separate files so moving bytes from one to the next changes the key
+	hash.addData(QByteArray::number(file.size()));
+	hash.addData(&file);
+
+	return true;
+}
+
+void ParseCache::addText(const QString &text)
+{
+	if (!usable)
+	{
+		return;
+	}
+
+	// Length first, so text can't run into whatever is added after it
+	hash.addData(QByteArray::number(text.size()));
+	hash.addData(text.toUtf8());
+}
+
+QString ParseCache::cacheDir()
+{
+	return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("parsed");
+}
+
+QString ParseCache::entryPath()
+{
+	return QDir(cacheDir()).filePath(QString::fromLatin1(hash.result().toHex()) + ".bin");
+}
+
+bool ParseCache::load(SeriesStore *store)
+{
+	if (!usable)
+	{
+		return false;
+	}
+
+	QFile file(entryPath());
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qCDebug(lcImport) << "ParseCache: miss" << file.fileName();
+		return false;
+	}
+
+	qint64 size = file.size();
+	uchar *data = file.map(0, size);
+	if (data == NULL)
+	{
+		qCDebug(lcImport) << "ParseCache: failed to map" << file.fileName();
+		return false;
+	}
+
+	QByteArray bytes = QByteArray::fromRawData((const char *)data, size);
+	QDataStream in(bytes);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic, version;
+	in >> magic >> version;
+
+	bool ok = (magic == PARSE_CACHE_MAGIC) && (version == PARSER_VERSION) && store->read(in);
+
+	file.unmap(data);
+
+	if (!ok)
+	{
+		qCDebug(lcImport) << "ParseCache: discarding unreadable entry" << file.fileName();
+		store->clear();
+		file.remove();
+		return false;
+	}
+
+	qCDebug(lcImport) << "ParseCache: hit" << file.fileName() << "with" << store->size() << "series";
+
+	// The modification time is when the entry was last used, prune() goes by it
+	file.close();
+	if (file.open(QIODevice::Append))
+	{
+		file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+	}
+
+	return true;
+}
+
+void ParseCache::save(const SeriesStore &store)
+{
+	if (!usable || store.isEmpty())
+	{
+		return;
+	}
+
+	if (!QDir().mkpath(cacheDir()))
+	{
+		qCDebug(lcImport) << "ParseCache: can't create" << cacheDir();
+		return;
+	}
+
+	// QSaveFile only replaces the entry once it's completely written
+	QSaveFile file(entryPath());
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qCDebug(lcImport) << "ParseCache: can't write" << file.fileName();
+		return;
+	}
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << (quint32)PARSE_CACHE_MAGIC << (quint32)PARSER_VERSION;
+	store.write(out);
+
+	if (!file.commit())
+	{
+		qCDebug(lcImport) << "ParseCache: failed to commit" << file.fileName();
+	}
+
+	prune();
+}
+
+void ParseCache::prune()
+{
+	QDir dir(cacheDir());
+	QFileInfoList entries = dir.entryInfoList(QStringList() << "*.bin", QDir::Files, QDir::Time);
+
+	// Newest first, so whatever is left once the limit is reached is the least recently used
+	QDateTime oldest = QDateTime::currentDateTime().addDays(-PARSE_CACHE_MAX_AGE_DAYS);
+	qint64 bytes = 0;
+	int removed = 0;
+
+	foreach (const QFileInfo &entry, entries)
+	{
+		bytes += entry.size();
+		if ((bytes > PARSE_CACHE_MAX_BYTES) || (entry.lastModified() < oldest))
+		{
+			bytes -= entry.size();
+			removed += QFile::remove(entry.filePath()) ? 1 : 0;
+		}
+	}
+
+	if (removed > 0)
+	{
+		qCDebug(lcImport) << "ParseCache: pruned" << removed << "entries," << bytes << "bytes left";
+	}
+}
+
+void ParseCache::clear()
+{
+	QDir(cacheDir()).removeRecursively();
+}
@@ -0,0 +1,55 @@
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include <QCryptographicHash>
+#include <QString>
+#include "SeriesStore.h"
+
+/*
+ * On-disk cache of parsed series, kept in the user's cache directory. An entry is keyed by the
+ * parser name, PARSER_VERSION and a hash of every input file's contents, so an edited file or a
+ * changed parser never hits a stale entry. Entries are stored in SeriesStore's binary form and
+ * read back through a single mapping of the cache file.
+ *
+ * A hit marks the entry as used. Every save drops entries that haven't been used for a month, then
+ * the least recently used ones until the cache is back under its size limit.
+ *
+ * Usage:
+ *     ParseCache cache("magnetospeed");
+ *     cache.addFile(path);
+ *     if (!cache.load(&store))
+ *     {
+ *         // parse path into store
+ *         cache.save(store);
+ *     }
+ */
+class ParseCache
+{
+public:
+	// Bump whenever a parser changes what it puts in the store
+	enum { PARSER_VERSION = 3 };
+
+	// A disabled cache never hits and saves nothing, for files that are still being written
+	ParseCache(const char *parser, bool enabled = true);
+
+	// Adds a file's contents to the key. Returns false if the file can't be read, which disables the cache.
+	bool addFile(const QString &path);
+
+	// Adds anything else the parser puts in the store to the key, e.g. the name it gives a series
+	void addText(const QString &text);
+
+	bool load(SeriesStore *store);
+	void save(const SeriesStore &store);
+
+	static void clear();
+
+private:
+	QString entryPath();
+	static QString cacheDir();
+	static void prune();
+
+	QCryptographicHash hash;
+	bool usable;
+};
+
+#endif // PARSE_CACHE_H
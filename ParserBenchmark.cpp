@@ -0,0 +1,512 @@
+#include "ParserBenchmark.h"
+#include "ChronographParsers.h"
+#include "ShotMarkerArchive.h"
+#include "ShotMarkerCsv.h"
+#include "SeriesStore.h"
+#include "MemoryStats.h"
+#include "miniz.h"
+
+#include "xlsxdocument.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Powder;
+
+// Keep repeating a parse until this much time has passed, so small inputs get a stable average
+#define MIN_BENCHMARK_NSECS Q_INT64_C(250000000)
+
+// Series (or strings) in the generated files have this many shots, like a typical range session
+#define SHOTS_PER_SERIES 10
+
+// QXlsx takes minutes to write a workbook larger than this
+#define MAX_XLSX_SHOTS 100000
+
+namespace
+{
+	/* Small LCG so every run generates the same files */
+	class Generator
+	{
+	public:
+		Generator() : state(12345) {}
+
+		quint32 next()
+		{
+			state = (state * 1103515245u) + 12345u;
+			return state >> 8;
+		}
+
+		// 2800.0 - 2899.9 ft/s
+		double velocity()
+		{
+			return 2800 + ((next() % 1000) / 10.0);
+		}
+
+		// -2.000 - 2.000 inches
+		double coordinate()
+		{
+			return ((int)(next() % 4001) - 2000) / 1000.0;
+		}
+
+	private:
+		quint32 state;
+	};
+
+	QByteArray labRadarReport(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+		text += "sep=;\n";
+		text += "Device ID;LBR-0123456;;\n";
+		text += "Series No;0001;;\n";
+		text += "Total number of shots;" + QByteArray::number(shots) + ";;\n";
+		text += "Units velocity;fps;;\n";
+		text += "Shot ID;V0;V1;V2;V3;V4;V5;Ke0;Ke1;Ke2;Ke3;Ke4;Ke5;PF0;TOF;Date;Time;\n";
+
+		for (int i = 0; i < shots; i++)
+		{
+			text += QByteArray::number(i + 1).rightJustified(4, '0') + ";" + QByteArray::number(gen.velocity(), 'f', 2);
+			text += ";2790.12;2780.55;2770.01;2760.42;2750.98;3250;3220;3190;3160;3130;3100;411;0.0351;";
+			text += "06-05-2021;13:" + QByteArray::number(10 + (i / 60) % 50) + ":" + QByteArray::number(10 + (i % 50)) + ";\n";
+		}
+
+		// LabRadar writes UTF-16LE with a byte order mark
+		QByteArray utf16("\xff\xfe", 2);
+		utf16.reserve(2 + (text.size() * 2));
+		for (int i = 0; i < text.size(); i++)
+		{
+			utf16 += text.at(i);
+			utf16 += '\0';
+		}
+
+		return utf16;
+	}
+
+	QByteArray magnetoSpeedV3(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+
+		for (int shot = 0, series = 1; shot < shots; series++)
+		{
+			text += "Series," + QByteArray::number(series) + ",Shots:," + QByteArray::number(SHOTS_PER_SERIES) + "\n";
+			text += "Min,2800,Max,2899\n";
+			text += "\n";
+			for (int i = 1; (i <= SHOTS_PER_SERIES) && (shot < shots); i++, shot++)
+			{
+				text += QByteArray::number(i) + ",," + QByteArray::number((int)gen.velocity()) + ",ft/s\n";
+			}
+			text += "----\n";
+		}
+
+		return text;
+	}
+
+	QByteArray magnetoSpeedXfr(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+
+		for (int shot = 0, series = 1; shot < shots; series++)
+		{
+			text += "Synced on:,2021-06-05 13:38:24\n";
+			text += "Series,Jun 5 2021,Shots:," + QByteArray::number(SHOTS_PER_SERIES) + "\n";
+			text += "Notes,Load " + QByteArray::number(series) + "\n";
+			for (int i = 1; (i <= SHOTS_PER_SERIES) && (shot < shots); i++, shot++)
+			{
+				text += QByteArray::number(i) + "," + QByteArray::number(gen.velocity(), 'f', 1) + ",ft/s\n";
+			}
+			text += "----\n";
+		}
+
+		return text;
+	}
+
+	QByteArray proChrono(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+		text += "Shot List,Index,Velocity,Ke,Pf,Mass,Notes,Unit,Date/Time\n";
+
+		for (int shot = 0, series = 1; shot < shots; series++)
+		{
+			for (int i = 1; (i <= SHOTS_PER_SERIES) && (shot < shots); i++, shot++)
+			{
+				text += "Load " + QByteArray::number(series) + "," + QByteArray::number(i) + "," + QByteArray::number((int)gen.velocity());
+				text += ",3100,411,175,,ft/s,6/5/2021 13:38:24\n";
+			}
+		}
+
+		return text;
+	}
+
+	QByteArray proChronoFormat2(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+		text += "Shot 1,Shot 2,Shot 3,Shot 4,Shot 5,Shot 6,Shot 7,Shot 8,Shot 9,Shot 10\n";
+
+		for (int shot = 0; shot < shots; )
+		{
+			for (int i = 0; (i < SHOTS_PER_SERIES) && (shot < shots); i++, shot++)
+			{
+				if (i > 0)
+				{
+					text += ",";
+				}
+				text += QByteArray::number((int)gen.velocity());
+			}
+			text += "\n6/5/2021 13:38:24\n";
+		}
+
+		return text;
+	}
+
+	QByteArray garminCsv(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+		text += "Load 1\n";
+		text += "#,SPEED (FPS),DELTA AVG (FPS),KE (FT-LB),POWER FACTOR (kgr-ft/s),TIME,CLEAN BORE,COLD BORE,SHOT NOTES\n";
+
+		// Decimal commas are quoted, like in international exports
+		for (int i = 0; i < shots; i++)
+		{
+			QByteArray velocity = QByteArray::number(gen.velocity(), 'f', 1).replace('.', ',');
+			text += QByteArray::number(i + 1) + ",\"" + velocity + "\",0,3100,411,13:38:24,,,\n";
+		}
+
+		text += "DATE,\"June 5, 2021 at 1:38 PM\"\n";
+
+		return text;
+	}
+
+	QByteArray garminXlsx(int shots)
+	{
+		Generator gen;
+		QXlsx::Document xlsx;
+
+		for (int shot = 0, sheet = 1; shot < shots; sheet++)
+		{
+			QString sheetName = QString("Load %1").arg(sheet);
+			xlsx.addSheet(sheetName);
+			xlsx.selectSheet(sheetName);
+			xlsx.write(1, 1, QString("Load %1").arg(sheet));
+			xlsx.write(2, 1, "#");
+			xlsx.write(2, 2, "SPEED (FPS)");
+
+			int row = 3;
+			for (int i = 1; (i <= SHOTS_PER_SERIES) && (shot < shots); i++, shot++, row++)
+			{
+				xlsx.write(row, 1, i);
+				xlsx.write(row, 2, gen.velocity());
+			}
+
+			xlsx.write(row, 1, "DATE");
+			xlsx.write(row, 2, "June 5, 2021 at 1:38 PM");
+		}
+
+		QByteArray data;
+		QBuffer buffer(&data);
+		buffer.open(QIODevice::WriteOnly);
+		xlsx.saveAs(&buffer);
+
+		return data;
+	}
+
+	QByteArray shotMarkerCsv(int shots)
+	{
+		Generator gen;
+		QByteArray text;
+		text += "ShotMarker Archived Data\n\n";
+
+		for (int shot = 0, string = 1; shot < shots; string++)
+		{
+			text += "Jun 5 2021,Load " + QByteArray::number(string) + ",F-Class,100y,Score: 50-5X\n";
+			text += ",time,id,tags,score,x (mm),y (mm),x (inch),y (inch),v,yaw,pitch,quality,,,,\n";
+			for (int i = 1; (i <= SHOTS_PER_SERIES) && (shot < shots); i++, shot++)
+			{
+				text += ",1:" + QByteArray::number(10 + (i % 50)) + ":24 pm," + QByteArray::number(i) + "," + ((i <= 2) ? "sighter" : "") + ",X,0,0,";
+				text += QByteArray::number(gen.coordinate(), 'f', 3) + "," + QByteArray::number(gen.coordinate(), 'f', 3) + ",2812,0,0,100,,,,\n";
+			}
+			text += ",,,,avg,,,,,2812,,,,,,,\n\n";
+		}
+
+		return text;
+	}
+
+	void appendTarEntry(QByteArray *tar, const QByteArray &name, const QByteArray &data)
+	{
+		char header[512];
+		memset(header, 0, sizeof(header));
+		strncpy(header, name.constData(), 99);
+		memcpy(header + 100, "0000644", 7);
+		memcpy(header + 108, "0000000", 7);
+		memcpy(header + 116, "0000000", 7);
+		snprintf(header + 124, 12, "%011o", (unsigned int)data.size());
+		memcpy(header + 136, "00000000000", 11);
+		header[156] = '0';
+		memcpy(header + 257, "ustar", 6);
+		memcpy(header + 263, "00", 2);
+
+		unsigned int checksum = 8 * ' ';
+		for (int i = 0; i < 512; i++)
+		{
+			if ((i < 148) || (i > 155))
+			{
+				checksum += (unsigned char)header[i];
+			}
+		}
+		snprintf(header + 148, 8, "%06o", checksum);
+		header[155] = ' ';
+
+		tar->append(header, sizeof(header));
+		tar->append(data);
+		tar->append(QByteArray((512 - (data.size() % 512)) % 512, '\0'));
+	}
+
+	QByteArray shotMarkerTar(int shots)
+	{
+		Generator gen;
+		QByteArray tar;
+
+		for (int shot = 0, string = 1; shot < shots; string++)
+		{
+			QByteArray json = "{\"name\":\"Load " + QByteArray::number(string) + "\",\"dist\":100,\"dist_unit\":\"y\",\"ts\":1622900304000,\"cal_x\":0,\"cal_y\":0,\"shots\":[";
+			for (int i = 1; (i <= SHOTS_PER_SERIES) && (shot < shots); i++, shot++)
+			{
+				if (i > 1)
+				{
+					json += ",";
+				}
+				json += "{\"x\":" + QByteArray::number(gen.coordinate() * 25.4, 'f', 2) + ",\"y\":" + QByteArray::number(gen.coordinate() * 25.4, 'f', 2);
+				json += ",\"v\":" + QByteArray::number(gen.velocity() / 3.2808399, 'f', 2) + ",\"sighter\":" + ((i <= 2) ? "true" : "false") + ",\"hidden\":false}";
+			}
+			json += "]}";
+
+			mz_ulong compressedLength = compressBound(json.size());
+			QByteArray compressed(compressedLength, Qt::Uninitialized);
+			compress((unsigned char *)compressed.data(), &compressedLength, (const unsigned char *)json.constData(), json.size());
+			compressed.truncate(compressedLength);
+
+			appendTarEntry(&tar, "string_" + QByteArray::number(string).rightJustified(6, '0') + ".z", compressed);
+		}
+
+		// End of archive
+		tar.append(QByteArray(1024, '\0'));
+
+		return tar;
+	}
+
+	int storeShotCount(const SeriesStore &store)
+	{
+		int count = 0;
+		for (int i = 0; i < store.size(); i++)
+		{
+			count += store.at(i).velocityCount + store.at(i).shotCount;
+		}
+		return count;
+	}
+
+	/* Parse functions. Each parses one file and returns the number of shots it found. */
+
+	int parseLabRadar(const QByteArray &data, const QString &)
+	{
+		SeriesStore store;
+		ChronographParsers::extractLabRadarSeries(data.constData(), data.size(), &store);
+		return storeShotCount(store);
+	}
+
+	int parseMagnetoSpeed(const QByteArray &data, const QString &)
+	{
+		SeriesStore store;
+		QTextStream csv(data);
+		ChronographParsers::extractMagnetoSpeedSeries(csv, &store);
+		return storeShotCount(store);
+	}
+
+	int parseProChrono(const QByteArray &data, const QString &)
+	{
+		SeriesStore store;
+		QTextStream csv(data);
+		ChronographParsers::extractProChronoSeries(csv, &store);
+		return storeShotCount(store);
+	}
+
+	int parseProChronoFormat2(const QByteArray &data, const QString &)
+	{
+		SeriesStore store;
+		QTextStream csv(data);
+		ChronographParsers::extractProChronoSeries_format2(csv, &store);
+		return storeShotCount(store);
+	}
+
+	int parseGarminCsv(const QByteArray &data, const QString &)
+	{
+		SeriesStore store;
+		QTextStream csv(data);
+		ChronographParsers::extractGarminSeries_csv(csv, &store);
+		return storeShotCount(store);
+	}
+
+	int parseGarminXlsx(const QByteArray &data, const QString &)
+	{
+		SeriesStore store;
+		QBuffer buffer;
+		buffer.setData(data);
+		buffer.open(QIODevice::ReadOnly);
+		QXlsx::Document xlsx(&buffer);
+		if (xlsx.load())
+		{
+			ChronographParsers::extractGarminSeries_xlsx(xlsx, &store);
+		}
+		return storeShotCount(store);
+	}
+
+	int parseShotMarkerCsv(const QByteArray &, const QString &path)
+	{
+		SeriesStore store;
+		ShotMarkerCsv csv;
+		if (csv.open(path))
+		{
+			QList<int> selected;
+			for (int i = 0; i < csv.stringCount(); i++)
+			{
+				selected.append(i);
+			}
+			csv.appendCoordinateSeries(selected, &store);
+		}
+		return storeShotCount(store);
+	}
+
+	int parseShotMarkerTar(const QByteArray &, const QString &path)
+	{
+		// Time the decode, not the archive cache
+		ShotMarkerArchive::clearCache();
+
+		SeriesStore store;
+		QSharedPointer<const ShotMarkerArchive> archive = ShotMarkerArchive::open(path);
+		if (archive)
+		{
+			archive->appendCoordinateSeries(&store);
+		}
+		return storeShotCount(store);
+	}
+
+	struct Format
+	{
+		const char *name;
+		const char *fileName;
+		QByteArray (*generate)(int shots);
+		int (*parse)(const QByteArray &data, const QString &path);
+		int maxShots;
+	};
+
+	const Format formats[] = {
+		{ "LabRadar", "SR0001 Report.csv", labRadarReport, parseLabRadar, 0 },
+		{ "MagnetoSpeed V3", "magnetospeed.csv", magnetoSpeedV3, parseMagnetoSpeed, 0 },
+		{ "MagnetoSpeed XFR", "xfr.csv", magnetoSpeedXfr, parseMagnetoSpeed, 0 },
+		{ "ProChrono", "prochrono.csv", proChrono, parseProChrono, 0 },
+		{ "ProChrono format 2", "prochrono2.csv", proChronoFormat2, parseProChronoFormat2, 0 },
+		{ "Garmin CSV", "garmin.csv", garminCsv, parseGarminCsv, 0 },
+		{ "Garmin XLSX", "garmin.xlsx", garminXlsx, parseGarminXlsx, MAX_XLSX_SHOTS },
+		{ "ShotMarker CSV", "shotmarker.csv", shotMarkerCsv, parseShotMarkerCsv, 0 },
+		{ "ShotMarker TAR", "shotmarker.tar", shotMarkerTar, parseShotMarkerTar, 0 },
+	};
+}
+
+int ParserBenchmark::run(const QStringList &arguments)
+{
+	int maxShots = 1000000;
+	int index = arguments.indexOf("--benchmark-parsers");
+	if ((index >= 0) && (index + 1 < arguments.size()))
+	{
+		bool ok;
+		int value = arguments.at(index + 1).toInt(&ok);
+		if (ok && (value > 0))
+		{
+			maxShots = value;
+		}
+	}
+
+	// Debug logging is disabled, so its arguments aren't even formatted during the timings
+	QLoggingCategory::setFilterRules("chronoplotter.*.debug=false");
+
+	QTemporaryDir tempDir;
+	if (!tempDir.isValid())
+	{
+		fprintf(stderr, "Can't create a temporary directory\n");
+		return 1;
+	}
+
+	printf("%-20s %9s %10s %6s %12s %14s %10s\n", "parser", "shots", "size (MB)", "runs", "ms/run", "shots/s", "MB/s");
+
+	const int sizes[] = { 10, 1000, 100000, 1000000 };
+	for (unsigned int f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+	{
+		const Format &format = formats[f];
+
+		for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+		{
+			int shots = sizes[s];
+			if (shots > maxShots)
+			{
+				break;
+			}
+
+			if ((format.maxShots > 0) && (shots > format.maxShots))
+			{
+				printf("%-20s %9d  skipped, generating it takes too long\n", format.name, shots);
+				continue;
+			}
+
+			QByteArray data = format.generate(shots);
+
+			// File based parsers read the file back from disk
+			QString path = QDir(tempDir.path()).filePath(format.fileName);
+			QFile file(path);
+			if (!file.open(QIODevice::WriteOnly) || (file.write(data) != data.size()))
+			{
+				fprintf(stderr, "Can't write %s\n", qPrintable(path));
+				return 1;
+			}
+			file.close();
+
+			QElapsedTimer timer;
+			timer.start();
+
+			int runs = 0;
+			int parsed = 0;
+			do
+			{
+				parsed = format.parse(data, path);
+				runs++;
+			}
+			while (timer.nsecsElapsed() < MIN_BENCHMARK_NSECS);
+
+			double seconds = timer.nsecsElapsed() / 1e9 / runs;
+			double megabytes = data.size() / (1024.0 * 1024.0);
+
+			printf("%-20s %9d %10.3f %6d %12.3f %14.0f %10.2f", format.name, shots, megabytes, runs, seconds * 1000, parsed / seconds, megabytes / seconds);
+			if (parsed != shots)
+			{
+				printf("  (parsed %d shots)", parsed);
+			}
+			printf("\n");
+			fflush(stdout);
+		}
+	}
+
+	// The peaks show what the largest file held while it was parsed
+	printf("\n%s", qPrintable(MemoryStats::report()));
+
+	return 0;
+}
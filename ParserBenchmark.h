@@ -0,0 +1,22 @@
+#ifndef PARSER_BENCHMARK_H
+#define PARSER_BENCHMARK_H
+
+#include <QStringList>
+
+/*
+ * Times every import parser on synthetic files. Run with:
+ *
+ *     ChronoPlotter --benchmark-parsers [maxShots]
+ *
+ * Each vendor format is generated deterministically at 10, 1k, 100k and 1M shots (up to maxShots)
+ * and parsed repeatedly. Throughput is printed in shots/s and MB/s so runs before and after a parser
+ * change can be compared.
+ */
+class ParserBenchmark
+{
+public:
+	// Returns the process exit code
+	static int run(const QStringList &arguments);
+};
+
+#endif // PARSER_BENCHMARK_H
@@ -7,11 +7,19 @@
 #include "ChronographParsers.h"
 #include "GraphRenderer.h"
 #include "FileSelectionHandlers.h"
+#include "FolderWatch.h"
 #include "SeriesDataManager.h"
+#include "SeriesTable.h"
+#include "MemoryStats.h"
+#include "Scheduler.h"
+#include "SessionFile.h"
+#include "TimestampParser.h"
+#include "Logging.h"
 
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QTimer>
 
 #include "xlsxdocument.h"
 #include "xlsxchartsheet.h"
@@ -22,18 +30,51 @@
 
 using namespace Powder;
 
+PowderTest::~PowderTest ( void )
+{
+	MemoryStats::removeProbes(this);
+}
+
+qint64 PowderTest::shotDataBytes ( const void *tab )
+{
+	const PowderTest *test = static_cast<const PowderTest *>(tab);
+
+	qint64 bytes = 0;
+	foreach ( const ChronoSeries *series, test->seriesData )
+	{
+		bytes += MemoryStats::listBytes(series->muzzleVelocities);
+		bytes += MemoryStats::stringBytes(series->name) + MemoryStats::stringBytes(series->velocityUnits) + MemoryStats::stringBytes(series->firstDate) + MemoryStats::stringBytes(series->firstTime);
+	}
+
+	return bytes;
+}
+
 PowderTest::PowderTest ( QWidget *parent )
 	: QWidget(parent)
 {
-	qDebug() << "Powder test";
+	qCDebug(lcUi) << "Powder test";
 
 	graphPreview = NULL;
+	liveGraph = NULL;
+	graphPreviewRefreshPending = false;
+	renderingGraph = false;
+	seriesWidget = NULL;
+	seriesTable = NULL;
+	seriesModel = NULL;
 	prevLabRadarDir = QDir::homePath();
 	prevMagnetoSpeedDir = QDir::homePath();
 	prevProChronoDir = QDir::homePath();
 	prevGarminDir = QDir::homePath();
 	prevShotMarkerDir = QDir::homePath();
 	prevSaveDir = QDir::homePath();
+	prevSessionDir = QDir::homePath();
+	importSource = FileSelectionHandlers::NO_SOURCE;
+
+	folderWatch = new FolderWatch(&seriesArena, this);
+	connect(folderWatch, SIGNAL(seriesArrived(const QList<ChronoSeries*> &, const QList<ChronoSeries*> &)), this, SLOT(watchedSeriesArrived(const QList<ChronoSeries*> &, const QList<ChronoSeries*> &)));
+
+	// The series list changes in too many places to keep a counter, it's measured for each report
+	MemoryStats::addProbe(MemoryStats::SHOT_DATA, shotDataBytes, this);
 
 	/* Left panel */
 
@@ -91,6 +132,13 @@ PowderTest::PowderTest ( QWidget *parent )
 	prepareGarminButton->setMinimumHeight(50);
 	prepareGarminButton->setMaximumHeight(50);
 
+	QPushButton *loadSessionButton = new QPushButton("Load saved session");
+	connect(loadSessionButton, SIGNAL(clicked(bool)), this, SLOT(loadSession(bool)));
+	loadSessionButton->setMinimumWidth(300);
+	loadSessionButton->setMaximumWidth(300);
+	loadSessionButton->setMinimumHeight(50);
+	loadSessionButton->setMaximumHeight(50);
+
 	QVBoxLayout *placeholderLayout = new QVBoxLayout();
 	placeholderLayout->addStretch(0);
 	placeholderLayout->addWidget(selectLabel);
@@ -109,6 +157,8 @@ PowderTest::PowderTest ( QWidget *parent )
 	placeholderLayout->setAlignment(manualEntryButton, Qt::AlignCenter);
 	placeholderLayout->addWidget(prepareGarminButton);
 	placeholderLayout->setAlignment(prepareGarminButton, Qt::AlignCenter);
+	placeholderLayout->addWidget(loadSessionButton);
+	placeholderLayout->setAlignment(loadSessionButton, Qt::AlignCenter);
 	placeholderLayout->addStretch(0);
 
 	QWidget *placeholderWidget = new QWidget();
@@ -138,6 +188,16 @@ PowderTest::PowderTest ( QWidget *parent )
 	brass = new QLineEdit();
 	primer = new QLineEdit();
 	weather = new QLineEdit();
+
+	// Details are applied to an open graph preview as they're typed
+	connect(graphTitle, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+	connect(rifle, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+	connect(projectile, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+	connect(propellant, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+	connect(brass, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+	connect(primer, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+	connect(weather, SIGNAL(textChanged(const QString&)), this, SLOT(graphOptionChanged()));
+
 	detailsFormLayout->addRow(new QLabel("Graph title:"), graphTitle);
 	detailsFormLayout->addRow(new QLabel("Rifle:"), rifle);
 	detailsFormLayout->addRow(new QLabel("Projectile:"), projectile);
@@ -163,6 +223,7 @@ PowderTest::PowderTest ( QWidget *parent )
 	weightUnits = new QComboBox();
 	weightUnits->addItem("grain (gr)");
 	weightUnits->addItem("gram (g)");
+	connect(weightUnits, SIGNAL(currentIndexChanged(int)), this, SLOT(graphOptionChanged()));
 	optionsFormLayout->addRow(new QLabel("Weight units:"), weightUnits);
 
 	velocityUnits = new QComboBox();
@@ -189,6 +250,7 @@ PowderTest::PowderTest ( QWidget *parent )
 	esLocation = new QComboBox();
 	esLocation->addItem("above shot strings");
 	esLocation->addItem("below shot strings");
+	connect(esLocation, SIGNAL(currentIndexChanged(int)), this, SLOT(graphOptionChanged()));
 	esLayout->addWidget(esLocation);
 	optionsLayout->addLayout(esLayout);
 
@@ -202,6 +264,7 @@ PowderTest::PowderTest ( QWidget *parent )
 	sdLocation = new QComboBox();
 	sdLocation->addItem("above shot strings");
 	sdLocation->addItem("below shot strings");
+	connect(sdLocation, SIGNAL(currentIndexChanged(int)), this, SLOT(graphOptionChanged()));
 	sdLayout->addWidget(sdLocation);
 	optionsLayout->addLayout(sdLayout);
 
@@ -215,6 +278,7 @@ PowderTest::PowderTest ( QWidget *parent )
 	avgLocation = new QComboBox();
 	avgLocation->addItem("above shot strings");
 	avgLocation->addItem("below shot strings");
+	connect(avgLocation, SIGNAL(currentIndexChanged(int)), this, SLOT(graphOptionChanged()));
 	avgLocation->setEnabled(false);
 	avgLayout->addWidget(avgLocation);
 	optionsLayout->addLayout(avgLayout);
@@ -229,6 +293,7 @@ PowderTest::PowderTest ( QWidget *parent )
 	vdLocation = new QComboBox();
 	vdLocation->addItem("above shot strings");
 	vdLocation->addItem("below shot strings");
+	connect(vdLocation, SIGNAL(currentIndexChanged(int)), this, SLOT(graphOptionChanged()));
 	vdLocation->setCurrentIndex(1);
 	vdLayout->addWidget(vdLocation);
 	optionsLayout->addLayout(vdLayout);
@@ -244,10 +309,19 @@ PowderTest::PowderTest ( QWidget *parent )
 	trendLineType->addItem("solid line");
 	trendLineType->addItem("dashed line");
 	trendLineType->setCurrentIndex(1);
+	connect(trendLineType, SIGNAL(currentIndexChanged(int)), this, SLOT(graphOptionChanged()));
 	trendLineType->setEnabled(false);
 	trendLayout->addWidget(trendLineType);
 	optionsLayout->addLayout(trendLayout);
 
+	QHBoxLayout *densityLayout = new QHBoxLayout();
+	densityCheckBox = new QCheckBox();
+	densityCheckBox->setChecked(false);
+	connect(densityCheckBox, SIGNAL(clicked(bool)), this, SLOT(graphOptionChanged()));
+	densityLayout->addWidget(densityCheckBox, 0);
+	densityLayout->addWidget(new QLabel("Shade scatter plot by shot density"), 1);
+	optionsLayout->addLayout(densityLayout);
+
 	// Don't resize row heights if window height changes
 	optionsLayout->addStretch(0);
 
@@ -264,6 +338,10 @@ PowderTest::PowderTest ( QWidget *parent )
 	connect(saveGraphButton, SIGNAL(clicked(bool)), this, SLOT(saveGraph(bool)));
 	graphButtonsLayout->addWidget(saveGraphButton);
 
+	QPushButton *saveSessionButton = new QPushButton("Save session");
+	connect(saveSessionButton, SIGNAL(clicked(bool)), this, SLOT(saveSession(bool)));
+	graphButtonsLayout->addWidget(saveSessionButton);
+
 	graphButtonsLayout->addStretch(0);
 
 	/* Vertically position graph options and generate graph buttons */
@@ -284,240 +362,210 @@ void PowderTest::DisplaySeriesData ( void )
 	SeriesDataManager::displaySeriesData(
 		this,
 		seriesData,
+		importSource != FileSelectionHandlers::NO_SOURCE,
 		stackedWidget,
-		&scrollWidget,
-		&scrollArea,
-		&seriesGrid,
-		&headerResult
+		&seriesWidget,
+		&seriesTable,
+		&seriesModel
 	);
-}
 
-static bool ChronoSeriesComparator ( ChronoSeries *one, ChronoSeries *two )
-{
-	return (one->seriesNum < two->seriesNum);
+	connectSeriesModel();
 }
 
-void PowderTest::addNewClicked ( bool state )
+void PowderTest::releaseSession ( void )
 {
-	qDebug() << "addNewClicked state =" << state;
+	// The table and its model are children of seriesWidget. deleteLater() since we may be inside one of its button handlers.
+	if ( seriesWidget != NULL )
+	{
+		stackedWidget->removeWidget(seriesWidget);
+		seriesWidget->deleteLater();
 
-	// un-bold the button after the first click
-	addNewButton->setStyleSheet("");
+		seriesWidget = NULL;
+		seriesTable = NULL;
+		seriesModel = NULL;
+	}
 
-	int numRows = seriesGrid->rowCount();
+	// The watch holds pointers into the arena, and a new session may come from somewhere else
+	folderWatch->stop();
+	importSource = FileSelectionHandlers::NO_SOURCE;
+	importPath.clear();
 
-	// Remove the stretch from the last row, we'll be using the row for our new series
-	seriesGrid->setRowStretch(numRows - 1, 0);
+	// Every series of the session lives in the arena, free them all at once
+	seriesData.clear();
+	seriesArena.clear();
 
-	qDebug() << "numRows =" << numRows;
+	publishSnapshot();
+}
 
-	ChronoSeries *series = new ChronoSeries();
+QString PowderTest::velocityUnitsText ( void )
+{
+	if ( velocityUnits->currentIndex() == FPS )
+	{
+		return QString("ft/s");
+	}
+	else
+	{
+		return QString("m/s");
+	}
+}
 
-	series->deleted = false;
+void PowderTest::addNewClicked ( bool state )
+{
+	qCDebug(lcUi) << "addNewClicked state =" << state;
+
+	// un-bold the button after the first click
+	addNewButton->setStyleSheet("");
 
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
+	ChronoSeries *series = seriesArena.create();
 
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seriesGrid->addWidget(series->enabled, numRows - 1, 0);
+	series->isValid = true;
+	series->enabled = true;
+	series->chargeWeight = 0;
+	series->timestamp = INVALID_TIMESTAMP;
+	series->velocityUnits = velocityUnitsText();
 
 	int newSeriesNum = 1;
-	for ( int i = seriesData.size() - 1; i >= 0; i-- )
+	if ( ! seriesData.isEmpty() )
 	{
-		ChronoSeries *series = seriesData.at(i);
-		if ( ! series->deleted )
-		{
-			newSeriesNum = series->seriesNum + 1;
-			qDebug() << "Found last un-deleted series" << series->seriesNum << "(" << series->name->text() << ") at index" << i;
-			break;
-		}
+		newSeriesNum = seriesData.last()->seriesNum + 1;
+		qCDebug(lcUi) << "Found last series" << seriesData.last()->seriesNum << "(" << seriesData.last()->name << ")";
 	}
 
 	series->seriesNum = newSeriesNum;
+	series->name = QString("Series %1").arg(newSeriesNum);
 
-	series->name = new QLabel(QString("Series %1").arg(newSeriesNum));
-	seriesGrid->addWidget(series->name, numRows - 1, 1);
-
-	series->chargeWeight = new QDoubleSpinBox();
-	series->chargeWeight->setDecimals(2);
-	series->chargeWeight->setSingleStep(0.1);
-	series->chargeWeight->setMaximum(1000000);
-	series->chargeWeight->setMinimumWidth(100);
-	series->chargeWeight->setMaximumWidth(100);
+	seriesModel->appendSeries(series);
+	seriesTable->scrollToBottom();
+}
 
-	QHBoxLayout *chargeWeightLayout = new QHBoxLayout();
-	chargeWeightLayout->addWidget(series->chargeWeight);
-	chargeWeightLayout->addStretch(0);
-	seriesGrid->addLayout(chargeWeightLayout, numRows - 1, 2);
+void PowderTest::seriesTableClicked ( const QModelIndex &index )
+{
+	// Disabled rows still report clicks, but their buttons are greyed out
+	if ( ! (seriesModel->flags(index) & Qt::ItemIsEnabled) )
+	{
+		return;
+	}
 
-	const char *velocityUnits2;
-	if ( velocityUnits->currentIndex() == FPS )
+	if ( index.column() == ChronoSeriesModel::ENTER_DATA_COLUMN )
 	{
-		velocityUnits2 = "ft/s";
+		enterSeriesData(index.row());
 	}
-	else
+	else if ( index.column() == ChronoSeriesModel::DELETE_COLUMN )
 	{
-		velocityUnits2 = "m/s";
+		deleteSeries(index.row());
 	}
-
-	series->result = new QLabel(QString("0 shots, 0-0 %1").arg(velocityUnits2));
-	seriesGrid->addWidget(series->result, numRows - 1, 3, Qt::AlignVCenter);
-
-	series->enterDataButton = new QPushButton("Enter velocity data");
-	connect(series->enterDataButton, SIGNAL(clicked(bool)), this, SLOT(enterDataClicked(bool)));
-	series->enterDataButton->setFixedSize(series->enterDataButton->minimumSizeHint());
-	seriesGrid->addWidget(series->enterDataButton, numRows - 1, 4, Qt::AlignLeft);
-
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seriesGrid->addWidget(series->deleteButton, numRows - 1, 5, Qt::AlignLeft);
-
-	seriesData.append(series);
-
-	// Add an empty stretch row at the end for proper spacing
-	seriesGrid->setRowStretch(numRows, 1);
 }
 
-void PowderTest::enterDataClicked ( bool state )
+void PowderTest::enterSeriesData ( int row )
 {
-	QPushButton *enterDataButton = qobject_cast<QPushButton *>(sender());
+	ChronoSeries *series = seriesModel->seriesAt(row);
 
-	qDebug() << "enterDataClicked state =" << state;
-
-	// We have the button object, now locate its ChronoSeries object
-	ChronoSeries *series = NULL;
-	for ( int i = 0; i < seriesData.size(); i++ )
-	{
-		ChronoSeries *curSeries = seriesData.at(i);
-		if ( enterDataButton == curSeries->enterDataButton )
-		{
-			series = curSeries;
-			break;
-		}
-	}
+	qCDebug(lcUi) << "enterSeriesData row =" << row << "series =" << series->seriesNum;
 
 	EnterVelocitiesDialog *dialog = new EnterVelocitiesDialog(series);
 	int result = dialog->exec();
 
-	qDebug() << "dialog result:" << result;
+	qCDebug(lcUi) << "dialog result:" << result;
 
 	if ( result )
 	{
-		qDebug() << "User OK'd dialog";
+		qCDebug(lcUi) << "User OK'd dialog";
 
 		QList<double> values = dialog->getValues();
 
 		if ( values.size() == 0 )
 		{
-			qDebug() << "No valid velocities were provided, bailing...";
+			qCDebug(lcUi) << "No valid velocities were provided, bailing...";
 			return;
 		}
 
-		// We have the button object, now locate its row in the grid
-		for ( int i = 0; i < seriesData.size(); i++ )
-		{
-			ChronoSeries *series = seriesData.at(i);
-			if ( enterDataButton == series->enterDataButton )
-			{
-				qDebug() << "Setting velocities for Series" << series->seriesNum;
-
-				series->muzzleVelocities = values;
-
-				const char *velocityUnits2;
-				if ( velocityUnits->currentIndex() == FPS )
-				{
-					velocityUnits2 = "ft/s";
-				}
-				else
-				{
-					velocityUnits2 = "m/s";
-				}
+		qCDebug(lcUi) << "Setting velocities for Series" << series->seriesNum;
 
-				// Update the series result
-				int totalShots = series->muzzleVelocities.size();
-				double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				series->result->setText(QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(velocityUnits2));
+		series->muzzleVelocities = values;
+		series->velocityUnits = velocityUnitsText();
 
-				break;
-			}
-		}
+		// Update the series result
+		seriesModel->refresh();
 	}
 	else
 	{
-		qDebug() << "User cancelled dialog";
+		qCDebug(lcUi) << "User cancelled dialog";
 	}
 }
 
-void PowderTest::deleteClicked ( bool state )
+void PowderTest::deleteSeries ( int row )
 {
-	QPushButton *deleteButton = qobject_cast<QPushButton *>(sender());
+	ChronoSeries *series = seriesModel->seriesAt(row);
 
-	qDebug() << "deleteClicked state =" << state;
+	qCDebug(lcUi) << "Series" << series->seriesNum << "(" << series->name << ") was deleted";
 
-	int newSeriesNum = -1;
+	int newSeriesNum = series->seriesNum;
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seriesData.size(); i++ )
+	seriesModel->removeSeries(row);
+	seriesArena.destroy(series);
+
+	// Renumber the series that followed the deleted one
+	for ( int i = row; i < seriesData.size(); i++ )
 	{
 		ChronoSeries *series = seriesData.at(i);
-		if ( deleteButton == series->deleteButton )
-		{
-			qDebug() << "Series" << series->seriesNum << "(" << series->name->text() << ") was deleted";
 
-			series->deleted = true;
+		qCDebug(lcUi) << "Updating Series" << series->seriesNum << "to Series" << newSeriesNum;
 
-			series->enabled->hide();
-			series->name->hide();
-			series->chargeWeight->hide();
-			series->result->hide();
-			series->enterDataButton->hide();
-			series->deleteButton->hide();
+		series->seriesNum = newSeriesNum;
+		series->name = QString("Series %1").arg(newSeriesNum);
 
-			newSeriesNum = series->seriesNum;
-		}
-		else if ( (! series->deleted) && newSeriesNum > 0 )
-		{
-			qDebug() << "Updating Series" << series->seriesNum << "to Series" << newSeriesNum;
-
-			series->seriesNum = newSeriesNum;
-			series->name->setText(QString("Series %1").arg(newSeriesNum));
-
-			newSeriesNum++;
-		}
+		newSeriesNum++;
 	}
+
+	seriesModel->refresh();
 }
 
 void PowderTest::manualDataEntry ( bool state )
 {
-	qDebug() << "manualDataEntry state =" << state;
+	qCDebug(lcUi) << "manualDataEntry state =" << state;
 
-	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
-	stackedWidget->removeWidget(scrollWidget);
+	// If we already have series data displayed, clear it out first
+	releaseSession();
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+	createManualEntryTable();
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+	/* Create initial row */
 
-	seriesGrid = new QGridLayout(scrollAreaWidget);
-	seriesGrid->setColumnStretch(0, 0);
-	seriesGrid->setColumnStretch(1, 1);
-	seriesGrid->setColumnStretch(2, 2);
-	seriesGrid->setColumnStretch(3, 3);
-	seriesGrid->setColumnStretch(4, 3);
-	seriesGrid->setColumnStretch(5, 3);
-	seriesGrid->setHorizontalSpacing(25);
+	ChronoSeries *series = seriesArena.create();
 
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+	series->isValid = true;
+	series->enabled = true;
+	series->chargeWeight = 0;
+	series->timestamp = INVALID_TIMESTAMP;
+	series->velocityUnits = velocityUnitsText();
+	series->seriesNum = 1;
+	series->name = QString("Series 1");
 
-	scrollLayout->addWidget(scrollArea);
+	seriesModel->appendSeries(series);
+}
+
+void PowderTest::createManualEntryTable ( void )
+{
+	seriesWidget = new QWidget();
 
-	/* Create utilities toolbar under scroll area */
+	QVBoxLayout *seriesLayout = new QVBoxLayout();
+
+	QCheckBox *headerCheckBox = new QCheckBox("Select all");
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
+	seriesLayout->addWidget(headerCheckBox);
+
+	seriesModel = new ChronoSeriesModel(&seriesData, true, seriesWidget);
+
+	seriesTable = SeriesTable::createView(seriesModel);
+	seriesTable->setItemDelegateForColumn(ChronoSeriesModel::CHARGE_WEIGHT_COLUMN, new SpinBoxDelegate(2, 0.1, 1000000, seriesTable));
+	seriesTable->setItemDelegateForColumn(ChronoSeriesModel::ENTER_DATA_COLUMN, new ButtonDelegate(seriesTable));
+	seriesTable->setItemDelegateForColumn(ChronoSeriesModel::DELETE_COLUMN, new ButtonDelegate(seriesTable));
+	connect(seriesTable, SIGNAL(clicked(const QModelIndex &)), this, SLOT(seriesTableClicked(const QModelIndex &)));
+
+	seriesLayout->addWidget(seriesTable);
+
+	/* Create utilities toolbar under the series table */
 
 	addNewButton = new QPushButton("Add new series");
 	addNewButton->setStyleSheet("font-weight: bold");
@@ -546,113 +594,80 @@ void PowderTest::manualDataEntry ( bool state )
 	utilitiesLayout->addWidget(autofillButton);
 	utilitiesLayout->addWidget(rrButton);
 
-	scrollLayout->addLayout(utilitiesLayout);
-
-	scrollWidget = new QWidget();
-	scrollWidget->setLayout(scrollLayout);
+	seriesLayout->addLayout(utilitiesLayout);
 
-	stackedWidget->addWidget(scrollWidget);
-	stackedWidget->setCurrentWidget(scrollWidget);
+	seriesWidget->setLayout(seriesLayout);
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seriesGrid->addWidget(headerCheckBox, 0, 0);
-
-	QLabel *headerName = new QLabel("Series Name");
-	seriesGrid->addWidget(headerName, 0, 1, Qt::AlignVCenter);
-	QLabel *headerChargeWeight = new QLabel("Charge Weight");
-	seriesGrid->addWidget(headerChargeWeight, 0, 2, Qt::AlignVCenter);
-	headerResult = new QLabel("Series Result");
-	seriesGrid->addWidget(headerResult, 0, 3, Qt::AlignVCenter);
-	QLabel *headerEnterData = new QLabel("");
-	seriesGrid->addWidget(headerEnterData, 0, 4, Qt::AlignVCenter);
-	QLabel *headerDelete = new QLabel("");
-	seriesGrid->addWidget(headerDelete, 0, 5, Qt::AlignVCenter);
+	stackedWidget->addWidget(seriesWidget);
+	stackedWidget->setCurrentWidget(seriesWidget);
 
 	// Only connect this signal for manual data entry
 	connect(velocityUnits, SIGNAL(activated(int)), this, SLOT(velocityUnitsChanged(int)));
 
-	/* Create initial row */
-
-	ChronoSeries *series = new ChronoSeries();
+	connectSeriesModel();
+}
 
-	series->deleted = false;
+void PowderTest::connectSeriesModel ( void )
+{
+	// Every edit goes through the model, so its signals are enough to keep the published snapshot current
+	connect(seriesModel, SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &, const QVector<int> &)), this, SLOT(publishSnapshot()));
+	connect(seriesModel, SIGNAL(rowsInserted(const QModelIndex &, int, int)), this, SLOT(publishSnapshot()));
+	connect(seriesModel, SIGNAL(rowsRemoved(const QModelIndex &, int, int)), this, SLOT(publishSnapshot()));
 
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
+	publishSnapshot();
+}
 
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seriesGrid->addWidget(series->enabled, 1, 0);
+void PowderTest::publishSnapshot ( void )
+{
+	publishedSeries.publish(PowderSnapshot::create(seriesData));
+}
 
-	series->seriesNum = 1;
+void PowderTest::showGraph ( bool state )
+{
+	qCDebug(lcRender) << "showGraph state =" << state;
 
-	series->name = new QLabel("Series 1");
-	seriesGrid->addWidget(series->name, 1, 1);
+	renderGraph(true);
+}
 
-	series->chargeWeight = new QDoubleSpinBox();
-	series->chargeWeight->setDecimals(2);
-	series->chargeWeight->setSingleStep(0.1);
-	series->chargeWeight->setMaximum(1000000);
-	series->chargeWeight->setMinimumWidth(100);
-	series->chargeWeight->setMaximumWidth(100);
+void PowderTest::saveGraph ( bool state )
+{
+	qCDebug(lcRender) << "showGraph state =" << state;
 
-	QHBoxLayout *chargeWeightLayout = new QHBoxLayout();
-	chargeWeightLayout->addWidget(series->chargeWeight);
-	chargeWeightLayout->addStretch(0);
-	seriesGrid->addLayout(chargeWeightLayout, 1, 2);
+	renderGraph(false);
+}
 
-	const char *velocityUnits2;
-	if ( velocityUnits->currentIndex() == FPS )
+void PowderTest::graphOptionChanged ( void )
+{
+	// Nothing to update until a graph preview has been shown
+	if ( (liveGraph == NULL) || (graphPreview == NULL) || (!graphPreview->isVisible()) )
 	{
-		velocityUnits2 = "ft/s";
+		return;
 	}
-	else
+
+	// Coalesce bursts of changes (e.g. typing a title) into a single refresh
+	if ( !graphPreviewRefreshPending )
 	{
-		velocityUnits2 = "m/s";
+		graphPreviewRefreshPending = true;
+		QTimer::singleShot(0, this, SLOT(refreshGraphPreview()));
 	}
-
-	series->result = new QLabel(QString("0 shots, 0-0 %1").arg(velocityUnits2));
-	seriesGrid->addWidget(series->result, 1, 3, Qt::AlignVCenter);
-
-	series->enterDataButton = new QPushButton("Enter velocity data");
-	connect(series->enterDataButton, SIGNAL(clicked(bool)), this, SLOT(enterDataClicked(bool)));
-	series->enterDataButton->setFixedSize(series->enterDataButton->minimumSizeHint());
-	seriesGrid->addWidget(series->enterDataButton, 1, 4, Qt::AlignLeft);
-
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seriesGrid->addWidget(series->deleteButton, 1, 5, Qt::AlignLeft);
-
-	seriesGrid->setRowMinimumHeight(0, series->chargeWeight->sizeHint().height());
-
-	seriesData.append(series);
-
-	// Add an empty stretch row at the end for proper spacing
-	seriesGrid->setRowStretch(seriesGrid->rowCount(), 1);
 }
 
-void PowderTest::showGraph ( bool state )
+void PowderTest::refreshGraphPreview ( void )
 {
-	qDebug() << "showGraph state =" << state;
+	graphPreviewRefreshPending = false;
 
-	renderGraph(true);
-}
+	if ( (liveGraph == NULL) || (graphPreview == NULL) )
+	{
+		return;
+	}
 
-void PowderTest::saveGraph ( bool state )
-{
-	qDebug() << "showGraph state =" << state;
+	qCDebug(lcRender) << "Refreshing graph preview with new options";
 
-	renderGraph(false);
+	GraphRenderer::updateGraphPreview(getGraphOptions(), liveGraph, graphPreview);
 }
 
-void PowderTest::renderGraph ( bool displayGraphPreview )
+GraphOptions PowderTest::getGraphOptions ( void )
 {
-	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
-
-	// Build graph options structure
 	GraphOptions options;
 	options.graphType = graphType->currentIndex();
 	options.weightUnitsIndex = weightUnits->currentIndex();
@@ -675,212 +690,116 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 	options.vdLocation = vdLocation->currentIndex();
 	options.showTrend = trendCheckBox->isChecked();
 	options.trendLineType = trendLineType->currentIndex();
+	options.showDensity = densityCheckBox->isChecked();
 
-	// Delegate to GraphRenderer
-	GraphRenderer::renderGraph(
-		this,
-		seriesData,
-		displayGraphPreview,
-		options,
-		prevSaveDir,
-		&prevSaveDir,
-		&graphPreview
-	);
+	return options;
 }
 
-void PowderTest::seriesCheckBoxChanged ( int state )
+void PowderTest::renderGraph ( bool displayGraphPreview )
 {
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
-
-	qDebug() << "seriesCheckBoxChanged state =" << state << " checkBox =" << checkBox;
+	qCDebug(lcRender) << "renderGraph displayGraphPreview =" << displayGraphPreview;
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
+	// Table edits are reported on the next event loop pass, make sure the snapshot has them
+	if ( seriesModel )
 	{
-		QWidget *rowCheckBox = seriesGrid->itemAtPosition(i, 0)->widget();
-
-		if ( checkBox == rowCheckBox )
-		{
-			QWidget *seriesName = seriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *chargeWeight = seriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *seriesResult = seriesGrid->itemAtPosition(i, 3)->widget();
-			QWidget *seriesDate = seriesGrid->itemAtPosition(i, 4)->widget();
-
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
-
-				seriesName->setEnabled(true);
-				chargeWeight->setEnabled(true);
-				seriesResult->setEnabled(true);
-				seriesDate->setEnabled(true);
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
-
-				seriesName->setEnabled(false);
-				chargeWeight->setEnabled(false);
-				seriesResult->setEnabled(false);
-				seriesDate->setEnabled(false);
-			}
-
-			return;
-		}
+		seriesModel->flushChanges();
 	}
-}
 
-void PowderTest::seriesManualCheckBoxChanged ( int state )
-{
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	// Waiting for the statistics runs an event loop, a watched folder can deliver more series meanwhile
+	renderingGraph = true;
 
-	qDebug() << "seriesManualCheckBoxChanged state =" << state << " checkBox =" << checkBox;
-
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
-	{
-		QWidget *rowCheckBox = seriesGrid->itemAtPosition(i, 0)->widget();
-
-		if ( checkBox == rowCheckBox )
-		{
-			QWidget *seriesName = seriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *chargeWeight = seriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *seriesResult = seriesGrid->itemAtPosition(i, 3)->widget();
-			QWidget *seriesEnterData = seriesGrid->itemAtPosition(i, 4)->widget();
-			QWidget *seriesDelete = seriesGrid->itemAtPosition(i, 5)->widget();
-
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
-
-				seriesName->setEnabled(true);
-				chargeWeight->setEnabled(true);
-				seriesResult->setEnabled(true);
-				seriesEnterData->setEnabled(true);
-				seriesDelete->setEnabled(true);
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
-
-				seriesName->setEnabled(false);
-				chargeWeight->setEnabled(false);
-				seriesResult->setEnabled(false);
-				seriesEnterData->setEnabled(false);
-				seriesDelete->setEnabled(false);
-			}
+	// Delegate to GraphRenderer
+	GraphRenderer::renderGraph(
+		this,
+		publishedSeries,
+		displayGraphPreview,
+		getGraphOptions(),
+		prevSaveDir,
+		&prevSaveDir,
+		&liveGraph,
+		&graphPreview
+	);
 
-			return;
-		}
-	}
+	renderingGraph = false;
 }
 
 void PowderTest::headerCheckBoxChanged ( int state )
 {
-	qDebug() << "headerCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "headerCheckBoxChanged state =" << state;
 
 	if ( state == Qt::Checked )
 	{
-		qDebug() << "Header checkbox was checked";
+		qCDebug(lcUi) << "Header checkbox was checked";
 
-		for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seriesGrid->itemAtPosition(i, 0)->widget());
-			checkBox->setChecked(true);
-		}
+		seriesModel->setAllEnabled(true);
 	}
 	else
 	{
-		qDebug() << "Header checkbox was unchecked";
+		qCDebug(lcUi) << "Header checkbox was unchecked";
 
-		for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seriesGrid->itemAtPosition(i, 0)->widget());
-			checkBox->setChecked(false);
-		}
+		seriesModel->setAllEnabled(false);
 	}
 }
 
 void PowderTest::velocityUnitsChanged ( int index )
 {
-	qDebug() << "velocityUnitsChanged index =" << index;
+	qCDebug(lcUi) << "velocityUnitsChanged index =" << index;
 
 	/*
 	 * This signal handler is only connected in manual data entry mode. When the velocity unit is changed, we
-	 * need to iterate through and update every Series Result row to display the new unit.
+	 * need to update every series to the new unit so the Series Result column displays it.
 	 */
 
-	const char *velocityUnit;
-
-	if ( index == FPS )
-	{
-		velocityUnit = "ft/s";
-	}
-	else
-	{
-		velocityUnit = "m/s";
-	}
+	QString velocityUnit = velocityUnitsText();
 
 	for ( int i = 0; i < seriesData.size(); i++ )
 	{
-		ChronoSeries *series = seriesData.at(i);
-		if ( ! series->deleted )
-		{
-			qDebug() << "Setting series" << i << "velocity unit to" << velocityUnit;
+		qCDebug(lcUi) << "Setting series" << i << "velocity unit to" << velocityUnit;
 
-			if ( series->muzzleVelocities.size() == 0 )
-			{
-				series->result->setText(QString("0 shots, 0-0 %1").arg(velocityUnit));
-			}
-			else
-			{
-				int totalShots = series->muzzleVelocities.size();
-				double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				series->result->setText(QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(velocityUnit));
-			}
-		}
+		seriesData.at(i)->velocityUnits = velocityUnit;
 	}
+
+	seriesModel->refresh();
 }
 
 void PowderTest::esCheckBoxChanged ( bool state )
 {
-	qDebug() << "esCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "esCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(esCheckBox, esLabel, esLocation);
 }
 
 void PowderTest::sdCheckBoxChanged ( bool state )
 {
-	qDebug() << "sdsCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "sdsCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(sdCheckBox, sdLabel, sdLocation);
 }
 
 void PowderTest::avgCheckBoxChanged ( bool state )
 {
-	qDebug() << "avgCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "avgCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(avgCheckBox, avgLabel, avgLocation);
 }
 
 void PowderTest::vdCheckBoxChanged ( bool state )
 {
-	qDebug() << "vdCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "vdCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(vdCheckBox, vdLabel, vdLocation);
 }
 
 void PowderTest::trendCheckBoxChanged ( bool state )
 {
-	qDebug() << "trendCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "trendCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(trendCheckBox, trendLabel, trendLineType);
 }
 
 void PowderTest::xAxisSpacingChanged ( int index )
 {
-	qDebug() << "xAxisSpacingChanged index =" << index;
+	qCDebug(lcUi) << "xAxisSpacingChanged index =" << index;
 
 	if ( index == CONSTANT )
 	{
@@ -901,152 +820,222 @@ void PowderTest::optionCheckBoxChanged ( QCheckBox *checkBox, QLabel *label, QCo
 {
 	if ( checkBox->isChecked() )
 	{
-		qDebug() << "checkbox was checked";
+		qCDebug(lcUi) << "checkbox was checked";
 		comboBox->setEnabled(true);
 	}
 	else
 	{
-		qDebug() << "checkbox was unchecked";
+		qCDebug(lcUi) << "checkbox was unchecked";
 		comboBox->setEnabled(false);
 	}
+
+	graphOptionChanged();
 }
 
 void PowderTest::loadNewChronographData ( bool state )
 {
-	qDebug() << "loadNewChronographData state =" << state;
+	qCDebug(lcImport) << "loadNewChronographData state =" << state;
 
 	QMessageBox::StandardButton reply;
 	reply = QMessageBox::question(this, "Load new data", "Are you sure you want to load new chronograph data?\n\nThis will clear your current work.", QMessageBox::Yes | QMessageBox::Cancel);
 
 	if ( reply == QMessageBox::Yes )
 	{
-		qDebug() << "User said yes";
-
-		// Hide the chronograph data screen. This returns to the initial screen to choose a new chronograph file.
-		stackedWidget->removeWidget(scrollWidget);
+		qCDebug(lcImport) << "User said yes";
 
-		// Delete the loaded chronograph data
-		seriesData.clear();
+		// Hide the chronograph data screen and free the loaded chronograph data. This returns to the initial screen to choose a new chronograph file.
+		releaseSession();
 
 		// Disconnect the velocity units header signal (used in manual data entry), if necessary
 		disconnect(velocityUnits, SIGNAL(activated(int)), this, SLOT(velocityUnitsChanged(int)));
 	}
 	else
 	{
-		qDebug() << "User said cancel";
+		qCDebug(lcImport) << "User said cancel";
 	}
 }
 
 void PowderTest::selectLabRadarDirectory ( bool state )
 {
-	qDebug() << "selectLabRadarDirectory state =" << state;
+	qCDebug(lcImport) << "selectLabRadarDirectory state =" << state;
 
 	QList<ChronoSeries*> newSeriesData = FileSelectionHandlers::selectLabRadarDirectory(
 		this,
 		prevLabRadarDir,
-		&prevLabRadarDir
+		&prevLabRadarDir,
+		&seriesArena
 	);
 
 	if (!newSeriesData.empty())
 	{
 		seriesData = newSeriesData;
+		importSource = FileSelectionHandlers::LABRADAR;
+		importPath = prevLabRadarDir;
 		DisplaySeriesData();
 	}
 }
 
 void PowderTest::selectMagnetoSpeedFile ( bool state )
 {
-	qDebug() << "selectMagnetoSpeedFile state =" << state;
+	qCDebug(lcImport) << "selectMagnetoSpeedFile state =" << state;
 
 	QList<ChronoSeries*> newSeriesData = FileSelectionHandlers::selectMagnetoSpeedFile(
 		this,
 		prevMagnetoSpeedDir,
-		&prevMagnetoSpeedDir
+		&prevMagnetoSpeedDir,
+		&seriesArena
 	);
 
 	if (!newSeriesData.empty())
 	{
 		seriesData = newSeriesData;
+		importSource = FileSelectionHandlers::MAGNETOSPEED;
+		importPath = prevMagnetoSpeedDir;
 		DisplaySeriesData();
 	}
 }
 
 void PowderTest::selectProChronoFile ( bool state )
 {
-	qDebug() << "selectProChronoFile state =" << state;
+	qCDebug(lcImport) << "selectProChronoFile state =" << state;
 
 	QList<ChronoSeries*> newSeriesData = FileSelectionHandlers::selectProChronoFile(
 		this,
 		prevProChronoDir,
-		&prevProChronoDir
+		&prevProChronoDir,
+		&seriesArena
 	);
 
 	if (!newSeriesData.empty())
 	{
 		seriesData = newSeriesData;
+		importSource = FileSelectionHandlers::PROCHRONO;
+		importPath = prevProChronoDir;
 		DisplaySeriesData();
 	}
 }
 
 void PowderTest::selectGarminFile ( bool state )
 {
-	qDebug() << "selectGarminFile state =" << state;
+	qCDebug(lcImport) << "selectGarminFile state =" << state;
 
 	QList<ChronoSeries*> newSeriesData = FileSelectionHandlers::selectGarminFile(
 		this,
 		prevGarminDir,
-		&prevGarminDir
+		&prevGarminDir,
+		&seriesArena
 	);
 
 	if (!newSeriesData.empty())
 	{
 		seriesData = newSeriesData;
+		importSource = FileSelectionHandlers::GARMIN;
+		importPath = prevGarminDir;
 		DisplaySeriesData();
 	}
 }
 
 void PowderTest::selectShotMarkerFile ( bool state )
 {
-	qDebug() << "selectShotMarkerFile state =" << state;
+	qCDebug(lcImport) << "selectShotMarkerFile state =" << state;
 
 	QList<ChronoSeries*> newSeriesData = FileSelectionHandlers::selectShotMarkerFile(
 		this,
 		prevShotMarkerDir,
-		&prevShotMarkerDir
+		&prevShotMarkerDir,
+		&seriesArena
 	);
 
 	if (!newSeriesData.empty())
 	{
 		seriesData = newSeriesData;
+		importSource = FileSelectionHandlers::SHOTMARKER;
+		importPath = prevShotMarkerDir;
 		DisplaySeriesData();
 	}
 }
 
+void PowderTest::watchFolderToggled ( bool checked )
+{
+	qCDebug(lcImport) << "watchFolderToggled checked =" << checked;
+
+	if ( checked )
+	{
+		folderWatch->start(importSource, importPath, seriesData);
+	}
+	else
+	{
+		folderWatch->stop();
+	}
+}
+
+void PowderTest::watchedSeriesArrived ( const QList<ChronoSeries*> &added, const QList<ChronoSeries*> &updated )
+{
+	if ( seriesModel == NULL )
+	{
+		return;
+	}
+
+	foreach ( ChronoSeries *series, added )
+	{
+		seriesModel->appendSeries(series);
+	}
+
+	foreach ( ChronoSeries *series, updated )
+	{
+		int row = seriesData.indexOf(series);
+		if ( row >= 0 )
+		{
+			seriesModel->seriesChanged(row);
+		}
+	}
+
+	// Publishes the new snapshot now rather than on the next pass
+	seriesModel->flushChanges();
+
+	// A graph being built picks up the new snapshot by itself
+	if ( renderingGraph )
+	{
+		return;
+	}
+
+	// Redraw an open preview with the new shots, unless that would need to ask the user something (e.g. a new series' charge weight)
+	if ( (graphPreview != NULL) && graphPreview->isVisible() && GraphRenderer::isGraphable(*publishedSeries.snapshot(), xAxisSpacing->currentIndex()) )
+	{
+		renderGraph(true);
+	}
+}
+
 void PowderTest::rrClicked ( bool state )
 {
-	qDebug() << "rrClicked state =" << state;
+	qCDebug(lcUi) << "rrClicked state =" << state;
 
 	RoundRobinDialog *dialog = new RoundRobinDialog(this);
 	int result = dialog->exec();
+	delete dialog;
 
-	qDebug() << "dialog result:" << result;
+	qCDebug(lcUi) << "dialog result:" << result;
 
 	if ( result )
 	{
-		qDebug() << "Performing series conversion";
+		qCDebug(lcUi) << "Performing series conversion";
 
 		QList<QList<double> > enabledSeriesVelocs;
+		QString enabledVelocityUnits;
 		for ( int i = 0; i < seriesData.size(); i++ )
 		{
 			ChronoSeries *series = seriesData.at(i);
-			if ( series->enabled->isChecked() )
+			if ( series->enabled )
 			{
 				enabledSeriesVelocs.append(series->muzzleVelocities);
+				enabledVelocityUnits = series->velocityUnits;
 			}
 		}
 
+		// The velocities were copied out above, so the current session can be released before building the new one
+		releaseSession();
+
 		// Iterate the number of velocities in the enabled series
-		QList<ChronoSeries *> newSeriesData;
 		for ( int i = 0; i < enabledSeriesVelocs.at(0).size(); i++ )
 		{
 			// Grab the Xth velocity in each of the enabled series and create a new series with them
@@ -1056,51 +1045,47 @@ void PowderTest::rrClicked ( bool state )
 				newVelocs.append(enabledSeriesVelocs.at(j).at(i));
 			}
 
-			ChronoSeries *newSeries = new ChronoSeries();
+			ChronoSeries *newSeries = seriesArena.create();
+
+			newSeries->isValid = true;
 
 			newSeries->seriesNum = i;
 
-			newSeries->name = new QLabel(QString("Series %1").arg(i + 1));
+			newSeries->name = QString("Series %1").arg(i + 1);
 
 			newSeries->muzzleVelocities = newVelocs;
+			newSeries->velocityUnits = enabledVelocityUnits;
 
-			newSeries->enabled = new QCheckBox();
-			newSeries->enabled->setChecked(true);
+			newSeries->enabled = true;
 
-			newSeries->chargeWeight = new QDoubleSpinBox();
-			newSeries->chargeWeight->setDecimals(2);
-			newSeries->chargeWeight->setSingleStep(0.1);
-			newSeries->chargeWeight->setMaximum(1000000);
-			newSeries->chargeWeight->setMinimumWidth(100);
-			newSeries->chargeWeight->setMaximumWidth(100);
+			newSeries->chargeWeight = 0;
 
-			newSeriesData.append(newSeries);
-		}
+			newSeries->timestamp = INVALID_TIMESTAMP;
 
-		// Replace the current series data with the new one
-		seriesData = newSeriesData;
+			seriesData.append(newSeries);
+		}
 
 		// Proceed to display the data
 		DisplaySeriesData();
 	}
 	else
 	{
-		qDebug() << "Not performing series conversion";
+		qCDebug(lcUi) << "Not performing series conversion";
 	}
 }
 
 void PowderTest::autofillClicked ( bool state )
 {
-	qDebug() << "autofillClicked state =" << state;
+	qCDebug(lcUi) << "autofillClicked state =" << state;
 
 	AutofillDialog *dialog = new AutofillDialog(this);
 	int result = dialog->exec();
 
-	qDebug() << "dialog result:" << result;
+	qCDebug(lcUi) << "dialog result:" << result;
 
 	if ( result )
 	{
-		qDebug() << "User OK'd dialog";
+		qCDebug(lcUi) << "User OK'd dialog";
 
 		AutofillValues *values = dialog->getValues();
 
@@ -1109,10 +1094,10 @@ void PowderTest::autofillClicked ( bool state )
 		for ( int i = 0; i < seriesData.size(); i++ )
 		{
 			ChronoSeries *series = seriesData.at(i);
-			if ( (! series->deleted) && series->enabled->isChecked() )
+			if ( series->enabled )
 			{
-				qDebug() << "Setting series" << i << "to" << currentCharge;
-				series->chargeWeight->setValue(currentCharge);
+				qCDebug(lcUi) << "Setting series" << i << "to" << currentCharge;
+				series->chargeWeight = currentCharge;
 				if ( values->increasing )
 				{
 					currentCharge += values->interval;
@@ -1123,66 +1108,49 @@ void PowderTest::autofillClicked ( bool state )
 				}
 			}
 		}
+
+		seriesModel->refresh();
 	}
 	else
 	{
-		qDebug() << "User cancelled dialog";
+		qCDebug(lcUi) << "User cancelled dialog";
 	}
 }
 
-void PowderTest::prepareGarminFiles ( bool state )
+namespace
 {
-	qDebug() << "prepareGarminFiles state =" << state;
-
-	// Open file selection dialog to select 2 or more CSV files
-	QStringList csvFiles = QFileDialog::getOpenFileNames(
-		this,
-		"Select Garmin CSV files (2 or more)",
-		prevGarminDir,
-		"CSV files (*.csv)"
-	);
-
-	if (csvFiles.isEmpty())
+	// The combined workbook and where it came from, owned by prepareGarminFiles()
+	struct GarminCombine
 	{
-		qDebug() << "User didn't select any files, bail";
-		return;
-	}
-
-	if (csvFiles.size() < 2)
-	{
-		qDebug() << "User selected less than 2 files";
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Warning);
-		msg->setText("Please select at least 2 CSV files to combine.");
-		msg->setWindowTitle("Not Enough Files");
-		msg->exec();
-		return;
-	}
-
-	qDebug() << "Selected" << csvFiles.size() << "CSV files";
-
-	// Update the previous directory
-	QFileInfo firstFileInfo(csvFiles.at(0));
-	prevGarminDir = firstFileInfo.absolutePath();
+		QStringList csvFiles;
+		QString failedPath;
+		QXlsx::Document xlsx;
+		QString savePath;
+		bool saved;
+	};
+}
 
-	// Create a new XLSX document
-	QXlsx::Document xlsx;
+static void combineGarminFiles ( Job *job, void *context )
+{
+	GarminCombine *combine = (GarminCombine *)context;
 
 	// Process each CSV file and add it as a worksheet
-	for (int i = 0; i < csvFiles.size(); i++)
+	for (int i = 0; i < combine->csvFiles.size(); i++)
 	{
-		QString csvPath = csvFiles.at(i);
-		qDebug() << "Processing CSV file:" << csvPath;
+		if (job->isCancelled())
+		{
+			return;
+		}
+		job->setProgress(i, combine->csvFiles.size());
+
+		QString csvPath = combine->csvFiles.at(i);
+		qCDebug(lcImport) << "Processing CSV file:" << csvPath;
 
 		QFile csvFile(csvPath);
 		if (!csvFile.open(QIODevice::ReadOnly | QIODevice::Text))
 		{
-			qDebug() << "Failed to open CSV file:" << csvPath;
-			QMessageBox *msg = new QMessageBox();
-			msg->setIcon(QMessageBox::Critical);
-			msg->setText(QString("Failed to open file:\n%1").arg(csvPath));
-			msg->setWindowTitle("Error");
-			msg->exec();
+			qCDebug(lcImport) << "Failed to open CSV file:" << csvPath;
+			combine->failedPath = csvPath;
 			return;
 		}
 
@@ -1210,25 +1178,25 @@ void PowderTest::prepareGarminFiles ( bool state )
 
 		if (rows.isEmpty())
 		{
-			qDebug() << "CSV file is empty:" << csvPath;
+			qCDebug(lcImport) << "CSV file is empty:" << csvPath;
 			continue;
 		}
 
 		// Create worksheet name
 		QString sheetName = QString("Sheet%1").arg(i + 1);
 		
-		qDebug() << "Creating worksheet:" << sheetName;
+		qCDebug(lcImport) << "Creating worksheet:" << sheetName;
 
 		// For the first sheet, rename the default sheet instead of adding a new one
 		if (i == 0)
 		{
-			xlsx.renameSheet("Sheet1", sheetName);
-			xlsx.selectSheet(sheetName);
+			combine->xlsx.renameSheet("Sheet1", sheetName);
+			combine->xlsx.selectSheet(sheetName);
 		}
 		else
 		{
-			xlsx.addSheet(sheetName);
-			xlsx.selectSheet(sheetName);
+			combine->xlsx.addSheet(sheetName);
+			combine->xlsx.selectSheet(sheetName);
 		}
 
 		// Write the CSV data to the worksheet
@@ -1238,11 +1206,74 @@ void PowderTest::prepareGarminFiles ( bool state )
 			for (int col = 0; col < cols.size(); col++)
 			{
 				// Write to Excel (1-based indexing)
-				xlsx.write(row + 1, col + 1, cols.at(col));
+				combine->xlsx.write(row + 1, col + 1, cols.at(col));
 			}
 		}
 		
-		qDebug() << "Wrote" << rows.size() << "rows to worksheet" << sheetName;
+		qCDebug(lcImport) << "Wrote" << rows.size() << "rows to worksheet" << sheetName;
+	}
+}
+
+static void saveGarminFile ( Job *, void *context )
+{
+	GarminCombine *combine = (GarminCombine *)context;
+	combine->saved = combine->xlsx.saveAs(combine->savePath);
+}
+
+void PowderTest::prepareGarminFiles ( bool state )
+{
+	qCDebug(lcImport) << "prepareGarminFiles state =" << state;
+
+	// Open file selection dialog to select 2 or more CSV files
+	QStringList csvFiles = QFileDialog::getOpenFileNames(
+		this,
+		"Select Garmin CSV files (2 or more)",
+		prevGarminDir,
+		"CSV files (*.csv)"
+	);
+
+	if (csvFiles.isEmpty())
+	{
+		qCDebug(lcImport) << "User didn't select any files, bail";
+		return;
+	}
+
+	if (csvFiles.size() < 2)
+	{
+		qCDebug(lcImport) << "User selected less than 2 files";
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Warning);
+		msg->setText("Please select at least 2 CSV files to combine.");
+		msg->setWindowTitle("Not Enough Files");
+		msg->exec();
+		return;
+	}
+
+	qCDebug(lcImport) << "Selected" << csvFiles.size() << "CSV files";
+
+	// Update the previous directory
+	QFileInfo firstFileInfo(csvFiles.at(0));
+	prevGarminDir = firstFileInfo.absolutePath();
+
+	// Worksheets are built on a worker, the window keeps painting while a big set of files is converted
+	GarminCombine combine;
+	combine.csvFiles = csvFiles;
+	combine.saved = false;
+
+	if (!Scheduler::run(new FunctionJob(combineGarminFiles, &combine, Job::BATCH), this, "Combining Garmin files..."))
+	{
+		qCDebug(lcImport) << "User cancelled combining the files";
+		return;
+	}
+
+	if (!combine.failedPath.isEmpty())
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText(QString("Failed to open file:\n%1").arg(combine.failedPath));
+		msg->setWindowTitle("Error");
+		msg->exec();
+		return;
 	}
 
 	// Present the user with a save dialog
@@ -1255,7 +1286,7 @@ void PowderTest::prepareGarminFiles ( bool state )
 
 	if (savePath.isEmpty())
 	{
-		qDebug() << "User cancelled save dialog";
+		qCDebug(lcImport) << "User cancelled save dialog";
 		return;
 	}
 
@@ -1265,14 +1296,20 @@ void PowderTest::prepareGarminFiles ( bool state )
 		savePath += ".xlsx";
 	}
 
-	qDebug() << "Saving XLSX file to:" << savePath;
+	qCDebug(lcImport) << "Saving XLSX file to:" << savePath;
 
 	// Save the XLSX file
-	bool saveSuccess = xlsx.saveAs(savePath);
+	combine.savePath = savePath;
+	// A save that already started can't be stopped, so only bail if it never ran
+	if (!Scheduler::run(new FunctionJob(saveGarminFile, &combine, Job::BATCH), this, "Saving Garmin file...") && !combine.saved)
+	{
+		qCDebug(lcImport) << "User cancelled saving the file";
+		return;
+	}
 
-	if (saveSuccess)
+	if (combine.saved)
 	{
-		qDebug() << "XLSX file saved successfully";
+		qCDebug(lcImport) << "XLSX file saved successfully";
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
 		msg->setText(QString("Successfully created multi-series Garmin file!\n\nSaved to:\n%1").arg(savePath));
@@ -1281,7 +1318,7 @@ void PowderTest::prepareGarminFiles ( bool state )
 	}
 	else
 	{
-		qDebug() << "Failed to save XLSX file";
+		qCDebug(lcImport) << "Failed to save XLSX file";
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
 		msg->setText(QString("Failed to save file:\n%1").arg(savePath));
@@ -1289,3 +1326,179 @@ void PowderTest::prepareGarminFiles ( bool state )
 		msg->exec();
 	}
 }
+
+QList<QPair<QString, QWidget *> > PowderTest::sessionOptions ( void )
+{
+	// Order matters when restoring, x-axis spacing resets the trend line checkbox
+	QList<QPair<QString, QWidget *> > options;
+	options.append(QPair<QString, QWidget *>("graphTitle", graphTitle));
+	options.append(QPair<QString, QWidget *>("rifle", rifle));
+	options.append(QPair<QString, QWidget *>("projectile", projectile));
+	options.append(QPair<QString, QWidget *>("propellant", propellant));
+	options.append(QPair<QString, QWidget *>("brass", brass));
+	options.append(QPair<QString, QWidget *>("primer", primer));
+	options.append(QPair<QString, QWidget *>("weather", weather));
+	options.append(QPair<QString, QWidget *>("graphType", graphType));
+	options.append(QPair<QString, QWidget *>("weightUnits", weightUnits));
+	options.append(QPair<QString, QWidget *>("velocityUnits", velocityUnits));
+	options.append(QPair<QString, QWidget *>("xAxisSpacing", xAxisSpacing));
+	options.append(QPair<QString, QWidget *>("showES", esCheckBox));
+	options.append(QPair<QString, QWidget *>("esLocation", esLocation));
+	options.append(QPair<QString, QWidget *>("showSD", sdCheckBox));
+	options.append(QPair<QString, QWidget *>("sdLocation", sdLocation));
+	options.append(QPair<QString, QWidget *>("showAvg", avgCheckBox));
+	options.append(QPair<QString, QWidget *>("avgLocation", avgLocation));
+	options.append(QPair<QString, QWidget *>("showVD", vdCheckBox));
+	options.append(QPair<QString, QWidget *>("vdLocation", vdLocation));
+	options.append(QPair<QString, QWidget *>("showTrend", trendCheckBox));
+	options.append(QPair<QString, QWidget *>("trendLineType", trendLineType));
+	options.append(QPair<QString, QWidget *>("densityShading", densityCheckBox));
+
+	return options;
+}
+
+void PowderTest::saveSession ( bool state )
+{
+	qCDebug(lcImport) << "saveSession state =" << state;
+
+	if ( seriesModel == NULL )
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText("There's no series data to save yet.");
+		msg->setWindowTitle("Error");
+		msg->exec();
+		return;
+	}
+
+	QString path = QFileDialog::getSaveFileName(this, "Save session", prevSessionDir, "ChronoPlotter sessions (*.cps)");
+
+	qCDebug(lcImport) << "Selected file:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qCDebug(lcImport) << "User didn't select a file, bail";
+		return;
+	}
+
+	prevSessionDir = path;
+
+	SessionFileWriter writer(SessionFile::POWDER_TEST, seriesModel->isManualEntry() ? SessionFile::MANUAL_ENTRY : 0);
+
+	for ( int i = 0; i < seriesData.size(); i++ )
+	{
+		ChronoSeries *series = seriesData.at(i);
+
+		SessionSeries &entry = writer.addSeries(series->seriesNum, series->name, series->velocityUnits, series->firstDate, series->firstTime);
+		entry.flags = series->enabled ? SessionFile::SERIES_ENABLED : 0;
+		entry.setting = series->chargeWeight;
+		entry.timestamp = series->timestamp;
+
+		for ( int j = 0; j < series->muzzleVelocities.size(); j++ )
+		{
+			writer.appendVelocity(series->muzzleVelocities.at(j));
+		}
+	}
+
+	QList<QPair<QString, QWidget *> > options = sessionOptions();
+	for ( int i = 0; i < options.size(); i++ )
+	{
+		writer.setOption(options.at(i).first, options.at(i).second);
+	}
+
+	QString error;
+	if ( ! writer.save(path, &error) )
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText(QString("Unable to save session to '%1'\n\n%2").arg(path).arg(error));
+		msg->setWindowTitle("Error");
+		msg->exec();
+	}
+}
+
+void PowderTest::loadSession ( bool state )
+{
+	qCDebug(lcImport) << "loadSession state =" << state;
+
+	QString path = QFileDialog::getOpenFileName(this, "Load session", prevSessionDir, "ChronoPlotter sessions (*.cps)");
+
+	qCDebug(lcImport) << "Selected file:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qCDebug(lcImport) << "User didn't select a file, bail";
+		return;
+	}
+
+	prevSessionDir = path;
+
+	SessionFile session;
+	QString error;
+	if ( ! session.open(path, SessionFile::POWDER_TEST, &error) )
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText(QString("Unable to load session from '%1'\n\n%2").arg(path).arg(error));
+		msg->setWindowTitle("Error");
+		msg->exec();
+		return;
+	}
+
+	releaseSession();
+	disconnect(velocityUnits, SIGNAL(activated(int)), this, SLOT(velocityUnitsChanged(int)));
+
+	QList<QPair<QString, QWidget *> > options = sessionOptions();
+	for ( int i = 0; i < options.size(); i++ )
+	{
+		session.restoreOption(options.at(i).first, options.at(i).second);
+	}
+
+	// Checkboxes don't emit clicked() when set programmatically, so update their location boxes by hand
+	esCheckBoxChanged(esCheckBox->isChecked());
+	sdCheckBoxChanged(sdCheckBox->isChecked());
+	avgCheckBoxChanged(avgCheckBox->isChecked());
+	vdCheckBoxChanged(vdCheckBox->isChecked());
+	trendCheckBoxChanged(trendCheckBox->isChecked());
+
+	QList<ChronoSeries *> newSeriesData;
+	for ( int i = 0; i < session.seriesCount(); i++ )
+	{
+		const SessionSeries &entry = session.series(i);
+
+		ChronoSeries *series = seriesArena.create();
+		series->isValid = true;
+		series->seriesNum = entry.seriesNum;
+		series->name = session.text(entry.name);
+		series->velocityUnits = session.text(entry.velocityUnits);
+		series->firstDate = session.text(entry.firstDate);
+		series->firstTime = session.text(entry.firstTime);
+		series->timestamp = entry.timestamp;
+		series->enabled = ((entry.flags & SessionFile::SERIES_ENABLED) != 0);
+		series->chargeWeight = entry.setting;
+
+		const double *velocities = session.velocities(i);
+		series->muzzleVelocities.reserve(entry.velocityCount);
+		for ( quint64 j = 0; j < entry.velocityCount; j++ )
+		{
+			series->muzzleVelocities.append(velocities[j]);
+		}
+
+		newSeriesData.append(series);
+	}
+
+	if ( session.flags() & SessionFile::MANUAL_ENTRY )
+	{
+		createManualEntryTable();
+
+		for ( int i = 0; i < newSeriesData.size(); i++ )
+		{
+			seriesModel->appendSeries(newSeriesData.at(i));
+		}
+	}
+	else
+	{
+		seriesData = newSeriesData;
+		DisplaySeriesData();
+	}
+}
@@ -13,13 +13,15 @@
 #include <QPushButton>
 #include <QStackedWidget>
 #include <QDoubleSpinBox>
-#include <QScrollArea>
-#include <QGridLayout>
+#include <QTableView>
 #include <QDialog>
 #include <QMainWindow>
 #include <QTextEdit>
 
 #include "ChronoPlotter.h"
+#include "GraphRenderer.h"
+#include "FileSelectionHandlers.h"
+#include "SeriesArena.h"
 
 namespace Powder
 {
@@ -27,26 +29,26 @@ namespace Powder
 	{
 		bool isValid;
 		int seriesNum;
-		QLabel *name;
+		QString name;
 		QList<double> muzzleVelocities;
 		QString velocityUnits;
-		QLabel *result;
 		QString firstDate;
 		QString firstTime;
-		QDoubleSpinBox *chargeWeight;
-		QPushButton *enterDataButton;
-		QPushButton *deleteButton;
-		QCheckBox *enabled;
-		bool deleted;
+		qint64 timestamp; // see TimestampParser
+		double chargeWeight;
+		bool enabled;
 	};
 
+	class ChronoSeriesModel;
+	class FolderWatch;
+
 	class PowderTest : public QWidget
 	{
 		Q_OBJECT
 
 		public:
 			PowderTest(QWidget *parent = 0);
-			~PowderTest() {};
+			~PowderTest();
 			QList<ChronoSeries *> seriesData;
 			QComboBox *weightUnits;
 
@@ -63,38 +65,59 @@ namespace Powder
 			void selectProChronoFile(bool);
 			void selectGarminFile(bool);
 			void selectShotMarkerFile(bool);
+			void watchFolderToggled(bool);
+			void watchedSeriesArrived(const QList<ChronoSeries*> &, const QList<ChronoSeries*> &);
 			void manualDataEntry(bool);
 			void prepareGarminFiles(bool);
 			void rrClicked(bool);
 			void addNewClicked(bool);
-			void enterDataClicked(bool);
-			void deleteClicked(bool);
+			void seriesTableClicked(const QModelIndex &);
 			void autofillClicked(bool);
 			void velocityUnitsChanged(int);
 			void headerCheckBoxChanged(int);
-			void seriesCheckBoxChanged(int);
-			void seriesManualCheckBoxChanged(int);
 			void showGraph(bool);
 			void saveGraph(bool);
+			void graphOptionChanged(void);
+			void refreshGraphPreview(void);
+			void publishSnapshot(void);
+			void saveSession(bool);
+			void loadSession(bool);
 
 		protected:
 			void optionCheckBoxChanged(QCheckBox *, QLabel *, QComboBox *);
 			void DisplaySeriesData(void);
+			void createManualEntryTable(void);
+			void connectSeriesModel(void);
+			void releaseSession(void);
+			void enterSeriesData(int);
+			void deleteSeries(int);
+			QString velocityUnitsText(void);
 			void renderGraph(bool);
+			GraphOptions getGraphOptions(void);
+			QList<QPair<QString, QWidget *> > sessionOptions(void);
+			static qint64 shotDataBytes(const void *);
 
 		private:
 			GraphPreview *graphPreview;
+			LiveGraph *liveGraph;
+			SnapshotPublisher<PowderSnapshot> publishedSeries;
+			bool graphPreviewRefreshPending;
+			bool renderingGraph;
 			QString prevLabRadarDir;
 			QString prevMagnetoSpeedDir;
 			QString prevProChronoDir;
 			QString prevGarminDir;
 			QString prevShotMarkerDir;
 			QString prevSaveDir;
+			QString prevSessionDir;
+			FileSelectionHandlers::Source importSource;
+			QString importPath;
+			FolderWatch *folderWatch;
 			QStackedWidget *stackedWidget;
-			QWidget *scrollWidget;
-			QScrollArea *scrollArea;
-			QGridLayout *seriesGrid;
-			QLabel *headerResult;
+			SeriesArena<ChronoSeries> seriesArena;
+			QWidget *seriesWidget;
+			QTableView *seriesTable;
+			ChronoSeriesModel *seriesModel;
 			QLineEdit *graphTitle;
 			QLineEdit *rifle;
 			QLineEdit *projectile;
@@ -111,6 +134,7 @@ namespace Powder
 			QCheckBox *avgCheckBox;
 			QCheckBox *vdCheckBox;
 			QCheckBox *trendCheckBox;
+			QCheckBox *densityCheckBox;
 			QComboBox *esLocation;
 			QComboBox *sdLocation;
 			QComboBox *avgLocation;
@@ -0,0 +1,435 @@
+#include "RenderBenchmark.h"
+#include "GraphRenderer.h"
+#include "PowderTest.h"
+#include "SeatingDepthTest.h"
+#include "TunerTest.h"
+#include "TimestampParser.h"
+#include "MemoryStats.h"
+
+#include "qcustomplot/qcustomplot.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QPixmap>
+#include <stdio.h>
+
+using namespace Powder;
+using namespace SeatingDepth;
+using namespace Tuner;
+
+// Keep repeating a render until this much time has passed, so small graphs get a stable average
+#define MIN_BENCHMARK_NSECS Q_INT64_C(250000000)
+
+// Shots in each generated powder series
+#define SHOTS_PER_SERIES 10
+
+namespace
+{
+	/* Small LCG so every run draws the same graphs */
+	class Generator
+	{
+	public:
+		Generator() : state(12345) {}
+
+		quint32 next()
+		{
+			state = (state * 1103515245u) + 12345u;
+			return state >> 8;
+		}
+
+		// 2800.0 - 2899.9 ft/s
+		double velocity()
+		{
+			return 2800 + ((next() % 1000) / 10.0);
+		}
+
+		// 0.200 - 1.199 inches
+		double groupSize()
+		{
+			return 0.2 + ((next() % 1000) / 1000.0);
+		}
+
+	private:
+		quint32 state;
+	};
+
+	struct RenderTimes
+	{
+		int runs;
+		qint64 layoutNsecs;
+		qint64 rasterNsecs;
+		qint64 encodeNsecs;
+		int pngBytes;
+	};
+
+	/* Draws the graph the same way the preview and savePng() do, timing the two steps separately */
+	void rasterise(QCustomPlot *customPlot, RenderTimes *times)
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		QPixmap pixmap = customPlot->toPixmap(1440, 625, 2.0);
+
+		times->rasterNsecs += timer.nsecsElapsed();
+		timer.restart();
+
+		QBuffer buffer;
+		buffer.open(QIODevice::WriteOnly);
+		pixmap.save(&buffer, "PNG");
+
+		times->encodeNsecs += timer.nsecsElapsed();
+		times->pngBytes = buffer.size();
+	}
+
+	void printTimes(const char *renderer, int numSeries, const QString &options, const RenderTimes &times)
+	{
+		double runs = times.runs;
+		printf("%-13s %6d  %-34s %5d %11.2f %11.2f %11.2f %9d\n", renderer, numSeries, qPrintable(options), times.runs,
+			times.layoutNsecs / 1e6 / runs, times.rasterNsecs / 1e6 / runs, times.encodeNsecs / 1e6 / runs, times.pngBytes / 1024);
+		fflush(stdout);
+	}
+
+	QString optionsText(const char *graphType, bool showTrend, bool showAnnotations, bool showDensity)
+	{
+		QString text(graphType);
+		if (showTrend)
+		{
+			text += " +trend";
+		}
+		if (showAnnotations)
+		{
+			text += " +annotations";
+		}
+		if (showDensity)
+		{
+			text += " +density";
+		}
+		return text;
+	}
+
+	const int seriesCounts[] = { 5, 50, 500 };
+
+	/* The tabs' buildGraph() reports a series it can't draw with a message box, which would wait
+	   forever offscreen. Check the generated series the same way before building anything. */
+	template <typename T>
+	bool graphable(const QList<T*> &seriesData)
+	{
+		if (seriesData.size() < 2)
+		{
+			return false;
+		}
+
+		foreach (T *series, seriesData)
+		{
+			if (!series->enabled || (series->manualEntry && (series->groupSize == 0)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int RenderBenchmark::run(const QStringList &arguments)
+{
+	int maxSeries = 500;
+	int index = arguments.indexOf("--benchmark-render");
+	if ((index >= 0) && (index + 1 < arguments.size()))
+	{
+		bool ok;
+		int value = arguments.at(index + 1).toInt(&ok);
+		if (ok && (value > 0))
+		{
+			maxSeries = value;
+		}
+	}
+
+	// Debug logging is disabled, so its arguments aren't even formatted during the timings
+	QLoggingCategory::setFilterRules("chronoplotter.*.debug=false");
+
+	// Same font the app draws with
+	registerFonts();
+
+	printf("%-13s %6s  %-34s %5s %11s %11s %11s %9s\n", "renderer", "series", "options", "runs", "layout ms", "raster ms", "encode ms", "png KB");
+
+	benchmarkPowder(maxSeries);
+	if (!benchmarkSeatingDepth(maxSeries) || !benchmarkTuner(maxSeries))
+	{
+		return 1;
+	}
+
+	// The peaks show what the largest graph held while it was drawn
+	printf("\n%s", qPrintable(MemoryStats::report()));
+
+	return 0;
+}
+
+void RenderBenchmark::benchmarkPowder(int maxSeries)
+{
+	for (unsigned int c = 0; c < sizeof(seriesCounts) / sizeof(seriesCounts[0]); c++)
+	{
+		int numSeries = seriesCounts[c];
+		if (numSeries > maxSeries)
+		{
+			break;
+		}
+
+		Generator generator;
+		QList<ChronoSeries*> seriesData;
+		for (int i = 0; i < numSeries; i++)
+		{
+			ChronoSeries *series = new ChronoSeries();
+			series->isValid = true;
+			series->seriesNum = i + 1;
+			series->name = QString("Series %1").arg(i + 1);
+			series->velocityUnits = "ft/s";
+			series->timestamp = INVALID_TIMESTAMP;
+			series->chargeWeight = 40.0 + (i * 0.1); // distinct, so proportional spacing doesn't prompt
+			series->enabled = true;
+			for (int j = 0; j < SHOTS_PER_SERIES; j++)
+			{
+				series->muzzleVelocities.append(generator.velocity());
+			}
+			seriesData.append(series);
+		}
+
+		PowderSnapshot *snapshot = PowderSnapshot::create(seriesData);
+
+		for (int graphType = SCATTER; graphType <= LINE_SD; graphType++)
+		{
+			for (int flags = 0; flags < 8; flags++)
+			{
+				bool showTrend = (flags & 1);
+				bool showAnnotations = (flags & 2);
+				bool showDensity = (flags & 4);
+
+				// Density shading only applies to scatter plots
+				if (showDensity && (graphType != SCATTER))
+				{
+					continue;
+				}
+
+				GraphOptions options;
+				options.graphType = graphType;
+				options.weightUnitsIndex = GRAINS;
+				options.velocityUnitsIndex = FPS;
+				options.xAxisSpacingIndex = PROPORTIONAL;
+				options.graphTitle = "Benchmark";
+				options.rifle = "Rifle";
+				options.projectile = "Projectile";
+				options.propellant = "Propellant";
+				options.brass = "Brass";
+				options.primer = "Primer";
+				options.weather = "Weather";
+				options.showES = showAnnotations;
+				options.esLocation = ABOVE_STRING;
+				options.showSD = showAnnotations;
+				options.sdLocation = ABOVE_STRING;
+				options.showAvg = showAnnotations;
+				options.avgLocation = BELOW_STRING;
+				options.showVD = showAnnotations;
+				options.vdLocation = BELOW_STRING;
+				options.showTrend = showTrend;
+				options.trendLineType = SOLID_LINE;
+				options.showDensity = showDensity;
+
+				RenderTimes times = {};
+				QElapsedTimer total;
+				total.start();
+				do
+				{
+					QElapsedTimer timer;
+					timer.start();
+
+					LiveGraph *liveGraph = GraphRenderer::buildGraph(NULL, *snapshot, options);
+
+					times.layoutNsecs += timer.nsecsElapsed();
+
+					rasterise(liveGraph->customPlot, &times);
+					GraphRenderer::deleteGraph(liveGraph);
+					times.runs++;
+				}
+				while (total.nsecsElapsed() < MIN_BENCHMARK_NSECS);
+
+				printTimes("Powder", numSeries, optionsText((graphType == SCATTER) ? "scatter" : "line + SD", showTrend, showAnnotations, showDensity), times);
+			}
+		}
+
+		delete snapshot;
+		qDeleteAll(seriesData);
+	}
+}
+
+bool RenderBenchmark::benchmarkSeatingDepth(int maxSeries)
+{
+	SeatingDepthTest tab;
+
+	for (unsigned int c = 0; c < sizeof(seriesCounts) / sizeof(seriesCounts[0]); c++)
+	{
+		int numSeries = seriesCounts[c];
+		if (numSeries > maxSeries)
+		{
+			break;
+		}
+
+		Generator generator;
+		for (int i = 0; i < numSeries; i++)
+		{
+			SeatingSeries *series = new SeatingSeries();
+			series->isValid = true;
+			series->seriesNum = i + 1;
+			series->name = QString("Series %1").arg(i + 1);
+			series->targetDistance = 100;
+			series->timestamp = INVALID_TIMESTAMP;
+			series->cartridgeLength = 2.800 + (i * 0.001); // distinct, so proportional spacing doesn't prompt
+			series->manualEntry = true;
+			series->groupSize = generator.groupSize();
+			series->tooFewShots = false;
+			series->enabled = true;
+			tab.seatingSeriesData.append(series);
+		}
+
+		bool valid = graphable(tab.seatingSeriesData);
+		foreach (SeatingSeries *series, tab.seatingSeriesData)
+		{
+			if (series->cartridgeLength == 0)
+			{
+				valid = false;
+			}
+		}
+
+		if (!valid)
+		{
+			fprintf(stderr, "Seating depth: generated series can't be graphed\n");
+			qDeleteAll(tab.seatingSeriesData);
+			tab.seatingSeriesData.clear();
+			return false;
+		}
+
+		for (int flags = 0; flags < 4; flags++)
+		{
+			bool showTrend = (flags & 1);
+			bool showAnnotations = (flags & 2);
+
+			tab.xAxisSpacing->setCurrentIndex(PROPORTIONAL);
+			tab.trendCheckBox->setChecked(showTrend);
+			tab.groupSizeCheckBox->setChecked(showAnnotations);
+			tab.gsdCheckBox->setChecked(showAnnotations);
+
+			RenderTimes times = {};
+			QElapsedTimer total;
+			total.start();
+			do
+			{
+				QElapsedTimer timer;
+				timer.start();
+
+				QCustomPlot *customPlot = tab.buildGraph();
+				if (customPlot == NULL)
+				{
+					fprintf(stderr, "Seating depth: failed to build the graph for %d series\n", numSeries);
+					qDeleteAll(tab.seatingSeriesData);
+					tab.seatingSeriesData.clear();
+					return false;
+				}
+
+				times.layoutNsecs += timer.nsecsElapsed();
+
+				rasterise(customPlot, &times);
+				delete customPlot;
+				times.runs++;
+			}
+			while (total.nsecsElapsed() < MIN_BENCHMARK_NSECS);
+
+			printTimes("Seating depth", numSeries, optionsText("line", showTrend, showAnnotations, false), times);
+		}
+
+		qDeleteAll(tab.seatingSeriesData);
+		tab.seatingSeriesData.clear();
+	}
+
+	return true;
+}
+
+bool RenderBenchmark::benchmarkTuner(int maxSeries)
+{
+	TunerTest tab;
+
+	for (unsigned int c = 0; c < sizeof(seriesCounts) / sizeof(seriesCounts[0]); c++)
+	{
+		int numSeries = seriesCounts[c];
+		if (numSeries > maxSeries)
+		{
+			break;
+		}
+
+		Generator generator;
+		for (int i = 0; i < numSeries; i++)
+		{
+			TunerSeries *series = new TunerSeries();
+			series->isValid = true;
+			series->seriesNum = i + 1;
+			series->name = QString("Series %1").arg(i + 1);
+			series->targetDistance = 100;
+			series->timestamp = INVALID_TIMESTAMP;
+			series->tunerSetting = i; // distinct, so proportional spacing doesn't prompt
+			series->manualEntry = true;
+			series->groupSize = generator.groupSize();
+			series->tooFewShots = false;
+			series->enabled = true;
+			tab.tunerSeriesData.append(series);
+		}
+
+		if (!graphable(tab.tunerSeriesData))
+		{
+			fprintf(stderr, "Tuner: generated series can't be graphed\n");
+			qDeleteAll(tab.tunerSeriesData);
+			tab.tunerSeriesData.clear();
+			return false;
+		}
+
+		for (int flags = 0; flags < 4; flags++)
+		{
+			bool showTrend = (flags & 1);
+			bool showAnnotations = (flags & 2);
+
+			tab.xAxisSpacing->setCurrentIndex(PROPORTIONAL);
+			tab.trendCheckBox->setChecked(showTrend);
+			tab.groupSizeCheckBox->setChecked(showAnnotations);
+			tab.gsdCheckBox->setChecked(showAnnotations);
+
+			RenderTimes times = {};
+			QElapsedTimer total;
+			total.start();
+			do
+			{
+				QElapsedTimer timer;
+				timer.start();
+
+				QCustomPlot *customPlot = tab.buildGraph();
+				if (customPlot == NULL)
+				{
+					fprintf(stderr, "Tuner: failed to build the graph for %d series\n", numSeries);
+					qDeleteAll(tab.tunerSeriesData);
+					tab.tunerSeriesData.clear();
+					return false;
+				}
+
+				times.layoutNsecs += timer.nsecsElapsed();
+
+				rasterise(customPlot, &times);
+				delete customPlot;
+				times.runs++;
+			}
+			while (total.nsecsElapsed() < MIN_BENCHMARK_NSECS);
+
+			printTimes("Tuner", numSeries, optionsText("smoothed line", showTrend, showAnnotations, false), times);
+		}
+
+		qDeleteAll(tab.tunerSeriesData);
+		tab.tunerSeriesData.clear();
+	}
+
+	return true;
+}
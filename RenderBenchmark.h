@@ -0,0 +1,28 @@
+#ifndef RENDER_BENCHMARK_H
+#define RENDER_BENCHMARK_H
+
+#include <QStringList>
+
+/*
+ * Times the powder, seating depth and tuner graph renderers on generated series. Run with:
+ *
+ *     ChronoPlotter --benchmark-render [maxSeries]
+ *
+ * Each renderer draws 5, 50 and 500 series (up to maxSeries) in every graph type with the trend line
+ * and annotations on and off. Layout, rasterisation and PNG encoding are timed separately. Nothing is
+ * shown, the platform defaults to offscreen. The exit code is 1 if a graph couldn't be built.
+ */
+class RenderBenchmark
+{
+public:
+	// Returns the process exit code
+	static int run(const QStringList &arguments);
+
+private:
+	static void benchmarkPowder(int maxSeries);
+	// False if a graph couldn't be built
+	static bool benchmarkSeatingDepth(int maxSeries);
+	static bool benchmarkTuner(int maxSeries);
+};
+
+#endif // RENDER_BENCHMARK_H
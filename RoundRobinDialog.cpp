@@ -1,5 +1,6 @@
 #include "PowderTest.h"
 #include "ChronoPlotter.h"
+#include "Logging.h"
 #include <QDialogButtonBox>
 #include <QVBoxLayout>
 #include <QLabel>
@@ -11,7 +12,7 @@ using namespace Powder;
 RoundRobinDialog::RoundRobinDialog(PowderTest *main, QDialog *parent)
 	: QDialog(parent)
 {
-	qDebug() << "Round-robin dialog";
+	qCDebug(lcUi) << "Round-robin dialog";
 
 	setWindowTitle("Convert from round-robin");
 
@@ -29,14 +30,14 @@ RoundRobinDialog::RoundRobinDialog(PowderTest *main, QDialog *parent)
 	for (int i = 0; i < main->seriesData.size(); i++)
 	{
 		ChronoSeries *series = main->seriesData.at(i);
-		if (series->enabled->isChecked())
+		if (series->enabled)
 		{
 			seriesVelocs.append(series->muzzleVelocities);
 		}
 	}
 
-	qDebug() << "Number of enabled series:" << seriesVelocs.size();
-	qDebug() << "seriesVelocs:" << seriesVelocs;
+	qCDebug(lcUi) << "Number of enabled series:" << seriesVelocs.size();
+	LOG_TRACE(lcStatsTrace) << "seriesVelocs:" << seriesVelocs;
 
 	QList<int> numVelocs;
 	for (int i = 0; i < seriesVelocs.size(); i++)
@@ -44,11 +45,11 @@ RoundRobinDialog::RoundRobinDialog(PowderTest *main, QDialog *parent)
 		numVelocs.append(seriesVelocs.at(i).size());
 	}
 
-	qDebug() << "numVelocs:" << numVelocs;
+	qCDebug(lcUi) << "numVelocs:" << numVelocs;
 
 	bool equalLens = std::equal(numVelocs.begin() + 1, numVelocs.end(), numVelocs.begin());
 
-	qDebug() << "equalLens:" << equalLens;
+	qCDebug(lcUi) << "equalLens:" << equalLens;
 
 	QLabel *detected = new QLabel();
 	QDialogButtonBox *buttonBox;
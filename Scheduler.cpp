@@ -0,0 +1,433 @@
+#include "Scheduler.h"
+#include "Trace.h"
+#include "Logging.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProgressDialog>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <QDebug>
+
+// Don't flash a progress dialog for jobs that finish quickly
+#define PROGRESS_DIALOG_DELAY_MSECS 500
+
+namespace
+{
+	struct WorkerQueue
+	{
+		QMutex mutex;
+		QList<Job *> jobs[Job::PRIORITY_COUNT];
+	};
+
+	struct Pool
+	{
+		QList<QThread *> threads;
+		QVector<WorkerQueue *> queues;
+		QAtomicInt queued;
+		QAtomicInt nextQueue;
+
+		// Idle workers sleep on the condition, stopping is only read and written under the mutex
+		QMutex sleepMutex;
+		QWaitCondition wakeCondition;
+		bool stopping;
+	};
+
+	QMutex poolMutex;
+	Pool *pool = NULL;
+
+	thread_local int workerIndex = -1;
+
+	void shutdownScheduler()
+	{
+		Scheduler::shutdown();
+	}
+}
+
+CancellationToken::CancellationToken()
+	: flag(new QAtomicInt(0))
+{
+}
+
+void CancellationToken::cancel()
+{
+	flag->storeRelease(1);
+}
+
+bool CancellationToken::isCancelled() const
+{
+	return flag->loadAcquire() != 0;
+}
+
+Job::Job(Priority priority)
+	: jobPriority(priority), progressValue(0), progressMaximum(0), progressPending(0), completed(false), deleteWhenFinished(true)
+{
+}
+
+Job::~Job()
+{
+}
+
+Job::Priority Job::priority() const
+{
+	return jobPriority;
+}
+
+void Job::setToken(const CancellationToken &token)
+{
+	cancelToken = token;
+}
+
+CancellationToken Job::token() const
+{
+	return cancelToken;
+}
+
+bool Job::isCancelled() const
+{
+	return cancelToken.isCancelled();
+}
+
+bool Job::isFinished() const
+{
+	return completed;
+}
+
+void Job::cancel()
+{
+	cancelToken.cancel();
+}
+
+void Job::setProgress(int value, int maximum)
+{
+	progressValue.storeRelaxed(value);
+	progressMaximum.storeRelaxed(maximum);
+
+	// At most one report is waiting in the GUI thread's queue, it picks up the latest values
+	if (progressPending.testAndSetOrdered(0, 1))
+	{
+		QMetaObject::invokeMethod(this, "reportProgress", Qt::QueuedConnection);
+	}
+}
+
+void Job::finish()
+{
+}
+
+void Job::reportProgress()
+{
+	progressPending.storeOrdered(0);
+
+	emit progressRangeChanged(0, progressMaximum.loadRelaxed());
+	emit progressValueChanged(progressValue.loadRelaxed());
+}
+
+void Job::complete()
+{
+	finish();
+	completed = true;
+
+	emit finished();
+
+	if (deleteWhenFinished)
+	{
+		deleteLater();
+	}
+}
+
+FunctionJob::FunctionJob(Function function, void *context, Priority priority)
+	: Job(priority), function(function), context(context)
+{
+}
+
+void FunctionJob::run()
+{
+	function(this, context);
+}
+
+void Scheduler::submit(Job *job)
+{
+	// Jobs report back through the GUI thread's event loop
+	QThread *guiThread = QCoreApplication::instance()->thread();
+	if (job->thread() != guiThread)
+	{
+		job->moveToThread(guiThread);
+	}
+
+	startWorkers();
+
+	// Queueing under the sleep mutex means shutdown() either sees the job or we see it stopping
+	QMutexLocker locker(&pool->sleepMutex);
+	if (pool->stopping)
+	{
+		job->cancel();
+		QMetaObject::invokeMethod(job, "complete", Qt::QueuedConnection);
+		return;
+	}
+
+	// Work spawned by a job stays with its worker, everything else is spread around
+	int index = workerIndex;
+	if (index < 0)
+	{
+		index = (pool->nextQueue.fetchAndAddRelaxed(1) & 0x7fffffff) % pool->queues.size();
+	}
+
+	WorkerQueue *queue = pool->queues.at(index);
+	{
+		QMutexLocker queueLocker(&queue->mutex);
+		queue->jobs[job->priority()].append(job);
+	}
+
+	pool->queued.fetchAndAddRelease(1);
+	pool->wakeCondition.wakeOne();
+}
+
+bool Scheduler::run(Job *job, QWidget *parent, const QString &label)
+{
+	return run(QList<Job *>() << job, parent, label);
+}
+
+bool Scheduler::run(const QList<Job *> &jobs, QWidget *parent, const QString &label)
+{
+	if (jobs.isEmpty())
+	{
+		return true;
+	}
+
+	QEventLoop loop;
+
+	QProgressDialog dialog(label, "Cancel", 0, jobs.size(), parent);
+	dialog.setWindowModality(Qt::WindowModal);
+	dialog.setMinimumDuration(PROGRESS_DIALOG_DELAY_MSECS);
+
+	/* The dialog only blocks the window once it's shown, until then a second import could release
+	   the data these jobs are working on. Disable the window for the whole wait, the dialog is a
+	   window of its own and is enabled again. A nested run() finds the window already disabled. */
+	QWidget *window = (parent != NULL) ? parent->window() : NULL;
+	bool disabledWindow = (window != NULL) && window->isEnabled();
+	if (disabledWindow)
+	{
+		window->setEnabled(false);
+		dialog.setEnabled(true);
+	}
+
+	foreach (Job *job, jobs)
+	{
+		job->deleteWhenFinished = false;
+		QObject::connect(job, &Job::finished, &loop, &QEventLoop::quit);
+		QObject::connect(&dialog, &QProgressDialog::canceled, job, &Job::cancel);
+	}
+
+	// A single job can say how far it's got, a batch counts finished jobs
+	if (jobs.size() == 1)
+	{
+		QObject::connect(jobs.first(), &Job::progressRangeChanged, &dialog, &QProgressDialog::setRange);
+		QObject::connect(jobs.first(), &Job::progressValueChanged, &dialog, &QProgressDialog::setValue);
+	}
+
+	foreach (Job *job, jobs)
+	{
+		submit(job);
+	}
+
+	/* Jobs only complete inside an event loop on this thread. setValue() processes events on a modal
+	   dialog, so count after it, or a quit could be missed before exec() starts. */
+	for (;;)
+	{
+		if (jobs.size() > 1)
+		{
+			int done = 0;
+			foreach (Job *job, jobs)
+			{
+				done += job->isFinished() ? 1 : 0;
+			}
+			dialog.setValue(done);
+		}
+
+		bool allFinished = true;
+		foreach (Job *job, jobs)
+		{
+			allFinished = allFinished && job->isFinished();
+		}
+
+		if (allFinished)
+		{
+			break;
+		}
+
+		loop.exec();
+	}
+
+	if (disabledWindow)
+	{
+		window->setEnabled(true);
+	}
+
+	bool cancelled = false;
+	foreach (Job *job, jobs)
+	{
+		cancelled = cancelled || job->isCancelled();
+	}
+
+	qDeleteAll(jobs);
+
+	return !cancelled;
+}
+
+int Scheduler::workerCount()
+{
+	startWorkers();
+	return pool->queues.size();
+}
+
+bool Scheduler::isWorkerThread()
+{
+	return workerIndex >= 0;
+}
+
+void Scheduler::shutdown()
+{
+	QMutexLocker poolLocker(&poolMutex);
+	if (pool == NULL)
+	{
+		return;
+	}
+
+	{
+		QMutexLocker locker(&pool->sleepMutex);
+		if (pool->stopping)
+		{
+			return;
+		}
+		pool->stopping = true;
+	}
+
+	// Nobody will wait for what's still queued, only the jobs already running are finished
+	int dropped = 0;
+	foreach (WorkerQueue *queue, pool->queues)
+	{
+		QMutexLocker locker(&queue->mutex);
+		for (int p = 0; p < Job::PRIORITY_COUNT; p++)
+		{
+			dropped += queue->jobs[p].size();
+			qDeleteAll(queue->jobs[p]);
+			queue->jobs[p].clear();
+		}
+	}
+
+	{
+		QMutexLocker locker(&pool->sleepMutex);
+		pool->wakeCondition.wakeAll();
+	}
+
+	foreach (QThread *thread, pool->threads)
+	{
+		thread->wait();
+	}
+	qDeleteAll(pool->threads);
+	pool->threads.clear();
+
+	qCDebug(lcUi) << "Scheduler stopped, dropped" << dropped << "queued jobs";
+}
+
+void Scheduler::startWorkers()
+{
+	QMutexLocker locker(&poolMutex);
+	if (pool != NULL)
+	{
+		return;
+	}
+
+	pool = new Pool();
+	pool->stopping = false;
+
+	int count = qMax(1, QThread::idealThreadCount());
+	for (int i = 0; i < count; i++)
+	{
+		pool->queues.append(new WorkerQueue());
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		QThread *thread = QThread::create(&Scheduler::workerLoop, i);
+		thread->setObjectName(QString("worker %1").arg(i + 1));
+		pool->threads.append(thread);
+		thread->start();
+	}
+
+	qAddPostRoutine(shutdownScheduler);
+
+	qCDebug(lcUi) << "Scheduler started with" << count << "workers";
+}
+
+void Scheduler::workerLoop(int index)
+{
+	workerIndex = index;
+
+	for (;;)
+	{
+		Job *job = takeJob(index);
+		if (job != NULL)
+		{
+			pool->queued.fetchAndAddRelaxed(-1);
+			execute(job);
+			continue;
+		}
+
+		QMutexLocker locker(&pool->sleepMutex);
+		if (pool->stopping)
+		{
+			return;
+		}
+		if (pool->queued.loadAcquire() == 0)
+		{
+			pool->wakeCondition.wait(&pool->sleepMutex);
+		}
+	}
+}
+
+Job *Scheduler::takeJob(int index)
+{
+	int count = pool->queues.size();
+
+	for (int p = 0; p < Job::PRIORITY_COUNT; p++)
+	{
+		// Newest first from our own queue, its data is most likely still in cache
+		WorkerQueue *own = pool->queues.at(index);
+		{
+			QMutexLocker locker(&own->mutex);
+			if (!own->jobs[p].isEmpty())
+			{
+				return own->jobs[p].takeLast();
+			}
+		}
+
+		// Oldest first from the others
+		for (int i = 1; i < count; i++)
+		{
+			WorkerQueue *victim = pool->queues.at((index + i) % count);
+			QMutexLocker locker(&victim->mutex);
+			if (!victim->jobs[p].isEmpty())
+			{
+				return victim->jobs[p].takeFirst();
+			}
+		}
+	}
+
+	return NULL;
+}
+
+void Scheduler::execute(Job *job)
+{
+	if (!job->isCancelled())
+	{
+		TRACE_SPAN("scheduler", "job");
+		job->run();
+	}
+
+	QMetaObject::invokeMethod(job, "complete", Qt::QueuedConnection);
+}
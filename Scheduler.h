@@ -0,0 +1,144 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+
+class QWidget;
+
+/*
+ * Shared cancel flag. Copies refer to the same flag, so one token can cancel a whole batch of jobs.
+ */
+class CancellationToken
+{
+public:
+	CancellationToken();
+
+	void cancel();
+	bool isCancelled() const;
+
+private:
+	QSharedPointer<QAtomicInt> flag;
+};
+
+/*
+ * A unit of work for the Scheduler. run() is called on a worker thread and must not touch widgets,
+ * finish() is then called on the GUI thread, followed by the finished() signal. The job deletes
+ * itself afterwards, so keep results in something the submitter owns.
+ *
+ * Long jobs should check isCancelled() between steps and report how far they've got with
+ * setProgress(). A job that is cancelled before it starts is never run, but finish() and finished()
+ * are still delivered.
+ */
+class Job : public QObject
+{
+	Q_OBJECT
+
+	friend class Scheduler;
+
+public:
+	// Queued jobs are started in this order, so an interactive preview doesn't wait behind an export
+	enum Priority
+	{
+		INTERACTIVE,
+		NORMAL,
+		BATCH,
+		PRIORITY_COUNT
+	};
+
+	Job(Priority priority = NORMAL);
+	virtual ~Job();
+
+	Priority priority() const;
+
+	// Replaces the job's own token, e.g. to cancel a batch together. Call before submitting.
+	void setToken(const CancellationToken &token);
+	CancellationToken token() const;
+	bool isCancelled() const;
+
+	// True once finish() has run
+	bool isFinished() const;
+
+	// Thread safe. Updates are coalesced, the GUI thread only sees the latest.
+	void setProgress(int value, int maximum);
+
+public slots:
+	void cancel();
+
+signals:
+	void progressRangeChanged(int minimum, int maximum);
+	void progressValueChanged(int value);
+	void finished();
+
+protected:
+	virtual void run() = 0;
+	virtual void finish();
+
+private slots:
+	void reportProgress();
+	void complete();
+
+private:
+	Priority jobPriority;
+	CancellationToken cancelToken;
+	QAtomicInt progressValue;
+	QAtomicInt progressMaximum;
+	QAtomicInt progressPending;
+	bool completed;
+	bool deleteWhenFinished;
+};
+
+/*
+ * Runs a plain function with a context pointer, for work that doesn't need its own Job subclass
+ */
+class FunctionJob : public Job
+{
+public:
+	typedef void (*Function)(Job *job, void *context);
+
+	FunctionJob(Function function, void *context, Priority priority = NORMAL);
+
+protected:
+	virtual void run() Q_DECL_OVERRIDE;
+
+private:
+	Function function;
+	void *context;
+};
+
+/*
+ * The application's worker pool, one thread per core. Every worker has its own queue for each
+ * priority. Jobs submitted from a worker go to that worker's queue and are taken newest first,
+ * jobs from the GUI thread are spread over the queues. An idle worker steals the oldest job from
+ * the others, always taking the most urgent priority available anywhere first.
+ */
+class Scheduler
+{
+public:
+	// Takes ownership of the job
+	static void submit(Job *job);
+
+	/* Runs the jobs and waits for all of them with a local event loop, so the window keeps painting.
+	   The parent's window takes no input meanwhile, and a progress dialog with a cancel button
+	   appears if they take more than half a second. Returns false if they were cancelled. The jobs
+	   are deleted when this returns. */
+	static bool run(Job *job, QWidget *parent, const QString &label);
+	static bool run(const QList<Job *> &jobs, QWidget *parent, const QString &label);
+
+	static int workerCount();
+	static bool isWorkerThread();
+
+	// Cancels whatever is queued and stops the workers. Called when the application exits.
+	static void shutdown();
+
+private:
+	static void startWorkers();
+	static void workerLoop(int index);
+	static Job *takeJob(int index);
+	static void execute(Job *job);
+};
+
+#endif // SCHEDULER_H
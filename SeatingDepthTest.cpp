@@ -1,7 +1,19 @@
-#include "untar.h"
-#include "miniz.h"
+#include "ShotMarkerArchive.h"
+#include "ShotMarkerCsv.h"
+#include "ParseCache.h"
+#include "SessionFile.h"
 #include "ChronoPlotter.h"
 #include "SeatingDepthTest.h"
+#include "LabelLayout.h"
+#include "Trace.h"
+#include "TextCache.h"
+#include "TargetRenderer.h"
+#include "SeriesTable.h"
+#include "MemoryStats.h"
+#include "Scheduler.h"
+#include "Logging.h"
+
+#include <QTimer>
 
 using namespace SeatingDepth;
 
@@ -131,230 +143,168 @@ double SeatingDepthTest::calculateMR ( QList<QPair<double, double> > coordinates
 	return meanRadius;
 }
 
+namespace
+{
+	// What the ShotMarker import jobs read and fill in, owned by selectShotMarkerFile()
+	struct ShotMarkerImport
+	{
+		QString path;
+		ShotMarkerCsv csv;
+		bool csvOpened;
+		QList<int> selected;
+		SeriesStore store;
+	};
+
+	// One worker's share of the imported series
+	struct GroupMetricsChunk
+	{
+		SeatingDepthTest *test;
+		QList<SeatingSeries *> series;
+	};
+}
+
+static void readShotMarkerArchive ( Job *, void *context )
+{
+	ShotMarkerImport *import = (ShotMarkerImport *)context;
+
+	ParseCache cache("shotmarker-coordinates");
+	cache.addFile(import->path);
+
+	if ( cache.load(&import->store) )
+	{
+		qCDebug(lcImport) << "ShotMarker data from the parse cache";
+	}
+	else
+	{
+		QSharedPointer<const ShotMarkerArchive> archive = ShotMarkerArchive::open(import->path);
+		if ( archive )
+		{
+			archive->appendCoordinateSeries(&import->store);
+		}
+
+		cache.save(import->store);
+	}
+}
+
+static void openShotMarkerCsv ( Job *, void *context )
+{
+	ShotMarkerImport *import = (ShotMarkerImport *)context;
+	import->csvOpened = import->csv.open(import->path);
+}
+
+static void readShotMarkerCsv ( Job *, void *context )
+{
+	ShotMarkerImport *import = (ShotMarkerImport *)context;
+	import->csv.appendCoordinateSeries(import->selected, &import->store);
+}
+
 void SeatingDepthTest::selectShotMarkerFile ( bool state )
 {
-	qDebug() << "selectShotMarkerFile state =" << state;
+	qCDebug(lcImport) << "selectShotMarkerFile state =" << state;
 
-	qDebug() << "Previous directory:" << prevShotMarkerDir;
+	qCDebug(lcImport) << "Previous directory:" << prevShotMarkerDir;
 
 	QString path = QFileDialog::getOpenFileName(this, "Select file", prevShotMarkerDir, "ShotMarker files (*.csv *.tar)");
 	prevShotMarkerDir = path;
 
-	qDebug() << "Selected file:" << path;
+	qCDebug(lcImport) << "Selected file:" << path;
 
 	if ( path.isEmpty() )
 	{
-		qDebug() << "User didn't select a file, bail";
+		qCDebug(lcImport) << "User didn't select a file, bail";
 		return;
 	}
 
-	seatingSeriesData.clear();
-
 	/*
 	 * ShotMarker records all of its series data in a single .CSV file
 	 */
 
-	QList<SeatingSeries *> allSeries;
+	ShotMarkerImport import;
+	import.path = path;
+	import.csvOpened = false;
 
 	if ( path.endsWith(".tar") )
 	{
-		qDebug() << "ShotMarker .tar bundle";
+		qCDebug(lcImport) << "ShotMarker .tar bundle";
 
-		allSeries = ExtractShotMarkerSeriesTar(path);
+		if ( ! Scheduler::run(new FunctionJob(readShotMarkerArchive, &import, Job::INTERACTIVE), this, "Reading ShotMarker data...") )
+		{
+			qCDebug(lcImport) << "User cancelled reading the file, bail";
+			return;
+		}
 	}
 	else
 	{
-		qDebug() << "ShotMarker .csv export";
-
-		QFile csvFile(path);
-		csvFile.open(QIODevice::ReadOnly);
-		QTextStream csv(&csvFile);
-
-		allSeries = ExtractShotMarkerSeriesCsv(csv);
-
-		csvFile.close();
-	}
-
-	qDebug() << "Got allSeries with size" << allSeries.size();
-
-	if ( ! allSeries.empty() )
-	{
-		qDebug() << "Detected ShotMarker file";
+		qCDebug(lcImport) << "ShotMarker .csv export";
 
-		for ( int i = 0; i < allSeries.size(); i++ )
+		// Archived data exports can span years, so only the strings the user picks are parsed
+		if ( ! Scheduler::run(new FunctionJob(openShotMarkerCsv, &import, Job::INTERACTIVE), this, "Indexing ShotMarker export...") )
 		{
-			SeatingSeries *series = allSeries.at(i);
-
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
-
-			series->cartridgeLength = new QDoubleSpinBox();
-			series->cartridgeLength->setDecimals(3);
-			series->cartridgeLength->setSingleStep(0.001);
-			series->cartridgeLength->setMinimumWidth(100);
-			series->cartridgeLength->setMaximumWidth(100);
-
-			/*
-			 * ShotMarker internally records shot coordinates in millimeters (at least it appears to, from studying its file formats). String
-			 * export files (tar/JSON) record coordinates in mm with one decimal place. System export files (CSV) contain mm, inches, MOA, and
-			 * mils, but for some reason round mm to whole integers. Inches are the most precise measurement available in CSV files, but are
-			 * rounded to two decimal places as well. This means group size calculations may be slightly different for the same string between
-			 * .tar and .CSV files, since we're going to use highest precision values when they're available.
-			 *
-			 * We'd like to provide the user the ability to graph all group size calculations (ES, RSD, MR, etc.) with all units. The simplest
-			 * way is to just perform every calculation upfront and save the results. This saves a ton of complexity (and opportunity for bugs),
-			 * and the performance hit is pretty negligible.
-			 *
-			 * Iterate through each unit and perform each group size calculation, starting from inches. The results are then stored in QLists,
-			 * where each index correlates to the index constants used in groupUnits.
-			 */
-
-			/* Source coordinates are already in inches, perform calculations directly */
-
-			series->extremeSpread.append(calculateES(series->coordinates));
-			series->extremeSpread_sighters.append(calculateES(series->coordinates_sighters));
-			series->yStdev.append(calculateYStdev(series->coordinates));
-			series->yStdev_sighters.append(calculateYStdev(series->coordinates_sighters));
-			series->xStdev.append(calculateXStdev(series->coordinates));
-			series->xStdev_sighters.append(calculateXStdev(series->coordinates_sighters));
-			series->radialStdev.append(calculateRSD(series->coordinates));
-			series->radialStdev_sighters.append(calculateRSD(series->coordinates_sighters));
-			series->meanRadius.append(calculateMR(series->coordinates));
-			series->meanRadius_sighters.append(calculateMR(series->coordinates_sighters));
-
-			/* Convert inches to MOA */
-
-			// C++ is tricky here. If we don't cast targetDistance or 100 to a double, then calculations like 650 / 100 will return 6 instead of 6.5!
-			series->extremeSpread.append( series->extremeSpread.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->yStdev.append( series->yStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->xStdev.append( series->xStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->radialStdev.append( series->radialStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->meanRadius.append( series->meanRadius.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-
-			/* Convert inches to centimeters, then perform calculations */
+			qCDebug(lcImport) << "User cancelled indexing the file, bail";
+			return;
+		}
 
-			QList<QPair<double, double> > coordinatesCm;
-			for ( int i = 0; i < series->coordinates.size(); i++ )
+		if ( import.csvOpened )
+		{
+			if ( ! ShotMarkerCsv::selectStrings(this, import.csv, &import.selected) )
 			{
-				// convert inches to cm
-				coordinatesCm.append( QPair<double, double>(series->coordinates.at(i).first * 2.54, series->coordinates.at(i).second * 2.54) );
+				return;
 			}
 
-			QList<QPair<double, double> > coordinatesCm_sighters;
-			for ( int i = 0; i < series->coordinates_sighters.size(); i++ )
+			if ( ! Scheduler::run(new FunctionJob(readShotMarkerCsv, &import, Job::INTERACTIVE), this, "Reading ShotMarker data...") )
 			{
-				// convert inches to cm
-				coordinatesCm_sighters.append( QPair<double, double>(series->coordinates_sighters.at(i).first * 2.54, series->coordinates_sighters.at(i).second * 2.54) );
+				qCDebug(lcImport) << "User cancelled reading the file, bail";
+				return;
 			}
+		}
+	}
 
-			series->extremeSpread.append(calculateES(coordinatesCm));
-			series->extremeSpread_sighters.append(calculateES(coordinatesCm_sighters));
-			series->yStdev.append(calculateYStdev(coordinatesCm));
-			series->yStdev_sighters.append(calculateYStdev(coordinatesCm_sighters));
-			series->xStdev.append(calculateXStdev(coordinatesCm));
-			series->xStdev_sighters.append(calculateXStdev(coordinatesCm_sighters));
-			series->radialStdev.append(calculateRSD(coordinatesCm));
-			series->radialStdev_sighters.append(calculateRSD(coordinatesCm_sighters));
-			series->meanRadius.append(calculateMR(coordinatesCm));
-			series->meanRadius_sighters.append(calculateMR(coordinatesCm_sighters));
-
-			/* Convert inches to mils */
-
-			// mils = target distance (converted from yards to inches), divided by 1000. What elegance!
-			series->extremeSpread.append( series->extremeSpread.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->yStdev.append( series->yStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->xStdev.append( series->xStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->radialStdev.append( series->radialStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->meanRadius.append( series->meanRadius.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-
-			const char *groupUnits2;
-			if ( groupUnits->currentIndex() == INCH )
-			{
-				groupUnits2 = "in";
-			}
-			else if ( groupUnits->currentIndex() == MOA )
-			{
-				groupUnits2 = "MOA";
-			}
-			else if ( groupUnits->currentIndex() == CENTIMETER )
-			{
-				groupUnits2 = "cm";
-			}
-			else
-			{
-				groupUnits2 = "mil";
-			}
+	releaseSession();
 
-			if ( includeSightersCheckBox->isChecked() )
-			{
-				if ( groupMeasurementType->currentIndex() == ES )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->extremeSpread_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == YSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->yStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == XSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->xStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == RSD )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->radialStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->meanRadius_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
+	qCDebug(lcImport) << "Got store with size" << import.store.size();
 
-				qDebug() << "Series '" << series->name->text() << "' has ES" << series->extremeSpread_sighters << ", RSD" << series->radialStdev_sighters << ", and MR" << series->meanRadius_sighters << "(with sighters) at target distance" << series->targetDistance;
-			}
-			else
-			{
-				if ( groupMeasurementType->currentIndex() == ES )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->extremeSpread.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == YSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->yStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == XSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->xStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == RSD )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->radialStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->meanRadius.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
+	if ( ! import.store.isEmpty() )
+	{
+		qCDebug(lcImport) << "Detected ShotMarker file";
 
-				qDebug() << "Series '" << series->name->text() << "' has ES" << series->extremeSpread << ", RSD" << series->radialStdev << ", and MR" << series->meanRadius << "at target distance" << series->targetDistance;
-			}
+		QList<SeatingSeries *> newSeriesData;
+		for ( int i = 0; i < import.store.size(); i++ )
+		{
+			const SeriesRecord &record = import.store.at(i);
+
+			SeatingSeries *series = seriesArena.create();
+			series->isValid = record.isValid;
+			series->seriesNum = record.seriesNum;
+			series->name = record.name;
+			series->coordinates = import.store.coordinates(i, false);
+			series->coordinates_sighters = import.store.coordinates(i, true);
+			series->targetDistance = record.targetDistance;
+			series->firstDate = record.firstDate;
+			series->firstTime = record.firstTime;
+			series->timestamp = record.timestamp;
+			series->enabled = true;
+			series->tooFewShots = false;
+			series->manualEntry = false;
+			series->cartridgeLength = 0;
+
+			newSeriesData.append(series);
+		}
 
-			seatingSeriesData.append(series);
+		if ( ! calculateGroupSizes(newSeriesData) )
+		{
+			qCDebug(lcImport) << "User cancelled the group size calculations, bail";
+			releaseSession();
+			return;
 		}
+
+		seatingSeriesData = newSeriesData;
 	}
 
 	/* We're finished parsing the file */
 
 	if ( seatingSeriesData.empty() )
 	{
-		qDebug() << "Didn't find any shot data in this file, bail";
+		qCDebug(lcImport) << "Didn't find any shot data in this file, bail";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
@@ -364,7 +314,7 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 	}
 	else
 	{
-		qDebug() << "Detected ShotMarker file" << path;
+		qCDebug(lcImport) << "Detected ShotMarker file" << path;
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Information);
@@ -372,341 +322,246 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 		msg->setWindowTitle("Success");
 		msg->exec();
 
-		// Connect and enable 'Include sighters' checkbox
-		connect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
+		displayImportedSeries();
+	}
+}
 
-		includeSightersCheckBox->setEnabled(true);
-		includeSightersLabel->setStyleSheet("");
+void SeatingDepthTest::displayImportedSeries ( void )
+{
+	// Connect and enable 'Include sighters' checkbox
+	connect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
 
-		// Proceed to display the data
-		DisplaySeriesData();
+	includeSightersCheckBox->setEnabled(true);
+	includeSightersLabel->setStyleSheet("");
 
-		// Convenience function to disable any series with too few shots to calculate
-		updateDisplayedData();
-	}
+	// Proceed to display the data
+	DisplaySeriesData();
+
+	// Convenience function to disable any series with too few shots to calculate
+	updateDisplayedData();
+}
+
+void SeatingDepthTest::calculateGroupSizes ( SeatingSeries *series )
+{
+	calculateGroupMetrics(series);
+	updateGroupSizeText(series);
 }
 
-QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesTar ( QString path )
+bool SeatingDepthTest::calculateGroupSizes ( const QList<SeatingSeries *> &seriesList )
 {
-	QList<SeatingSeries *> allSeries;
-	SeatingSeries *curSeries = new SeatingSeries();
-	QTemporaryDir tempDir;
-	int ret;
+	// Series don't depend on each other, so give every worker a contiguous share of them
+	int chunkCount = qMin(Scheduler::workerCount(), seriesList.size());
+	QVector<GroupMetricsChunk> chunks(chunkCount);
 
-	if ( ! tempDir.isValid() )
+	CancellationToken token;
+	QList<Job *> jobs;
+	for ( int i = 0; i < chunkCount; i++ )
 	{
-		qDebug() << "Temp directory is NOT valid";
-	}
+		int first = i * seriesList.size() / chunkCount;
+		int last = (i + 1) * seriesList.size() / chunkCount;
 
-	qDebug() << "Temporary directory:" << tempDir.path();
+		chunks[i].test = this;
+		chunks[i].series = seriesList.mid(first, last - first);
 
-	/*
-	 * ShotMarker .tar files contain one .z file for each string being exported.
-	 * Each .z file is a zlib-compressed JSON file containing shot data for that string.
-	 */
+		Job *job = new FunctionJob(groupMetricsJob, &chunks[i], Job::NORMAL);
+		job->setToken(token);
+		jobs.append(job);
+	}
 
-	QFile rf(path);
-	if ( ! rf.open(QIODevice::ReadOnly) )
+	if ( ! Scheduler::run(jobs, this, "Calculating group sizes...") )
 	{
-		qDebug() << "Failed to open ShotMarker .tar file:" << path;
-		return allSeries;
+		return false;
 	}
 
-	ret = untar(rf, tempDir.path());
-	if ( ret )
+	// The text depends on the unit and measurement widgets, so it's filled in back on the GUI thread
+	for ( int i = 0; i < seriesList.size(); i++ )
 	{
-		qDebug() << "Error while extracting ShotMarker .tar file:" << path;
-		return allSeries;
+		updateGroupSizeText(seriesList.at(i));
 	}
 
-	/*
-	 * We have a temp directory with our extracted files in it. Now iterate over each .z
-	 * file and decompress it.
-	 */
+	return true;
+}
 
-	QDir dir(tempDir.path());
-	QStringList stringFiles = dir.entryList(QStringList() << "*.z", QDir::Files);
+void SeatingDepthTest::groupMetricsJob ( Job *job, void *context )
+{
+	GroupMetricsChunk *chunk = (GroupMetricsChunk *)context;
 
-	qDebug() << "iterating over files:";
-	int seriesNum = 1;
-	foreach ( QString filename, stringFiles )
+	for ( int i = 0; i < chunk->series.size(); i++ )
 	{
-		QString path(tempDir.path());
-		path.append("/");
-		path.append(filename);
-		qDebug() << path;
-
-
-		QFile file(path);
-		file.open(QIODevice::ReadOnly);
-		QByteArray buf = file.readAll();
-		qDebug() << "file:" << path << ", size:" << buf.size();
-
-		// 1mb ought to be enough for anybody!
-		unsigned char *destBuf = (unsigned char *)malloc(1024 * 1024);
-		qDebug() << "malloc returned" << (void *)destBuf;
-		if ( destBuf == NULL )
+		if ( job->isCancelled() )
 		{
-			qDebug() << "malloc returned NULL! skipping... but we should really throw an exception here.";
-			continue;
+			return;
 		}
 
-		mz_ulong uncomp_len = 1024 * 1024;
-		qDebug() << "calling uncompress 1 with destBuf=" << (void *)destBuf << ", uncomp_len=" << uncomp_len << ", buf.data()=" << buf.data() << ", buf.size()=" << buf.size();
-		ret = uncompress(destBuf, &uncomp_len, (const unsigned char *)buf.data(), buf.size());
+		chunk->test->calculateGroupMetrics(chunk->series.at(i));
+		job->setProgress(i + 1, chunk->series.size());
+	}
+}
 
-		qDebug() << "output size:" << uncomp_len;
-		if ( ret != MZ_OK )
-		{
-			qDebug() << "Failed to uncompress, skipping..." << path;
-			free(destBuf);
-			continue;
-		}
+void SeatingDepthTest::calculateGroupMetrics ( SeatingSeries *series )
+{
+	TRACE_SPAN("stats", "group sizes");
 
-		//qDebug() << "calling uncompress 2 with destBuf=" << (void *)destBuf << ", uncomp_len=" << uncomp_len << ", buf.data()=" << buf.data() << ", buf.size()=" << buf.size();
-		//uncompress(destBuf, &uncomp_len, (const unsigned char *)buf.data(), buf.size());
-		QByteArray ba = QByteArray::fromRawData((const char *)destBuf, uncomp_len);
-		//qDebug() << "decompressed" << uncomp_len << ":" << ba;
+	/*
+	 * ShotMarker internally records shot coordinates in millimeters (at least it appears to, from studying its file formats). String
+	 * export files (tar/JSON) record coordinates in mm with one decimal place. System export files (CSV) contain mm, inches, MOA, and
+	 * mils, but for some reason round mm to whole integers. Inches are the most precise measurement available in CSV files, but are
+	 * rounded to two decimal places as well. This means group size calculations may be slightly different for the same string between
+	 * .tar and .CSV files, since we're going to use highest precision values when they're available.
+	 *
+	 * We'd like to provide the user the ability to graph all group size calculations (ES, RSD, MR, etc.) with all units. The simplest
+	 * way is to just perform every calculation upfront and save the results. This saves a ton of complexity (and opportunity for bugs),
+	 * and the performance hit is pretty negligible.
+	 *
+	 * Iterate through each unit and perform each group size calculation, starting from inches. The results are then stored in QLists,
+	 * where each index correlates to the index constants used in groupUnits.
+	 */
 
-		QJsonParseError parseError;
-		QJsonDocument jsonDoc;
-		jsonDoc = QJsonDocument::fromJson(ba, &parseError);
+	/* Source coordinates are already in inches, perform calculations directly */
+
+	series->extremeSpread.append(calculateES(series->coordinates));
+	series->extremeSpread_sighters.append(calculateES(series->coordinates_sighters));
+	series->yStdev.append(calculateYStdev(series->coordinates));
+	series->yStdev_sighters.append(calculateYStdev(series->coordinates_sighters));
+	series->xStdev.append(calculateXStdev(series->coordinates));
+	series->xStdev_sighters.append(calculateXStdev(series->coordinates_sighters));
+	series->radialStdev.append(calculateRSD(series->coordinates));
+	series->radialStdev_sighters.append(calculateRSD(series->coordinates_sighters));
+	series->meanRadius.append(calculateMR(series->coordinates));
+	series->meanRadius_sighters.append(calculateMR(series->coordinates_sighters));
+
+	/* Convert inches to MOA */
+
+	// C++ is tricky here. If we don't cast targetDistance or 100 to a double, then calculations like 650 / 100 will return 6 instead of 6.5!
+	series->extremeSpread.append( series->extremeSpread.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->yStdev.append( series->yStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->xStdev.append( series->xStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->radialStdev.append( series->radialStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->meanRadius.append( series->meanRadius.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+
+	/* Convert inches to centimeters, then perform calculations */
+
+	QList<QPair<double, double> > coordinatesCm;
+	for ( int i = 0; i < series->coordinates.size(); i++ )
+	{
+		// convert inches to cm
+		coordinatesCm.append( QPair<double, double>(series->coordinates.at(i).first * 2.54, series->coordinates.at(i).second * 2.54) );
+	}
+
+	QList<QPair<double, double> > coordinatesCm_sighters;
+	for ( int i = 0; i < series->coordinates_sighters.size(); i++ )
+	{
+		// convert inches to cm
+		coordinatesCm_sighters.append( QPair<double, double>(series->coordinates_sighters.at(i).first * 2.54, series->coordinates_sighters.at(i).second * 2.54) );
+	}
+
+	series->extremeSpread.append(calculateES(coordinatesCm));
+	series->extremeSpread_sighters.append(calculateES(coordinatesCm_sighters));
+	series->yStdev.append(calculateYStdev(coordinatesCm));
+	series->yStdev_sighters.append(calculateYStdev(coordinatesCm_sighters));
+	series->xStdev.append(calculateXStdev(coordinatesCm));
+	series->xStdev_sighters.append(calculateXStdev(coordinatesCm_sighters));
+	series->radialStdev.append(calculateRSD(coordinatesCm));
+	series->radialStdev_sighters.append(calculateRSD(coordinatesCm_sighters));
+	series->meanRadius.append(calculateMR(coordinatesCm));
+	series->meanRadius_sighters.append(calculateMR(coordinatesCm_sighters));
+
+	/* Convert inches to mils */
+
+	// mils = target distance (converted from yards to inches), divided by 1000. What elegance!
+	series->extremeSpread.append( series->extremeSpread.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->yStdev.append( series->yStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->xStdev.append( series->xStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->radialStdev.append( series->radialStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->meanRadius.append( series->meanRadius.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+}
+
+void SeatingDepthTest::updateGroupSizeText ( SeatingSeries *series )
+{
+	const char *groupUnits2;
+	if ( groupUnits->currentIndex() == INCH )
+	{
+		groupUnits2 = "in";
+	}
+	else if ( groupUnits->currentIndex() == MOA )
+	{
+		groupUnits2 = "MOA";
+	}
+	else if ( groupUnits->currentIndex() == CENTIMETER )
+	{
+		groupUnits2 = "cm";
+	}
+	else
+	{
+		groupUnits2 = "mil";
+	}
 
-		if ( parseError.error != QJsonParseError::NoError )
+	if ( includeSightersCheckBox->isChecked() )
+	{
+		if ( groupMeasurementType->currentIndex() == ES )
 		{
-			qDebug() << "JSON parse error, skipping... at" << parseError.offset << ":" << parseError.errorString();
-			free(destBuf);
-			continue;
+			series->groupSizeText = QString("%1 %2").arg(series->extremeSpread_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
-
-		QJsonObject jsonObj = jsonDoc.object();
-
-		/* We have a JSON file containing a single series */
-
-		qDebug() << "Beginning new series";
-
-		curSeries = new SeatingSeries();
-		curSeries->isValid = false;
-		curSeries->seriesNum = seriesNum;
-		qDebug() << "name =" << jsonObj["name"].toString();
-		curSeries->name = new QLabel(jsonObj["name"].toString() + QString(" (%1%2)").arg(jsonObj["dist"].toInt()).arg(jsonObj["dist_unit"].toString()));
-		curSeries->deleted = false;
-		QDateTime dateTime;
-		dateTime.setMSecsSinceEpoch(jsonObj["ts"].toVariant().toULongLong());
-		curSeries->firstDate = dateTime.date().toString(Qt::TextDate);
-		curSeries->firstTime = dateTime.time().toString(Qt::TextDate);
-
-		qDebug() << "setting date =" << curSeries->firstDate << " time =" << curSeries->firstTime << "from ts" << jsonObj["ts"].toVariant().toULongLong();
-
-		if ( jsonObj["dist_unit"].toString() == "y" )
+		else if ( groupMeasurementType->currentIndex() == YSTDEV )
 		{
-			// distance is in yards already
-			curSeries->targetDistance = jsonObj["dist"].toInt();
+			series->groupSizeText = QString("%1 %2").arg(series->yStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
-		else
+		else if ( groupMeasurementType->currentIndex() == XSTDEV )
 		{
-			// convert from meters to yards
-			curSeries->targetDistance = jsonObj["dist"].toInt() * 1.0936133; // the result is cast to an int
+			series->groupSizeText = QString("%1 %2").arg(series->xStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
-
-		foreach ( const QJsonValue& shot, jsonObj["shots"].toArray() )
+		else if ( groupMeasurementType->currentIndex() == RSD )
 		{
-			// convert from millimeters to inches
-			double xMm = shot["x"].toDouble() + jsonObj["cal_x"].toDouble();
-			double yMm = shot["y"].toDouble() + jsonObj["cal_y"].toDouble();
-
-			if ( shot["hidden"].toBool() )
-			{
-				// hidden shot
-
-				qDebug() << "ignoring hidden shot" << shot["display_text"];
-			}
-			else if ( shot["sighter"].toBool() )
-			{
-				// sighter shot
-
-				qDebug() << "adding coords (sighter)" << QPair<double,double>(xMm / 25.4, yMm / 25.4) << "from mm:" << QPair<double,double>(xMm, yMm);
-				curSeries->coordinates_sighters.append(QPair<double,double>(xMm / 25.4, yMm / 25.4));
-			}
-			else
-			{
-				// shot for record
-
-				qDebug() << "adding coords" << QPair<double,double>(xMm / 25.4, yMm / 25.4) << "from mm:" << QPair<double,double>(xMm, yMm);
-				curSeries->coordinates_sighters.append(QPair<double,double>(xMm / 25.4, yMm / 25.4));
-				curSeries->coordinates.append(QPair<double,double>(xMm / 25.4, yMm / 25.4));
-			}
-
+			series->groupSizeText = QString("%1 %2").arg(series->radialStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
-
-		// Finish parsing the current series.
-		qDebug() << "End of JSON";
-
-		if ( (curSeries->coordinates.size() > 0) || (curSeries->coordinates_sighters.size() > 0) )
+		else
 		{
-			qDebug() << "Adding curSeries to allSeries";
-
-			allSeries.append(curSeries);
+			series->groupSizeText = QString("%1 %2").arg(series->meanRadius_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
 
-		free(destBuf);
-
-		seriesNum++;
+		qCDebug(lcStats) << "Series '" << series->name << "' has ES" << series->extremeSpread_sighters << ", RSD" << series->radialStdev_sighters << ", and MR" << series->meanRadius_sighters << "(with sighters) at target distance" << series->targetDistance;
 	}
-
-	return allSeries;
-}
-
-QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesCsv ( QTextStream &csv )
-{
-	QList<SeatingSeries *> allSeries;
-	SeatingSeries *curSeries = new SeatingSeries();
-	curSeries->isValid = false;
-	curSeries->deleted = false;
-	curSeries->seriesNum = -1;
-
-	int i = 0;
-	int seriesNum = 1;
-	while ( ! csv.atEnd() )
+	else
 	{
-		QString line = csv.readLine();
-
-		// ShotMarker uses comma (,) as delimeter
-		QStringList rows(line.split(","));
-
-		// Trim whitespace from cells
-		QMutableStringListIterator it(rows);
-		while ( it.hasNext() )
+		if ( groupMeasurementType->currentIndex() == ES )
 		{
-			it.next();
-			it.setValue(it.value().trimmed());
+			series->groupSizeText = QString("%1 %2").arg(series->extremeSpread.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
-
-		qDebug() << "Line" << i << ":" << rows;
-
-		// Validate the first row header
-		if ( i == 0 )
+		else if ( groupMeasurementType->currentIndex() == YSTDEV )
 		{
-			if ( (rows.size() >= 1) && (rows.at(0).contains("ShotMarker Archived Data")) )
-			{
-				qDebug() << "Found the ShotMarker header";
-			}
-			else
-			{
-				qDebug() << "File doesn't have the ShotMarker header, bailing";
-				return allSeries;
-			}
+			series->groupSizeText = QString("%1 %2").arg(series->yStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
-
-		if ( rows.size() >= 5 )
+		else if ( groupMeasurementType->currentIndex() == XSTDEV )
 		{
-			// Check if first cell is a date, signifying the beginning of a new series
-			QDate seriesDate;
-			seriesDate = QDate::fromString(rows.at(0), "MMM d yyyy");
-			if ( seriesDate.isValid() )
-			{
-				 // End the previous series (if necessary) and start a new one
-
-				if ( (curSeries->coordinates.size() > 0) || (curSeries->coordinates_sighters.size() > 0) )
-				{
-					qDebug() << "Adding curSeries to allSeries";
-
-					allSeries.append(curSeries);
-				}
-
-				qDebug() << "Beginning new series";
-
-				curSeries = new SeatingSeries();
-				curSeries->isValid = false;
-				curSeries->seriesNum = seriesNum;
-				curSeries->name = new QLabel(rows.at(1) + QString(" (%1)").arg(rows.at(3)));
-				curSeries->deleted = false;
-				curSeries->firstDate = rows.at(0);
-
-				if ( rows.at(3).right(1) == "y" )
-				{
-					// distance is in yards already
-					QString distance = rows.at(3);
-					distance.chop(1);
-					curSeries->targetDistance = distance.toInt(NULL, 10);
-				}
-				else
-				{
-					// convert from meters to yards
-					QString distance = rows.at(3);
-					distance.chop(1);
-					curSeries->targetDistance = distance.toInt(NULL, 10) * 1.0936133; // the result is casted to an int
-				}
-
-				seriesNum++;
-			}
-			else if ( rows.size() >= 17 )
-			{
-				// This is either a row containing headers, shot data, or avg/SD summary data
-
-				QTime seriesTime;
-				seriesTime = QTime::fromString(rows.at(1), "h:mm:ss ap");
-				if ( seriesTime.isValid() )
-				{
-					// Rows with a time in the second cell are shot data
-
-					if ( curSeries->firstTime.isNull() )
-					{
-						curSeries->firstTime = rows.at(1);
-						qDebug() << "firstTime =" << curSeries->firstTime;
-					}
-
-					if ( rows.at(3).contains("hidden") )
-					{
-						// hidden shots
-
-						qDebug() << "ignoring hidden shot" << rows.at(2);
-					}
-					else if ( rows.at(3).contains("sighter") )
-					{
-						// sighter shots
-
-						qDebug() << "adding coords (sighter)" << QPair<double,double>(rows.at(7).toDouble(), rows.at(8).toDouble());
-
-						curSeries->coordinates_sighters.append(QPair<double,double>(rows.at(7).toDouble(), rows.at(8).toDouble()));
-					}
-					else
-					{
-						// all other shots for record
-
-						qDebug() << "adding coords" << QPair<double,double>(rows.at(7).toDouble(), rows.at(8).toDouble());
-
-						curSeries->coordinates_sighters.append(QPair<double,double>(rows.at(7).toDouble(), rows.at(8).toDouble()));
-						curSeries->coordinates.append(QPair<double,double>(rows.at(7).toDouble(), rows.at(8).toDouble()));
-					}
-				}
-			}
+			series->groupSizeText = QString("%1 %2").arg(series->xStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
+		}
+		else if ( groupMeasurementType->currentIndex() == RSD )
+		{
+			series->groupSizeText = QString("%1 %2").arg(series->radialStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
 		else
 		{
-			qDebug() << "Skipping line";
+			series->groupSizeText = QString("%1 %2").arg(series->meanRadius.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2);
 		}
 
-		i++;
-	}
-
-	// End of the file. Finish parsing the current series.
-	qDebug() << "End of file";
-
-	if ( (curSeries->coordinates.size() > 0) || (curSeries->coordinates_sighters.size() > 0) )
-	{
-		qDebug() << "Adding curSeries to allSeries";
-
-		allSeries.append(curSeries);
+		qCDebug(lcStats) << "Series '" << series->name << "' has ES" << series->extremeSpread << ", RSD" << series->radialStdev << ", and MR" << series->meanRadius << "at target distance" << series->targetDistance;
 	}
-
-	return allSeries;
 }
 
 AutofillDialog::AutofillDialog ( SeatingDepthTest *main, QDialog *parent )
 	: QDialog(parent)
 {
-	qDebug() << "Autofill dialog";
+	qCDebug(lcUi) << "Autofill dialog";
 
 	setWindowTitle("Auto-fill cartridge lengths");
 
@@ -783,16 +638,16 @@ AutofillValues *AutofillDialog::getValues ( void )
 
 void SeatingDepthTest::autofillClicked ( bool state )
 {
-	qDebug() << "autofillClicked state =" << state;
+	qCDebug(lcUi) << "autofillClicked state =" << state;
 
 	AutofillDialog *dialog = new AutofillDialog(this);
 	int result = dialog->exec();
 
-	qDebug() << "dialog result:" << result;
+	qCDebug(lcUi) << "dialog result:" << result;
 
 	if ( result )
 	{
-		qDebug() << "User OK'd dialog";
+		qCDebug(lcUi) << "User OK'd dialog";
 
 		AutofillValues *values = dialog->getValues();
 
@@ -801,10 +656,10 @@ void SeatingDepthTest::autofillClicked ( bool state )
 		for ( int i = 0; i < seatingSeriesData.size(); i++ )
 		{
 			SeatingSeries *series = seatingSeriesData.at(i);
-			if ( (! series->deleted) && series->enabled->isChecked() )
+			if ( series->enabled )
 			{
-				qDebug() << "Setting series" << i << "to" << currentLength;
-				series->cartridgeLength->setValue(currentLength);
+				qCDebug(lcUi) << "Setting series" << i << "to" << currentLength;
+				series->cartridgeLength = currentLength;
 				if ( values->increasing )
 				{
 					currentLength += values->interval;
@@ -815,134 +670,141 @@ void SeatingDepthTest::autofillClicked ( bool state )
 				}
 			}
 		}
+
+		seriesModel->refresh();
 	}
 	else
 	{
-		qDebug() << "User cancelled dialog";
+		qCDebug(lcUi) << "User cancelled dialog";
 	}
 }
 
 void SeatingDepthTest::addNewClicked ( bool state )
 {
-	qDebug() << "addNewClicked state =" << state;
+	qCDebug(lcUi) << "addNewClicked state =" << state;
 
 	// un-bold the button after the first click
 	addNewButton->setStyleSheet("");
 
-	int numRows = seatingSeriesGrid->rowCount();
+	SeatingSeries *series = seriesArena.create();
 
-	// Remove the stretch from the last row, we'll be using the row for our new series
-	seatingSeriesGrid->setRowStretch(numRows - 1, 0);
+	series->isValid = true;
+	series->enabled = true;
+	series->tooFewShots = false;
+	series->manualEntry = true;
+	series->timestamp = INVALID_TIMESTAMP;
+	series->cartridgeLength = 0;
+	series->groupSize = 0;
 
-	qDebug() << "numRows =" << numRows;
-
-	SeatingSeries *series = new SeatingSeries();
+	int newSeriesNum = 1;
+	if ( ! seatingSeriesData.isEmpty() )
+	{
+		newSeriesNum = seatingSeriesData.last()->seriesNum + 1;
+		qCDebug(lcUi) << "Found last series" << seatingSeriesData.last()->seriesNum << "(" << seatingSeriesData.last()->name << ")";
+	}
 
-	series->deleted = false;
+	series->seriesNum = newSeriesNum;
+	series->name = QString("Series %1").arg(newSeriesNum);
 
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
+	seriesModel->appendSeries(series);
+	seriesTable->scrollToBottom();
+}
 
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(series->enabled, numRows - 1, 0);
+void SeatingDepthTest::seriesTableClicked ( const QModelIndex &index )
+{
+	// Disabled rows still report clicks, but their buttons are greyed out
+	if ( ! (seriesModel->flags(index) & Qt::ItemIsEnabled) )
+	{
+		return;
+	}
 
-	int newSeriesNum = 1;
-	for ( int i = seatingSeriesData.size() - 1; i >= 0; i-- )
+	if ( seriesModel->isManualEntry() && (index.column() == SeatingSeriesModel::DELETE_COLUMN) )
 	{
-		SeatingSeries *series = seatingSeriesData.at(i);
-		if ( ! series->deleted )
-		{
-			newSeriesNum = series->seriesNum + 1;
-			qDebug() << "Found last un-deleted series" << series->seriesNum << "(" << series->name->text() << ") at index" << i;
-			break;
-		}
+		deleteSeries(index.row());
 	}
+}
 
-	series->seriesNum = newSeriesNum;
+void SeatingDepthTest::deleteSeries ( int row )
+{
+	SeatingSeries *series = seriesModel->seriesAt(row);
 
-	series->name = new QLabel(QString("Series %1").arg(newSeriesNum));
-	seatingSeriesGrid->addWidget(series->name, numRows - 1, 1);
+	qCDebug(lcUi) << "Series" << series->seriesNum << "(" << series->name << ") was deleted";
 
-	series->cartridgeLength = new QDoubleSpinBox();
-	series->cartridgeLength->setDecimals(3);
-	series->cartridgeLength->setSingleStep(0.001);
-	series->cartridgeLength->setMinimumWidth(100);
-	series->cartridgeLength->setMaximumWidth(100);
+	int newSeriesNum = series->seriesNum;
 
-	QHBoxLayout *cartridgeLengthLayout = new QHBoxLayout();
-	cartridgeLengthLayout->addWidget(series->cartridgeLength);
-	cartridgeLengthLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(cartridgeLengthLayout, numRows - 1, 2);
+	seriesModel->removeSeries(row);
+	seriesArena.destroy(series);
 
-	series->groupSize = new QDoubleSpinBox();
-	series->groupSize->setDecimals(3);
-	series->groupSize->setSingleStep(0.001);
-	series->groupSize->setMinimumWidth(100);
-	series->groupSize->setMaximumWidth(100);
+	// Renumber the series that followed the deleted one
+	for ( int i = row; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
 
-	QHBoxLayout *groupSizeLayout = new QHBoxLayout();
-	groupSizeLayout->addWidget(series->groupSize);
-	groupSizeLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(groupSizeLayout, numRows - 1, 3);
+		qCDebug(lcUi) << "Updating Series" << series->seriesNum << "to Series" << newSeriesNum;
 
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seatingSeriesGrid->addWidget(series->deleteButton, numRows - 1, 4, Qt::AlignLeft);
+		series->seriesNum = newSeriesNum;
+		series->name = QString("Series %1").arg(newSeriesNum);
 
-	seatingSeriesData.append(series);
+		newSeriesNum++;
+	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seatingSeriesGrid->setRowStretch(numRows, 1);
+	seriesModel->refresh();
 }
 
-void SeatingDepthTest::deleteClicked ( bool state )
+SeatingDepthTest::~SeatingDepthTest ( void )
 {
-	QPushButton *deleteButton = qobject_cast<QPushButton *>(sender());
-
-	qDebug() << "deleteClicked state =" << state;
+	MemoryStats::removeProbes(this);
+}
 
-	int newSeriesNum = -1;
+qint64 SeatingDepthTest::shotDataBytes ( const void *tab )
+{
+	const SeatingDepthTest *test = static_cast<const SeatingDepthTest *>(tab);
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	qint64 bytes = 0;
+	foreach ( const SeatingSeries *series, test->seatingSeriesData )
 	{
-		SeatingSeries *series = seatingSeriesData.at(i);
-		if ( deleteButton == series->deleteButton )
-		{
-			qDebug() << "Series" << series->seriesNum << "(" << series->name->text() << ") was deleted";
-
-			series->deleted = true;
-
-			series->enabled->hide();
-			series->name->hide();
-			series->cartridgeLength->hide();
-			series->groupSize->hide();
-			series->deleteButton->hide();
+		bytes += MemoryStats::listBytes(series->coordinates) + MemoryStats::listBytes(series->coordinates_sighters);
+		bytes += MemoryStats::stringBytes(series->name) + MemoryStats::stringBytes(series->firstDate) + MemoryStats::stringBytes(series->firstTime) + MemoryStats::stringBytes(series->groupSizeText);
+	}
 
-			newSeriesNum = series->seriesNum;
-		}
-		else if ( (! series->deleted) && newSeriesNum > 0 )
-		{
-			qDebug() << "Updating Series" << series->seriesNum << "to Series" << newSeriesNum;
+	return bytes;
+}
 
-			series->seriesNum = newSeriesNum;
-			series->name->setText(QString("Series %1").arg(newSeriesNum));
+qint64 SeatingDepthTest::metricCacheBytes ( const void *tab )
+{
+	const SeatingDepthTest *test = static_cast<const SeatingDepthTest *>(tab);
 
-			newSeriesNum++;
-		}
+	qint64 bytes = 0;
+	foreach ( const SeatingSeries *series, test->seatingSeriesData )
+	{
+		bytes += MemoryStats::listBytes(series->extremeSpread) + MemoryStats::listBytes(series->extremeSpread_sighters);
+		bytes += MemoryStats::listBytes(series->yStdev) + MemoryStats::listBytes(series->yStdev_sighters);
+		bytes += MemoryStats::listBytes(series->xStdev) + MemoryStats::listBytes(series->xStdev_sighters);
+		bytes += MemoryStats::listBytes(series->radialStdev) + MemoryStats::listBytes(series->radialStdev_sighters);
+		bytes += MemoryStats::listBytes(series->meanRadius) + MemoryStats::listBytes(series->meanRadius_sighters);
 	}
+
+	return bytes;
 }
 
 SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	: QWidget(parent)
 {
-	qDebug() << "Seating depth test";
+	qCDebug(lcUi) << "Seating depth test";
 
 	graphPreview = NULL;
+	targetPreview = NULL;
+	seriesWidget = NULL;
+	seriesTable = NULL;
+	seriesModel = NULL;
+	displayedDataRefreshPending = false;
 	prevShotMarkerDir = QDir::homePath();
 	prevSaveDir = QDir::homePath();
+	prevSessionDir = QDir::homePath();
+
+	// The series lists change in too many places to keep a counter, they're measured for each report
+	MemoryStats::addProbe(MemoryStats::SHOT_DATA, shotDataBytes, this);
+	MemoryStats::addProbe(MemoryStats::METRIC_CACHES, metricCacheBytes, this);
 
 	/* Left panel */
 
@@ -965,6 +827,13 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	manualEntryButton->setMinimumHeight(50);
 	manualEntryButton->setMaximumHeight(50);
 
+	QPushButton *loadSessionButton = new QPushButton("Load saved session");
+	connect(loadSessionButton, SIGNAL(clicked(bool)), this, SLOT(loadSession(bool)));
+	loadSessionButton->setMinimumWidth(300);
+	loadSessionButton->setMaximumWidth(300);
+	loadSessionButton->setMinimumHeight(50);
+	loadSessionButton->setMaximumHeight(50);
+
 	QVBoxLayout *placeholderLayout = new QVBoxLayout();
 	placeholderLayout->addStretch(0);
 	placeholderLayout->addWidget(selectLabel);
@@ -973,6 +842,8 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	placeholderLayout->setAlignment(smFileButton, Qt::AlignCenter);
 	placeholderLayout->addWidget(manualEntryButton);
 	placeholderLayout->setAlignment(manualEntryButton, Qt::AlignCenter);
+	placeholderLayout->addWidget(loadSessionButton);
+	placeholderLayout->setAlignment(loadSessionButton, Qt::AlignCenter);
 	placeholderLayout->addStretch(0);
 
 	QWidget *placeholderWidget = new QWidget();
@@ -1027,9 +898,6 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	connect(cartridgeMeasurementType, SIGNAL(activated(int)), this, SLOT(cartridgeMeasurementTypeChanged(int)));
 	optionsFormLayout->addRow(new QLabel("Cartridge measurement:"), cartridgeMeasurementType);
 
-	// create the header object that cartridgeMeasurementType controls
-	headerLengthType = new QLabel(cartridgeMeasurementType->currentText());
-
 	cartridgeUnits = new QComboBox();
 	cartridgeUnits->addItem("inches (in)");
 	cartridgeUnits->addItem("centimeters (cm)");
@@ -1044,30 +912,6 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	connect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(groupMeasurementTypeChanged(int)));
 	optionsFormLayout->addRow(new QLabel("Group size measurement:"), groupMeasurementType);
 
-	// create the header object that groupMeasurementType controls
-	const char *headerGroupType2;
-	if ( groupMeasurementType->currentIndex() == ES )
-	{
-		headerGroupType2 = "Group Size (ES)";
-	}
-	else if ( groupMeasurementType->currentIndex() == YSTDEV )
-	{
-		headerGroupType2 = "Group Size (Y Stdev)";
-	}
-	else if ( groupMeasurementType->currentIndex() == XSTDEV )
-	{
-		headerGroupType2 = "Group Size (X Stdev)";
-	}
-	else if ( groupMeasurementType->currentIndex() == RSD )
-	{
-		headerGroupType2 = "Group Size (RSD)";
-	}
-	else
-	{
-		headerGroupType2 = "Group Size (MR)";
-	}
-	headerGroupType = new QLabel(headerGroupType2);
-
 	groupUnits = new QComboBox();
 	groupUnits->addItem("inches (in)");
 	groupUnits->addItem("minutes (MOA)");
@@ -1154,6 +998,14 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	connect(saveGraphButton, SIGNAL(clicked(bool)), this, SLOT(saveGraph(bool)));
 	graphButtonsLayout->addWidget(saveGraphButton);
 
+	QPushButton *showTargetsButton = new QPushButton("Show target view");
+	connect(showTargetsButton, SIGNAL(clicked(bool)), this, SLOT(showTargets(bool)));
+	graphButtonsLayout->addWidget(showTargetsButton);
+
+	QPushButton *saveSessionButton = new QPushButton("Save session");
+	connect(saveSessionButton, SIGNAL(clicked(bool)), this, SLOT(saveSession(bool)));
+	graphButtonsLayout->addWidget(saveSessionButton);
+
 	graphButtonsLayout->addStretch(0);
 
 	/* Vertically position graph options and generate graph buttons */
@@ -1171,20 +1023,17 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 
 void SeatingDepthTest::loadNewShotData ( bool state )
 {
-	qDebug() << "loadNewShotData state =" << state;
+	qCDebug(lcImport) << "loadNewShotData state =" << state;
 
 	QMessageBox::StandardButton reply;
 	reply = QMessageBox::question(this, "Load new data", "Are you sure you want to load new shot data?\n\nThis will clear your current work.", QMessageBox::Yes | QMessageBox::Cancel);
 
 	if ( reply == QMessageBox::Yes )
 	{
-		qDebug() << "User said yes";
-
-		// Hide the shot data screen. This returns to the initial screen to choose a new shot data file.
-		stackedWidget->removeWidget(scrollWidget);
+		qCDebug(lcImport) << "User said yes";
 
-		// Delete the loaded shot data
-		seatingSeriesData.clear();
+		// Hide the shot data screen and free the loaded shot data. This returns to the initial screen to choose a new shot data file.
+		releaseSession();
 
 		// Disconnect the group measurement type signal (used in imported data entry), if necessary
 		disconnect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
@@ -1199,406 +1048,501 @@ void SeatingDepthTest::loadNewShotData ( bool state )
 	}
 	else
 	{
-		qDebug() << "User said cancel";
+		qCDebug(lcImport) << "User said cancel";
 	}
 }
 
-static bool SeatingSeriesComparator ( SeatingSeries *one, SeatingSeries *two )
+SeatingSeriesModel::SeatingSeriesModel ( QList<SeatingSeries*> *seriesData, bool manualEntry, QObject *parent )
+	: SeriesTableModel(parent)
 {
-	return (one->seriesNum < two->seriesNum);
+	this->seriesData = seriesData;
+	this->manualEntry = manualEntry;
+	deleteIcon = QApplication::style()->standardIcon(QStyle::SP_DialogCancelButton);
 }
 
-void SeatingDepthTest::DisplaySeriesData ( void )
+int SeatingSeriesModel::rowCount ( const QModelIndex &parent ) const
 {
-	// Sort the list by series number
-	std::sort(seatingSeriesData.begin(), seatingSeriesData.end(), SeatingSeriesComparator);
-
-	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
-	stackedWidget->removeWidget(scrollWidget);
+	if ( parent.isValid() )
+	{
+		return 0;
+	}
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+	return seriesData->size();
+}
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+int SeatingSeriesModel::columnCount ( const QModelIndex &parent ) const
+{
+	if ( parent.isValid() )
+	{
+		return 0;
+	}
 
-	seatingSeriesGrid = new QGridLayout(scrollAreaWidget);
-	seatingSeriesGrid->setColumnStretch(0, 0);
-	seatingSeriesGrid->setColumnStretch(1, 1);
-	seatingSeriesGrid->setColumnStretch(2, 2);
-	seatingSeriesGrid->setColumnStretch(3, 3);
-	seatingSeriesGrid->setColumnStretch(4, 3);
-	seatingSeriesGrid->setHorizontalSpacing(25);
+	return DATE_COLUMN + 1;
+}
 
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+QVariant SeatingSeriesModel::data ( const QModelIndex &index, int role ) const
+{
+	if ( (! index.isValid()) || (index.row() >= seriesData->size()) )
+	{
+		return QVariant();
+	}
 
-	scrollLayout->addWidget(scrollArea);
+	const SeatingSeries *series = seriesData->at(index.row());
 
-	/* Create utilities toolbar under scroll area */
+	switch ( index.column() )
+	{
+		case ENABLED_COLUMN:
+			if ( role == Qt::CheckStateRole )
+			{
+				return series->enabled ? Qt::Checked : Qt::Unchecked;
+			}
+			break;
 
-	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
-	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
-	loadNewButton->setMinimumWidth(225);
-	loadNewButton->setMaximumWidth(225);
+		case NAME_COLUMN:
+			if ( role == Qt::DisplayRole )
+			{
+				return series->name;
+			}
+			break;
 
-	QPushButton *autofillButton = new QPushButton("Auto-fill cartridge lengths");
-	connect(autofillButton, SIGNAL(clicked(bool)), this, SLOT(autofillClicked(bool)));
-	autofillButton->setMinimumWidth(225);
-	autofillButton->setMaximumWidth(225);
+		case CARTRIDGE_LENGTH_COLUMN:
+			if ( (role == Qt::DisplayRole) || (role == Qt::EditRole) )
+			{
+				return series->cartridgeLength;
+			}
+			break;
 
-	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
-	utilitiesLayout->addWidget(loadNewButton);
-	utilitiesLayout->addWidget(autofillButton);
+		case GROUP_SIZE_COLUMN:
+			if ( manualEntry && ((role == Qt::DisplayRole) || (role == Qt::EditRole)) )
+			{
+				return series->groupSize;
+			}
+			else if ( role == Qt::DisplayRole )
+			{
+				return series->groupSizeText;
+			}
+			break;
 
-	scrollLayout->addLayout(utilitiesLayout);
+		case DATE_COLUMN:
+			if ( manualEntry && (role == Qt::DecorationRole) )
+			{
+				return deleteIcon;
+			}
+			else if ( (! manualEntry) && (role == Qt::DisplayRole) )
+			{
+				return QString("%1 %2").arg(series->firstDate).arg(series->firstTime);
+			}
+			break;
+	}
 
-	scrollWidget = new QWidget();
-	scrollWidget->setLayout(scrollLayout);
+	return QVariant();
+}
 
-	stackedWidget->addWidget(scrollWidget);
-	stackedWidget->setCurrentWidget(scrollWidget);
+bool SeatingSeriesModel::setData ( const QModelIndex &index, const QVariant &value, int role )
+{
+	if ( (! index.isValid()) || (index.row() >= seriesData->size()) )
+	{
+		return false;
+	}
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(headerCheckBox, 0, 0);
+	SeatingSeries *series = seriesData->at(index.row());
 
-	/*
-	 * Connect signals to update all calculations in the Group Size column when the user selects a new group measurement type (ES, RSD, MR, etc.) or
-	 * measurement unit (in, MOA, cm, mil, etc.). This is only done for imported shot data, where the group sizes are QLabels and not user-controllable.
-	 */
+	if ( (index.column() == ENABLED_COLUMN) && (role == Qt::CheckStateRole) )
+	{
+		series->enabled = (value.toInt() == Qt::Checked);
+		qCDebug(lcUi) << "Series" << series->seriesNum << "enabled =" << series->enabled;
 
-	connect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
-	connect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+		// The rest of the row is greyed out along with the checkbox
+		seriesChanged(index.row());
+		return true;
+	}
 
-	/* Headers for series data */
+	if ( role != Qt::EditRole )
+	{
+		return false;
+	}
 
-	QLabel *headerNumber = new QLabel("Series Name");
-	seatingSeriesGrid->addWidget(headerNumber, 0, 1, Qt::AlignVCenter);
+	if ( index.column() == CARTRIDGE_LENGTH_COLUMN )
+	{
+		series->cartridgeLength = value.toDouble();
+	}
+	else if ( manualEntry && (index.column() == GROUP_SIZE_COLUMN) )
+	{
+		series->groupSize = value.toDouble();
+	}
+	else
+	{
+		return false;
+	}
 
-	// these two objects were previously created
-	seatingSeriesGrid->addWidget(headerLengthType, 0, 2, Qt::AlignVCenter);
-	seatingSeriesGrid->addWidget(headerGroupType, 0, 3, Qt::AlignVCenter);
+	markDirty(index.row(), index.column(), index.column());
+	return true;
+}
 
-	QLabel *headerDate = new QLabel("Series Date");
-	seatingSeriesGrid->addWidget(headerDate, 0, 4, Qt::AlignVCenter);
+QVariant SeatingSeriesModel::headerData ( int section, Qt::Orientation orientation, int role ) const
+{
+	if ( (orientation != Qt::Horizontal) || (role != Qt::DisplayRole) )
+	{
+		return QVariant();
+	}
 
-	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	switch ( section )
 	{
-		SeatingSeries *series = seatingSeriesData.at(i);
+		case NAME_COLUMN:
+			return QString("Series Name");
+		case CARTRIDGE_LENGTH_COLUMN:
+			return lengthHeader;
+		case GROUP_SIZE_COLUMN:
+			return groupSizeHeader;
+		case DATE_COLUMN:
+			return manualEntry ? QString("") : QString("Series Date");
+	}
 
-		connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesCheckBoxChanged(int)));
+	return QString("");
+}
 
-		seatingSeriesGrid->addWidget(series->enabled, i + 1, 0);
-		seatingSeriesGrid->addWidget(series->name, i + 1, 1, Qt::AlignVCenter);
+Qt::ItemFlags SeatingSeriesModel::flags ( const QModelIndex &index ) const
+{
+	if ( (! index.isValid()) || (index.row() >= seriesData->size()) )
+	{
+		return Qt::NoItemFlags;
+	}
 
-		QHBoxLayout *cartridgeLengthLayout = new QHBoxLayout();
-		cartridgeLengthLayout->addWidget(series->cartridgeLength);
-		cartridgeLengthLayout->addStretch(0);
-		seatingSeriesGrid->addLayout(cartridgeLengthLayout, i + 1, 2);
+	const SeatingSeries *series = seriesData->at(index.row());
 
-		seatingSeriesGrid->addWidget(series->groupSizeLabel, i + 1, 3, Qt::AlignVCenter);
+	if ( index.column() == ENABLED_COLUMN )
+	{
+		// Series with too few shots to calculate a group size can't be enabled
+		if ( series->tooFewShots )
+		{
+			return Qt::ItemIsUserCheckable;
+		}
 
-		QLabel *datetimeLabel = new QLabel(QString("%1 %2").arg(series->firstDate).arg(series->firstTime));
-		seatingSeriesGrid->addWidget(datetimeLabel, i + 1, 4, Qt::AlignVCenter);
+		return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+	}
 
-		seatingSeriesGrid->setRowMinimumHeight(0, series->cartridgeLength->sizeHint().height());
+	// Unchecked series are greyed out and can't be edited
+	if ( ! series->enabled )
+	{
+		return Qt::NoItemFlags;
 	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seatingSeriesGrid->setRowStretch(seatingSeriesData.size() + 1, 1);
+	if ( (index.column() == CARTRIDGE_LENGTH_COLUMN) || (manualEntry && (index.column() == GROUP_SIZE_COLUMN)) )
+	{
+		return Qt::ItemIsEnabled | Qt::ItemIsEditable;
+	}
 
-	scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-	scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-	scrollArea->setWidgetResizable(true);
+	return Qt::ItemIsEnabled;
 }
 
-void SeatingDepthTest::manualDataEntry ( bool state )
+bool SeatingSeriesModel::isManualEntry ( void ) const
 {
-	qDebug() << "manualDataEntry state =" << state;
-
-	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
-	stackedWidget->removeWidget(scrollWidget);
-
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
-
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
-
-	seatingSeriesGrid = new QGridLayout(scrollAreaWidget);
-	seatingSeriesGrid->setColumnStretch(0, 0);
-	seatingSeriesGrid->setColumnStretch(1, 1);
-	seatingSeriesGrid->setColumnStretch(2, 2);
-	seatingSeriesGrid->setColumnStretch(3, 2);
-	seatingSeriesGrid->setColumnStretch(4, 3);
-	seatingSeriesGrid->setHorizontalSpacing(25);
-
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+	return manualEntry;
+}
 
-	scrollLayout->addWidget(scrollArea);
+SeatingSeries *SeatingSeriesModel::seriesAt ( int row ) const
+{
+	return seriesData->at(row);
+}
 
-	/* Create utilities toolbar under scroll area */
+void SeatingSeriesModel::appendSeries ( SeatingSeries *series )
+{
+	beginInsertRows(QModelIndex(), seriesData->size(), seriesData->size());
+	seriesData->append(series);
+	endInsertRows();
+}
 
-	addNewButton = new QPushButton("Add new group");
-	addNewButton->setStyleSheet("font-weight: bold");
-	connect(addNewButton, SIGNAL(clicked(bool)), this, SLOT(addNewClicked(bool)));
-	addNewButton->setMinimumWidth(225);
-	addNewButton->setMaximumWidth(225);
+void SeatingSeriesModel::removeSeries ( int row )
+{
+	beginRemoveRows(QModelIndex(), row, row);
+	seriesData->removeAt(row);
+	endRemoveRows();
+}
 
-	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
-	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
-	loadNewButton->setMinimumWidth(225);
-	loadNewButton->setMaximumWidth(225);
+void SeatingSeriesModel::setAllEnabled ( bool enabled )
+{
+	for ( int i = 0; i < seriesData->size(); i++ )
+	{
+		SeatingSeries *series = seriesData->at(i);
 
-	QPushButton *autofillButton = new QPushButton("Auto-fill cartridge lengths");
-	connect(autofillButton, SIGNAL(clicked(bool)), this, SLOT(autofillClicked(bool)));
-	autofillButton->setMinimumWidth(225);
-	autofillButton->setMaximumWidth(225);
+		// Only rows that actually flip are repainted
+		if ( (! series->tooFewShots) && (series->enabled != enabled) )
+		{
+			series->enabled = enabled;
+			seriesChanged(i);
+		}
+	}
+}
 
-	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
-	utilitiesLayout->addWidget(addNewButton);
-	utilitiesLayout->addWidget(loadNewButton);
-	utilitiesLayout->addWidget(autofillButton);
+void SeatingSeriesModel::setLengthHeader ( const QString &header )
+{
+	lengthHeader = header;
+	emit headerDataChanged(Qt::Horizontal, CARTRIDGE_LENGTH_COLUMN, CARTRIDGE_LENGTH_COLUMN);
+}
 
-	scrollLayout->addLayout(utilitiesLayout);
+void SeatingSeriesModel::setGroupSizeHeader ( const QString &header )
+{
+	groupSizeHeader = header;
+	emit headerDataChanged(Qt::Horizontal, GROUP_SIZE_COLUMN, GROUP_SIZE_COLUMN);
+}
 
-	scrollWidget = new QWidget();
-	scrollWidget->setLayout(scrollLayout);
+void SeatingDepthTest::releaseSession ( void )
+{
+	// The table and its model are children of seriesWidget. deleteLater() since we may be inside one of its button handlers.
+	if ( seriesWidget != NULL )
+	{
+		stackedWidget->removeWidget(seriesWidget);
+		seriesWidget->deleteLater();
 
-	stackedWidget->addWidget(scrollWidget);
-	stackedWidget->setCurrentWidget(scrollWidget);
+		seriesWidget = NULL;
+		seriesTable = NULL;
+		seriesModel = NULL;
+	}
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(headerCheckBox, 0, 0);
+	// Every series of the session lives in the arena, free them all at once
+	seatingSeriesData.clear();
+	seriesArena.clear();
+}
 
-	/* Headers for series data */
+static bool SeatingSeriesComparator ( SeatingSeries *one, SeatingSeries *two )
+{
+	// Series from different files can share a number, keep those in the order they were recorded
+	if ( one->seriesNum != two->seriesNum )
+	{
+		return (one->seriesNum < two->seriesNum);
+	}
 
-	QLabel *headerNumber = new QLabel("Series Name");
-	seatingSeriesGrid->addWidget(headerNumber, 0, 1, Qt::AlignVCenter);
+	return (one->timestamp < two->timestamp);
+}
 
-	// this object was previously created
-	seatingSeriesGrid->addWidget(headerLengthType, 0, 2, Qt::AlignVCenter);
+QString SeatingDepthTest::groupSizeHeaderText ( void )
+{
+	int index = groupMeasurementType->currentIndex();
 
-	const char *headerGroupType2;
-	if ( groupMeasurementType->currentIndex() == ES )
+	if ( index == ES )
 	{
-		headerGroupType2 = "Group Size (ES)";
+		return QString("Group Size (ES)");
 	}
-	else if ( groupMeasurementType->currentIndex() == YSTDEV )
+	else if ( index == YSTDEV )
 	{
-		headerGroupType2 = "Group Size (Y Stdev)";
+		return QString("Group Size (Y Stdev)");
 	}
-	else if ( groupMeasurementType->currentIndex() == XSTDEV )
+	else if ( index == XSTDEV )
 	{
-		headerGroupType2 = "Group Size (X Stdev)";
+		return QString("Group Size (X Stdev)");
 	}
-	else if ( groupMeasurementType->currentIndex() == RSD )
+	else if ( index == RSD )
 	{
-		headerGroupType2 = "Group Size (RSD)";
+		return QString("Group Size (RSD)");
 	}
 	else
 	{
-		headerGroupType2 = "Group Size (MR)";
+		return QString("Group Size (MR)");
+	}
+}
+
+void SeatingDepthTest::DisplaySeriesData ( void )
+{
+	// Sort the list by series number
+	std::sort(seatingSeriesData.begin(), seatingSeriesData.end(), SeatingSeriesComparator);
+
+	// If we already have series data displayed, clear it out first. The table and model are children of the old widget.
+	if ( seriesWidget != NULL )
+	{
+		stackedWidget->removeWidget(seriesWidget);
+		seriesWidget->deleteLater();
 	}
 
-	headerGroupType = new QLabel(headerGroupType2);
-	seatingSeriesGrid->addWidget(headerGroupType, 0, 3, Qt::AlignVCenter);
-	QLabel *headerDelete = new QLabel("");
-	seatingSeriesGrid->addWidget(headerDelete, 0, 4, Qt::AlignVCenter);
+	seriesWidget = new QWidget();
 
-	/* Create initial row */
+	QVBoxLayout *seriesLayout = new QVBoxLayout();
 
-	SeatingSeries *series = new SeatingSeries();
+	QCheckBox *headerCheckBox = new QCheckBox("Select all");
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
+	seriesLayout->addWidget(headerCheckBox);
+
+	seriesModel = new SeatingSeriesModel(&seatingSeriesData, false, seriesWidget);
+	seriesModel->setLengthHeader(cartridgeMeasurementType->currentText());
+	seriesModel->setGroupSizeHeader(groupSizeHeaderText());
+
+	seriesTable = SeriesTable::createView(seriesModel);
+	seriesTable->setItemDelegateForColumn(SeatingSeriesModel::CARTRIDGE_LENGTH_COLUMN, new SpinBoxDelegate(3, 0.001, 99.99, seriesTable));
+
+	seriesLayout->addWidget(seriesTable);
+
+	/* Create utilities toolbar under the series table */
+
+	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
+	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
+	loadNewButton->setMinimumWidth(225);
+	loadNewButton->setMaximumWidth(225);
+
+	QPushButton *autofillButton = new QPushButton("Auto-fill cartridge lengths");
+	connect(autofillButton, SIGNAL(clicked(bool)), this, SLOT(autofillClicked(bool)));
+	autofillButton->setMinimumWidth(225);
+	autofillButton->setMaximumWidth(225);
 
-	series->deleted = false;
+	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
+	utilitiesLayout->addWidget(loadNewButton);
+	utilitiesLayout->addWidget(autofillButton);
 
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
+	seriesLayout->addLayout(utilitiesLayout);
 
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(series->enabled, 1, 0);
+	seriesWidget->setLayout(seriesLayout);
 
-	series->seriesNum = 1;
+	stackedWidget->addWidget(seriesWidget);
+	stackedWidget->setCurrentWidget(seriesWidget);
 
-	series->name = new QLabel("Series 1");
-	seatingSeriesGrid->addWidget(series->name, 1, 1);
+	/*
+	 * Connect signals to update all calculations in the Group Size column when the user selects a new group measurement type (ES, RSD, MR, etc.) or
+	 * measurement unit (in, MOA, cm, mil, etc.). This is only done for imported shot data, where the group sizes are calculated and not user-controllable.
+	 */
 
-	series->cartridgeLength = new QDoubleSpinBox();
-	series->cartridgeLength->setDecimals(3);
-	series->cartridgeLength->setSingleStep(0.001);
-	series->cartridgeLength->setMinimumWidth(100);
-	series->cartridgeLength->setMaximumWidth(100);
+	connect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
+	connect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+}
 
-	QHBoxLayout *cartridgeLengthLayout = new QHBoxLayout();
-	cartridgeLengthLayout->addWidget(series->cartridgeLength);
-	cartridgeLengthLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(cartridgeLengthLayout, 1, 2);
+void SeatingDepthTest::manualDataEntry ( bool state )
+{
+	qCDebug(lcUi) << "manualDataEntry state =" << state;
 
-	series->groupSize = new QDoubleSpinBox();
-	series->groupSize->setDecimals(3);
-	series->groupSize->setSingleStep(0.001);
-	series->groupSize->setMinimumWidth(100);
-	series->groupSize->setMaximumWidth(100);
+	// If we already have series data displayed, clear it out first
+	releaseSession();
 
-	QHBoxLayout *groupSizeLayout = new QHBoxLayout();
-	groupSizeLayout->addWidget(series->groupSize);
-	groupSizeLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(groupSizeLayout, 1, 3);
+	createManualEntryTable();
 
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seatingSeriesGrid->addWidget(series->deleteButton, 1, 4, Qt::AlignLeft);
+	/* Create initial row */
 
-	seatingSeriesGrid->setRowMinimumHeight(0, series->cartridgeLength->sizeHint().height());
+	SeatingSeries *series = seriesArena.create();
 
-	seatingSeriesData.append(series);
+	series->isValid = true;
+	series->enabled = true;
+	series->tooFewShots = false;
+	series->manualEntry = true;
+	series->timestamp = INVALID_TIMESTAMP;
+	series->cartridgeLength = 0;
+	series->groupSize = 0;
+	series->seriesNum = 1;
+	series->name = QString("Series 1");
 
-	// Add an empty stretch row at the end for proper spacing
-	seatingSeriesGrid->setRowStretch(seatingSeriesGrid->rowCount(), 1);
+	seriesModel->appendSeries(series);
 }
 
-void SeatingDepthTest::seriesCheckBoxChanged ( int state )
+void SeatingDepthTest::createManualEntryTable ( void )
 {
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	seriesWidget = new QWidget();
 
-	qDebug() << "seriesCheckBoxChanged state =" << state;
+	QVBoxLayout *seriesLayout = new QVBoxLayout();
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-	{
-		QWidget *rowCheckBox = seatingSeriesGrid->itemAtPosition(i, 0)->widget();
-		if ( checkBox == rowCheckBox )
-		{
-			QWidget *seriesName = seatingSeriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *cartridgeLength = seatingSeriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *groupSizeLabel = seatingSeriesGrid->itemAtPosition(i, 3)->widget();
-			QWidget *seriesDate = seatingSeriesGrid->itemAtPosition(i, 4)->widget();
+	QCheckBox *headerCheckBox = new QCheckBox("Select all");
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
+	seriesLayout->addWidget(headerCheckBox);
 
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
+	seriesModel = new SeatingSeriesModel(&seatingSeriesData, true, seriesWidget);
+	seriesModel->setLengthHeader(cartridgeMeasurementType->currentText());
+	seriesModel->setGroupSizeHeader(groupSizeHeaderText());
 
-				seriesName->setEnabled(true);
-				cartridgeLength->setEnabled(true);
-				groupSizeLabel->setEnabled(true);
-				seriesDate->setEnabled(true);
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
+	seriesTable = SeriesTable::createView(seriesModel);
+	seriesTable->setItemDelegateForColumn(SeatingSeriesModel::CARTRIDGE_LENGTH_COLUMN, new SpinBoxDelegate(3, 0.001, 99.99, seriesTable));
+	seriesTable->setItemDelegateForColumn(SeatingSeriesModel::GROUP_SIZE_COLUMN, new SpinBoxDelegate(3, 0.001, 99.99, seriesTable));
+	seriesTable->setItemDelegateForColumn(SeatingSeriesModel::DELETE_COLUMN, new ButtonDelegate(seriesTable));
+	connect(seriesTable, SIGNAL(clicked(const QModelIndex &)), this, SLOT(seriesTableClicked(const QModelIndex &)));
 
-				seriesName->setEnabled(false);
-				cartridgeLength->setEnabled(false);
-				groupSizeLabel->setEnabled(false);
-				seriesDate->setEnabled(false);
-			}
+	seriesLayout->addWidget(seriesTable);
 
-			return;
-		}
-	}
-}
+	/* Create utilities toolbar under the series table */
 
-void SeatingDepthTest::seriesManualCheckBoxChanged ( int state )
-{
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	addNewButton = new QPushButton("Add new group");
+	addNewButton->setStyleSheet("font-weight: bold");
+	connect(addNewButton, SIGNAL(clicked(bool)), this, SLOT(addNewClicked(bool)));
+	addNewButton->setMinimumWidth(225);
+	addNewButton->setMaximumWidth(225);
 
-	qDebug() << "seriesManualCheckBoxChanged state =" << state;
+	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
+	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
+	loadNewButton->setMinimumWidth(225);
+	loadNewButton->setMaximumWidth(225);
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-	{
-		QWidget *rowCheckBox = seatingSeriesGrid->itemAtPosition(i, 0)->widget();
-		if ( checkBox == rowCheckBox )
-		{
-			QWidget *seriesName = seatingSeriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *cartridgeLength = seatingSeriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *groupSize = seatingSeriesGrid->itemAtPosition(i, 3)->layout()->itemAt(0)->widget();
-			QWidget *deleteButton = seatingSeriesGrid->itemAtPosition(i, 4)->widget();
+	QPushButton *autofillButton = new QPushButton("Auto-fill cartridge lengths");
+	connect(autofillButton, SIGNAL(clicked(bool)), this, SLOT(autofillClicked(bool)));
+	autofillButton->setMinimumWidth(225);
+	autofillButton->setMaximumWidth(225);
 
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
+	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
+	utilitiesLayout->addWidget(addNewButton);
+	utilitiesLayout->addWidget(loadNewButton);
+	utilitiesLayout->addWidget(autofillButton);
 
-				seriesName->setEnabled(true);
-				cartridgeLength->setEnabled(true);
-				groupSize->setEnabled(true);
-				deleteButton->setEnabled(true);;
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
+	seriesLayout->addLayout(utilitiesLayout);
 
-				seriesName->setEnabled(false);
-				cartridgeLength->setEnabled(false);
-				groupSize->setEnabled(false);
-				deleteButton->setEnabled(false);
-			}
+	seriesWidget->setLayout(seriesLayout);
 
-			return;
-		}
-	}
+	stackedWidget->addWidget(seriesWidget);
+	stackedWidget->setCurrentWidget(seriesWidget);
 }
 
 void SeatingDepthTest::headerCheckBoxChanged ( int state )
 {
-	qDebug() << "headerCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "headerCheckBoxChanged state =" << state;
 
 	if ( state == Qt::Checked )
 	{
-		qDebug() << "Header checkbox was checked";
+		qCDebug(lcUi) << "Header checkbox was checked";
 
-		for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seatingSeriesGrid->itemAtPosition(i, 0)->widget());
-			if ( checkBox->isEnabled() )
-			{
-				checkBox->setChecked(true);
-			}
-		}
+		seriesModel->setAllEnabled(true);
 	}
 	else
 	{
-		qDebug() << "Header checkbox was unchecked";
+		qCDebug(lcUi) << "Header checkbox was unchecked";
 
-		for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seatingSeriesGrid->itemAtPosition(i, 0)->widget());
-			if ( checkBox->isEnabled() )
-			{
-				checkBox->setChecked(false);
-			}
-		}
+		seriesModel->setAllEnabled(false);
 	}
 }
 
 void SeatingDepthTest::groupSizeCheckBoxChanged ( bool state )
 {
-	qDebug() << "groupSizeCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "groupSizeCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(groupSizeCheckBox, groupSizeLabel, groupSizeLocation);
 }
 
 void SeatingDepthTest::gsdCheckBoxChanged ( bool state )
 {
-	qDebug() << "gsdCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "gsdCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(gsdCheckBox, gsdLabel, gsdLocation);
 }
 
 void SeatingDepthTest::trendCheckBoxChanged ( bool state )
 {
-	qDebug() << "trendCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "trendCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(trendCheckBox, trendLabel, trendLineType);
 }
 
+void SeatingDepthTest::displayedDataChanged ( void )
+{
+	// Coalesce bursts of changes (e.g. scrolling through the units box) into a single update
+	if ( ! displayedDataRefreshPending )
+	{
+		displayedDataRefreshPending = true;
+		QTimer::singleShot(0, this, SLOT(refreshDisplayedData()));
+	}
+}
+
+void SeatingDepthTest::refreshDisplayedData ( void )
+{
+	displayedDataRefreshPending = false;
+
+	// The table may have been released in the meantime
+	if ( seriesModel )
+	{
+		updateDisplayedData();
+	}
+}
+
 void SeatingDepthTest::updateDisplayedData ( void )
 {
 	// Update the series data to reflect any changes. The user could've either included/excluded sighters
@@ -1679,66 +1623,78 @@ void SeatingDepthTest::updateDisplayedData ( void )
 		}
 
 
+		QString groupSizeText = series->groupSizeText;
+		bool enabled = series->enabled;
+		bool tooFewShots = series->tooFewShots;
+
 		if ( includeSightersCheckBox->isChecked() )
 		{
-
-			qDebug() << "Setting series (sighters)" << i << "to" << groupMeasurementType2 << groupSize_sighters;
+			LOG_TRACE(lcStatsTrace) << "Setting series (sighters)" << i << "to" << groupMeasurementType2 << groupSize_sighters;
 
 			if ( qIsNaN(groupSize_sighters) )
 			{
-				// series doesn't have enough shots to calculate, so disable it altogether. unchecking the box triggers seriesCheckBoxChanged() to run
-				series->groupSizeLabel->setText("2+ shots required");
-				series->enabled->setChecked(false);
-				series->enabled->setEnabled(false);
+				// series doesn't have enough shots to calculate, so disable it altogether
+				groupSizeText = "2+ shots required";
+				enabled = false;
+				tooFewShots = true;
 			}
 			else
 			{
-				series->groupSizeLabel->setText(QString("%1 %2").arg(groupSize_sighters, 0, 'f', 3).arg(groupUnits2));
+				groupSizeText = QString("%1 %2").arg(groupSize_sighters, 0, 'f', 3).arg(groupUnits2);
 
 				if ( qIsNaN(groupSize) )
 				{
 					// transition from disabled series (no sighters) to enabled series (with sighters)
-					series->enabled->setChecked(true);
-					series->enabled->setEnabled(true);
+					enabled = true;
+					tooFewShots = false;
 				}
 			}
 		}
 		else
 		{
-			qDebug() << "Setting series" << i << "to" << groupMeasurementType2 << groupSize;
+			LOG_TRACE(lcStatsTrace) << "Setting series" << i << "to" << groupMeasurementType2 << groupSize;
 
 			if ( qIsNaN(groupSize) )
 			{
-				// series doesn't have enough shots to calculate, so disable it altogether. unchecking the box triggers seriesCheckBoxChanged() to run
-				series->groupSizeLabel->setText("2+ shots required");
-				series->enabled->setChecked(false);
-				series->enabled->setEnabled(false);
+				// series doesn't have enough shots to calculate, so disable it altogether
+				groupSizeText = "2+ shots required";
+				enabled = false;
+				tooFewShots = true;
 			}
 			else
 			{
-				series->groupSizeLabel->setText(QString("%1 %2").arg(groupSize, 0, 'f', 3).arg(groupUnits2));
+				groupSizeText = QString("%1 %2").arg(groupSize, 0, 'f', 3).arg(groupUnits2);
 
 				if ( qIsNaN(groupSize_sighters) )
 				{
 					// transition from disabled series (with sighters) to enabled series (no sighters)
-					series->enabled->setChecked(true);
-					series->enabled->setEnabled(true);
+					enabled = true;
+					tooFewShots = false;
 				}
 			}
 		}
+
+		// Only rows whose text or state changed are repainted
+		if ( (groupSizeText != series->groupSizeText) || (enabled != series->enabled) || (tooFewShots != series->tooFewShots) )
+		{
+			series->groupSizeText = groupSizeText;
+			series->enabled = enabled;
+			series->tooFewShots = tooFewShots;
+			seriesModel->seriesChanged(i);
+		}
 	}
 }
 
 void SeatingDepthTest::importedGroupIncludeSightersCheckBoxChanged ( bool state )
 {
-	qDebug() << "importedGroupIncludeSightersCheckBoxChanged state =" << state;
+	qCDebug(lcUi) << "importedGroupIncludeSightersCheckBoxChanged state =" << state;
 
-	updateDisplayedData();
+	displayedDataChanged();
 }
 
 void SeatingDepthTest::xAxisSpacingChanged ( int index )
 {
-	qDebug() << "xAxisSpacingChanged index =" << index;
+	qCDebug(lcUi) << "xAxisSpacingChanged index =" << index;
 
 	if ( index == CONSTANT )
 	{
@@ -1760,76 +1716,65 @@ void SeatingDepthTest::optionCheckBoxChanged ( QCheckBox *checkBox, QLabel *labe
 {
 	if ( checkBox->isChecked() )
 	{
-		qDebug() << "checkbox was checked";
+		qCDebug(lcUi) << "checkbox was checked";
 		comboBox->setEnabled(true);
 	}
 	else
 	{
-		qDebug() << "checkbox was unchecked";
+		qCDebug(lcUi) << "checkbox was unchecked";
 		comboBox->setEnabled(false);
 	}
 }
 
 void SeatingDepthTest::cartridgeMeasurementTypeChanged ( int index )
 {
-	qDebug() << "cartridgeMeasurementTypeChanged index =" << index;
+	qCDebug(lcUi) << "cartridgeMeasurementTypeChanged index =" << index;
 
-	headerLengthType->setText(cartridgeMeasurementType->currentText());
+	// The series table only exists once data has been loaded or manual entry started
+	if ( seriesModel )
+	{
+		seriesModel->setLengthHeader(cartridgeMeasurementType->currentText());
+	}
 }
 
 void SeatingDepthTest::groupMeasurementTypeChanged ( int index )
 {
-	qDebug() << "groupMeasurementTypeChanged index =" << index;
+	qCDebug(lcUi) << "groupMeasurementTypeChanged index =" << index;
 
-	if ( index == ES )
-	{
-		headerGroupType->setText("Group Size (ES)");
-	}
-	else if ( index == YSTDEV )
-	{
-		headerGroupType->setText("Group Size (Y Stdev)");
-	}
-	else if ( index == XSTDEV )
-	{
-		headerGroupType->setText("Group Size (X Stdev)");
-	}
-	else if ( index == RSD )
+	// The series table only exists once data has been loaded or manual entry started
+	if ( seriesModel )
 	{
-		headerGroupType->setText("Group Size (RSD)");
-	}
-	else
-	{
-		headerGroupType->setText("Group Size (MR)");
+		seriesModel->setGroupSizeHeader(groupSizeHeaderText());
 	}
 }
 
 void SeatingDepthTest::importedGroupMeasurementTypeChanged ( int index )
 {
-	qDebug() << "importedGroupMeasurementTypeChanged index =" << index;
+	qCDebug(lcUi) << "importedGroupMeasurementTypeChanged index =" << index;
 
 	/*
 	 * This signal handler is only connected in imported data entry mode. When the group measurement type is changed,
 	 * we need to iterate through and update every Group Size row to display the new measurement type.
 	 */
 
-	updateDisplayedData();
+	displayedDataChanged();
 }
 
 void SeatingDepthTest::importedGroupUnitsChanged ( int index )
 {
-	qDebug() << "importedGroupUnitsChanged index =" << index;
+	qCDebug(lcUi) << "importedGroupUnitsChanged index =" << index;
 
 	/*
 	 * This signal handler is only connected in imported data entry mode. When the group size units is changed,
 	 * we need to iterate through and update every Group Size row to display the new unit.
 	 */
 
-	updateDisplayedData();
+	displayedDataChanged();
 }
 
 void SeatingDepthTest::showGraph ( bool state )
 {
-	qDebug() << "showGraph state =" << state;
+	qCDebug(lcRender) << "showGraph state =" << state;
 
 	renderGraph(true);
 }
@@ -1837,7 +1782,7 @@ void SeatingDepthTest::showGraph ( bool state )
 
 void SeatingDepthTest::saveGraph ( bool state )
 {
-	qDebug() << "saveGraph state =" << state;
+	qCDebug(lcRender) << "saveGraph state =" << state;
 
 	renderGraph(false);
 }
@@ -1998,7 +1943,7 @@ public:
 
 void QCPSmoothGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
 {
-  qDebug() << "QCPSmoothGraph::drawLinePlot lines =" << lines;
+  LOG_TRACE(lcRenderTrace) << "QCPSmoothGraph::drawLinePlot lines =" << lines;
   if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
   {
     applyDefaultAntialiasingHint(painter);
@@ -2015,61 +1960,121 @@ void QCPSmoothGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &l
 
 static bool CartridgeLengthComparator ( SeatingSeries *one, SeatingSeries *two )
 {
-	return (one->cartridgeLength->value() < two->cartridgeLength->value());
+	return (one->cartridgeLength < two->cartridgeLength);
 }
 
-void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
+void SeatingDepthTest::showTargets ( bool state )
 {
-	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
+	qCDebug(lcRender) << "showTargets state =" << state;
+
+	/* Only imported strings have shot coordinates */
+
+	QList<SeatingSeries *> seriesToGraph;
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
+
+		if ( series->enabled && (! series->manualEntry) )
+		{
+			seriesToGraph.append(series);
+		}
+	}
+
+	if ( seriesToGraph.size() == 0 )
+	{
+		qCDebug(lcRender) << "No imported series enabled, bailing";
+
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText("The target view requires imported ShotMarker data!");
+		msg->setWindowTitle("Error");
+		msg->exec();
+		return;
+	}
+
+	std::sort(seriesToGraph.begin(), seriesToGraph.end(), CartridgeLengthComparator);
+
+	QStringList unitNames;
+	unitNames << "in" << "MOA" << "cm" << "mil";
+
+	QList<TargetPanel> panels;
+	for ( int i = 0; i < seriesToGraph.size(); i++ )
+	{
+		SeatingSeries *series = seriesToGraph.at(i);
+
+		TargetPanel panel;
+		panel.label = QString("%1 (%2 %3)").arg(series->name).arg(series->cartridgeLength).arg(cartridgeUnits->currentIndex() == INCH ? "in" : "cm");
+		panel.units = unitNames.at(groupUnits->currentIndex());
+		if ( includeSightersCheckBox->isChecked() )
+		{
+			panel.coordinates = series->coordinates_sighters;
+			panel.extremeSpread = series->extremeSpread_sighters.at(groupUnits->currentIndex());
+			panel.meanRadius = series->meanRadius_sighters.at(groupUnits->currentIndex());
+		}
+		else
+		{
+			panel.coordinates = series->coordinates;
+			panel.extremeSpread = series->extremeSpread.at(groupUnits->currentIndex());
+			panel.meanRadius = series->meanRadius.at(groupUnits->currentIndex());
+		}
+		panels.append(panel);
+	}
+
+	TargetRenderer::showTargets(panels, graphTitle->text(), &targetPreview);
+}
 
+QCustomPlot *SeatingDepthTest::buildGraph ( void )
+{
 	/* Validate series before continuing */
 
 	int numEnabled = 0;
 	for ( int i = 0; i < seatingSeriesData.size(); i++ )
 	{
 		SeatingSeries *series = seatingSeriesData.at(i);
-		if ( (! series->deleted) && series->enabled->isChecked() )
+		if ( series->enabled )
 		{
 			numEnabled += 1;
 
-			if ( series->cartridgeLength->value() == 0 )
+			if ( series->cartridgeLength == 0 )
 			{
-				qDebug() << series->name->text() << "is missing cartridge length, bailing";
+				qCDebug(lcRender) << series->name << "is missing cartridge length, bailing";
 
 				QMessageBox *msg = new QMessageBox();
 				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("%1 is missing cartridge length!").arg(series->name->text()));
+				msg->setText(QString("%1 is missing cartridge length!").arg(series->name));
 				msg->setWindowTitle("Error");
 				msg->exec();
-				return;
+				return NULL;
 			}
 
-			if ( series->groupSize && (series->groupSize->value() == 0) )
+			if ( series->manualEntry && (series->groupSize == 0) )
 			{
-				qDebug() << series->name->text() << "is missing group size, bailing";
+				qCDebug(lcRender) << series->name << "is missing group size, bailing";
 
 				QMessageBox *msg = new QMessageBox();
 				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("%1 is missing group size!").arg(series->name->text()));
+				msg->setText(QString("%1 is missing group size!").arg(series->name));
 				msg->setWindowTitle("Error");
 				msg->exec();
-				return;
+				return NULL;
 			}
 		}
 	}
 
 	if ( numEnabled < 2 )
 	{
-		qDebug() << "Only" << numEnabled << "series enabled, bailing";
+		qCDebug(lcRender) << "Only" << numEnabled << "series enabled, bailing";
 
 		QMessageBox *msg = new QMessageBox();
 		msg->setIcon(QMessageBox::Critical);
 		msg->setText("At least two series are required to graph!");
 		msg->setWindowTitle("Error");
 		msg->exec();
-		return;
+		return NULL;
 	}
 
+	TRACE_SPAN("render", "build graph");
+
 	QCustomPlot *customPlot = new QCustomPlot();
 	// TODO: dynamically calculate width based on graph contents
 	customPlot->setGeometry(40, 40, 1440, 625);
@@ -2082,13 +2087,9 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	{
 		SeatingSeries *series = seatingSeriesData.at(i);
 
-		if ( series->deleted )
+		if ( ! series->enabled )
 		{
-			qDebug() << series->name->text() << "is deleted, skipping...";
-		}
-		else if ( ! series->enabled->isChecked() )
-		{
-			qDebug() << series->name->text() << "is unchecked, skipping...";
+			qCDebug(lcRender) << series->name << "is unchecked, skipping...";
 		}
 		else
 		{
@@ -2109,26 +2110,27 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		{
 			SeatingSeries *series = seriesToGraph.at(i);
 
-			double cartridgeLength = series->cartridgeLength->value();
+			double cartridgeLength = series->cartridgeLength;
 
 			if ( cartridgeLength == lastCartridgeLength )
 			{
-				qDebug() << "Duplicate cartridge length detected" << cartridgeLength << ", prompting user to switch to constant x-axis spacing";
+				qCDebug(lcRender) << "Duplicate cartridge length detected" << cartridgeLength << ", prompting user to switch to constant x-axis spacing";
 
 				QMessageBox::StandardButton reply;
 				reply = QMessageBox::question(this, "Duplicate cartridge lengths", "Duplicate cartridge lengths detected. Switching graph to constant spacing mode.", QMessageBox::Ok | QMessageBox::Cancel);
 
 				if ( reply == QMessageBox::Ok )
 				{
-					qDebug() << "Set x-axis spacing to constant";
+					qCDebug(lcRender) << "Set x-axis spacing to constant";
 
 					xAxisSpacing->setCurrentIndex(CONSTANT);
 					break;
 				}
 				else
 				{
-					qDebug() << "User cancel, bailing out";
-					return;
+					qCDebug(lcRender) << "User cancel, bailing out";
+					delete customPlot;
+					return NULL;
 				}
 			}
 
@@ -2137,7 +2139,7 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	}
 	else
 	{
-		qDebug() << "Constant x-axis spacing selected, skipping duplicate check";
+		qCDebug(lcRender) << "Constant x-axis spacing selected, skipping duplicate check";
 	}
 
 	/* Collect the data to graph */
@@ -2152,13 +2154,13 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	{
 		SeatingSeries *series = seriesToGraph.at(i);
 
-		double cartridgeLength = series->cartridgeLength->value();
+		double cartridgeLength = series->cartridgeLength;
 
 		double groupSize;
-		if ( series->groupSize )
+		if ( series->manualEntry )
 		{
 			// If the user selected manual data entry
-			groupSize = series->groupSize->value();
+			groupSize = series->groupSize;
 		}
 		else
 		{
@@ -2212,8 +2214,8 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 			}
 		}
 
-		qDebug() << QString("%1 - %2, %3").arg(series->name->text()).arg(cartridgeLength).arg(groupSize);
-		qDebug() << "";
+		LOG_TRACE(lcRenderTrace) << QString("%1 - %2, %3").arg(series->name).arg(cartridgeLength).arg(groupSize);
+		LOG_TRACE(lcRenderTrace) << "";
 
 		/*
 		 * The user can select either default x-axis spacing (x-ticks are spaced proportionally and irregular values will create "holes" in the
@@ -2255,13 +2257,13 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	if ( trendCheckBox->isChecked() )
 	{
 		std::vector<double> res = GetLinearFit(xPoints, yPoints);
-		qDebug() << "linear fit:" << res[0] << res[1];
+		qCDebug(lcRender) << "linear fit:" << res[0] << res[1];
 
 		std::vector<SplineSet> res2a = spline(xPoints, yPoints);
 		SplineSet res2;
 		foreach ( res2, res2a )
 		{
-			qDebug() << "spline:" << res2.a << res2.b << res2.c << res2.d << res2.x;
+			LOG_TRACE(lcRenderTrace) << "spline:" << res2.a << res2.b << res2.c << res2.d << res2.x;
 		}
 
 		QVector<double> xTrendPoints;
@@ -2271,8 +2273,8 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		xTrendPoints.push_back(xPoints.last());
 		yTrendPoints.push_back(res[1] + (xPoints.last() * res[0]));
 
-		qDebug() << "xTrendPoints:" << xTrendPoints;
-		qDebug() << "yTrendPoints:" << yTrendPoints;
+		qCDebug(lcRender) << "xTrendPoints:" << xTrendPoints;
+		qCDebug(lcRender) << "yTrendPoints:" << yTrendPoints;
 
 		Qt::PenStyle lineType;
 		if ( trendLineType->currentIndex() == SOLID_LINE )
@@ -2360,7 +2362,7 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 
 	QCPTextElement *title = new QCPTextElement(customPlot);
 	title->setText(QString("\n%1").arg(graphTitle->text()));
-	title->setFont(QFont("DejaVu Sans", scaleFontSize(24)));
+	title->setFont(TextCache::font(24));
 	title->setTextColor(QColor("#4d4d4d"));
 	customPlot->plotLayout()->insertRow(0);
 	customPlot->plotLayout()->addElement(0, 0, title);
@@ -2369,7 +2371,7 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	QStringList subtitleText;
 	subtitleText << rifle->text() << propellant->text() << projectile->text() << brass->text() << primer->text() << weather->text() << distance->text();
 	subtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
-	subtitle->setFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	subtitle->setFont(TextCache::font(12));
 	subtitle->setTextColor(QColor("#4d4d4d"));
 	customPlot->plotLayout()->insertRow(1);
 	customPlot->plotLayout()->addElement(1, 0, subtitle);
@@ -2384,9 +2386,9 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	customPlot->xAxis->setLabel(QString("%1 (%2)").arg(cartridgeMeasurementType2).arg(cartridgeUnits2));
 	customPlot->xAxis->scaleRange(1.1);
 	customPlot->xAxis->setTicker(textTicker);
-	customPlot->xAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->xAxis->setTickLabelFont(TextCache::font(9));
 	customPlot->xAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->xAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->xAxis->setLabelFont(TextCache::font(12));
 	customPlot->xAxis->setLabelColor(QColor("#4d4d4d"));
 	customPlot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
 	customPlot->xAxis->grid()->setPen(gridPen);
@@ -2403,9 +2405,9 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 
 	customPlot->yAxis->setLabel(QString("%1 (%2)").arg(groupMeasurementType2).arg(groupUnits2));
 	customPlot->yAxis->scaleRange(1.3);
-	customPlot->yAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->yAxis->setTickLabelFont(TextCache::font(9));
 	customPlot->yAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->yAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->yAxis->setLabelFont(TextCache::font(12));
 	customPlot->yAxis->setLabelColor(QColor("#4d4d4d"));
 	customPlot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
 	customPlot->yAxis->grid()->setPen(gridPen);
@@ -2426,14 +2428,18 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	customPlot->axisRect()->setupFullAxesBox();
 
 	// Render the graph off-screen
+	TraceSpan layoutSpan("render", "layout pass");
 	QPixmap picture(QSize(1440, 625));
 	QCPPainter painter(&picture);
 	customPlot->toPainter(&painter, 1440, 625);
+	layoutSpan.end();
 
 	/*
 	 * Generate text annotations. We need to do this after rendering the graph so that coordToPixel() works.
 	 */
 
+	TraceSpan annotationSpan("render", "annotations");
+	QList<PlotLabel> labels;
 	bool prevSizeSet = false;
 	double prevSize = 0;
 
@@ -2489,9 +2495,8 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 
 		yCoord = yPoints.at(i);
 
-		QCPItemText *belowAnnotation = new QCPItemText(customPlot);
-		belowAnnotation->setText(belowAnnotationText.join('\n'));
-		belowAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
+		QCPItemText *belowAnnotation = new CachedTextItem(customPlot);
+		belowAnnotation->setFont(TextCache::font(9));
 		belowAnnotation->setColor(QColor("#4d4d4d"));
 		belowAnnotation->position->setType(QCPItemPosition::ptAbsolute);
 		if ( xAxisSpacing->currentIndex() == CONSTANT )
@@ -2507,11 +2512,10 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		belowAnnotation->setBrush(QBrush(Qt::white));
 		belowAnnotation->setClipToAxisRect(false);
 		belowAnnotation->setLayer(customPlot->layer(5));
-		qDebug() << "min pixel coords:" << belowAnnotation->position->pixelPosition() << "layer:" << belowAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
+		LOG_TRACE(lcRenderTrace) << "min pixel coords:" << belowAnnotation->position->pixelPosition() << "layer:" << belowAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
 
-		QCPItemText *aboveAnnotation = new QCPItemText(customPlot);
-		aboveAnnotation->setText(aboveAnnotationText.join('\n'));
-		aboveAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
+		QCPItemText *aboveAnnotation = new CachedTextItem(customPlot);
+		aboveAnnotation->setFont(TextCache::font(9));
 		aboveAnnotation->setColor(QColor("#4d4d4d"));
 		aboveAnnotation->position->setType(QCPItemPosition::ptAbsolute);
 		if ( xAxisSpacing->currentIndex() == CONSTANT )
@@ -2527,18 +2531,56 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		aboveAnnotation->setBrush(QBrush(Qt::white));
 		aboveAnnotation->setClipToAxisRect(false);
 		aboveAnnotation->setLayer(customPlot->layer(5));
-		qDebug() << "max pixel coords:" << aboveAnnotation->position->pixelPosition() << "layer:" << aboveAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
+		LOG_TRACE(lcRenderTrace) << "max pixel coords:" << aboveAnnotation->position->pixelPosition() << "layer:" << aboveAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
+
+		PlotLabel belowLabel;
+		belowLabel.item = belowAnnotation;
+		belowLabel.baseCoords = belowAnnotation->position->coords();
+		belowLabel.lines = belowAnnotationText;
+		belowLabel.above = false;
+		labels.append(belowLabel);
+
+		PlotLabel aboveLabel;
+		aboveLabel.item = aboveAnnotation;
+		aboveLabel.baseCoords = aboveAnnotation->position->coords();
+		aboveLabel.lines = aboveAnnotationText;
+		aboveLabel.above = true;
+		labels.append(aboveLabel);
 
 		prevSize = yCoord;
 		prevSizeSet = true;
 	}
 
+	annotationSpan.end();
+
+	// Stagger, abbreviate or drop labels that would overlap on wide ladders
+	LabelLayout::layoutLabels(labels, QRectF(0, 0, 1440, 625));
+
+	return customPlot;
+}
+
+void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
+{
+	qCDebug(lcRender) << "renderGraph displayGraphPreview =" << displayGraphPreview;
+
+	QCustomPlot *customPlot = buildGraph();
+	if ( customPlot == NULL )
+	{
+		return;
+	}
+
+	// Only the pixmap outlives this function, the plot is deleted once it's drawn
+	MemoryAccount<MemoryStats::PLOT_SCENES> sceneMemory;
+	sceneMemory.set(MemoryStats::plotBytes(customPlot));
+
 	if ( displayGraphPreview )
 	{
-		qDebug() << "Showing graph preview";
+		qCDebug(lcRender) << "Showing graph preview";
 
 		//customPlot->show();
+		TraceSpan rasterSpan("render", "rasterise");
 		QPixmap preview = customPlot->toPixmap(1440, 625, 2.0);
+		rasterSpan.end();
 
 		if ( graphPreview )
 		{
@@ -2560,16 +2602,17 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		}
 
 		QString savePath = QDir(prevSaveDir).filePath(fileName);
-		qDebug() << "graphTitle:" << graphTitle->text();
-		qDebug() << "fileName:" << fileName;
-		qDebug() << "savePath:" << savePath;
+		qCDebug(lcRender) << "graphTitle:" << graphTitle->text();
+		qCDebug(lcRender) << "fileName:" << fileName;
+		qCDebug(lcRender) << "savePath:" << savePath;
 
 		QString path = QFileDialog::getSaveFileName(this, "Save graph as image", savePath, "PNG image (*.png);;JPG image (*.jpg);;PDF file (*.pdf)");
-		qDebug() << "User selected save path:" << path;
+		qCDebug(lcRender) << "User selected save path:" << path;
 
 		if ( path.isEmpty() )
 		{
-			qDebug() << "No path selected, bailing";
+			qCDebug(lcRender) << "No path selected, bailing";
+			delete customPlot;
 			return;
 		}
 
@@ -2587,16 +2630,16 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 			pathExt = "png";;
 		}
 
-		qDebug() << "Using save path:" << path;
+		qCDebug(lcRender) << "Using save path:" << path;
 
 		bool res;
 		if ( pathExt == "png")
 		{
-			res = customPlot->savePng(path, 1440, 625, 2.0);
+			res = saveRasterImage(customPlot, path, "PNG");
 		}
 		else if ( pathExt == "jpg" )
 		{
-			res = customPlot->saveJpg(path, 1440, 625, 2.0);
+			res = saveRasterImage(customPlot, path, "JPG");
 		}
 		else if ( pathExt == "pdf" )
 		{
@@ -2604,11 +2647,11 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		}
 		else
 		{
-			qDebug() << "error, shouldn't be reached";
+			qCDebug(lcRender) << "error, shouldn't be reached";
 			res = false;
 		}
 
-		qDebug() << "save file res =" << res;
+		qCDebug(lcRender) << "save file res =" << res;
 
 		if ( res )
 		{
@@ -2619,4 +2662,213 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 			QMessageBox::warning(this, "Save file", QString("Unable to save file to '%1'\n\nPlease choose a different path").arg(path), QMessageBox::Ok, QMessageBox::Ok);
 		}
 	}
+
+	delete customPlot;
+}
+
+QList<QPair<QString, QWidget *> > SeatingDepthTest::sessionOptions ( void )
+{
+	// Order matters when restoring, x-axis spacing resets the trend line checkbox
+	QList<QPair<QString, QWidget *> > options;
+	options.append(QPair<QString, QWidget *>("graphTitle", graphTitle));
+	options.append(QPair<QString, QWidget *>("rifle", rifle));
+	options.append(QPair<QString, QWidget *>("projectile", projectile));
+	options.append(QPair<QString, QWidget *>("propellant", propellant));
+	options.append(QPair<QString, QWidget *>("brass", brass));
+	options.append(QPair<QString, QWidget *>("primer", primer));
+	options.append(QPair<QString, QWidget *>("weather", weather));
+	options.append(QPair<QString, QWidget *>("distance", distance));
+	options.append(QPair<QString, QWidget *>("groupMeasurementType", groupMeasurementType));
+	options.append(QPair<QString, QWidget *>("groupUnits", groupUnits));
+	options.append(QPair<QString, QWidget *>("cartridgeMeasurementType", cartridgeMeasurementType));
+	options.append(QPair<QString, QWidget *>("cartridgeUnits", cartridgeUnits));
+	options.append(QPair<QString, QWidget *>("xAxisSpacing", xAxisSpacing));
+	options.append(QPair<QString, QWidget *>("showGroupSize", groupSizeCheckBox));
+	options.append(QPair<QString, QWidget *>("groupSizeLocation", groupSizeLocation));
+	options.append(QPair<QString, QWidget *>("showGSD", gsdCheckBox));
+	options.append(QPair<QString, QWidget *>("gsdLocation", gsdLocation));
+	options.append(QPair<QString, QWidget *>("showTrend", trendCheckBox));
+	options.append(QPair<QString, QWidget *>("trendLineType", trendLineType));
+	options.append(QPair<QString, QWidget *>("includeSighters", includeSightersCheckBox));
+
+	return options;
+}
+
+void SeatingDepthTest::saveSession ( bool state )
+{
+	qCDebug(lcImport) << "saveSession state =" << state;
+
+	if ( seriesModel == NULL )
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText("There's no series data to save yet.");
+		msg->setWindowTitle("Error");
+		msg->exec();
+		return;
+	}
+
+	QString path = QFileDialog::getSaveFileName(this, "Save session", prevSessionDir, "ChronoPlotter sessions (*.cps)");
+
+	qCDebug(lcImport) << "Selected file:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qCDebug(lcImport) << "User didn't select a file, bail";
+		return;
+	}
+
+	prevSessionDir = path;
+
+	SessionFileWriter writer(SessionFile::SEATING_DEPTH_TEST, seriesModel->isManualEntry() ? SessionFile::MANUAL_ENTRY : 0);
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
+
+		SessionSeries &entry = writer.addSeries(series->seriesNum, series->name, QString(), series->firstDate, series->firstTime);
+		entry.flags = (series->enabled ? SessionFile::SERIES_ENABLED : 0) | (series->manualEntry ? SessionFile::SERIES_MANUAL_ENTRY : 0);
+		entry.setting = series->cartridgeLength;
+		entry.groupSize = series->groupSize;
+		entry.targetDistance = series->targetDistance;
+		entry.timestamp = series->timestamp;
+
+		// Record shots are the same shots in the same order, with the sighters left out
+		int recordShot = 0;
+		for ( int j = 0; j < series->coordinates_sighters.size(); j++ )
+		{
+			const QPair<double, double> &shot = series->coordinates_sighters.at(j);
+
+			bool sighter = true;
+			if ( (recordShot < series->coordinates.size()) && (series->coordinates.at(recordShot) == shot) )
+			{
+				sighter = false;
+				recordShot++;
+			}
+
+			writer.appendShot(shot.first, shot.second, sighter);
+		}
+	}
+
+	QList<QPair<QString, QWidget *> > options = sessionOptions();
+	for ( int i = 0; i < options.size(); i++ )
+	{
+		writer.setOption(options.at(i).first, options.at(i).second);
+	}
+
+	QString error;
+	if ( ! writer.save(path, &error) )
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText(QString("Unable to save session to '%1'\n\n%2").arg(path).arg(error));
+		msg->setWindowTitle("Error");
+		msg->exec();
+	}
+}
+
+void SeatingDepthTest::loadSession ( bool state )
+{
+	qCDebug(lcImport) << "loadSession state =" << state;
+
+	QString path = QFileDialog::getOpenFileName(this, "Load session", prevSessionDir, "ChronoPlotter sessions (*.cps)");
+
+	qCDebug(lcImport) << "Selected file:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qCDebug(lcImport) << "User didn't select a file, bail";
+		return;
+	}
+
+	prevSessionDir = path;
+
+	SessionFile session;
+	QString error;
+	if ( ! session.open(path, SessionFile::SEATING_DEPTH_TEST, &error) )
+	{
+		QMessageBox *msg = new QMessageBox();
+		msg->setIcon(QMessageBox::Critical);
+		msg->setText(QString("Unable to load session from '%1'\n\n%2").arg(path).arg(error));
+		msg->setWindowTitle("Error");
+		msg->exec();
+		return;
+	}
+
+	releaseSession();
+
+	// Reset the imported data signals, displayImportedSeries() connects them again
+	disconnect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
+	disconnect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+	disconnect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
+
+	includeSightersCheckBox->setEnabled(false);
+	includeSightersLabel->setStyleSheet("color: #878787");
+
+	QList<QPair<QString, QWidget *> > options = sessionOptions();
+	for ( int i = 0; i < options.size(); i++ )
+	{
+		session.restoreOption(options.at(i).first, options.at(i).second);
+	}
+
+	// Checkboxes don't emit clicked() when set programmatically, so update their location boxes by hand
+	groupSizeCheckBoxChanged(groupSizeCheckBox->isChecked());
+	gsdCheckBoxChanged(gsdCheckBox->isChecked());
+	trendCheckBoxChanged(trendCheckBox->isChecked());
+
+	QList<SeatingSeries *> newSeriesData;
+	for ( int i = 0; i < session.seriesCount(); i++ )
+	{
+		const SessionSeries &entry = session.series(i);
+
+		SeatingSeries *series = seriesArena.create();
+		series->isValid = true;
+		series->seriesNum = entry.seriesNum;
+		series->name = session.text(entry.name);
+		series->firstDate = session.text(entry.firstDate);
+		series->firstTime = session.text(entry.firstTime);
+		series->timestamp = entry.timestamp;
+		series->targetDistance = entry.targetDistance;
+		series->cartridgeLength = entry.setting;
+		series->groupSize = entry.groupSize;
+		series->manualEntry = ((entry.flags & SessionFile::SERIES_MANUAL_ENTRY) != 0);
+		series->enabled = ((entry.flags & SessionFile::SERIES_ENABLED) != 0);
+		series->tooFewShots = false;
+
+		const double *shotX = session.shotX(i);
+		const double *shotY = session.shotY(i);
+		const quint8 *shotFlags = session.shotFlags(i);
+		for ( quint64 j = 0; j < entry.shotCount; j++ )
+		{
+			QPair<double, double> shot(shotX[j], shotY[j]);
+
+			series->coordinates_sighters.append(shot);
+			if ( ! (shotFlags[j] & SessionFile::SHOT_SIGHTER) )
+			{
+				series->coordinates.append(shot);
+			}
+		}
+
+		if ( ! series->manualEntry )
+		{
+			calculateGroupSizes(series);
+		}
+
+		newSeriesData.append(series);
+	}
+
+	if ( session.flags() & SessionFile::MANUAL_ENTRY )
+	{
+		createManualEntryTable();
+
+		for ( int i = 0; i < newSeriesData.size(); i++ )
+		{
+			seriesModel->appendSeries(newSeriesData.at(i));
+		}
+	}
+	else
+	{
+		seatingSeriesData = newSeriesData;
+		displayImportedSeries();
+	}
 }
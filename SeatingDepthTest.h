@@ -13,13 +13,19 @@
 #include <QPushButton>
 #include <QStackedWidget>
 #include <QDoubleSpinBox>
-#include <QScrollArea>
-#include <QGridLayout>
+#include <QTableView>
+#include <QIcon>
 #include <QDialog>
 #include <QMainWindow>
 #include <QTextEdit>
 
 #include "ChronoPlotter.h"
+#include "SeriesStore.h"
+#include "SeriesArena.h"
+#include "SeriesTable.h"
+
+class RenderBenchmark;
+class Job;
 
 namespace SeatingDepth
 {
@@ -27,7 +33,7 @@ namespace SeatingDepth
 	{
 		bool isValid;
 		int seriesNum;
-		QLabel *name;
+		QString name;
 		QList<QPair<double, double> > coordinates;
 		QList<QPair<double, double> > coordinates_sighters;
 		QList<double> extremeSpread;
@@ -43,21 +49,67 @@ namespace SeatingDepth
 		int targetDistance; // in yards
 		QString firstDate;
 		QString firstTime;
-		QDoubleSpinBox *cartridgeLength;
-		QDoubleSpinBox *groupSize;
-		QLabel *groupSizeLabel;
-		QPushButton *deleteButton;
-		QCheckBox *enabled;
-		bool deleted;
+		qint64 timestamp; // see TimestampParser
+		double cartridgeLength;
+		bool manualEntry; // group size is entered by hand rather than calculated from coordinates
+		double groupSize;
+		QString groupSizeText;
+		bool tooFewShots;
+		bool enabled;
+	};
+
+	/*
+	 * Table model over the seating depth test's series list. Imported series show their calculated group size and date,
+	 * manually entered series have an editable group size and a delete button.
+	 */
+	class SeatingSeriesModel : public SeriesTableModel
+	{
+	public:
+		enum Column
+		{
+			ENABLED_COLUMN,
+			NAME_COLUMN,
+			CARTRIDGE_LENGTH_COLUMN,
+			GROUP_SIZE_COLUMN,
+			DATE_COLUMN,
+			DELETE_COLUMN = DATE_COLUMN
+		};
+
+		SeatingSeriesModel(QList<SeatingSeries*> *seriesData, bool manualEntry, QObject *parent = 0);
+
+		virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		virtual int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+		virtual bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) Q_DECL_OVERRIDE;
+		virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+		virtual Qt::ItemFlags flags(const QModelIndex &index) const Q_DECL_OVERRIDE;
+
+		bool isManualEntry(void) const;
+		SeatingSeries *seriesAt(int row) const;
+		void appendSeries(SeatingSeries *series);
+		void removeSeries(int row);
+		void setAllEnabled(bool enabled);
+		void setLengthHeader(const QString &header);
+		void setGroupSizeHeader(const QString &header);
+
+	private:
+		QList<SeatingSeries*> *seriesData;
+		bool manualEntry;
+		QString lengthHeader;
+		QString groupSizeHeader;
+		QIcon deleteIcon;
 	};
 
 	class SeatingDepthTest : public QWidget
 	{
 		Q_OBJECT
 
+		// Drives buildGraph() with generated series
+		friend class ::RenderBenchmark;
+
 		public:
 			SeatingDepthTest(QWidget *parent = 0);
-			~SeatingDepthTest() {};
+			~SeatingDepthTest();
 			QList<SeatingSeries *> seatingSeriesData;
 			QComboBox *cartridgeUnits;
 
@@ -72,19 +124,22 @@ namespace SeatingDepth
 			void importedGroupMeasurementTypeChanged(int);
 			void importedGroupUnitsChanged(int);
 			void loadNewShotData(bool);
+			void refreshDisplayedData(void);
 			void selectShotMarkerFile(bool);
 			void manualDataEntry(bool);
 			void addNewClicked(bool);
-			void deleteClicked(bool);
+			void seriesTableClicked(const QModelIndex &);
 			void autofillClicked(bool);
 			void headerCheckBoxChanged(int);
-			void seriesCheckBoxChanged(int);
-			void seriesManualCheckBoxChanged(int);
 			void showGraph(bool);
 			void saveGraph(bool);
+			void showTargets(bool);
+			void saveSession(bool);
+			void loadSession(bool);
 
 		protected:
 			void updateDisplayedData ( void );
+			void displayedDataChanged ( void );
 			double calculateES ( QList<QPair<double, double> > );
 			double calculateYStdev ( QList<QPair<double, double> > );
 			double calculateXStdev ( QList<QPair<double, double> > );
@@ -92,23 +147,36 @@ namespace SeatingDepth
 			static double pairSumX ( double, const QPair<double, double> );
 			static double pairSumY ( double, const QPair<double, double> );
 			double calculateMR ( QList<QPair<double, double> > );
-			QList<SeatingSeries *> ExtractShotMarkerSeriesTar ( QString );
-			QList<SeatingSeries *> ExtractShotMarkerSeriesCsv ( QTextStream & );
 			void optionCheckBoxChanged(QCheckBox *, QLabel *, QComboBox *);
 			void DisplaySeriesData ( void );
+			void displayImportedSeries ( void );
+			void createManualEntryTable ( void );
+			void calculateGroupSizes ( SeatingSeries * );
+			bool calculateGroupSizes ( const QList<SeatingSeries *> & );
+			void calculateGroupMetrics ( SeatingSeries * );
+			void updateGroupSizeText ( SeatingSeries * );
+			static void groupMetricsJob ( Job *, void * );
+			QList<QPair<QString, QWidget *> > sessionOptions ( void );
+			void releaseSession ( void );
+			void deleteSeries ( int );
+			QString groupSizeHeaderText ( void );
+			QCustomPlot *buildGraph ( void );
 			void renderGraph ( bool );
+			static qint64 shotDataBytes ( const void * );
+			static qint64 metricCacheBytes ( const void * );
 
 		private:
 			GraphPreview *graphPreview;
+			GraphPreview *targetPreview;
 			QString prevSaveDir;
 			QString prevShotMarkerDir;
+			QString prevSessionDir;
 			QStackedWidget *stackedWidget;
-			QWidget *scrollWidget;
-			QVBoxLayout *scrollLayout;
-			QScrollArea *scrollArea;
-			QGridLayout *seatingSeriesGrid;
-			QLabel *headerLengthType;
-			QLabel *headerGroupType;
+			SeriesArena<SeatingSeries> seriesArena;
+			QWidget *seriesWidget;
+			QTableView *seriesTable;
+			SeatingSeriesModel *seriesModel;
+			bool displayedDataRefreshPending;
 			QLineEdit *graphTitle;
 			QLineEdit *rifle;
 			QLineEdit *projectile;
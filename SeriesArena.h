@@ -0,0 +1,131 @@
+#ifndef SERIES_ARENA_H
+#define SERIES_ARENA_H
+
+#include <QVector>
+#include <new>
+#include "MemoryStats.h"
+
+/*
+ * Owns every series of one loaded session. Series are constructed in fixed-size blocks and released all at once by
+ * clear(), which keeps the blocks around for the next session. Reloading data over and over therefore reuses the same
+ * memory instead of growing the heap. destroy() releases a single series (e.g. a deleted manual entry row) and its
+ * slot is handed out again by the next create().
+ */
+template <typename T>
+class SeriesArena
+{
+public:
+	SeriesArena() : used(0), live(0) {}
+
+	~SeriesArena()
+	{
+		clear();
+
+		for (int i = 0; i < blocks.size(); i++)
+		{
+			::operator delete(blocks.at(i));
+		}
+	}
+
+	// Value-initialized like 'new T()', so pointer and numeric members start out zeroed
+	T *create()
+	{
+		int index;
+		if (!freeSlots.isEmpty())
+		{
+			index = freeSlots.takeLast();
+		}
+		else
+		{
+			if (used == blocks.size() * BLOCK_SIZE)
+			{
+				blocks.append(static_cast<T *>(::operator new(sizeof(T) * BLOCK_SIZE)));
+				memory.add(sizeof(T) * BLOCK_SIZE);
+			}
+
+			index = used++;
+			constructed.append(false);
+		}
+
+		T *object = new (slotAt(index)) T();
+		constructed[index] = true;
+		live++;
+
+		return object;
+	}
+
+	void destroy(T *object)
+	{
+		int index = indexOf(object);
+		if ((index < 0) || (index >= used) || !constructed.at(index))
+		{
+			return;
+		}
+
+		object->~T();
+		constructed[index] = false;
+		freeSlots.append(index);
+		live--;
+	}
+
+	// Destroys every series in the arena. The blocks are kept for reuse.
+	void clear()
+	{
+		for (int i = 0; i < used; i++)
+		{
+			if (constructed.at(i))
+			{
+				slotAt(i)->~T();
+			}
+		}
+
+		used = 0;
+		live = 0;
+		constructed.clear();
+		freeSlots.clear();
+	}
+
+	int count() const
+	{
+		return live;
+	}
+
+	int capacity() const
+	{
+		return blocks.size() * BLOCK_SIZE;
+	}
+
+private:
+	enum { BLOCK_SIZE = 64 };
+
+	T *slotAt(int index) const
+	{
+		return blocks.at(index / BLOCK_SIZE) + (index % BLOCK_SIZE);
+	}
+
+	int indexOf(const T *object) const
+	{
+		for (int i = 0; i < blocks.size(); i++)
+		{
+			const T *block = blocks.at(i);
+			if ((object >= block) && (object < block + BLOCK_SIZE))
+			{
+				return (i * BLOCK_SIZE) + (int)(object - block);
+			}
+		}
+
+		return -1;
+	}
+
+	QVector<T *> blocks;
+	QVector<bool> constructed;
+	QVector<int> freeSlots;
+	int used;
+	int live;
+	MemoryAccount<MemoryStats::SHOT_DATA> memory; // the blocks, what the series point at is counted by the tabs
+
+	SeriesArena(const SeriesArena &);
+	SeriesArena &operator=(const SeriesArena &);
+};
+
+#endif // SERIES_ARENA_H
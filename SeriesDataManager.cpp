@@ -1,59 +1,286 @@
 #include "SeriesDataManager.h"
 #include "PowderTest.h"
+#include "SeriesTable.h"
+#include "Logging.h"
 
+#include <QApplication>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QGridLayout>
-#include <QScrollArea>
-#include <QLabel>
+#include <QHeaderView>
+#include <QTableView>
 #include <QCheckBox>
 #include <QPushButton>
 #include <QStackedWidget>
+#include <QStyle>
 #include <QDebug>
 #include <algorithm>
 
 using namespace Powder;
 
+ChronoSeriesModel::ChronoSeriesModel(QList<ChronoSeries*> *seriesData, bool manualEntry, QObject *parent)
+	: SeriesTableModel(parent)
+{
+	this->seriesData = seriesData;
+	this->manualEntry = manualEntry;
+	deleteIcon = QApplication::style()->standardIcon(QStyle::SP_DialogCancelButton);
+}
+
+int ChronoSeriesModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+	{
+		return 0;
+	}
+
+	return seriesData->size();
+}
+
+int ChronoSeriesModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+	{
+		return 0;
+	}
+
+	return manualEntry ? DELETE_COLUMN + 1 : DATE_COLUMN + 1;
+}
+
+QString ChronoSeriesModel::resultText(const ChronoSeries *series)
+{
+	int totalShots = series->muzzleVelocities.size();
+	if (totalShots == 0)
+	{
+		return QString("0 shots, 0-0 %1").arg(series->velocityUnits);
+	}
+
+	double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
+	double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
+	return QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(series->velocityUnits);
+}
+
+QVariant ChronoSeriesModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= seriesData->size())
+	{
+		return QVariant();
+	}
+
+	const ChronoSeries *series = seriesData->at(index.row());
+
+	switch (index.column())
+	{
+		case ENABLED_COLUMN:
+			if (role == Qt::CheckStateRole)
+			{
+				return series->enabled ? Qt::Checked : Qt::Unchecked;
+			}
+			break;
+
+		case NAME_COLUMN:
+			if (role == Qt::DisplayRole)
+			{
+				return series->name;
+			}
+			break;
+
+		case CHARGE_WEIGHT_COLUMN:
+			if ((role == Qt::DisplayRole) || (role == Qt::EditRole))
+			{
+				return series->chargeWeight;
+			}
+			break;
+
+		case RESULT_COLUMN:
+			if (role == Qt::DisplayRole)
+			{
+				return resultText(series);
+			}
+			break;
+
+		case DATE_COLUMN:
+			if (role == Qt::DisplayRole)
+			{
+				if (manualEntry)
+				{
+					return QString("Enter velocity data");
+				}
+				return QString("%1 %2").arg(series->firstDate).arg(series->firstTime);
+			}
+			break;
+
+		case DELETE_COLUMN:
+			if (role == Qt::DecorationRole)
+			{
+				return deleteIcon;
+			}
+			break;
+	}
+
+	return QVariant();
+}
+
+bool ChronoSeriesModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+	if (!index.isValid() || index.row() >= seriesData->size())
+	{
+		return false;
+	}
+
+	ChronoSeries *series = seriesData->at(index.row());
+
+	if ((index.column() == ENABLED_COLUMN) && (role == Qt::CheckStateRole))
+	{
+		series->enabled = (value.toInt() == Qt::Checked);
+		qCDebug(lcUi) << "Series" << series->seriesNum << "enabled =" << series->enabled;
+
+		// The rest of the row is greyed out along with the checkbox
+		seriesChanged(index.row());
+		return true;
+	}
+
+	if ((index.column() == CHARGE_WEIGHT_COLUMN) && (role == Qt::EditRole))
+	{
+		series->chargeWeight = value.toDouble();
+		markDirty(index.row(), index.column(), index.column());
+		return true;
+	}
+
+	return false;
+}
+
+QVariant ChronoSeriesModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+	{
+		return QVariant();
+	}
+
+	switch (section)
+	{
+		case NAME_COLUMN:
+			return QString("Series Name");
+		case CHARGE_WEIGHT_COLUMN:
+			return QString("Charge Weight");
+		case RESULT_COLUMN:
+			return QString("Series Result");
+		case DATE_COLUMN:
+			return manualEntry ? QString("") : QString("Series Date");
+	}
+
+	return QString("");
+}
+
+Qt::ItemFlags ChronoSeriesModel::flags(const QModelIndex &index) const
+{
+	if (!index.isValid() || index.row() >= seriesData->size())
+	{
+		return Qt::NoItemFlags;
+	}
+
+	if (index.column() == ENABLED_COLUMN)
+	{
+		return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+	}
+
+	// Unchecked series are greyed out and can't be edited
+	if (!seriesData->at(index.row())->enabled)
+	{
+		return Qt::NoItemFlags;
+	}
+
+	if (index.column() == CHARGE_WEIGHT_COLUMN)
+	{
+		return Qt::ItemIsEnabled | Qt::ItemIsEditable;
+	}
+
+	return Qt::ItemIsEnabled;
+}
+
+bool ChronoSeriesModel::isManualEntry(void) const
+{
+	return manualEntry;
+}
+
+ChronoSeries *ChronoSeriesModel::seriesAt(int row) const
+{
+	return seriesData->at(row);
+}
+
+void ChronoSeriesModel::appendSeries(ChronoSeries *series)
+{
+	beginInsertRows(QModelIndex(), seriesData->size(), seriesData->size());
+	seriesData->append(series);
+	endInsertRows();
+}
+
+void ChronoSeriesModel::removeSeries(int row)
+{
+	beginRemoveRows(QModelIndex(), row, row);
+	seriesData->removeAt(row);
+	endRemoveRows();
+}
+
+void ChronoSeriesModel::setAllEnabled(bool enabled)
+{
+	// Only rows that actually flip are repainted
+	for (int i = 0; i < seriesData->size(); i++)
+	{
+		ChronoSeries *series = seriesData->at(i);
+		if (series->enabled != enabled)
+		{
+			series->enabled = enabled;
+			seriesChanged(i);
+		}
+	}
+}
+
 static bool ChronoSeriesComparator(ChronoSeries *one, ChronoSeries *two)
 {
-	return (one->seriesNum < two->seriesNum);
+	// Series from different files can share a number, keep those in the order they were recorded
+	if (one->seriesNum != two->seriesNum)
+	{
+		return (one->seriesNum < two->seriesNum);
+	}
+
+	return (one->timestamp < two->timestamp);
 }
 
 void SeriesDataManager::displaySeriesData(
 	QWidget *parent,
 	QList<ChronoSeries*> &seriesData,
+	bool watchable,
 	QStackedWidget *stackedWidget,
-	QWidget **outScrollWidget,
-	QScrollArea **outScrollArea,
-	QGridLayout **outSeriesGrid,
-	QLabel **outHeaderResult)
+	QWidget **outSeriesWidget,
+	QTableView **outSeriesTable,
+	ChronoSeriesModel **outSeriesModel)
 {
 	// Sort the list by series number
 	std::sort(seriesData.begin(), seriesData.end(), ChronoSeriesComparator);
 
-	// If we already have series data displayed, clear it out first
-	stackedWidget->removeWidget(*outScrollWidget);
+	// If we already have series data displayed, clear it out first. The table and model are children of the old widget.
+	if (*outSeriesWidget != NULL)
+	{
+		stackedWidget->removeWidget(*outSeriesWidget);
+		(*outSeriesWidget)->deleteLater();
+	}
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+	*outSeriesWidget = new QWidget();
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+	QVBoxLayout *seriesLayout = new QVBoxLayout();
+
+	QCheckBox *headerCheckBox = new QCheckBox("Select all");
+	headerCheckBox->setChecked(true);
+	QObject::connect(headerCheckBox, SIGNAL(stateChanged(int)), parent, SLOT(headerCheckBoxChanged(int)));
+	seriesLayout->addWidget(headerCheckBox);
 
-	*outSeriesGrid = new QGridLayout(scrollAreaWidget);
-	(*outSeriesGrid)->setColumnStretch(0, 0);
-	(*outSeriesGrid)->setColumnStretch(1, 1);
-	(*outSeriesGrid)->setColumnStretch(2, 2);
-	(*outSeriesGrid)->setColumnStretch(3, 3);
-	(*outSeriesGrid)->setColumnStretch(4, 3);
-	(*outSeriesGrid)->setHorizontalSpacing(25);
+	*outSeriesModel = new ChronoSeriesModel(&seriesData, false, *outSeriesWidget);
 
-	*outScrollArea = new QScrollArea();
-	(*outScrollArea)->setWidget(scrollAreaWidget);
-	(*outScrollArea)->setWidgetResizable(true);
+	*outSeriesTable = SeriesTable::createView(*outSeriesModel);
+	(*outSeriesTable)->setItemDelegateForColumn(ChronoSeriesModel::CHARGE_WEIGHT_COLUMN, new SpinBoxDelegate(2, 0.1, 1000000, *outSeriesTable));
 
-	scrollLayout->addWidget(*outScrollArea);
+	seriesLayout->addWidget(*outSeriesTable);
 
-	/* Create utilities toolbar under scroll area */
+	/* Create utilities toolbar under the series table */
 	QPushButton *loadNewButton = new QPushButton("Load new chronograph file");
 	QObject::connect(loadNewButton, SIGNAL(clicked(bool)), parent, SLOT(loadNewChronographData(bool)));
 	loadNewButton->setMinimumWidth(225);
@@ -74,59 +301,19 @@ void SeriesDataManager::displaySeriesData(
 	utilitiesLayout->addWidget(rrButton);
 	utilitiesLayout->addWidget(autofillButton);
 
-	scrollLayout->addLayout(utilitiesLayout);
-
-	*outScrollWidget = new QWidget();
-	(*outScrollWidget)->setLayout(scrollLayout);
-
-	stackedWidget->addWidget(*outScrollWidget);
-	stackedWidget->setCurrentWidget(*outScrollWidget);
-
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	QObject::connect(headerCheckBox, SIGNAL(stateChanged(int)), parent, SLOT(headerCheckBoxChanged(int)));
-	(*outSeriesGrid)->addWidget(headerCheckBox, 0, 0);
-
-	/* Headers for series data */
-	QLabel *headerName = new QLabel("Series Name");
-	(*outSeriesGrid)->addWidget(headerName, 0, 1, Qt::AlignVCenter);
-	QLabel *headerChargeWeight = new QLabel("Charge Weight");
-	(*outSeriesGrid)->addWidget(headerChargeWeight, 0, 2, Qt::AlignVCenter);
-	*outHeaderResult = new QLabel("Series Result");
-	(*outSeriesGrid)->addWidget(*outHeaderResult, 0, 3, Qt::AlignVCenter);
-	QLabel *headerDate = new QLabel("Series Date");
-	(*outSeriesGrid)->addWidget(headerDate, 0, 4, Qt::AlignVCenter);
-
-	for (int i = 0; i < seriesData.size(); i++)
+	// Sessions from a round robin conversion or a saved session have no folder to follow
+	if (watchable)
 	{
-		ChronoSeries *series = seriesData.at(i);
-
-		QObject::connect(series->enabled, SIGNAL(stateChanged(int)), parent, SLOT(seriesCheckBoxChanged(int)));
-
-		(*outSeriesGrid)->addWidget(series->enabled, i + 1, 0);
-		(*outSeriesGrid)->addWidget(series->name, i + 1, 1, Qt::AlignVCenter);
-
-		QHBoxLayout *chargeWeightLayout = new QHBoxLayout();
-		chargeWeightLayout->addWidget(series->chargeWeight);
-		chargeWeightLayout->addStretch(0);
-		(*outSeriesGrid)->addLayout(chargeWeightLayout, i + 1, 2);
-
-		int totalShots = series->muzzleVelocities.size();
-		double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		QLabel *resultLabel = new QLabel(QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(series->velocityUnits));
-		(*outSeriesGrid)->addWidget(resultLabel, i + 1, 3, Qt::AlignVCenter);
-
-		QLabel *datetimeLabel = new QLabel(QString("%1 %2").arg(series->firstDate).arg(series->firstTime));
-		(*outSeriesGrid)->addWidget(datetimeLabel, i + 1, 4, Qt::AlignVCenter);
-
-		(*outSeriesGrid)->setRowMinimumHeight(0, series->chargeWeight->sizeHint().height());
+		QCheckBox *watchCheckBox = new QCheckBox("Watch folder for new files");
+		watchCheckBox->setToolTip("Add series from new or changed files in the folder as they're written");
+		QObject::connect(watchCheckBox, SIGNAL(toggled(bool)), parent, SLOT(watchFolderToggled(bool)));
+		utilitiesLayout->addWidget(watchCheckBox);
 	}
 
-	// Add an empty stretch row at the end for proper spacing
-	(*outSeriesGrid)->setRowStretch(seriesData.size() + 1, 1);
+	seriesLayout->addLayout(utilitiesLayout);
+
+	(*outSeriesWidget)->setLayout(seriesLayout);
 
-	(*outScrollArea)->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-	(*outScrollArea)->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-	(*outScrollArea)->setWidgetResizable(true);
+	stackedWidget->addWidget(*outSeriesWidget);
+	stackedWidget->setCurrentWidget(*outSeriesWidget);
 }
@@ -3,27 +3,70 @@
 
 #include <QWidget>
 #include <QList>
+#include <QIcon>
+
+#include "SeriesTable.h"
 
 class QStackedWidget;
-class QScrollArea;
-class QGridLayout;
-class QLabel;
+class QTableView;
 
 namespace Powder
 {
 	struct ChronoSeries;
 
+	/*
+	 * Table model over the powder test's series list. Manual data entry replaces the date column
+	 * with 'Enter velocity data' and delete buttons.
+	 */
+	class ChronoSeriesModel : public SeriesTableModel
+	{
+	public:
+		enum Column
+		{
+			ENABLED_COLUMN,
+			NAME_COLUMN,
+			CHARGE_WEIGHT_COLUMN,
+			RESULT_COLUMN,
+			DATE_COLUMN,
+			ENTER_DATA_COLUMN = DATE_COLUMN,
+			DELETE_COLUMN
+		};
+
+		ChronoSeriesModel(QList<ChronoSeries*> *seriesData, bool manualEntry, QObject *parent = 0);
+
+		virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		virtual int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+		virtual bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) Q_DECL_OVERRIDE;
+		virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+		virtual Qt::ItemFlags flags(const QModelIndex &index) const Q_DECL_OVERRIDE;
+
+		bool isManualEntry(void) const;
+		ChronoSeries *seriesAt(int row) const;
+		void appendSeries(ChronoSeries *series);
+		void removeSeries(int row);
+		void setAllEnabled(bool enabled);
+
+		static QString resultText(const ChronoSeries *series);
+
+	private:
+		QList<ChronoSeries*> *seriesData;
+		bool manualEntry;
+		QIcon deleteIcon;
+	};
+
 	class SeriesDataManager
 	{
 	public:
+		// watchable adds a checkbox for following the folder the series were imported from
 		static void displaySeriesData(
 			QWidget *parent,
 			QList<ChronoSeries*> &seriesData,
+			bool watchable,
 			QStackedWidget *stackedWidget,
-			QWidget **outScrollWidget,
-			QScrollArea **outScrollArea,
-			QGridLayout **outSeriesGrid,
-			QLabel **outHeaderResult
+			QWidget **outSeriesWidget,
+			QTableView **outSeriesTable,
+			ChronoSeriesModel **outSeriesModel
 		);
 	};
 }
@@ -0,0 +1,322 @@
+#include "SeriesStore.h"
+#include "Logging.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QIODevice>
+
+SeriesStore::SeriesStore()
+{
+}
+
+int SeriesStore::beginSeries()
+{
+	SeriesRecord record;
+	record.isValid = false;
+	record.seriesNum = -1;
+	record.timestamp = INVALID_TIMESTAMP;
+	record.targetDistance = 0;
+	record.velocityOffset = velocityValues.size();
+	record.velocityCount = 0;
+	record.shotOffset = shotX.size();
+	record.shotCount = 0;
+	record.recordShotCount = 0;
+
+	records.append(record);
+	updateMemory();
+
+	return records.size() - 1;
+}
+
+void SeriesStore::discardSeries()
+{
+	if (records.isEmpty())
+	{
+		return;
+	}
+
+	// The last series owns the tail of each shot array
+	const SeriesRecord &record = records.last();
+	velocityValues.resize(record.velocityOffset);
+	velocityTimes.resize(record.velocityOffset);
+	shotX.resize(record.shotOffset);
+	shotY.resize(record.shotOffset);
+	shotSighter.resize(record.shotOffset);
+	shotTimes.resize(record.shotOffset);
+
+	records.removeLast();
+	updateMemory();
+}
+
+void SeriesStore::clear()
+{
+	records.clear();
+	velocityValues.clear();
+	velocityTimes.clear();
+	shotX.clear();
+	shotY.clear();
+	shotSighter.clear();
+	shotTimes.clear();
+	updateMemory();
+}
+
+int SeriesStore::size() const
+{
+	return records.size();
+}
+
+bool SeriesStore::isEmpty() const
+{
+	return records.isEmpty();
+}
+
+SeriesRecord &SeriesStore::at(int index)
+{
+	return records[index];
+}
+
+const SeriesRecord &SeriesStore::at(int index) const
+{
+	return records.at(index);
+}
+
+SeriesRecord &SeriesStore::last()
+{
+	return records.last();
+}
+
+void SeriesStore::appendVelocity(double velocity, qint64 timestamp)
+{
+	if (records.isEmpty())
+	{
+		qCDebug(lcImport) << "SeriesStore: velocity appended without a series, ignoring";
+		return;
+	}
+
+	// Only account again when the arrays are about to grow
+	bool growing = (velocityValues.size() == velocityValues.capacity());
+
+	velocityValues.append(velocity);
+	velocityTimes.append(timestamp);
+
+	if (growing)
+	{
+		updateMemory();
+	}
+
+	SeriesRecord &record = records.last();
+	record.velocityCount++;
+	if (record.timestamp == INVALID_TIMESTAMP)
+	{
+		record.timestamp = timestamp;
+	}
+}
+
+void SeriesStore::appendShot(double x, double y, bool sighter, qint64 timestamp)
+{
+	if (records.isEmpty())
+	{
+		qCDebug(lcImport) << "SeriesStore: shot appended without a series, ignoring";
+		return;
+	}
+
+	bool growing = (shotX.size() == shotX.capacity());
+
+	shotX.append(x);
+	shotY.append(y);
+	shotSighter.append(sighter);
+	shotTimes.append(timestamp);
+
+	if (growing)
+	{
+		updateMemory();
+	}
+
+	SeriesRecord &record = records.last();
+	record.shotCount++;
+	if (record.timestamp == INVALID_TIMESTAMP)
+	{
+		record.timestamp = timestamp;
+	}
+	if (!sighter)
+	{
+		record.recordShotCount++;
+	}
+}
+
+const double *SeriesStore::velocityData(int index) const
+{
+	return velocityValues.constData() + records.at(index).velocityOffset;
+}
+
+const qint64 *SeriesStore::velocityTimestamps(int index) const
+{
+	return velocityTimes.constData() + records.at(index).velocityOffset;
+}
+
+const qint64 *SeriesStore::shotTimestamps(int index) const
+{
+	return shotTimes.constData() + records.at(index).shotOffset;
+}
+
+QList<double> SeriesStore::velocities(int index) const
+{
+	const SeriesRecord &record = records.at(index);
+
+	QList<double> result;
+	result.reserve(record.velocityCount);
+
+	const double *data = velocityValues.constData() + record.velocityOffset;
+	for (int i = 0; i < record.velocityCount; i++)
+	{
+		result.append(data[i]);
+	}
+
+	return result;
+}
+
+QList<QPair<double, double> > SeriesStore::coordinates(int index, bool includeSighters) const
+{
+	const SeriesRecord &record = records.at(index);
+
+	QList<QPair<double, double> > result;
+	result.reserve(includeSighters ? record.shotCount : record.recordShotCount);
+
+	int end = record.shotOffset + record.shotCount;
+	for (int i = record.shotOffset; i < end; i++)
+	{
+		if (includeSighters || !shotSighter.at(i))
+		{
+			result.append(QPair<double, double>(shotX.at(i), shotY.at(i)));
+		}
+	}
+
+	return result;
+}
+
+// isValid, seven qint32 fields, four QString lengths and the timestamp
+#define SERIES_RECORD_MIN_BYTES (1 + 7 * 4 + 4 * 4 + 8)
+
+template <typename T>
+static void writeArray(QDataStream &out, const QVector<T> &array)
+{
+	out << (qint32)array.size();
+	out.writeRawData((const char *)array.constData(), array.size() * sizeof(T));
+}
+
+template <typename T>
+static bool readArray(QDataStream &in, QVector<T> *array)
+{
+	qint32 size;
+	in >> size;
+	if ((in.status() != QDataStream::Ok) || (size < 0))
+	{
+		return false;
+	}
+
+	// A corrupt size must not turn into a huge allocation, the data has to be there
+	qint64 bytes = size * (qint64)sizeof(T);
+	if ((in.device() == NULL) || (bytes > in.device()->bytesAvailable()))
+	{
+		return false;
+	}
+
+	array->resize(size);
+	return in.readRawData((char *)array->data(), (int)bytes) == bytes;
+}
+
+void SeriesStore::write(QDataStream &out) const
+{
+	out << (qint32)records.size();
+	for (int i = 0; i < records.size(); i++)
+	{
+		const SeriesRecord &record = records.at(i);
+		out << record.isValid << (qint32)record.seriesNum << record.name << record.velocityUnits << record.firstDate << record.firstTime << record.timestamp;
+		out << (qint32)record.targetDistance << (qint32)record.velocityOffset << (qint32)record.velocityCount;
+		out << (qint32)record.shotOffset << (qint32)record.shotCount << (qint32)record.recordShotCount;
+	}
+
+	writeArray(out, velocityValues);
+	writeArray(out, velocityTimes);
+	writeArray(out, shotX);
+	writeArray(out, shotY);
+	writeArray(out, shotSighter);
+	writeArray(out, shotTimes);
+}
+
+bool SeriesStore::read(QDataStream &in)
+{
+	clear();
+
+	qint32 count;
+	in >> count;
+	if ((in.status() != QDataStream::Ok) || (count < 0))
+	{
+		return false;
+	}
+
+	// Each record takes at least SERIES_RECORD_MIN_BYTES in the stream, more if its strings aren't empty
+	if ((in.device() == NULL) || (count > in.device()->bytesAvailable() / SERIES_RECORD_MIN_BYTES))
+	{
+		return false;
+	}
+
+	records.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		SeriesRecord &record = records[i];
+		qint32 seriesNum, targetDistance, velocityOffset, velocityCount, shotOffset, shotCount, recordShotCount;
+		in >> record.isValid >> seriesNum >> record.name >> record.velocityUnits >> record.firstDate >> record.firstTime >> record.timestamp;
+		in >> targetDistance >> velocityOffset >> velocityCount;
+		in >> shotOffset >> shotCount >> recordShotCount;
+
+		record.seriesNum = seriesNum;
+		record.targetDistance = targetDistance;
+		record.velocityOffset = velocityOffset;
+		record.velocityCount = velocityCount;
+		record.shotOffset = shotOffset;
+		record.shotCount = shotCount;
+		record.recordShotCount = recordShotCount;
+	}
+
+	if ((in.status() != QDataStream::Ok) || !readArray(in, &velocityValues) || !readArray(in, &velocityTimes) ||
+		!readArray(in, &shotX) || !readArray(in, &shotY) || !readArray(in, &shotSighter) || !readArray(in, &shotTimes))
+	{
+		clear();
+		return false;
+	}
+
+	// Make sure every record points inside the arrays before anyone reads through it
+	if ((velocityTimes.size() != velocityValues.size()) || (shotY.size() != shotX.size()) || (shotSighter.size() != shotX.size()) || (shotTimes.size() != shotX.size()))
+	{
+		clear();
+		return false;
+	}
+
+	for (int i = 0; i < records.size(); i++)
+	{
+		const SeriesRecord &record = records.at(i);
+		if ((record.velocityOffset < 0) || (record.velocityCount < 0) || (record.velocityOffset > velocityValues.size()) || (record.velocityCount > velocityValues.size() - record.velocityOffset) ||
+			(record.shotOffset < 0) || (record.shotCount < 0) || (record.shotOffset > shotX.size()) || (record.shotCount > shotX.size() - record.shotOffset))
+		{
+			qCDebug(lcImport) << "SeriesStore: series" << i << "is out of bounds";
+			clear();
+			return false;
+		}
+	}
+
+	updateMemory();
+
+	return true;
+}
+
+void SeriesStore::updateMemory()
+{
+	qint64 bytes = records.capacity() * (qint64)sizeof(SeriesRecord);
+	bytes += velocityValues.capacity() * (qint64)sizeof(double);
+	bytes += velocityTimes.capacity() * (qint64)sizeof(qint64);
+	bytes += (shotX.capacity() + shotY.capacity()) * (qint64)sizeof(double);
+	bytes += shotSighter.capacity() * (qint64)sizeof(bool);
+	bytes += shotTimes.capacity() * (qint64)sizeof(qint64);
+	memory.set(bytes);
+}
@@ -0,0 +1,84 @@
+#ifndef SERIES_STORE_H
+#define SERIES_STORE_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include "TimestampParser.h"
+#include "MemoryStats.h"
+
+class QDataStream;
+
+/*
+ * Metadata for one parsed series. Shot data isn't stored here, the record only points at its
+ * range in the store's shot arrays.
+ */
+struct SeriesRecord
+{
+	bool isValid;
+	int seriesNum;
+	QString name;
+	QString velocityUnits;
+	QString firstDate;
+	QString firstTime;
+	qint64 timestamp; // see TimestampParser, INVALID_TIMESTAMP if unknown
+	int targetDistance; // in yards
+	int velocityOffset;
+	int velocityCount;
+	int shotOffset;
+	int shotCount; // includes sighters
+	int recordShotCount;
+};
+
+/*
+ * Widget-free storage for parsed series. Velocities and target coordinates for every series live
+ * in contiguous arrays, so parsers don't create any QWidgets and can run off the GUI thread. The
+ * tabs read from the store when they build their rows.
+ *
+ * Shots are always appended to the most recently started series. Velocities and shots can carry a
+ * timestamp, and a series without one takes the timestamp of its first timed shot.
+ */
+class SeriesStore
+{
+public:
+	SeriesStore();
+
+	int beginSeries();
+	void discardSeries();
+	void clear();
+
+	int size() const;
+	bool isEmpty() const;
+	SeriesRecord &at(int index);
+	const SeriesRecord &at(int index) const;
+	SeriesRecord &last();
+
+	void appendVelocity(double velocity, qint64 timestamp = INVALID_TIMESTAMP);
+	void appendShot(double x, double y, bool sighter, qint64 timestamp = INVALID_TIMESTAMP);
+
+	const double *velocityData(int index) const;
+	const qint64 *velocityTimestamps(int index) const;
+	const qint64 *shotTimestamps(int index) const;
+	QList<double> velocities(int index) const;
+	QList<QPair<double, double> > coordinates(int index, bool includeSighters) const;
+
+	// Compact binary form. The shot arrays are written as raw blocks in native byte order.
+	void write(QDataStream &out) const;
+	bool read(QDataStream &in);
+
+private:
+	// Accounts the capacity of every array as shot data
+	void updateMemory();
+
+	QVector<SeriesRecord> records;
+	QVector<double> velocityValues;
+	QVector<qint64> velocityTimes;
+	QVector<double> shotX;
+	QVector<double> shotY;
+	QVector<bool> shotSighter;
+	QVector<qint64> shotTimes;
+	MemoryAccount<MemoryStats::SHOT_DATA> memory;
+};
+
+#endif // SERIES_STORE_H
@@ -0,0 +1,227 @@
+#include "SeriesTable.h"
+
+#include <QApplication>
+#include <QHeaderView>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QPainter>
+#include <QTimer>
+#include <QDebug>
+
+QTableView *SeriesTable::createView(QAbstractItemModel *model)
+{
+	QTableView *view = new QTableView();
+	view->setModel(model);
+	view->setSelectionMode(QAbstractItemView::NoSelection);
+	view->setEditTriggers(QAbstractItemView::AllEditTriggers);
+	view->setShowGrid(false);
+	view->setWordWrap(false);
+	view->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+	view->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+	view->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+	// Every row is the height of a spin box editor. Fixed row heights mean the view never measures rows it isn't showing.
+	QDoubleSpinBox spinBox;
+	view->verticalHeader()->hide();
+	view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	view->verticalHeader()->setDefaultSectionSize(spinBox.sizeHint().height());
+
+	// Columns sized to their contents only look at the visible rows
+	view->horizontalHeader()->setResizeContentsPrecision(0);
+	view->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+	view->horizontalHeader()->setHighlightSections(false);
+	view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+	view->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+
+	return view;
+}
+
+SeriesTableModel::SeriesTableModel(QObject *parent)
+	: QAbstractTableModel(parent), flushPending(false)
+{
+}
+
+void SeriesTableModel::seriesChanged(int row)
+{
+	markDirty(row, 0, columnCount() - 1);
+}
+
+void SeriesTableModel::refresh(void)
+{
+	for (int row = 0; row < rowCount(); row++)
+	{
+		markDirty(row, 0, columnCount() - 1);
+	}
+}
+
+void SeriesTableModel::markDirty(int row, int firstColumn, int lastColumn)
+{
+	QMap<int, DirtyColumns>::iterator it = dirtyRows.find(row);
+	if (it == dirtyRows.end())
+	{
+		DirtyColumns columns;
+		columns.first = firstColumn;
+		columns.last = lastColumn;
+		dirtyRows.insert(row, columns);
+	}
+	else
+	{
+		it->first = qMin(it->first, firstColumn);
+		it->last = qMax(it->last, lastColumn);
+	}
+
+	if (!flushPending)
+	{
+		flushPending = true;
+		QTimer::singleShot(0, this, &SeriesTableModel::flushChanges);
+	}
+}
+
+void SeriesTableModel::flushChanges(void)
+{
+	flushPending = false;
+
+	// Rows may have been removed since they were marked
+	int rows = rowCount();
+
+	QMap<int, DirtyColumns>::const_iterator it = dirtyRows.constBegin();
+	while ((it != dirtyRows.constEnd()) && (it.key() < rows))
+	{
+		int firstRow = it.key();
+		int lastRow = firstRow;
+		DirtyColumns columns = it.value();
+
+		for (++it; (it != dirtyRows.constEnd()) && (it.key() == lastRow + 1) && (it.key() < rows); ++it)
+		{
+			lastRow = it.key();
+			columns.first = qMin(columns.first, it->first);
+			columns.last = qMax(columns.last, it->last);
+		}
+
+		emit dataChanged(index(firstRow, columns.first), index(lastRow, columns.last));
+	}
+
+	dirtyRows.clear();
+}
+
+SpinBoxDelegate::SpinBoxDelegate(int decimals, double singleStep, double maximum, QObject *parent)
+	: QStyledItemDelegate(parent)
+{
+	this->decimals = decimals;
+	this->singleStep = singleStep;
+	this->maximum = maximum;
+}
+
+QWidget *SpinBoxDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+	Q_UNUSED(option);
+	Q_UNUSED(index);
+
+	if (decimals == 0)
+	{
+		QSpinBox *editor = new QSpinBox(parent);
+		editor->setSingleStep((int)singleStep);
+		editor->setMaximum((int)maximum);
+		editor->setMaximumWidth(100);
+		return editor;
+	}
+
+	QDoubleSpinBox *editor = new QDoubleSpinBox(parent);
+	editor->setDecimals(decimals);
+	editor->setSingleStep(singleStep);
+	editor->setMaximum(maximum);
+	editor->setMaximumWidth(100);
+	return editor;
+}
+
+void SpinBoxDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+	if (decimals == 0)
+	{
+		static_cast<QSpinBox *>(editor)->setValue(index.data(Qt::EditRole).toInt());
+	}
+	else
+	{
+		static_cast<QDoubleSpinBox *>(editor)->setValue(index.data(Qt::EditRole).toDouble());
+	}
+}
+
+void SpinBoxDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+	if (decimals == 0)
+	{
+		QSpinBox *spinBox = static_cast<QSpinBox *>(editor);
+		spinBox->interpretText();
+		model->setData(index, spinBox->value(), Qt::EditRole);
+	}
+	else
+	{
+		QDoubleSpinBox *spinBox = static_cast<QDoubleSpinBox *>(editor);
+		spinBox->interpretText();
+		model->setData(index, spinBox->value(), Qt::EditRole);
+	}
+}
+
+QString SpinBoxDelegate::displayText(const QVariant &value, const QLocale &locale) const
+{
+	return locale.toString(value.toDouble(), 'f', decimals);
+}
+
+ButtonDelegate::ButtonDelegate(QObject *parent)
+	: QStyledItemDelegate(parent)
+{
+}
+
+void ButtonDelegate::initButtonOption(QStyleOptionButton *button, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+	QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+
+	if (option.widget)
+	{
+		button->initFrom(option.widget);
+	}
+	button->text = index.data(Qt::DisplayRole).toString();
+	button->icon = qvariant_cast<QIcon>(index.data(Qt::DecorationRole));
+	button->iconSize = option.decorationSize;
+	button->state = QStyle::State_Raised;
+	if (option.state & QStyle::State_Enabled)
+	{
+		button->state |= QStyle::State_Enabled;
+	}
+
+	// Size the button to its contents, like QPushButton::minimumSizeHint()
+	QSize contents = option.fontMetrics.size(Qt::TextShowMnemonic, button->text);
+	if (!button->icon.isNull())
+	{
+		contents.setWidth(contents.width() + button->iconSize.width() + 4);
+		contents.setHeight(qMax(contents.height(), button->iconSize.height()));
+	}
+	QSize size = style->sizeFromContents(QStyle::CT_PushButton, button, contents, option.widget);
+	size = size.boundedTo(option.rect.size());
+
+	button->rect = QRect(option.rect.left(), option.rect.top() + (option.rect.height() - size.height()) / 2, size.width(), size.height());
+}
+
+void ButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+	QStyleOptionViewItem itemOption = option;
+	initStyleOption(&itemOption, index);
+
+	QStyleOptionButton button;
+	initButtonOption(&button, itemOption, index);
+
+	QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+	style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
+}
+
+QSize ButtonDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+	QStyleOptionViewItem itemOption = option;
+	initStyleOption(&itemOption, index);
+	itemOption.rect = QRect(0, 0, QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+
+	QStyleOptionButton button;
+	initButtonOption(&button, itemOption, index);
+
+	return button.rect.size();
+}
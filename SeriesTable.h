@@ -0,0 +1,88 @@
+#ifndef SERIES_TABLE_H
+#define SERIES_TABLE_H
+
+#include <QStyledItemDelegate>
+#include <QStyleOption>
+#include <QTableView>
+#include <QAbstractItemModel>
+#include <QAbstractTableModel>
+#include <QMap>
+
+/*
+ * Shared pieces of the series tables on each tab. The tables are QTableViews over a per-tab model,
+ * so only the visible rows are painted and a single editor exists at a time, no matter how many
+ * series are loaded.
+ */
+class SeriesTable
+{
+public:
+	static QTableView *createView(QAbstractItemModel *model);
+};
+
+/*
+ * Base of the tabs' series models. Changed cells are collected per row and reported on the next pass
+ * of the event loop, one dataChanged() per run of adjacent rows, so a burst of changes (e.g. "Select
+ * all" or switching units on a long table) repaints each affected row once.
+ */
+class SeriesTableModel : public QAbstractTableModel
+{
+public:
+	SeriesTableModel(QObject *parent = 0);
+
+	// The series in a row were changed directly, e.g. their group size text was recalculated
+	void seriesChanged(int row);
+
+	// Every row, for changes that touch the whole table
+	void refresh(void);
+
+	// Reports collected changes now instead of waiting for the event loop
+	void flushChanges(void);
+
+protected:
+	void markDirty(int row, int firstColumn, int lastColumn);
+
+private:
+	struct DirtyColumns
+	{
+		int first;
+		int last;
+	};
+
+	QMap<int, DirtyColumns> dirtyRows;
+	bool flushPending;
+};
+
+/* Edits a numeric cell with a spin box. Zero decimals gives a QSpinBox, otherwise a QDoubleSpinBox. */
+class SpinBoxDelegate : public QStyledItemDelegate
+{
+public:
+	SpinBoxDelegate(int decimals, double singleStep, double maximum, QObject *parent = 0);
+
+	virtual QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
+	virtual void setEditorData(QWidget *editor, const QModelIndex &index) const Q_DECL_OVERRIDE;
+	virtual void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const Q_DECL_OVERRIDE;
+	virtual QString displayText(const QVariant &value, const QLocale &locale) const Q_DECL_OVERRIDE;
+
+private:
+	int decimals;
+	double singleStep;
+	double maximum;
+};
+
+/*
+ * Paints a cell as a push button using its display text and decoration icon. Clicks are handled
+ * by the tab through QTableView::clicked().
+ */
+class ButtonDelegate : public QStyledItemDelegate
+{
+public:
+	ButtonDelegate(QObject *parent = 0);
+
+	virtual void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
+	virtual QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
+
+private:
+	void initButtonOption(QStyleOptionButton *button, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+};
+
+#endif // SERIES_TABLE_H
@@ -0,0 +1,356 @@
+#include "SessionFile.h"
+#include "Logging.h"
+
+#include <QSaveFile>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QDebug>
+#include <string.h>
+
+#define SESSION_BYTE_ORDER 0x01020304
+
+static quint64 alignTo8(quint64 offset)
+{
+	return (offset + 7) & ~(quint64)7;
+}
+
+SessionFile::SessionFile()
+{
+	data = NULL;
+	dataSize = 0;
+	header = NULL;
+}
+
+SessionFile::~SessionFile()
+{
+	close();
+}
+
+bool SessionFile::inBounds(quint64 offset, quint64 count, quint64 size) const
+{
+	if (((offset % 8) != 0) || (offset > (quint64)dataSize))
+	{
+		return false;
+	}
+
+	return count <= ((quint64)dataSize - offset) / size;
+}
+
+bool SessionFile::open(const QString &path, TestType testType, QString *error)
+{
+	close();
+
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		*error = file.errorString();
+		return false;
+	}
+
+	dataSize = file.size();
+	if (dataSize < (qint64)sizeof(SessionFileHeader))
+	{
+		*error = "Not a ChronoPlotter session file.";
+		close();
+		return false;
+	}
+
+	data = file.map(0, dataSize);
+	if (data == NULL)
+	{
+		*error = file.errorString();
+		close();
+		return false;
+	}
+
+	header = (const SessionFileHeader *)data;
+
+	if (memcmp(header->magic, SESSION_FILE_MAGIC, sizeof(header->magic)) != 0)
+	{
+		*error = "Not a ChronoPlotter session file.";
+		close();
+		return false;
+	}
+
+	if (header->byteOrder != SESSION_BYTE_ORDER)
+	{
+		*error = "The session was saved on a machine with a different byte order.";
+		close();
+		return false;
+	}
+
+	if (header->version != SESSION_FILE_VERSION)
+	{
+		*error = QString("Unsupported session file version %1.").arg(header->version);
+		close();
+		return false;
+	}
+
+	if (header->testType != (quint32)testType)
+	{
+		*error = "The session was saved from a different test.";
+		close();
+		return false;
+	}
+
+	if (!inBounds(header->seriesOffset, header->seriesCount, sizeof(SessionSeries)) ||
+		!inBounds(header->optionsOffset, header->optionCount, sizeof(SessionOption)) ||
+		!inBounds(header->velocityOffset, header->velocityCount, sizeof(double)) ||
+		!inBounds(header->shotXOffset, header->shotCount, sizeof(double)) ||
+		!inBounds(header->shotYOffset, header->shotCount, sizeof(double)) ||
+		!inBounds(header->shotFlagsOffset, header->shotCount, sizeof(quint8)) ||
+		!inBounds(header->stringsOffset, header->stringCount, sizeof(QChar)))
+	{
+		*error = "The session file is truncated or damaged.";
+		close();
+		return false;
+	}
+
+	// Check every series' ranges once here, so the accessors don't have to
+	for (int i = 0; i < seriesCount(); i++)
+	{
+		const SessionSeries &entry = series(i);
+		if ((entry.velocityOffset > header->velocityCount) || (entry.velocityCount > header->velocityCount - entry.velocityOffset) ||
+			(entry.shotOffset > header->shotCount) || (entry.shotCount > header->shotCount - entry.shotOffset))
+		{
+			*error = "The session file is truncated or damaged.";
+			close();
+			return false;
+		}
+	}
+
+	qCDebug(lcImport) << "Opened session" << path << "with" << header->seriesCount << "series," << header->velocityCount << "velocities and" << header->shotCount << "shots";
+
+	return true;
+}
+
+void SessionFile::close()
+{
+	if (data != NULL)
+	{
+		file.unmap(data);
+	}
+
+	file.close();
+
+	data = NULL;
+	dataSize = 0;
+	header = NULL;
+}
+
+quint32 SessionFile::flags() const
+{
+	return header->flags;
+}
+
+int SessionFile::seriesCount() const
+{
+	return header->seriesCount;
+}
+
+const SessionSeries &SessionFile::series(int index) const
+{
+	return ((const SessionSeries *)(data + header->seriesOffset))[index];
+}
+
+const double *SessionFile::velocities(int index) const
+{
+	return (const double *)(data + header->velocityOffset) + series(index).velocityOffset;
+}
+
+const double *SessionFile::shotX(int index) const
+{
+	return (const double *)(data + header->shotXOffset) + series(index).shotOffset;
+}
+
+const double *SessionFile::shotY(int index) const
+{
+	return (const double *)(data + header->shotYOffset) + series(index).shotOffset;
+}
+
+const quint8 *SessionFile::shotFlags(int index) const
+{
+	return (const quint8 *)(data + header->shotFlagsOffset) + series(index).shotOffset;
+}
+
+QString SessionFile::text(const SessionString &string) const
+{
+	if ((string.offset > header->stringCount) || (string.length > header->stringCount - string.offset))
+	{
+		return QString();
+	}
+
+	return QString((const QChar *)(data + header->stringsOffset) + string.offset, string.length);
+}
+
+QString SessionFile::option(const QString &key) const
+{
+	const SessionOption *options = (const SessionOption *)(data + header->optionsOffset);
+	for (quint32 i = 0; i < header->optionCount; i++)
+	{
+		if (text(options[i].key) == key)
+		{
+			return text(options[i].value);
+		}
+	}
+
+	return QString();
+}
+
+void SessionFile::restoreOption(const QString &key, QWidget *widget) const
+{
+	QString value = option(key);
+
+	if (QLineEdit *lineEdit = qobject_cast<QLineEdit *>(widget))
+	{
+		lineEdit->setText(value);
+	}
+	else if (QComboBox *comboBox = qobject_cast<QComboBox *>(widget))
+	{
+		bool ok;
+		int index = value.toInt(&ok);
+		if (ok && (index >= 0) && (index < comboBox->count()))
+		{
+			comboBox->setCurrentIndex(index);
+		}
+	}
+	else if (QCheckBox *checkBox = qobject_cast<QCheckBox *>(widget))
+	{
+		if (!value.isEmpty())
+		{
+			checkBox->setChecked(value == "1");
+		}
+	}
+}
+
+SessionFileWriter::SessionFileWriter(SessionFile::TestType testType, quint32 flags)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SESSION_FILE_MAGIC, sizeof(header.magic));
+	header.byteOrder = SESSION_BYTE_ORDER;
+	header.version = SESSION_FILE_VERSION;
+	header.testType = testType;
+	header.flags = flags;
+}
+
+SessionString SessionFileWriter::addString(const QString &string)
+{
+	SessionString result;
+	result.offset = strings.size();
+	result.length = string.size();
+
+	strings.resize(strings.size() + string.size());
+	memcpy(strings.data() + result.offset, string.constData(), string.size() * sizeof(QChar));
+
+	return result;
+}
+
+SessionSeries &SessionFileWriter::addSeries(int seriesNum, const QString &name, const QString &velocityUnits, const QString &firstDate, const QString &firstTime)
+{
+	SessionSeries entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.seriesNum = seriesNum;
+	entry.name = addString(name);
+	entry.velocityUnits = addString(velocityUnits);
+	entry.firstDate = addString(firstDate);
+	entry.firstTime = addString(firstTime);
+	entry.velocityOffset = velocityValues.size();
+	entry.shotOffset = shotX.size();
+
+	seriesList.append(entry);
+
+	return seriesList.last();
+}
+
+void SessionFileWriter::appendVelocity(double velocity)
+{
+	velocityValues.append(velocity);
+	seriesList.last().velocityCount++;
+}
+
+void SessionFileWriter::appendShot(double x, double y, bool sighter)
+{
+	shotX.append(x);
+	shotY.append(y);
+	shotFlags.append(sighter ? SessionFile::SHOT_SIGHTER : 0);
+	seriesList.last().shotCount++;
+}
+
+void SessionFileWriter::setOption(const QString &key, const QString &value)
+{
+	SessionOption option;
+	option.key = addString(key);
+	option.value = addString(value);
+
+	options.append(option);
+}
+
+void SessionFileWriter::setOption(const QString &key, QWidget *widget)
+{
+	if (QLineEdit *lineEdit = qobject_cast<QLineEdit *>(widget))
+	{
+		setOption(key, lineEdit->text());
+	}
+	else if (QComboBox *comboBox = qobject_cast<QComboBox *>(widget))
+	{
+		setOption(key, QString::number(comboBox->currentIndex()));
+	}
+	else if (QCheckBox *checkBox = qobject_cast<QCheckBox *>(widget))
+	{
+		setOption(key, checkBox->isChecked() ? "1" : "0");
+	}
+}
+
+bool SessionFileWriter::save(const QString &path, QString *error)
+{
+	/* Lay out the arrays after the header */
+
+	quint64 offset = alignTo8(sizeof(SessionFileHeader));
+
+	header.seriesCount = seriesList.size();
+	header.seriesOffset = offset;
+	offset = alignTo8(offset + seriesList.size() * sizeof(SessionSeries));
+
+	header.optionCount = options.size();
+	header.optionsOffset = offset;
+	offset = alignTo8(offset + options.size() * sizeof(SessionOption));
+
+	header.velocityCount = velocityValues.size();
+	header.velocityOffset = offset;
+	offset = alignTo8(offset + velocityValues.size() * sizeof(double));
+
+	header.shotCount = shotX.size();
+	header.shotXOffset = offset;
+	offset = alignTo8(offset + shotX.size() * sizeof(double));
+	header.shotYOffset = offset;
+	offset = alignTo8(offset + shotY.size() * sizeof(double));
+	header.shotFlagsOffset = offset;
+	offset = alignTo8(offset + shotFlags.size() * sizeof(quint8));
+
+	header.stringCount = strings.size();
+	header.stringsOffset = offset;
+	offset = alignTo8(offset + strings.size() * sizeof(QChar));
+
+	QByteArray buf(offset, '\0');
+	char *out = buf.data();
+	memcpy(out, &header, sizeof(header));
+	memcpy(out + header.seriesOffset, seriesList.constData(), seriesList.size() * sizeof(SessionSeries));
+	memcpy(out + header.optionsOffset, options.constData(), options.size() * sizeof(SessionOption));
+	memcpy(out + header.velocityOffset, velocityValues.constData(), velocityValues.size() * sizeof(double));
+	memcpy(out + header.shotXOffset, shotX.constData(), shotX.size() * sizeof(double));
+	memcpy(out + header.shotYOffset, shotY.constData(), shotY.size() * sizeof(double));
+	memcpy(out + header.shotFlagsOffset, shotFlags.constData(), shotFlags.size() * sizeof(quint8));
+	memcpy(out + header.stringsOffset, strings.constData(), strings.size() * sizeof(QChar));
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly) || (file.write(buf) != buf.size()) || !file.commit())
+	{
+		*error = file.errorString();
+		return false;
+	}
+
+	qCDebug(lcImport) << "Saved session" << path << "with" << seriesList.size() << "series," << velocityValues.size() << "velocities and" << shotX.size() << "shots";
+
+	return true;
+}
@@ -0,0 +1,172 @@
+#ifndef SESSION_FILE_H
+#define SESSION_FILE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+
+/*
+ * A saved test session. The file is a fixed header followed by flat arrays, each 8-byte aligned:
+ *
+ *     SessionFileHeader
+ *     SessionSeries[seriesCount]
+ *     SessionOption[optionCount]
+ *     double velocities[velocityCount]
+ *     double shotX[shotCount], double shotY[shotCount]
+ *     quint8 shotFlags[shotCount]
+ *     QChar strings[stringCount]
+ *
+ * Every series points at its range in the velocity and shot arrays, so an opened file is mapped and
+ * read in place. Files are written in the byte order of the machine that saved them and files with
+ * a foreign byte order are rejected.
+ */
+
+#define SESSION_FILE_MAGIC "CPSESSN"
+#define SESSION_FILE_VERSION 2
+
+struct SessionString
+{
+	quint32 offset; // in QChars
+	quint32 length;
+};
+
+struct SessionFileHeader
+{
+	char magic[8];
+	quint32 byteOrder; // 0x01020304 as written
+	quint32 version;
+	quint32 testType;
+	quint32 flags;
+	quint32 seriesCount;
+	quint32 optionCount;
+	quint64 seriesOffset;
+	quint64 optionsOffset;
+	quint64 velocityOffset;
+	quint64 velocityCount;
+	quint64 shotXOffset;
+	quint64 shotYOffset;
+	quint64 shotFlagsOffset;
+	quint64 shotCount;
+	quint64 stringsOffset;
+	quint64 stringCount;
+};
+
+struct SessionSeries
+{
+	qint32 seriesNum;
+	quint32 flags;
+	double setting; // charge weight, tuner setting or cartridge length
+	double groupSize; // manually entered group size
+	qint32 targetDistance; // in yards
+	quint32 reserved;
+	SessionString name;
+	SessionString velocityUnits;
+	SessionString firstDate;
+	SessionString firstTime;
+	qint64 timestamp; // see TimestampParser
+	quint64 velocityOffset;
+	quint64 velocityCount;
+	quint64 shotOffset;
+	quint64 shotCount;
+};
+
+struct SessionOption
+{
+	SessionString key;
+	SessionString value;
+};
+
+class SessionFile
+{
+public:
+	enum TestType
+	{
+		POWDER_TEST = 1,
+		SEATING_DEPTH_TEST = 2,
+		TUNER_TEST = 3
+	};
+
+	// SessionFileHeader::flags
+	enum
+	{
+		MANUAL_ENTRY = 0x1
+	};
+
+	// SessionSeries::flags
+	enum
+	{
+		SERIES_ENABLED = 0x1,
+		SERIES_MANUAL_ENTRY = 0x2
+	};
+
+	// shotFlags
+	enum
+	{
+		SHOT_SIGHTER = 0x1
+	};
+
+	SessionFile();
+	~SessionFile();
+
+	// Maps the file and checks that every array is inside it. On failure, error says why.
+	bool open(const QString &path, TestType testType, QString *error);
+	void close();
+
+	quint32 flags() const;
+	int seriesCount() const;
+	const SessionSeries &series(int index) const;
+	const double *velocities(int index) const;
+	const double *shotX(int index) const;
+	const double *shotY(int index) const;
+	const quint8 *shotFlags(int index) const;
+
+	// Returns a copy, so it stays valid after the file is closed
+	QString text(const SessionString &string) const;
+
+	QString option(const QString &key) const;
+
+	// Restores a QLineEdit, QComboBox or QCheckBox saved with SessionFileWriter::setOption()
+	void restoreOption(const QString &key, QWidget *widget) const;
+
+private:
+	bool inBounds(quint64 offset, quint64 count, quint64 size) const;
+
+	QFile file;
+	uchar *data;
+	qint64 dataSize;
+	const SessionFileHeader *header;
+
+	SessionFile(const SessionFile &);
+	SessionFile &operator=(const SessionFile &);
+};
+
+class SessionFileWriter
+{
+public:
+	SessionFileWriter(SessionFile::TestType testType, quint32 flags);
+
+	// Velocities and shots are added to the most recently added series. The returned entry is only valid until the next addSeries().
+	SessionSeries &addSeries(int seriesNum, const QString &name, const QString &velocityUnits, const QString &firstDate, const QString &firstTime);
+	void appendVelocity(double velocity);
+	void appendShot(double x, double y, bool sighter);
+
+	void setOption(const QString &key, const QString &value);
+	void setOption(const QString &key, QWidget *widget);
+
+	bool save(const QString &path, QString *error);
+
+private:
+	SessionString addString(const QString &string);
+
+	SessionFileHeader header;
+	QVector<SessionSeries> seriesList;
+	QVector<SessionOption> options;
+	QVector<double> velocityValues;
+	QVector<double> shotX;
+	QVector<double> shotY;
+	QVector<quint8> shotFlags;
+	QVector<QChar> strings;
+};
+
+#endif // SESSION_FILE_H
@@ -0,0 +1,316 @@
+#include "ShotMarkerArchive.h"
+#include "miniz.h"
+#include "untar.h"
+#include "TimestampParser.h"
+#include "Trace.h"
+#include "Logging.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QJsonParseError>
+#include <QDebug>
+
+// 1mb ought to be enough for anybody!
+#define MAX_STRING_SIZE (1024 * 1024)
+
+namespace
+{
+	struct CacheEntry
+	{
+		qint64 size;
+		QDateTime lastModified;
+		QSharedPointer<const ShotMarkerArchive> archive;
+	};
+
+	QMutex cacheMutex;
+	QHash<QString, CacheEntry> cache;
+}
+
+ShotMarkerArchive::ShotMarkerArchive()
+{
+}
+
+QSharedPointer<const ShotMarkerArchive> ShotMarkerArchive::open(const QString &path)
+{
+	QFileInfo info(path);
+	QString key = info.canonicalFilePath();
+	if (key.isEmpty())
+	{
+		qCDebug(lcImport) << "ShotMarker archive doesn't exist:" << path;
+		return QSharedPointer<const ShotMarkerArchive>();
+	}
+
+	QMutexLocker locker(&cacheMutex);
+
+	QHash<QString, CacheEntry>::const_iterator it = cache.constFind(key);
+	if ((it != cache.constEnd()) && (it->size == info.size()) && (it->lastModified == info.lastModified()))
+	{
+		qCDebug(lcImport) << "Using cached ShotMarker archive:" << key;
+		return it->archive;
+	}
+
+	QSharedPointer<ShotMarkerArchive> archive(new ShotMarkerArchive());
+	if (!archive->decode(key))
+	{
+		cache.remove(key);
+		return QSharedPointer<const ShotMarkerArchive>();
+	}
+
+	CacheEntry entry;
+	entry.size = info.size();
+	entry.lastModified = info.lastModified();
+	entry.archive = archive;
+	cache.insert(key, entry);
+
+	return archive;
+}
+
+void ShotMarkerArchive::clearCache()
+{
+	QMutexLocker locker(&cacheMutex);
+	cache.clear();
+}
+
+int ShotMarkerArchive::stringCount() const
+{
+	return strings.size();
+}
+
+const ShotMarkerString &ShotMarkerArchive::string(int index) const
+{
+	return strings.at(index);
+}
+
+const ShotMarkerShot *ShotMarkerArchive::shots(int index) const
+{
+	return shotData.constData() + strings.at(index).shotOffset;
+}
+
+bool ShotMarkerArchive::decode(const QString &path)
+{
+	TRACE_SPAN("import", "ShotMarker archive");
+
+	QTemporaryDir tempDir;
+	if (!tempDir.isValid())
+	{
+		qCDebug(lcImport) << "Temp directory is NOT valid";
+	}
+
+	qCDebug(lcImport) << "Temporary directory:" << tempDir.path();
+
+	/*
+	 * ShotMarker .tar files contain one .z file for each string being exported.
+	 * Each .z file is a zlib-compressed JSON file containing shot data for that string.
+	 */
+
+	QFile rf(path);
+	if (!rf.open(QIODevice::ReadOnly))
+	{
+		qCDebug(lcImport) << "Failed to open ShotMarker .tar file:" << path;
+		return false;
+	}
+
+	TraceSpan untarSpan("import", "tar extraction");
+	if (untar(rf, tempDir.path()))
+	{
+		qCDebug(lcImport) << "Error while extracting ShotMarker .tar file:" << path;
+		return false;
+	}
+	untarSpan.end();
+
+	QDir dir(tempDir.path());
+	QStringList stringFiles = dir.entryList(QStringList() << "*.z", QDir::Files);
+
+	qCDebug(lcImport) << "iterating over files:";
+	int seriesNum = 1;
+	foreach (QString filename, stringFiles)
+	{
+		QFile file(dir.filePath(filename));
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			qCDebug(lcImport) << "Failed to open, skipping..." << file.fileName();
+			continue;
+		}
+
+		if (decodeString(file.readAll(), seriesNum))
+		{
+			seriesNum++;
+		}
+	}
+
+	qCDebug(lcImport) << "Decoded" << strings.size() << "strings with" << shotData.size() << "shots from" << path;
+
+	qint64 bytes = shotData.capacity() * (qint64)sizeof(ShotMarkerShot) + strings.capacity() * (qint64)sizeof(ShotMarkerString);
+	foreach (const ShotMarkerString &string, strings)
+	{
+		bytes += MemoryStats::stringBytes(string.name) + MemoryStats::stringBytes(string.distUnit);
+	}
+	memory.set(bytes);
+
+	return true;
+}
+
+bool ShotMarkerArchive::decodeString(const QByteArray &compressed, int seriesNum)
+{
+	QByteArray json(MAX_STRING_SIZE, Qt::Uninitialized);
+	mz_ulong uncomp_len = MAX_STRING_SIZE;
+
+	// Held until the string is parsed, along with the compressed copy read from the .z file
+	MemoryAccount<MemoryStats::DECOMPRESSION_BUFFERS> bufferMemory;
+	bufferMemory.set(MAX_STRING_SIZE + compressed.size());
+
+	TraceSpan inflateSpan("import", "inflate");
+	int ret = uncompress((unsigned char *)json.data(), &uncomp_len, (const unsigned char *)compressed.constData(), compressed.size());
+	inflateSpan.end();
+	if (ret != MZ_OK)
+	{
+		qCDebug(lcImport) << "Failed to uncompress, skipping...";
+		return false;
+	}
+
+	json.truncate(uncomp_len);
+
+	TRACE_SPAN("import", "JSON parse");
+
+	QJsonParseError parseError;
+	QJsonDocument jsonDoc = QJsonDocument::fromJson(json, &parseError);
+	if (parseError.error != QJsonParseError::NoError)
+	{
+		qCDebug(lcImport) << "JSON parse error, skipping... at" << parseError.offset << ":" << parseError.errorString();
+		return false;
+	}
+
+	QJsonObject jsonObj = jsonDoc.object();
+
+	ShotMarkerString string;
+	string.seriesNum = seriesNum;
+	string.name = jsonObj["name"].toString();
+	string.dist = jsonObj["dist"].toInt();
+	string.distUnit = jsonObj["dist_unit"].toString();
+	string.timestamp = jsonObj["ts"].toVariant().toLongLong();
+	string.calX = jsonObj["cal_x"].toDouble();
+	string.calY = jsonObj["cal_y"].toDouble();
+	string.shotOffset = shotData.size();
+	string.shotCount = 0;
+
+	qCDebug(lcImport) << "name =" << string.name << "ts =" << string.timestamp;
+
+	QJsonArray shotArray = jsonObj["shots"].toArray();
+	shotData.reserve(shotData.size() + shotArray.size());
+
+	foreach (const QJsonValue &value, shotArray)
+	{
+		QJsonObject shotObj = value.toObject();
+
+		ShotMarkerShot shot;
+		shot.x = shotObj["x"].toDouble();
+		shot.y = shotObj["y"].toDouble();
+		shot.velocity = shotObj["v"].toDouble();
+		shot.sighter = shotObj["sighter"].toBool();
+		shot.hidden = shotObj["hidden"].toBool();
+
+		shotData.append(shot);
+		string.shotCount++;
+	}
+
+	strings.append(string);
+
+	return true;
+}
+
+void ShotMarkerArchive::appendVelocitySeries(SeriesStore *store) const
+{
+	for (int i = 0; i < strings.size(); i++)
+	{
+		const ShotMarkerString &string = strings.at(i);
+
+		SeriesRecord *curSeries = &store->at(store->beginSeries());
+		curSeries->seriesNum = string.seriesNum;
+		curSeries->name = string.name;
+		curSeries->velocityUnits = "ft/s";
+		QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(string.timestamp);
+		curSeries->firstDate = dateTime.date().toString(Qt::TextDate);
+		curSeries->firstTime = dateTime.time().toString(Qt::TextDate);
+		curSeries->timestamp = TimestampParser::fromEpoch(string.timestamp);
+
+		const ShotMarkerShot *stringShots = shots(i);
+		for (int j = 0; j < string.shotCount; j++)
+		{
+			if (stringShots[j].hidden || stringShots[j].sighter)
+			{
+				continue;
+			}
+
+			// convert from m/s to ft/s
+			double velocity = stringShots[j].velocity * 1.0936133 * 3;
+			store->appendVelocity(velocity);
+		}
+
+		if (curSeries->velocityCount > 0)
+		{
+			curSeries->isValid = true;
+		}
+		else
+		{
+			qCDebug(lcImport) << "No record shots in" << string.name << ", skipping";
+			store->discardSeries();
+		}
+	}
+}
+
+void ShotMarkerArchive::appendCoordinateSeries(SeriesStore *store) const
+{
+	for (int i = 0; i < strings.size(); i++)
+	{
+		const ShotMarkerString &string = strings.at(i);
+
+		SeriesRecord *curSeries = &store->at(store->beginSeries());
+		curSeries->seriesNum = string.seriesNum;
+		curSeries->name = string.name + QString(" (%1%2)").arg(string.dist).arg(string.distUnit);
+		QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(string.timestamp);
+		curSeries->firstDate = dateTime.date().toString(Qt::TextDate);
+		curSeries->firstTime = dateTime.time().toString(Qt::TextDate);
+		curSeries->timestamp = TimestampParser::fromEpoch(string.timestamp);
+
+		if (string.distUnit == "y")
+		{
+			// distance is in yards already
+			curSeries->targetDistance = string.dist;
+		}
+		else
+		{
+			// convert from meters to yards
+			curSeries->targetDistance = string.dist * 1.0936133; // the result is cast to an int
+		}
+
+		const ShotMarkerShot *stringShots = shots(i);
+		for (int j = 0; j < string.shotCount; j++)
+		{
+			if (stringShots[j].hidden)
+			{
+				continue;
+			}
+
+			// convert from millimeters to inches
+			double x = (stringShots[j].x + string.calX) / 25.4;
+			double y = (stringShots[j].y + string.calY) / 25.4;
+			store->appendShot(x, y, stringShots[j].sighter);
+		}
+
+		if (curSeries->shotCount == 0)
+		{
+			qCDebug(lcImport) << "No shots in" << string.name << ", skipping";
+			store->discardSeries();
+		}
+	}
+}
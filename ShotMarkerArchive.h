@@ -0,0 +1,70 @@
+#ifndef SHOTMARKER_ARCHIVE_H
+#define SHOTMARKER_ARCHIVE_H
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include "SeriesStore.h"
+#include "MemoryStats.h"
+
+/* One shot as recorded by ShotMarker. Coordinates are in millimeters and don't include the string's calibration offset. */
+struct ShotMarkerShot
+{
+	double x;
+	double y;
+	double velocity; // in m/s
+	bool sighter;
+	bool hidden;
+};
+
+/* Metadata for one string in the archive. The shots live in the archive's shot array. */
+struct ShotMarkerString
+{
+	int seriesNum;
+	QString name;
+	int dist;
+	QString distUnit;
+	qint64 timestamp; // ms since epoch
+	double calX;
+	double calY;
+	int shotOffset;
+	int shotCount;
+};
+
+/*
+ * A ShotMarker .tar export decoded into memory. The archive holds one zlib-compressed JSON file per
+ * string, which is expensive to unpack, so every tab opens archives through open(). Archives are
+ * cached for the rest of the session and a file is only decoded again if it changes on disk.
+ *
+ * The powder test reads velocities from the archive, the tuner and seating depth tests read target
+ * coordinates.
+ */
+class ShotMarkerArchive
+{
+public:
+	// Returns a null pointer if the file can't be read as a ShotMarker archive
+	static QSharedPointer<const ShotMarkerArchive> open(const QString &path);
+	static void clearCache();
+
+	int stringCount() const;
+	const ShotMarkerString &string(int index) const;
+	const ShotMarkerShot *shots(int index) const;
+
+	// Appends a series of record shot velocities (in ft/s) for each string
+	void appendVelocitySeries(SeriesStore *store) const;
+
+	// Appends a series of shot coordinates (in inches, sighters included) for each string
+	void appendCoordinateSeries(SeriesStore *store) const;
+
+private:
+	ShotMarkerArchive();
+
+	bool decode(const QString &path);
+	bool decodeString(const QByteArray &compressed, int seriesNum);
+
+	QVector<ShotMarkerString> strings;
+	QVector<ShotMarkerShot> shotData;
+	MemoryAccount<MemoryStats::SHOT_DATA> memory; // released when the cache drops the archive
+};
+
+#endif // SHOTMARKER_ARCHIVE_H
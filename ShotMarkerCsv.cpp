@@ -0,0 +1,375 @@
+#include "ShotMarkerCsv.h"
+
+#include <QByteArray>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QListWidget>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QDebug>
+#include <string.h>
+#include "TimestampParser.h"
+#include "NumberParser.h"
+#include "Trace.h"
+#include "Logging.h"
+
+#define SHOTMARKER_CSV_HEADER "ShotMarker Archived Data"
+
+namespace
+{
+	struct Cell
+	{
+		const char *begin;
+		const char *end;
+	};
+
+	bool isSpace(char c)
+	{
+		return (c == ' ') || (c == '\t') || (c == '\r');
+	}
+
+	bool isDigit(char c)
+	{
+		return (c >= '0') && (c <= '9');
+	}
+
+	// Splits one line on commas and trims each cell, without copying. Returns the number of cells, which may exceed maxCells.
+	int splitLine(const char *begin, const char *end, Cell *cells, int maxCells)
+	{
+		int count = 0;
+		const char *cellBegin = begin;
+
+		for (const char *p = begin; p <= end; p++)
+		{
+			if ((p != end) && (*p != ','))
+			{
+				continue;
+			}
+
+			if (count < maxCells)
+			{
+				const char *b = cellBegin;
+				const char *e = p;
+				while ((b < e) && isSpace(*b)) b++;
+				while ((e > b) && isSpace(e[-1])) e--;
+				cells[count].begin = b;
+				cells[count].end = e;
+			}
+
+			count++;
+			cellBegin = p + 1;
+		}
+
+		return count;
+	}
+
+	QString cellText(const Cell &cell)
+	{
+		return QString::fromUtf8(cell.begin, cell.end - cell.begin);
+	}
+
+	// A "MMM d yyyy" date in the first cell, e.g. "Jun 5 2021", begins each string
+	bool isDateCell(const Cell &cell)
+	{
+		return (cell.begin != cell.end) && !isDigit(cell.begin[0]) && (TimestampParser::parseDate(cell.begin, cell.end - cell.begin) != INVALID_TIMESTAMP);
+	}
+
+	// Shot rows have a "h:mm:ss ap" time in the second cell. Good enough for counting, the parser checks properly.
+	bool isTimeCell(const Cell &cell)
+	{
+		return ((cell.end - cell.begin) >= 4) && isDigit(cell.begin[0]) && (memchr(cell.begin, ':', cell.end - cell.begin) != NULL);
+	}
+}
+
+ShotMarkerCsv::ShotMarkerCsv()
+{
+	data = NULL;
+	dataSize = 0;
+}
+
+ShotMarkerCsv::~ShotMarkerCsv()
+{
+	close();
+}
+
+bool ShotMarkerCsv::open(const QString &path)
+{
+	close();
+
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qCDebug(lcImport) << "Failed to open ShotMarker .csv file:" << path;
+		return false;
+	}
+
+	dataSize = file.size();
+	if (dataSize > 0)
+	{
+		data = file.map(0, dataSize);
+	}
+
+	if (data == NULL)
+	{
+		qCDebug(lcImport) << "Failed to map ShotMarker .csv file:" << path;
+		close();
+		return false;
+	}
+
+	// Validate the first row header
+	const char *begin = (const char *)data;
+	const char *end = begin + dataSize;
+	const char *lineEnd = (const char *)memchr(begin, '\n', dataSize);
+	if (lineEnd == NULL)
+	{
+		lineEnd = end;
+	}
+
+	Cell header;
+	splitLine(begin, lineEnd, &header, 1);
+	if (!QByteArray::fromRawData(header.begin, header.end - header.begin).contains(SHOTMARKER_CSV_HEADER))
+	{
+		qCDebug(lcImport) << "File doesn't have the ShotMarker header, bailing";
+		close();
+		return false;
+	}
+
+	qCDebug(lcImport) << "Found the ShotMarker header";
+
+	buildIndex();
+
+	qCDebug(lcImport) << "Indexed" << strings.size() << "strings in" << path;
+
+	return true;
+}
+
+void ShotMarkerCsv::close()
+{
+	if (data != NULL)
+	{
+		file.unmap(data);
+	}
+
+	file.close();
+
+	data = NULL;
+	dataSize = 0;
+	strings.clear();
+}
+
+void ShotMarkerCsv::buildIndex()
+{
+	TRACE_SPAN("import", "ShotMarker CSV index");
+
+	const char *begin = (const char *)data;
+	const char *end = begin + dataSize;
+
+	ShotMarkerCsvString *curString = NULL;
+	int seriesNum = 1;
+
+	const char *line = begin;
+	while (line < end)
+	{
+		const char *lineEnd = (const char *)memchr(line, '\n', end - line);
+		if (lineEnd == NULL)
+		{
+			lineEnd = end;
+		}
+
+		Cell cells[4];
+		int cellCount = splitLine(line, lineEnd, cells, 4);
+
+		if ((cellCount >= 5) && isDateCell(cells[0]))
+		{
+			// A date in the first cell begins a new string
+			if (curString != NULL)
+			{
+				curString->length = (line - begin) - curString->offset;
+			}
+
+			ShotMarkerCsvString string;
+			string.seriesNum = seriesNum++;
+			string.offset = line - begin;
+			string.length = 0;
+			string.date = cellText(cells[0]);
+			string.name = cellText(cells[1]);
+			string.distance = cellText(cells[3]);
+			string.shotCount = 0;
+
+			strings.append(string);
+			curString = &strings.last();
+		}
+		else if ((curString != NULL) && (cellCount >= 17) && isTimeCell(cells[1]))
+		{
+			curString->shotCount++;
+		}
+
+		line = lineEnd + 1;
+	}
+
+	if (curString != NULL)
+	{
+		curString->length = dataSize - curString->offset;
+	}
+}
+
+int ShotMarkerCsv::stringCount() const
+{
+	return strings.size();
+}
+
+const ShotMarkerCsvString &ShotMarkerCsv::string(int index) const
+{
+	return strings.at(index);
+}
+
+void ShotMarkerCsv::appendCoordinateSeries(const QList<int> &selected, SeriesStore *store) const
+{
+	TRACE_SPAN("import", "ShotMarker CSV parse");
+
+	foreach (int index, selected)
+	{
+		const ShotMarkerCsvString &string = strings.at(index);
+
+		SeriesRecord *curSeries = &store->at(store->beginSeries());
+		curSeries->seriesNum = string.seriesNum;
+		curSeries->name = string.name + QString(" (%1)").arg(string.distance);
+		curSeries->firstDate = string.date;
+
+		QString distance = string.distance;
+		distance.chop(1);
+		if (string.distance.right(1) == "y")
+		{
+			// distance is in yards already
+			curSeries->targetDistance = distance.toInt(NULL, 10);
+		}
+		else
+		{
+			// convert from meters to yards
+			curSeries->targetDistance = distance.toInt(NULL, 10) * 1.0936133; // the result is cast to an int
+		}
+
+		// Only this string's rows are read, straight from the mapped file
+		const char *line = (const char *)data + string.offset;
+		const char *end = line + string.length;
+		NumberParser numbers;
+		qint64 date = TimestampParser::parseDate(string.date);
+
+		while (line < end)
+		{
+			const char *lineEnd = (const char *)memchr(line, '\n', end - line);
+			if (lineEnd == NULL)
+			{
+				lineEnd = end;
+			}
+
+			Cell cells[9];
+			int cellCount = splitLine(line, lineEnd, cells, 9);
+			line = lineEnd + 1;
+
+			if (cellCount < 17)
+			{
+				continue;
+			}
+
+			// Rows with a time in the second cell are shot data, others are the date row, headers or avg/SD summaries
+			qint64 time = TimestampParser::parseTime(cells[1].begin, cells[1].end - cells[1].begin);
+			if (time == INVALID_TIMESTAMP)
+			{
+				continue;
+			}
+
+			if (curSeries->firstTime.isNull())
+			{
+				curSeries->firstTime = cellText(cells[1]);
+			}
+
+			QByteArray tags = QByteArray::fromRawData(cells[3].begin, cells[3].end - cells[3].begin);
+			if (tags.contains("hidden"))
+			{
+				LOG_TRACE(lcImportTrace) << "ignoring hidden shot" << cellText(cells[2]);
+				continue;
+			}
+
+			double x, y;
+			if (!numbers.toDouble(cells[7].begin, cells[7].end - cells[7].begin, &x) || !numbers.toDouble(cells[8].begin, cells[8].end - cells[8].begin, &y))
+			{
+				qCDebug(lcImport) << "Skipping shot with unreadable coordinates" << cellText(cells[2]);
+				continue;
+			}
+
+			store->appendShot(x, y, tags.contains("sighter"), TimestampParser::combine(date, time));
+		}
+
+		if (curSeries->timestamp == INVALID_TIMESTAMP)
+		{
+			curSeries->timestamp = date;
+		}
+
+		if (curSeries->shotCount == 0)
+		{
+			qCDebug(lcImport) << "No shots in" << string.name << ", skipping";
+			store->discardSeries();
+		}
+	}
+}
+
+bool ShotMarkerCsv::selectStrings(QWidget *parent, const ShotMarkerCsv &csv, QList<int> *selected)
+{
+	selected->clear();
+
+	if (csv.stringCount() <= 1)
+	{
+		if (csv.stringCount() == 1)
+		{
+			selected->append(0);
+		}
+		return true;
+	}
+
+	QDialog dialog(parent);
+	dialog.setWindowTitle("Select strings");
+
+	QLabel *label = new QLabel(QString("This file has %1 strings. Select the ones to load (Ctrl+A selects all):").arg(csv.stringCount()));
+
+	QListWidget *list = new QListWidget();
+	list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+	for (int i = 0; i < csv.stringCount(); i++)
+	{
+		const ShotMarkerCsvString &string = csv.string(i);
+		new QListWidgetItem(QString("%1    %2 (%3), %4 shots").arg(string.date).arg(string.name).arg(string.distance).arg(string.shotCount), list);
+	}
+	list->selectAll();
+	list->scrollToBottom();
+
+	QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+	QObject::connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QObject::connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+	QObject::connect(list, &QListWidget::itemDoubleClicked, &dialog, &QDialog::accept);
+
+	QVBoxLayout *layout = new QVBoxLayout(&dialog);
+	layout->addWidget(label);
+	layout->addWidget(list);
+	layout->addWidget(buttonBox);
+
+	dialog.resize(500, 400);
+
+	if (dialog.exec() != QDialog::Accepted)
+	{
+		qCDebug(lcImport) << "User cancelled the string picker";
+		return false;
+	}
+
+	// Keep the file's order no matter how they were clicked
+	for (int i = 0; i < list->count(); i++)
+	{
+		if (list->item(i)->isSelected())
+		{
+			selected->append(i);
+		}
+	}
+
+	qCDebug(lcImport) << "Selected" << selected->size() << "of" << csv.stringCount() << "strings";
+
+	return true;
+}
@@ -0,0 +1,67 @@
+#ifndef SHOTMARKER_CSV_H
+#define SHOTMARKER_CSV_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+#include "SeriesStore.h"
+
+/* Where one string's rows are in the file, plus what's shown in the picker */
+struct ShotMarkerCsvString
+{
+	int seriesNum;
+	qint64 offset; // byte offset of the string's date row
+	qint64 length; // up to the next date row or the end of the file
+	QString date;
+	QString name;
+	QString distance; // as written, e.g. "100y" or "300m"
+	int shotCount; // rows that look like shots, hidden ones included
+};
+
+/*
+ * A ShotMarker "Archived Data" .csv export. These hold every string the unit has ever recorded, so
+ * open() only scans the raw bytes for the date rows that begin each string and keeps a byte-offset
+ * index. Just the rows of the strings asked for are split and parsed afterwards.
+ *
+ * Usage:
+ *     ShotMarkerCsv csv;
+ *     QList<int> selected;
+ *     if (csv.open(path) && ShotMarkerCsv::selectStrings(parent, csv, &selected))
+ *     {
+ *         csv.appendCoordinateSeries(selected, &store);
+ *     }
+ */
+class ShotMarkerCsv
+{
+public:
+	ShotMarkerCsv();
+	~ShotMarkerCsv();
+
+	// Maps the file and builds the index. Returns false if it isn't a ShotMarker export.
+	bool open(const QString &path);
+	void close();
+
+	int stringCount() const;
+	const ShotMarkerCsvString &string(int index) const;
+
+	// Appends a series of shot coordinates (in inches, sighters included) for each selected string
+	void appendCoordinateSeries(const QList<int> &selected, SeriesStore *store) const;
+
+	// Lets the user pick strings from the index. Returns false if they cancelled. Files with a single string don't ask.
+	static bool selectStrings(QWidget *parent, const ShotMarkerCsv &csv, QList<int> *selected);
+
+private:
+	void buildIndex();
+
+	QFile file;
+	uchar *data;
+	qint64 dataSize;
+	QVector<ShotMarkerCsvString> strings;
+
+	ShotMarkerCsv(const ShotMarkerCsv &);
+	ShotMarkerCsv &operator=(const ShotMarkerCsv &);
+};
+
+#endif // SHOTMARKER_CSV_H
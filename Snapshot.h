@@ -0,0 +1,59 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+
+/*
+ * The latest published copy of some state the GUI thread edits, e.g. a test's series. A published
+ * value is never changed again, so a worker that took one can read it without locks for as long as
+ * it likes while the GUI thread publishes newer ones. The mutex is only held to swap or copy the
+ * pointer.
+ *
+ * Every publish() gets the next generation number, stored in the value's generation member. A worker
+ * whose snapshot's generation no longer matches generation() is working on stale data, and its
+ * result can be thrown away.
+ */
+template <typename T>
+class SnapshotPublisher
+{
+public:
+	SnapshotPublisher() : latestGeneration(0)
+	{
+		publish(new T());
+	}
+
+	// Takes ownership of the value, which must not be changed afterwards
+	void publish(T *value)
+	{
+		QSharedPointer<const T> next(value);
+
+		QMutexLocker locker(&mutex);
+		value->generation = latestGeneration.loadRelaxed() + 1;
+		latest = next;
+		latestGeneration.storeRelease(value->generation);
+	}
+
+	QSharedPointer<const T> snapshot() const
+	{
+		QMutexLocker locker(&mutex);
+		return latest;
+	}
+
+	quint64 generation() const
+	{
+		return latestGeneration.loadAcquire();
+	}
+
+private:
+	mutable QMutex mutex;
+	QSharedPointer<const T> latest;
+	QAtomicInteger<quint64> latestGeneration;
+
+	SnapshotPublisher(const SnapshotPublisher &);
+	SnapshotPublisher &operator=(const SnapshotPublisher &);
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,146 @@
+#include "Startup.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_MACOS)
+#include <sys/sysctl.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	struct Milestone
+	{
+		const char *name;
+		qint64 msecs;
+	};
+
+	QElapsedTimer mainTimer;
+	qint64 beforeMainMsecs = -1;
+	QList<Milestone> milestones;
+
+	// How long the process had been running when main() started, or -1 if the platform can't say
+	qint64 processAgeMsecs()
+	{
+	#if defined(Q_OS_WIN)
+		FILETIME creation, exitTime, kernelTime, userTime, now;
+		if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernelTime, &userTime))
+		{
+			return -1;
+		}
+		GetSystemTimeAsFileTime(&now);
+
+		// Both are in 100 ns units
+		ULARGE_INTEGER created, current;
+		created.LowPart = creation.dwLowDateTime;
+		created.HighPart = creation.dwHighDateTime;
+		current.LowPart = now.dwLowDateTime;
+		current.HighPart = now.dwHighDateTime;
+		return (qint64)(current.QuadPart - created.QuadPart) / 10000;
+	#elif defined(Q_OS_LINUX)
+		// The start time is in clock ticks since boot, field 22 of /proc/self/stat
+		QFile statFile("/proc/self/stat");
+		QFile uptimeFile("/proc/uptime");
+		if (!statFile.open(QIODevice::ReadOnly) || !uptimeFile.open(QIODevice::ReadOnly))
+		{
+			return -1;
+		}
+
+		// The command name in field 2 can contain spaces, so count from the closing parenthesis
+		QByteArray stat = statFile.readAll();
+		QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+		double uptime = uptimeFile.readAll().split(' ').value(0).toDouble();
+		long ticks = sysconf(_SC_CLK_TCK);
+		if ((fields.size() < 20) || (uptime <= 0) || (ticks <= 0))
+		{
+			return -1;
+		}
+
+		// Both are rounded to a tick, don't let that make it negative
+		return qMax((qint64)0, (qint64)(uptime * 1000) - fields.at(19).toLongLong() * 1000 / ticks);
+	#elif defined(Q_OS_MACOS)
+		struct kinfo_proc info;
+		size_t size = sizeof(info);
+		int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid() };
+		if (sysctl(mib, 4, &info, &size, NULL, 0) != 0)
+		{
+			return -1;
+		}
+
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		struct timeval started = info.kp_proc.p_starttime;
+		return (qint64)(now.tv_sec - started.tv_sec) * 1000 + (now.tv_usec - started.tv_usec) / 1000;
+	#else
+		return -1;
+	#endif
+	}
+}
+
+void Startup::begin()
+{
+	mainTimer.start();
+
+	beforeMainMsecs = processAgeMsecs();
+
+	mark("main()");
+}
+
+void Startup::mark(const char *name)
+{
+	Milestone milestone;
+	milestone.name = name;
+	milestone.msecs = elapsed();
+	milestones.append(milestone);
+}
+
+qint64 Startup::elapsed()
+{
+	return qMax(beforeMainMsecs, (qint64)0) + mainTimer.elapsed();
+}
+
+qint64 Startup::firstPaintMsecs()
+{
+	foreach (const Milestone &milestone, milestones)
+	{
+		if (strcmp(milestone.name, "first paint") == 0)
+		{
+			return milestone.msecs;
+		}
+	}
+
+	return -1;
+}
+
+QString Startup::report()
+{
+	QStringList lines;
+	lines << QString("%1 %2 %3").arg("startup", -24).arg("ms", 8).arg("+ms", 8);
+
+	if (beforeMainMsecs < 0)
+	{
+		lines << "(process start time unavailable, timed from main())";
+	}
+	else
+	{
+		lines << QString("%1 %2").arg("process start", -24).arg(0, 8);
+	}
+
+	qint64 previous = 0;
+	foreach (const Milestone &milestone, milestones)
+	{
+		lines << QString("%1 %2 %3").arg(milestone.name, -24).arg(milestone.msecs, 8).arg(milestone.msecs - previous, 8);
+		previous = milestone.msecs;
+	}
+
+	return lines.join('\n') + '\n';
+}
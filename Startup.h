@@ -0,0 +1,35 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <QString>
+
+/*
+ * Cold start milestones, timed from when the OS created the process where the platform can tell us
+ * (Windows, Linux, macOS) and from main() otherwise. main() marks each step up to the window's first
+ * paint, and the table is logged once it's painted. Run with:
+ *
+ *     ChronoPlotter --benchmark-startup [budgetMsecs]
+ *
+ * to print the table and exit after the first paint. With a budget the exit code is 1 if the first
+ * paint took longer, so a script can catch startup regressions.
+ */
+class Startup
+{
+public:
+	// Call first thing in main()
+	static void begin();
+
+	// name must be a string literal, only the pointer is kept
+	static void mark(const char *name);
+
+	// Milliseconds since the process started
+	static qint64 elapsed();
+
+	// When "first paint" was marked, or -1 if it hasn't been yet
+	static qint64 firstPaintMsecs();
+
+	// Plain text table of the milestones
+	static QString report();
+};
+
+#endif // STARTUP_H
@@ -0,0 +1,331 @@
+#include "TargetRenderer.h"
+#include "ChronoPlotter.h"
+#include "TextCache.h"
+#include "Logging.h"
+
+#include <QPainter>
+#include <QPen>
+#include <QStringList>
+#include <QVector>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+
+#define TARGET_VIEW_WIDTH 1440
+#define TARGET_PANEL_SIZE 240
+#define TARGET_TITLE_HEIGHT 70
+#define TARGET_CAPTION_HEIGHT 40
+
+// Height available for panels, past this they're drawn smaller rather than the view growing
+#define TARGET_VIEW_MAX_PANELS_HEIGHT 1200
+
+void TargetRenderer::showTargets(
+	const QList<TargetPanel> &panels,
+	const QString &title,
+	GraphPreview **outGraphPreview)
+{
+	qCDebug(lcRender) << "Showing target view with" << panels.size() << "targets";
+
+	QPixmap preview = renderTargets(panels, title, 2.0);
+
+	if (*outGraphPreview)
+	{
+		(*outGraphPreview)->deleteLater();
+	}
+
+	*outGraphPreview = new GraphPreview(preview);
+	(*outGraphPreview)->setWindowTitle("Target view");
+}
+
+QPixmap TargetRenderer::renderTargets(
+	const QList<TargetPanel> &panels,
+	const QString &title,
+	double scale)
+{
+	/* Add columns until every panel fits, so a large archive can't make the pixmap arbitrarily tall */
+	int columns = TARGET_VIEW_WIDTH / TARGET_PANEL_SIZE;
+	double panelSize = TARGET_PANEL_SIZE;
+	int rows = (panels.size() + columns - 1) / columns;
+	while ((rows * panelSize) > TARGET_VIEW_MAX_PANELS_HEIGHT)
+	{
+		columns++;
+		panelSize = (double)TARGET_VIEW_WIDTH / columns;
+		rows = (panels.size() + columns - 1) / columns;
+	}
+	int height = TARGET_TITLE_HEIGHT + qCeil(rows * panelSize);
+
+	if (columns > TARGET_VIEW_WIDTH / TARGET_PANEL_SIZE)
+	{
+		qCDebug(lcRender) << "Target view shrunk to" << columns << "columns for" << panels.size() << "targets";
+	}
+
+	QPixmap pixmap(qRound(TARGET_VIEW_WIDTH * scale), qRound(height * scale));
+	pixmap.setDevicePixelRatio(scale);
+	pixmap.fill(Qt::white);
+
+	/* Every target is drawn at the same scale so dispersion can be compared between them */
+	double maxExtent = 0;
+	for (int i = 0; i < panels.size(); i++)
+	{
+		const QList<QPair<double, double> > &coordinates = panels.at(i).coordinates;
+		for (int j = 0; j < coordinates.size(); j++)
+		{
+			maxExtent = qMax(maxExtent, qMax(qAbs(coordinates.at(j).first), qAbs(coordinates.at(j).second)));
+		}
+	}
+	if (maxExtent == 0)
+	{
+		maxExtent = 1;
+	}
+
+	double targetDiameter = TARGET_PANEL_SIZE - TARGET_CAPTION_HEIGHT - 20;
+	double pixelsPerInch = targetDiameter / (maxExtent * 2.2);
+	double ringStep = niceStep(maxExtent / 3.0);
+
+	qCDebug(lcRender) << "Target view max extent:" << maxExtent << "in, ring step:" << ringStep << "in";
+
+	QPainter painter(&pixmap);
+	painter.setRenderHint(QPainter::Antialiasing);
+
+	QFont titleFont = TextCache::font(24);
+	painter.setFont(titleFont);
+	painter.setPen(QColor("#4d4d4d"));
+	painter.drawText(QRectF(0, 0, TARGET_VIEW_WIDTH, TARGET_TITLE_HEIGHT), Qt::AlignCenter, title);
+
+	/* Panels are laid out at full size and scaled down as a whole, text and markers included */
+	for (int i = 0; i < panels.size(); i++)
+	{
+		painter.save();
+		painter.translate((i % columns) * panelSize, TARGET_TITLE_HEIGHT + ((i / columns) * panelSize));
+		painter.scale(panelSize / TARGET_PANEL_SIZE, panelSize / TARGET_PANEL_SIZE);
+		drawPanel(&painter, QRectF(0, 0, TARGET_PANEL_SIZE, TARGET_PANEL_SIZE), panels.at(i), pixelsPerInch, ringStep);
+		painter.restore();
+	}
+
+	return pixmap;
+}
+
+void TargetRenderer::drawPanel(
+	QPainter *painter,
+	const QRectF &panelRect,
+	const TargetPanel &panel,
+	double pixelsPerInch,
+	double ringStep)
+{
+	QRectF targetRect = panelRect.adjusted(10, 10, -10, -(TARGET_CAPTION_HEIGHT + 10));
+	QPointF center = targetRect.center();
+
+	painter->save();
+
+	QPen borderPen(QColor("#d9d9d9"));
+	borderPen.setWidthF(1.0);
+	painter->setPen(borderPen);
+	painter->setBrush(Qt::NoBrush);
+	painter->drawRect(panelRect.adjusted(4, 4, -4, -4));
+
+	painter->setClipRect(targetRect);
+
+	/* Rings and crosshair around the aim point */
+	QPen ringPen(QColor("#e6e6e6"));
+	ringPen.setWidthF(1.0);
+	painter->setPen(ringPen);
+	double maxRadius = qMax(targetRect.width(), targetRect.height());
+	for (double r = ringStep; (r * pixelsPerInch) < maxRadius; r += ringStep)
+	{
+		painter->drawEllipse(center, r * pixelsPerInch, r * pixelsPerInch);
+	}
+	painter->drawLine(QPointF(targetRect.left(), center.y()), QPointF(targetRect.right(), center.y()));
+	painter->drawLine(QPointF(center.x(), targetRect.top()), QPointF(center.x(), targetRect.bottom()));
+
+	/* All shots go out in a single drawPoints() call, a round-capped pen makes each point a disc */
+	int totalShots = panel.coordinates.size();
+	QVector<QPointF> points;
+	points.reserve(totalShots);
+	double xSum = 0;
+	double ySum = 0;
+	for (int i = 0; i < totalShots; i++)
+	{
+		double x = panel.coordinates.at(i).first;
+		double y = panel.coordinates.at(i).second;
+		xSum += x;
+		ySum += y;
+		points.append(QPointF(center.x() + (x * pixelsPerInch), center.y() - (y * pixelsPerInch)));
+	}
+
+	QColor shotColor("#0536b0");
+	shotColor.setAlphaF(0.75);
+	QPen shotPen(shotColor);
+	shotPen.setWidthF(6.0);
+	shotPen.setCapStyle(Qt::RoundCap);
+	painter->setPen(shotPen);
+	painter->drawPoints(points.constData(), points.size());
+
+	if (totalShots > 1)
+	{
+		QPointF meanPoi(xSum / totalShots, ySum / totalShots);
+		QPointF meanPoiPixel(center.x() + (meanPoi.x() * pixelsPerInch), center.y() - (meanPoi.y() * pixelsPerInch));
+
+		/* ES pair */
+		QPointF first;
+		QPointF second;
+		if (findExtremePair(panel.coordinates, &first, &second))
+		{
+			QColor esColor(Qt::red);
+			esColor.setAlphaF(0.65);
+			QPen esPen(esColor, 1.5, Qt::DashLine);
+			painter->setPen(esPen);
+			painter->drawLine(QPointF(center.x() + (first.x() * pixelsPerInch), center.y() - (first.y() * pixelsPerInch)),
+				QPointF(center.x() + (second.x() * pixelsPerInch), center.y() - (second.y() * pixelsPerInch)));
+		}
+
+		/* Mean radius circle, in inches regardless of the units shown in the caption */
+		double meanRadius = 0;
+		for (int i = 0; i < totalShots; i++)
+		{
+			meanRadius += qSqrt(qPow(panel.coordinates.at(i).first - meanPoi.x(), 2) + qPow(panel.coordinates.at(i).second - meanPoi.y(), 2));
+		}
+		meanRadius /= totalShots;
+
+		QColor mrColor("#1c57eb");
+		mrColor.setAlphaF(0.65);
+		QPen mrPen(mrColor, 1.5);
+		painter->setPen(mrPen);
+		painter->drawEllipse(meanPoiPixel, meanRadius * pixelsPerInch, meanRadius * pixelsPerInch);
+
+		/* Mean POI */
+		QPen poiPen(Qt::red, 2.0);
+		painter->setPen(poiPen);
+		painter->drawLine(meanPoiPixel - QPointF(6, 0), meanPoiPixel + QPointF(6, 0));
+		painter->drawLine(meanPoiPixel - QPointF(0, 6), meanPoiPixel + QPointF(0, 6));
+	}
+
+	painter->setClipping(false);
+
+	/* Caption */
+	QFont captionFont = TextCache::font(9);
+	painter->setFont(captionFont);
+	painter->setPen(QColor("#4d4d4d"));
+
+	QStringList caption;
+	caption << panel.label;
+	if (totalShots > 1)
+	{
+		caption << QString("%1 shots, ES %2 %3, MR %4 %3").arg(totalShots).arg(panel.extremeSpread, 0, 'f', 2).arg(panel.units).arg(panel.meanRadius, 0, 'f', 2);
+	}
+	else
+	{
+		caption << QString("%1 shots").arg(totalShots);
+	}
+
+	double lineY = targetRect.bottom() + 10;
+	for (int i = 0; i < caption.size(); i++)
+	{
+		const QStaticText &line = TextCache::staticText(captionFont, caption.at(i));
+		painter->drawStaticText(QPointF(panelRect.center().x() - (line.size().width() / 2.0), lineY), line);
+		lineY += line.size().height();
+	}
+
+	painter->restore();
+}
+
+static double cross(const QPointF &o, const QPointF &a, const QPointF &b)
+{
+	return ((a.x() - o.x()) * (b.y() - o.y())) - ((a.y() - o.y()) * (b.x() - o.x()));
+}
+
+static bool PointComparator(const QPointF &one, const QPointF &two)
+{
+	return (one.x() < two.x()) || ((one.x() == two.x()) && (one.y() < two.y()));
+}
+
+bool TargetRenderer::findExtremePair(
+	const QList<QPair<double, double> > &coordinates,
+	QPointF *outFirst,
+	QPointF *outSecond)
+{
+	if (coordinates.size() < 2)
+	{
+		return false;
+	}
+
+	QVector<QPointF> points;
+	points.reserve(coordinates.size());
+	for (int i = 0; i < coordinates.size(); i++)
+	{
+		points.append(QPointF(coordinates.at(i).first, coordinates.at(i).second));
+	}
+	std::sort(points.begin(), points.end(), PointComparator);
+
+	/* The farthest pair is always on the convex hull, which is usually only a handful of shots */
+	QVector<QPointF> hull(points.size() * 2);
+	int k = 0;
+	for (int i = 0; i < points.size(); i++)
+	{
+		while ((k >= 2) && (cross(hull.at(k - 2), hull.at(k - 1), points.at(i)) <= 0))
+		{
+			k--;
+		}
+		hull[k++] = points.at(i);
+	}
+	for (int i = points.size() - 2, lower = k + 1; i >= 0; i--)
+	{
+		while ((k >= lower) && (cross(hull.at(k - 2), hull.at(k - 1), points.at(i)) <= 0))
+		{
+			k--;
+		}
+		hull[k++] = points.at(i);
+	}
+	hull.resize(qMax(k - 1, 1));
+
+	// All shots in the same hole
+	if (hull.size() < 2)
+	{
+		*outFirst = points.first();
+		*outSecond = points.last();
+		return true;
+	}
+
+	double extremeSpread = -1;
+	for (int i = 0; i < hull.size(); i++)
+	{
+		for (int j = i + 1; j < hull.size(); j++)
+		{
+			double dx = hull.at(i).x() - hull.at(j).x();
+			double dy = hull.at(i).y() - hull.at(j).y();
+			double es = (dx * dx) + (dy * dy);
+			if (es > extremeSpread)
+			{
+				extremeSpread = es;
+				*outFirst = hull.at(i);
+				*outSecond = hull.at(j);
+			}
+		}
+	}
+
+	return true;
+}
+
+double TargetRenderer::niceStep(double range)
+{
+	if (range <= 0)
+	{
+		return 1;
+	}
+
+	/* Round to 1, 2 or 5 times a power of ten */
+	double magnitude = qPow(10, qFloor(log10(range)));
+	double fraction = range / magnitude;
+	if (fraction < 1.5)
+	{
+		return magnitude;
+	}
+	else if (fraction < 3.5)
+	{
+		return 2 * magnitude;
+	}
+	else if (fraction < 7.5)
+	{
+		return 5 * magnitude;
+	}
+	return 10 * magnitude;
+}
@@ -0,0 +1,58 @@
+#ifndef TARGET_RENDERER_H
+#define TARGET_RENDERER_H
+
+#include <QWidget>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QPixmap>
+#include <QPointF>
+#include <QRectF>
+
+class QPainter;
+class GraphPreview;
+
+/* One small target in the target view. Coordinates are in inches relative to the aim point. */
+struct TargetPanel
+{
+	QString label;
+	QList<QPair<double, double> > coordinates;
+	double extremeSpread;
+	double meanRadius;
+	QString units;
+};
+
+class TargetRenderer
+{
+public:
+	static void showTargets(
+		const QList<TargetPanel> &panels,
+		const QString &title,
+		GraphPreview **outGraphPreview
+	);
+
+	static QPixmap renderTargets(
+		const QList<TargetPanel> &panels,
+		const QString &title,
+		double scale
+	);
+
+private:
+	static void drawPanel(
+		QPainter *painter,
+		const QRectF &panelRect,
+		const TargetPanel &panel,
+		double pixelsPerInch,
+		double ringStep
+	);
+
+	static bool findExtremePair(
+		const QList<QPair<double, double> > &coordinates,
+		QPointF *outFirst,
+		QPointF *outSecond
+	);
+
+	static double niceStep(double range);
+};
+
+#endif // TARGET_RENDERER_H
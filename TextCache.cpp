@@ -0,0 +1,172 @@
+#include "TextCache.h"
+#include "ChronoPlotter.h"
+#include "Logging.h"
+#include "MemoryStats.h"
+
+#include <QFontMetrics>
+#include <QStringList>
+#include <QDebug>
+
+// Plenty for a batch of graphs. The caches are simply dropped when they grow past this.
+#define TEXT_CACHE_MAX_ENTRIES 4096
+
+// Rough cost of a hash node, and of each prepared glyph (index, position and font engine entry)
+#define HASH_NODE_BYTES 32
+#define STATIC_GLYPH_BYTES 32
+
+namespace
+{
+	MemoryAccount<MemoryStats::METRIC_CACHES> textRectMemory;
+	MemoryAccount<MemoryStats::METRIC_CACHES> staticTextMemory;
+}
+
+QHash<int, QFont> TextCache::fonts;
+QHash<QString, QRect> TextCache::textRects;
+QHash<QString, QStaticText> TextCache::staticTexts;
+
+QFont TextCache::font(int size)
+{
+	QHash<int, QFont>::const_iterator it = fonts.constFind(size);
+	if (it != fonts.constEnd())
+	{
+		return it.value();
+	}
+
+	// Normally done just after startup, but a graph drawn before then still needs the font
+	registerFonts();
+
+	QFont font("DejaVu Sans", scaleFontSize(size));
+	fonts.insert(size, font);
+	return font;
+}
+
+QRect TextCache::textRect(const QFont &font, int flags, const QString &text)
+{
+	QString key = textKey(font, flags, text);
+
+	QHash<QString, QRect>::const_iterator it = textRects.constFind(key);
+	if (it != textRects.constEnd())
+	{
+		return it.value();
+	}
+
+	if (textRects.size() >= TEXT_CACHE_MAX_ENTRIES)
+	{
+		qCDebug(lcRender) << "Text measurement cache full, clearing";
+		textRects.clear();
+		textRectMemory.set(0);
+	}
+
+	QFontMetrics metrics(font);
+	QRect rect = metrics.boundingRect(0, 0, 0, 0, flags, text);
+	textRects.insert(key, rect);
+	textRectMemory.add(MemoryStats::stringBytes(key) + sizeof(QRect) + HASH_NODE_BYTES);
+	return rect;
+}
+
+const QStaticText &TextCache::staticText(const QFont &font, const QString &line)
+{
+	QString key = textKey(font, 0, line);
+
+	QHash<QString, QStaticText>::iterator it = staticTexts.find(key);
+	if (it != staticTexts.end())
+	{
+		return it.value();
+	}
+
+	if (staticTexts.size() >= TEXT_CACHE_MAX_ENTRIES)
+	{
+		qCDebug(lcRender) << "Static text cache full, clearing";
+		staticTexts.clear();
+		staticTextMemory.set(0);
+	}
+
+	QStaticText staticText(line);
+	staticText.setTextFormat(Qt::PlainText);
+	staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+	staticText.prepare(QTransform(), font);
+	staticTextMemory.add(MemoryStats::stringBytes(key) + (line.size() * STATIC_GLYPH_BYTES) + HASH_NODE_BYTES);
+	return staticTexts.insert(key, staticText).value();
+}
+
+void TextCache::clear()
+{
+	fonts.clear();
+	textRects.clear();
+	staticTexts.clear();
+	textRectMemory.set(0);
+	staticTextMemory.set(0);
+}
+
+QString TextCache::textKey(const QFont &font, int flags, const QString &text)
+{
+	return QString("%1|%2|%3").arg(font.key()).arg(flags).arg(text);
+}
+
+CachedTextItem::CachedTextItem(QCustomPlot *parentPlot)
+	: QCPItemText(parentPlot)
+{
+}
+
+void CachedTextItem::draw(QCPPainter *painter)
+{
+	/* Same geometry as QCPItemText::draw(), with the measuring and shaping coming from the cache */
+	QPointF pos(position->pixelPosition());
+	QTransform transform = painter->transform();
+	transform.translate(pos.x(), pos.y());
+	if (!qFuzzyIsNull(mRotation))
+	{
+		transform.rotate(mRotation);
+	}
+
+	QFont font = mainFont();
+	painter->setFont(font);
+	QRect textRect = TextCache::textRect(font, Qt::TextDontClip | mTextAlignment, mText);
+	QRect textBoxRect = textRect.adjusted(-mPadding.left(), -mPadding.top(), mPadding.right(), mPadding.bottom());
+	QPointF textPos = getTextDrawPoint(QPointF(0, 0), textBoxRect, mPositionAlignment); // 0, 0 because the transform does the translation
+	textRect.moveTopLeft(textPos.toPoint() + QPoint(mPadding.left(), mPadding.top()));
+	textBoxRect.moveTopLeft(textPos.toPoint());
+	double clipPad = mainPen().widthF();
+	QRect boundingRect = textBoxRect.adjusted(-clipPad, -clipPad, clipPad, clipPad);
+
+	if (!transform.mapRect(boundingRect).intersects(painter->transform().mapRect(clipRect())))
+	{
+		return;
+	}
+
+	painter->setTransform(transform);
+	if (((mainBrush().style() != Qt::NoBrush) && (mainBrush().color().alpha() != 0)) ||
+		((mainPen().style() != Qt::NoPen) && (mainPen().color().alpha() != 0)))
+	{
+		painter->setPen(mainPen());
+		painter->setBrush(mainBrush());
+		painter->drawRect(textBoxRect);
+	}
+	painter->setBrush(Qt::NoBrush);
+	painter->setPen(QPen(mainColor()));
+
+	// Lines are drawn one at a time, aligned within the measured rect the same way drawText() would
+	QStringList lines = mText.split('\n');
+	int lineSpacing = QFontMetrics(font).lineSpacing();
+	for (int i = 0; i < lines.size(); i++)
+	{
+		const QStaticText &line = TextCache::staticText(font, lines.at(i));
+		double lineWidth = line.size().width();
+
+		double x;
+		if (mTextAlignment & Qt::AlignHCenter)
+		{
+			x = textRect.left() + ((textRect.width() - lineWidth) / 2.0);
+		}
+		else if (mTextAlignment & Qt::AlignRight)
+		{
+			x = textRect.right() - lineWidth;
+		}
+		else
+		{
+			x = textRect.left();
+		}
+
+		painter->drawStaticText(QPointF(x, textRect.top() + (i * lineSpacing)), line);
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <QFont>
+#include <QHash>
+#include <QRect>
+#include <QStaticText>
+#include <QString>
+
+#include "qcustomplot/qcustomplot.h"
+
+/*
+ * Fonts, text measurements and pre-shaped text shared by all graph renderers. Graphs are
+ * rendered on the GUI thread only, so the caches aren't locked.
+ */
+class TextCache
+{
+public:
+	static QFont font(int size);
+	static QRect textRect(const QFont &font, int flags, const QString &text);
+	static const QStaticText &staticText(const QFont &font, const QString &line);
+	static void clear();
+
+private:
+	static QString textKey(const QFont &font, int flags, const QString &text);
+
+	static QHash<int, QFont> fonts;
+	static QHash<QString, QRect> textRects;
+	static QHash<QString, QStaticText> staticTexts;
+};
+
+/* QCPItemText that draws from TextCache instead of shaping its text on every render */
+class CachedTextItem : public QCPItemText
+{
+public:
+	CachedTextItem(QCustomPlot *parentPlot);
+
+protected:
+	virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+};
+
+#endif // TEXT_CACHE_H
@@ -0,0 +1,443 @@
+#include "TimestampParser.h"
+
+#include <QDateTime>
+
+#define MSECS_PER_DAY Q_INT64_C(86400000)
+
+namespace
+{
+	inline int code(QChar c)
+	{
+		return c.unicode();
+	}
+
+	inline int code(char c)
+	{
+		return (unsigned char)c;
+	}
+
+	inline bool isDigit(int c)
+	{
+		return (c >= '0') && (c <= '9');
+	}
+
+	inline bool isLetter(int c)
+	{
+		return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+	}
+
+	inline int toLower(int c)
+	{
+		return ((c >= 'A') && (c <= 'Z')) ? (c + ('a' - 'A')) : c;
+	}
+
+	template <typename Char>
+	struct Cursor
+	{
+		const Char *p;
+		const Char *end;
+
+		bool atEnd() const
+		{
+			return p == end;
+		}
+
+		int peek() const
+		{
+			return (p == end) ? 0 : code(*p);
+		}
+
+		void skipSpaces()
+		{
+			while ((p != end) && ((code(*p) == ' ') || (code(*p) == '\t')))
+			{
+				p++;
+			}
+		}
+
+		bool accept(int c)
+		{
+			if (peek() == c)
+			{
+				p++;
+				return true;
+			}
+			return false;
+		}
+
+		// Reads up to maxDigits digits. Returns the number read.
+		int number(int *value, int maxDigits)
+		{
+			int digits = 0;
+			*value = 0;
+			while ((digits < maxDigits) && isDigit(peek()))
+			{
+				*value = (*value * 10) + (code(*p) - '0');
+				p++;
+				digits++;
+			}
+			return digits;
+		}
+
+		// Reads a run of letters, lowercasing the first few into word. Returns the run length.
+		int word(char *word, int size)
+		{
+			int length = 0;
+			while (isLetter(peek()))
+			{
+				if (length < size)
+				{
+					word[length] = toLower(code(*p));
+				}
+				p++;
+				length++;
+			}
+			return length;
+		}
+	};
+
+	// 1-12 for "jan" through "dec", otherwise 0
+	int monthFromName(const char *name)
+	{
+		static const char months[] = "janfebmaraprmayjunjulaugsepoctnovdec";
+
+		for (int i = 0; i < 12; i++)
+		{
+			const char *month = months + (i * 3);
+			if ((name[0] == month[0]) && (name[1] == month[1]) && (name[2] == month[2]))
+			{
+				return i + 1;
+			}
+		}
+
+		return 0;
+	}
+
+	bool isLeapYear(int year)
+	{
+		return ((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0));
+	}
+
+	int daysInMonth(int year, int month)
+	{
+		static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+		return ((month == 2) && isLeapYear(year)) ? 29 : days[month - 1];
+	}
+
+	// Days from 1970-01-01 to a proleptic Gregorian date (http://howardhinnant.github.io/date_algorithms.html)
+	qint64 daysFromCivil(int year, int month, int day)
+	{
+		year -= (month <= 2) ? 1 : 0;
+		int era = ((year >= 0) ? year : (year - 399)) / 400;
+		int yearOfEra = year - (era * 400);
+		int dayOfYear = ((153 * (month + ((month > 2) ? -3 : 9))) + 2) / 5 + day - 1;
+		int dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+		return ((qint64)era * 146097) + dayOfEra - 719468;
+	}
+
+	qint64 makeDate(int year, int yearDigits, int month, int day)
+	{
+		if (yearDigits == 2)
+		{
+			year += 2000;
+		}
+		else if (yearDigits != 4)
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		if ((month < 1) || (month > 12) || (day < 1) || (day > daysInMonth(year, month)))
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		return daysFromCivil(year, month, day) * MSECS_PER_DAY;
+	}
+
+	template <typename Char>
+	qint64 readDate(Cursor<Char> &in)
+	{
+		char name[3];
+		int first, second, year;
+
+		in.skipSpaces();
+
+		if (isLetter(in.peek()))
+		{
+			// "Jun 5 2021", "June 5, 2022"
+			if (in.word(name, 3) < 3)
+			{
+				return INVALID_TIMESTAMP;
+			}
+
+			int month = monthFromName(name);
+			in.accept('.');
+			in.skipSpaces();
+			if ((month == 0) || (in.number(&first, 2) == 0))
+			{
+				return INVALID_TIMESTAMP;
+			}
+
+			in.accept(',');
+			in.skipSpaces();
+			int yearDigits = in.number(&year, 4);
+			return makeDate(year, yearDigits, month, first);
+		}
+
+		int firstDigits = in.number(&first, 4);
+		if (firstDigits == 0)
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		int separator = in.peek();
+		if ((separator == ' ') || (separator == '-'))
+		{
+			// "5 Jun 2021", "05-Jun-2021"
+			const Char *afterNumber = in.p;
+			in.p++;
+			in.skipSpaces();
+			if (isLetter(in.peek()))
+			{
+				if ((firstDigits > 2) || (in.word(name, 3) < 3))
+				{
+					return INVALID_TIMESTAMP;
+				}
+
+				int month = monthFromName(name);
+				in.accept('.');
+				if ((separator == '-') && !in.accept('-'))
+				{
+					return INVALID_TIMESTAMP;
+				}
+				in.skipSpaces();
+				int yearDigits = in.number(&year, 4);
+				return (month == 0) ? INVALID_TIMESTAMP : makeDate(year, yearDigits, month, first);
+			}
+			in.p = afterNumber;
+		}
+
+		if ((separator != '-') && (separator != '/') && (separator != '.'))
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		// "2021-06-05", "6/5/2021", "05.06.21"
+		in.p++;
+		if ((in.number(&second, 2) == 0) || !in.accept(separator))
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		int third;
+		int thirdDigits = in.number(&third, 4);
+
+		if (firstDigits == 4)
+		{
+			return (thirdDigits > 2) ? INVALID_TIMESTAMP : makeDate(first, 4, second, third);
+		}
+
+		if (firstDigits > 2)
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		// Dotted dates are day first, the rest month first unless that can't be right
+		if ((separator == '.') || ((first > 12) && (second <= 12)))
+		{
+			return makeDate(third, thirdDigits, second, first);
+		}
+
+		return makeDate(third, thirdDigits, first, second);
+	}
+
+	template <typename Char>
+	qint64 readTime(Cursor<Char> &in)
+	{
+		int hour, minute, second = 0, msec = 0;
+
+		in.skipSpaces();
+
+		if ((in.number(&hour, 2) == 0) || !in.accept(':') || (in.number(&minute, 2) != 2))
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		if (in.accept(':'))
+		{
+			if (in.number(&second, 2) != 2)
+			{
+				return INVALID_TIMESTAMP;
+			}
+
+			if (in.accept('.'))
+			{
+				// Keep milliseconds, drop anything finer
+				int fraction;
+				int digits = in.number(&fraction, 3);
+				if (digits == 0)
+				{
+					return INVALID_TIMESTAMP;
+				}
+				msec = fraction * ((digits == 1) ? 100 : ((digits == 2) ? 10 : 1));
+				while (isDigit(in.peek()))
+				{
+					in.p++;
+				}
+			}
+		}
+
+		in.skipSpaces();
+
+		// "am", "pm", "a.m.", "PM"
+		int meridiem = toLower(in.peek());
+		if ((meridiem == 'a') || (meridiem == 'p'))
+		{
+			in.p++;
+			in.accept('.');
+			if (toLower(in.peek()) != 'm')
+			{
+				return INVALID_TIMESTAMP;
+			}
+			in.p++;
+			in.accept('.');
+
+			if ((hour < 1) || (hour > 12))
+			{
+				return INVALID_TIMESTAMP;
+			}
+
+			hour %= 12;
+			if (meridiem == 'p')
+			{
+				hour += 12;
+			}
+		}
+
+		if ((hour > 23) || (minute > 59) || (second > 60))
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		return ((((qint64)hour * 60) + minute) * 60 + second) * 1000 + msec;
+	}
+
+	template <typename Char>
+	bool finished(Cursor<Char> &in)
+	{
+		in.skipSpaces();
+		return in.atEnd();
+	}
+
+	template <typename Char>
+	qint64 dateFromText(const Char *text, int length)
+	{
+		Cursor<Char> in = { text, text + length };
+		qint64 date = readDate(in);
+		return finished(in) ? date : INVALID_TIMESTAMP;
+	}
+
+	template <typename Char>
+	qint64 timeFromText(const Char *text, int length)
+	{
+		Cursor<Char> in = { text, text + length };
+		qint64 time = readTime(in);
+		return finished(in) ? time : INVALID_TIMESTAMP;
+	}
+
+	template <typename Char>
+	qint64 dateTimeFromText(const Char *text, int length)
+	{
+		Cursor<Char> in = { text, text + length };
+
+		qint64 date = readDate(in);
+		if (date == INVALID_TIMESTAMP)
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		if (finished(in))
+		{
+			return date;
+		}
+
+		// "2021-06-05T13:38:24", "June 5, 2022 at 10:31 AM"
+		if (!in.accept('T') && !in.accept(','))
+		{
+			const Char *beforeAt = in.p;
+			char at[2];
+			if ((in.word(at, 2) != 2) || (at[0] != 'a') || (at[1] != 't'))
+			{
+				in.p = beforeAt;
+			}
+		}
+
+		qint64 time = readTime(in);
+		if ((time == INVALID_TIMESTAMP) || !finished(in))
+		{
+			return INVALID_TIMESTAMP;
+		}
+
+		return date + time;
+	}
+}
+
+qint64 TimestampParser::parseDate(const QChar *text, int length)
+{
+	return dateFromText(text, length);
+}
+
+qint64 TimestampParser::parseDate(const char *text, int length)
+{
+	return dateFromText(text, length);
+}
+
+qint64 TimestampParser::parseDate(const QString &text)
+{
+	return dateFromText(text.constData(), text.size());
+}
+
+qint64 TimestampParser::parseTime(const QChar *text, int length)
+{
+	return timeFromText(text, length);
+}
+
+qint64 TimestampParser::parseTime(const char *text, int length)
+{
+	return timeFromText(text, length);
+}
+
+qint64 TimestampParser::parseTime(const QString &text)
+{
+	return timeFromText(text.constData(), text.size());
+}
+
+qint64 TimestampParser::parseDateTime(const QChar *text, int length)
+{
+	return dateTimeFromText(text, length);
+}
+
+qint64 TimestampParser::parseDateTime(const char *text, int length)
+{
+	return dateTimeFromText(text, length);
+}
+
+qint64 TimestampParser::parseDateTime(const QString &text)
+{
+	return dateTimeFromText(text.constData(), text.size());
+}
+
+qint64 TimestampParser::combine(qint64 date, qint64 time)
+{
+	if ((date == INVALID_TIMESTAMP) || (time == INVALID_TIMESTAMP))
+	{
+		return INVALID_TIMESTAMP;
+	}
+
+	return date + time;
+}
+
+qint64 TimestampParser::fromEpoch(qint64 msecsSinceEpoch)
+{
+	return msecsSinceEpoch + ((qint64)QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch).offsetFromUtc() * 1000);
+}
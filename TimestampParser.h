@@ -0,0 +1,54 @@
+#ifndef TIMESTAMP_PARSER_H
+#define TIMESTAMP_PARSER_H
+
+#include <QChar>
+#include <QString>
+
+// Marks a series or shot whose time isn't known
+#define INVALID_TIMESTAMP (-Q_INT64_C(9223372036854775807) - 1)
+
+/*
+ * Parses the dates and times written by the chronographs and targets we import, without QDate/QTime
+ * format strings, locales or allocations. Recognised forms:
+ *
+ *     dates:  "2021-06-05", "6/5/2021", "06-05-2021", "05.06.21", "Jun 5 2021", "June 5, 2022", "5 Jun 2021"
+ *     times:  "13:38:24", "1:38:24 pm", "10:31 AM", "13:38:24.250"
+ *     both:   a date and a time separated by a space, 'T' or " at "
+ *
+ * Numeric dates are month first unless the year comes first, the first field can't be a month or
+ * the fields are separated by dots.
+ * Month names are English, which is what every vendor writes.
+ *
+ * Timestamps are milliseconds since 1970-01-01 00:00 on the wall clock the device recorded, i.e.
+ * local time without a time zone. That keeps a string's date and the times of its shots comparable
+ * across vendors that never record an offset. Epoch times (ShotMarker's "ts") are moved onto the
+ * same scale with fromEpoch().
+ */
+class TimestampParser
+{
+public:
+	// Each returns INVALID_TIMESTAMP unless the whole text (surrounding spaces aside) is recognised
+
+	// Midnight of the date
+	static qint64 parseDate(const QChar *text, int length);
+	static qint64 parseDate(const char *text, int length);
+	static qint64 parseDate(const QString &text);
+
+	// Milliseconds since midnight
+	static qint64 parseTime(const QChar *text, int length);
+	static qint64 parseTime(const char *text, int length);
+	static qint64 parseTime(const QString &text);
+
+	// A date alone is taken as midnight
+	static qint64 parseDateTime(const QChar *text, int length);
+	static qint64 parseDateTime(const char *text, int length);
+	static qint64 parseDateTime(const QString &text);
+
+	// Combines a date from parseDate() with a time from parseTime()
+	static qint64 combine(qint64 date, qint64 time);
+
+	// Converts milliseconds since the UTC epoch to local wall clock time
+	static qint64 fromEpoch(qint64 msecsSinceEpoch);
+};
+
+#endif // TIMESTAMP_PARSER_H
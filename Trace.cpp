@@ -0,0 +1,198 @@
+#include "Trace.h"
+#include "Logging.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+#include <chrono>
+
+// Spans kept per thread, must be a power of two
+#define TRACE_BUFFER_SIZE 16384
+
+namespace
+{
+	struct TraceEvent
+	{
+		const char *category;
+		const char *name;
+		qint64 start;
+		qint64 duration;
+	};
+
+	/* Written only by its own thread. head counts every span ever recorded, so the writer never waits
+	   and a reader can tell which slots were reused while it was copying them. */
+	struct TraceBuffer
+	{
+		int threadId;
+		QString threadName;
+		QAtomicInteger<quint64> head;
+		TraceEvent events[TRACE_BUFFER_SIZE];
+	};
+
+	// Buffers are never freed, so spans from threads that have exited can still be exported
+	QMutex buffersMutex;
+	QList<TraceBuffer *> buffers;
+
+	thread_local TraceBuffer *threadBuffer = NULL;
+
+	TraceBuffer *currentBuffer()
+	{
+		if (threadBuffer != NULL)
+		{
+			return threadBuffer;
+		}
+
+		TraceBuffer *buffer = new TraceBuffer();
+		buffer->head.storeRelaxed(0);
+
+		QThread *thread = QThread::currentThread();
+		if ((QCoreApplication::instance() != NULL) && (thread == QCoreApplication::instance()->thread()))
+		{
+			buffer->threadName = "main";
+		}
+		else
+		{
+			buffer->threadName = thread->objectName();
+		}
+
+		QMutexLocker locker(&buffersMutex);
+		buffer->threadId = buffers.size() + 1;
+		if (buffer->threadName.isEmpty())
+		{
+			buffer->threadName = QString("thread %1").arg(buffer->threadId);
+		}
+		buffers.append(buffer);
+
+		threadBuffer = buffer;
+		return buffer;
+	}
+
+	// Chrome wants microseconds, keep the nanoseconds as decimals
+	void appendMicroseconds(QByteArray *json, qint64 nsecs)
+	{
+		json->append(QByteArray::number(nsecs / 1000));
+		json->append('.');
+		json->append(QByteArray::number(nsecs % 1000).rightJustified(3, '0'));
+	}
+}
+
+QAtomicInt Trace::enabled(0);
+
+void Trace::setEnabled(bool state)
+{
+	qCDebug(lcUi) << "Tracing" << (state ? "enabled" : "disabled");
+
+	enabled.storeRelaxed(state ? 1 : 0);
+}
+
+qint64 Trace::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char *category, const char *name, qint64 start, qint64 duration)
+{
+	TraceBuffer *buffer = currentBuffer();
+
+	quint64 head = buffer->head.loadRelaxed();
+	TraceEvent &event = buffer->events[head & (TRACE_BUFFER_SIZE - 1)];
+	event.category = category;
+	event.name = name;
+	event.start = start;
+	event.duration = duration;
+
+	buffer->head.storeRelease(head + 1);
+}
+
+bool Trace::writeChromeTrace(const QString &path)
+{
+	QList<TraceBuffer *> threads;
+	{
+		QMutexLocker locker(&buffersMutex);
+		threads = buffers;
+	}
+
+	/* Copy each buffer while its thread keeps recording, then drop the spans that may have been
+	   overwritten during the copy */
+	QVector<QVector<TraceEvent> > threadEvents;
+	qint64 firstStart = -1;
+	foreach (TraceBuffer *buffer, threads)
+	{
+		quint64 head = buffer->head.loadAcquire();
+		quint64 first = (head > TRACE_BUFFER_SIZE) ? (head - TRACE_BUFFER_SIZE) : 0;
+
+		QVector<TraceEvent> events;
+		events.reserve(head - first);
+		for (quint64 i = first; i < head; i++)
+		{
+			events.append(buffer->events[i & (TRACE_BUFFER_SIZE - 1)]);
+		}
+
+		// The slot after the newest span may be mid-write too
+		quint64 after = buffer->head.loadAcquire();
+		quint64 firstIntact = ((after + 1) > TRACE_BUFFER_SIZE) ? ((after + 1) - TRACE_BUFFER_SIZE) : 0;
+		if (firstIntact > first)
+		{
+			events.remove(0, qMin((int)(firstIntact - first), events.size()));
+		}
+
+		foreach (const TraceEvent &event, events)
+		{
+			if ((firstStart < 0) || (event.start < firstStart))
+			{
+				firstStart = event.start;
+			}
+		}
+
+		threadEvents.append(events);
+	}
+
+	QByteArray json;
+	json.append("{\"traceEvents\":[\n");
+
+	int spanCount = 0;
+	for (int t = 0; t < threads.size(); t++)
+	{
+		TraceBuffer *buffer = threads.at(t);
+		QByteArray tid = QByteArray::number(buffer->threadId);
+
+		json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"");
+		json.append(buffer->threadName.toUtf8().replace('\\', "\\\\").replace('"', "\\\""));
+		json.append("\"}}");
+
+		foreach (const TraceEvent &event, threadEvents.at(t))
+		{
+			json.append(",\n{\"name\":\"");
+			json.append(event.name);
+			json.append("\",\"cat\":\"");
+			json.append(event.category);
+			json.append("\",\"ph\":\"X\",\"ts\":");
+			appendMicroseconds(&json, event.start - firstStart);
+			json.append(",\"dur\":");
+			appendMicroseconds(&json, event.duration);
+			json.append(",\"pid\":1,\"tid\":" + tid + "}");
+			spanCount++;
+		}
+
+		json.append((t + 1 < threads.size()) ? ",\n" : "\n");
+	}
+
+	json.append("],\"displayTimeUnit\":\"ns\"}\n");
+
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly) || (file.write(json) != json.size()))
+	{
+		qCDebug(lcUi) << "Failed to write trace file:" << path;
+		return false;
+	}
+
+	qCDebug(lcUi) << "Wrote" << spanCount << "spans from" << threads.size() << "threads to" << path;
+
+	return true;
+}
@@ -0,0 +1,75 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QAtomicInt>
+
+/*
+ * Timing spans for finding out where an import or export spends its time. A span covers the rest of
+ * the enclosing scope, or up to end():
+ *
+ *     TRACE_SPAN("import", "LabRadar report");
+ *
+ * Category and name must be string literals, only the pointers are kept. Every thread records into
+ * its own ring buffer without locking, and once a buffer fills the oldest spans are overwritten.
+ * Recording is off until setEnabled(true). A span created while it's off costs one atomic load.
+ *
+ * writeChromeTrace() saves the recorded spans as Chrome trace_event JSON, which chrome://tracing and
+ * ui.perfetto.dev can open.
+ */
+class Trace
+{
+public:
+	static void setEnabled(bool enabled);
+
+	static bool isEnabled()
+	{
+		return enabled.loadRelaxed() != 0;
+	}
+
+	// Monotonic nanoseconds
+	static qint64 now();
+
+	static void record(const char *category, const char *name, qint64 start, qint64 duration);
+
+	// Writes every span still in the ring buffers. Returns false if the file can't be written.
+	static bool writeChromeTrace(const QString &path);
+
+private:
+	static QAtomicInt enabled;
+};
+
+class TraceSpan
+{
+public:
+	TraceSpan(const char *category, const char *name)
+		: category(category), name(name), start(Trace::isEnabled() ? Trace::now() : -1)
+	{
+	}
+
+	~TraceSpan()
+	{
+		end();
+	}
+
+	// Ends the span before the end of the scope
+	void end()
+	{
+		if (start >= 0)
+		{
+			Trace::record(category, name, start, Trace::now() - start);
+			start = -1;
+		}
+	}
+
+private:
+	const char *category;
+	const char *name;
+	qint64 start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(category, name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(category, name)
+
+#endif // TRACE_H
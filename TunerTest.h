@@ -13,13 +13,19 @@
 #include <QPushButton>
 #include <QStackedWidget>
 #include <QSpinBox>
-#include <QScrollArea>
-#include <QGridLayout>
+#include <QTableView>
+#include <QIcon>
 #include <QDialog>
 #include <QMainWindow>
 #include <QTextEdit>
 
 #include "ChronoPlotter.h"
+#include "SeriesStore.h"
+#include "SeriesArena.h"
+#include "SeriesTable.h"
+
+class RenderBenchmark;
+class Job;
 
 namespace Tuner
 {
@@ -27,7 +33,7 @@ namespace Tuner
 	{
 		bool isValid;
 		int seriesNum;
-		QLabel *name;
+		QString name;
 		QList<QPair<double, double> > coordinates;
 		QList<QPair<double, double> > coordinates_sighters;
 		QList<double> extremeSpread;
@@ -43,21 +49,65 @@ namespace Tuner
 		int targetDistance; // in yards
 		QString firstDate;
 		QString firstTime;
-		QSpinBox *tunerSetting;
-		QDoubleSpinBox *groupSize;
-		QLabel *groupSizeLabel;
-		QPushButton *deleteButton;
-		QCheckBox *enabled;
-		bool deleted;
+		qint64 timestamp; // see TimestampParser
+		int tunerSetting;
+		bool manualEntry; // group size is entered by hand rather than calculated from coordinates
+		double groupSize;
+		QString groupSizeText;
+		bool tooFewShots;
+		bool enabled;
+	};
+
+	/*
+	 * Table model over the tuner test's series list. Imported series show their calculated group size and date,
+	 * manually entered series have an editable group size and a delete button.
+	 */
+	class TunerSeriesModel : public SeriesTableModel
+	{
+	public:
+		enum Column
+		{
+			ENABLED_COLUMN,
+			NAME_COLUMN,
+			TUNER_SETTING_COLUMN,
+			GROUP_SIZE_COLUMN,
+			DATE_COLUMN,
+			DELETE_COLUMN = DATE_COLUMN
+		};
+
+		TunerSeriesModel(QList<TunerSeries*> *seriesData, bool manualEntry, QObject *parent = 0);
+
+		virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		virtual int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+		virtual bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) Q_DECL_OVERRIDE;
+		virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+		virtual Qt::ItemFlags flags(const QModelIndex &index) const Q_DECL_OVERRIDE;
+
+		bool isManualEntry(void) const;
+		TunerSeries *seriesAt(int row) const;
+		void appendSeries(TunerSeries *series);
+		void removeSeries(int row);
+		void setAllEnabled(bool enabled);
+		void setGroupSizeHeader(const QString &header);
+
+	private:
+		QList<TunerSeries*> *seriesData;
+		bool manualEntry;
+		QString groupSizeHeader;
+		QIcon deleteIcon;
 	};
 
 	class TunerTest : public QWidget
 	{
 		Q_OBJECT
 
+		// Drives buildGraph() with generated series
+		friend class ::RenderBenchmark;
+
 		public:
 			TunerTest(QWidget *parent = 0);
-			~TunerTest() {};
+			~TunerTest();
 			QList<TunerSeries *> tunerSeriesData;
 
 		public slots:
@@ -70,19 +120,22 @@ namespace Tuner
 			void importedGroupMeasurementTypeChanged(int);
 			void importedGroupUnitsChanged(int);
 			void loadNewShotData(bool);
+			void refreshDisplayedData(void);
 			void selectShotMarkerFile(bool);
 			void manualDataEntry(bool);
 			void addNewClicked(bool);
-			void deleteClicked(bool);
+			void seriesTableClicked(const QModelIndex &);
 			void autofillClicked(bool);
 			void headerCheckBoxChanged(int);
-			void seriesCheckBoxChanged(int);
-			void seriesManualCheckBoxChanged(int);
 			void showGraph(bool);
 			void saveGraph(bool);
+			void showTargets(bool);
+			void saveSession(bool);
+			void loadSession(bool);
 
 		protected:
 			void updateDisplayedData ( void );
+			void displayedDataChanged ( void );
 			double calculateES ( QList<QPair<double, double> > );
 			double calculateYStdev ( QList<QPair<double, double> > );
 			double calculateXStdev ( QList<QPair<double, double> > );
@@ -90,23 +143,36 @@ namespace Tuner
 			static double pairSumX ( double, const QPair<double, double> );
 			static double pairSumY ( double, const QPair<double, double> );
 			double calculateMR ( QList<QPair<double, double> > );
-			QList<TunerSeries *> ExtractShotMarkerSeriesTar ( QString );
-			QList<TunerSeries *> ExtractShotMarkerSeriesCsv ( QTextStream & );
 			void optionCheckBoxChanged(QCheckBox *, QLabel *, QComboBox *);
 			void DisplaySeriesData ( void );
+			void displayImportedSeries ( void );
+			void createManualEntryTable ( void );
+			void calculateGroupSizes ( TunerSeries * );
+			bool calculateGroupSizes ( const QList<TunerSeries *> & );
+			void calculateGroupMetrics ( TunerSeries * );
+			void updateGroupSizeText ( TunerSeries * );
+			static void groupMetricsJob ( Job *, void * );
+			QList<QPair<QString, QWidget *> > sessionOptions ( void );
+			void releaseSession ( void );
+			void deleteSeries ( int );
+			QString groupSizeHeaderText ( void );
+			QCustomPlot *buildGraph ( void );
 			void renderGraph ( bool );
+			static qint64 shotDataBytes ( const void * );
+			static qint64 metricCacheBytes ( const void * );
 
 		private:
 			GraphPreview *graphPreview;
+			GraphPreview *targetPreview;
 			QString prevSaveDir;
 			QString prevShotMarkerDir;
+			QString prevSessionDir;
 			QStackedWidget *stackedWidget;
-			QWidget *scrollWidget;
-			QVBoxLayout *scrollLayout;
-			QScrollArea *scrollArea;
-			QGridLayout *tunerSeriesGrid;
-			QLabel *headerLengthType;
-			QLabel *headerGroupType;
+			SeriesArena<TunerSeries> seriesArena;
+			QWidget *seriesWidget;
+			QTableView *seriesTable;
+			TunerSeriesModel *seriesModel;
+			bool displayedDataRefreshPending;
 			QLineEdit *graphTitle;
 			QLineEdit *rifle;
 			QLineEdit *projectile;
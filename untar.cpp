@@ -34,6 +34,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QIODevice>
+#include "Logging.h"
 
 /* Parse an octal number, ignoring leading and trailing nonsense. */
 static int
@@ -93,39 +94,39 @@ untar(QFile &rf, QString tempDir)
 	for (;;) {
 		bytes_read = rf.read(buff, 512);
 		if (bytes_read < 512) {
-			qDebug() << "Short read: expected 512, got" << bytes_read;
+			qCDebug(lcImport) << "Short read: expected 512, got" << bytes_read;
 			return -1;
 		}
 		if (is_end_of_archive(buff)) {
-			qDebug() << "End of archive";
+			qCDebug(lcImport) << "End of archive";
 			break;
 		}
 		if (!verify_checksum(buff)) {
-			qDebug() << "Checksum failure";
+			qCDebug(lcImport) << "Checksum failure";
 			return -1;
 		}
 		filesize = parseoct(buff + 124, 12);
 		switch (buff[156]) {
 		case '1':
-			qDebug() << " Ignoring hardlink" << buff;
+			LOG_TRACE(lcImportTrace) << " Ignoring hardlink" << buff;
 			break;
 		case '2':
-			qDebug() << " Ignoring symlink" << buff;
+			LOG_TRACE(lcImportTrace) << " Ignoring symlink" << buff;
 			break;
 		case '3':
-			qDebug() << " Ignoring character device" << buff;
+			LOG_TRACE(lcImportTrace) << " Ignoring character device" << buff;
 			break;
 		case '4':
-			qDebug() << " Ignoring block device" << buff;
+			LOG_TRACE(lcImportTrace) << " Ignoring block device" << buff;
 			break;
 		case '5':
-			qDebug() << " Ignoring dir" << buff;
+			LOG_TRACE(lcImportTrace) << " Ignoring dir" << buff;
 			break;
 		case '6':
-			qDebug() << " Ignoring FIFO" << buff;
+			LOG_TRACE(lcImportTrace) << " Ignoring FIFO" << buff;
 			break;
 		default:
-			qDebug() << " Extracting file" << buff;
+			LOG_TRACE(lcImportTrace) << " Extracting file" << buff;
 
 			QString path(tempDir);
 			path.append("/");
@@ -134,14 +135,14 @@ untar(QFile &rf, QString tempDir)
 			wf = new QFile(path);
 			if ( ! wf->open(QIODevice::WriteOnly) )
 			{
-				qDebug() << "Failed to create file, skipping...";
+				qCDebug(lcImport) << "Failed to create file, skipping...";
 			}
 			break;
 		}
 		while (filesize > 0) {
 			bytes_read = rf.read(buff, 512);
 			if (bytes_read < 512) {
-				qDebug() << "Short read: Expected 512, got" << bytes_read;
+				qCDebug(lcImport) << "Short read: Expected 512, got" << bytes_read;
 				return -1;
 			}
 			if (filesize < 512)